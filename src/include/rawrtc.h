@@ -329,6 +329,15 @@ enum rawrtc_ice_server_transport {
     RAWRTC_ICE_SERVER_TRANSPORT_TLS
 };
 
+/*
+ * Drop policy of the ICE gatherer's early packet buffer once it is
+ * full.
+ */
+enum rawrtc_ice_gatherer_buffer_drop_policy {
+    RAWRTC_ICE_GATHERER_BUFFER_DROP_NEWEST, // drop arriving packets
+    RAWRTC_ICE_GATHERER_BUFFER_DROP_OLDEST // overwrite the oldest packet
+};
+
 /*
  * Length of various arrays.
  * TODO: private
@@ -354,6 +363,17 @@ struct rawrtc_data_transport;
 struct rawrtc_sctp_transport;
 struct rawrtc_sctp_capabilities;
 struct rawrtc_peer_connection_ice_candidate;
+struct rawrtc_shard;
+struct rawrtc_sctp_message_stream;
+struct rawrtc_sid_map;
+struct rawrtc_sctp_redirect_demux;
+struct rawrtc_sctp_redirect_demux_entry;
+struct rawrtc_path_mtu;
+struct rawrtc_dtls_context;
+struct rawrtc_dtls_handshake;
+struct rawrtc_certificate_pool;
+struct rawrtc_udp_mux;
+struct rawrtc_udp_mux_entry;
 
 
 
@@ -472,6 +492,43 @@ typedef void (rawrtc_data_channel_message_handler)(
     void* const arg
 );
 
+/*
+ * Scatter-gather view of a complete message.
+ * `buffers` contains the message's chunks in order, each one ranging
+ * from its position to its end. The buffers MUST NOT be modified.
+ * Reference the view to keep it beyond the handler's invocation.
+ */
+struct rawrtc_data_channel_message_view {
+    struct mbuf** buffers; // referenced
+    size_t n_buffers;
+    uint64_t length;
+};
+
+/*
+ * Data channel message view handler.
+ * Replaces the message handler in case partial delivery has not been
+ * requested. Hands out the received chunks without copying them into a
+ * single buffer.
+ */
+typedef void (rawrtc_data_channel_message_view_handler)(
+    struct rawrtc_data_channel_message_view* const view,
+    enum rawrtc_data_channel_message_flag const flags,
+    void* const arg
+);
+
+/*
+ * Data channel message producer.
+ * Write the next part of a streamed message into `buffer`. At most
+ * `mbuf_get_space(buffer)` bytes should be written. Set `*lastp` to
+ * `true` once the last part of the message has been written. Only the
+ * last part may be empty. Returning an error aborts the message.
+ */
+typedef enum rawrtc_code (rawrtc_data_channel_message_producer)(
+    struct mbuf* const buffer, // written into
+    bool* const lastp, // de-referenced
+    void* const arg
+);
+
 /*
  * Data channel handler.
  *
@@ -540,6 +597,16 @@ typedef void (rawrtc_dtls_transport_receive_handler)(
     void* const arg
 );
 
+/*
+ * Handle path MTU changes (maximum size of a data message that fits
+ * into a single DTLS record).
+ * TODO: private -> dtls_transport.h
+ */
+typedef void (rawrtc_dtls_transport_path_mtu_handler)(
+    size_t const path_mtu,
+    void* const arg
+);
+
 /*
  * Create the data channel (transport handler).
  * TODO: private -> data_transport.h
@@ -568,6 +635,39 @@ typedef enum rawrtc_code (rawrtc_data_transport_channel_send_handler)(
     bool const is_binary
 );
 
+/*
+ * Send a batch of messages via the data channel (transport handler).
+ * TODO: private -> data_transport.h
+ */
+typedef enum rawrtc_code (rawrtc_data_transport_channel_send_batch_handler)(
+    size_t* const n_sentp, // de-referenced
+    struct rawrtc_data_channel* const channel,
+    struct mbuf* const * const buffers, // entries nullable (if size 0), referenced
+    size_t const n_buffers,
+    bool const is_binary
+);
+
+/*
+ * Send a streamed message via the data channel (transport handler).
+ * TODO: private -> data_transport.h
+ */
+typedef enum rawrtc_code (rawrtc_data_transport_channel_send_stream_handler)(
+    struct rawrtc_data_channel* const channel,
+    rawrtc_data_channel_message_producer* const producer,
+    size_t const window,
+    bool const is_binary,
+    void* const arg // nullable
+);
+
+/*
+ * Get the amount of bytes buffered on the data channel (transport handler).
+ * TODO: private -> data_transport.h
+ */
+typedef enum rawrtc_code (rawrtc_data_transport_channel_get_buffered_amount_handler)(
+    uint64_t* const buffered_amountp, // de-referenced
+    struct rawrtc_data_channel* const channel
+);
+
 
 
 /*
@@ -585,6 +685,21 @@ struct rawrtc_config {
     enum rawrtc_ice_server_transport ice_server_secure_transport;
     uint32_t stun_keepalive_interval;
     struct stun_conf stun_config;
+    bool sctp_receive_buffer_recycle;
+    bool sctp_packet_batching;
+    uint32_t sctp_timer_interval; // in milliseconds, must not be 0
+    uint32_t sctp_timer_idle_interval; // in milliseconds
+    uint32_t path_mtu_min; // UDP payload size in bytes, must be at least 576
+    uint32_t path_mtu_max; // UDP payload size in bytes, equal to the minimum disables probing
+    bool dtls_context_sharing;
+    uint32_t dtls_session_cache_size; // initial per shard, 0 disables resumption (as does no sharing)
+    bool ice_udp_mux; // default for gather options
+    uint16_t ice_udp_mux_port; // default for gather options, 0 binds to an ephemeral port
+    bool ice_lite; // default for gather options
+    uint32_t udp_receive_batch_size; // default for gather options
+    uint16_t ice_gatherer_buffer_slots; // default for gather options
+    uint16_t ice_gatherer_buffer_slot_size; // default for gather options
+    enum rawrtc_ice_gatherer_buffer_drop_policy ice_gatherer_buffer_drop_policy; // likewise
 };
 
 /*
@@ -621,6 +736,16 @@ struct rawrtc_certificate {
     enum rawrtc_certificate_key_type key_type;
 };
 
+/*
+ * Certificate pool statistics.
+ */
+struct rawrtc_certificate_pool_statistics {
+    uint64_t generated; // by the background workers
+    uint64_t taken; // pre-generated certificates handed out
+    uint64_t generated_on_demand; // since the pool was empty
+    uint32_t available;
+};
+
 /*
  * ICE gather options.
  * TODO: private
@@ -628,6 +753,16 @@ struct rawrtc_certificate {
 struct rawrtc_ice_gather_options {
     enum rawrtc_ice_gather_policy gather_policy;
     struct list ice_servers;
+    uint32_t path_mtu_min; // UDP payload size in bytes
+    uint32_t path_mtu_max; // UDP payload size in bytes
+    uint32_t path_mtu_artificial_limit; // for testing only, 0 disables the limit
+    bool udp_mux;
+    uint16_t udp_mux_port; // 0 binds to an ephemeral port
+    bool ice_lite;
+    uint32_t udp_receive_batch_size; // datagrams per wakeup (host candidates), 0 disables
+    uint16_t buffer_slots; // early packets per ICE gatherer, 0 disables buffering
+    uint16_t buffer_slot_size; // in bytes, larger packets are dropped
+    enum rawrtc_ice_gatherer_buffer_drop_policy buffer_drop_policy;
 };
 
 /*
@@ -698,6 +833,28 @@ struct rawrtc_ice_candidate {
     } candidate;
 };
 
+/*
+ * Batched UDP receive statistics (shared by all host candidate sockets
+ * of a shard).
+ */
+struct rawrtc_udp_receive_statistics {
+    uint64_t wakeups;
+    uint64_t datagrams;
+    uint64_t datagrams_max; // in a single wakeup
+    uint64_t full_batches; // wakeups that filled the batch
+    uint64_t datagrams_truncated; // larger than the receive buffer, discarded
+};
+
+/*
+ * ICE gatherer early packet buffer statistics.
+ */
+struct rawrtc_ice_gatherer_buffer_statistics {
+    uint64_t packets_buffered;
+    uint64_t packets_replayed;
+    uint64_t packets_dropped; // buffer full, according to the drop policy
+    uint64_t packets_oversized; // exceeding the slot size, dropped
+};
+
 /*
  * ICE parameters.
  * TODO: private
@@ -719,13 +876,16 @@ struct rawrtc_ice_gatherer {
     rawrtc_ice_gatherer_error_handler* error_handler; // nullable
     rawrtc_ice_gatherer_local_candidate_handler* local_candidate_handler; // nullable
     void* arg; // nullable
-    struct list buffered_messages; // TODO: Can this be added to the candidates list?
+    struct rawrtc_packet_ring* buffered_packets; // referenced
     struct list local_candidates; // TODO: Hash list instead?
     char ice_username_fragment[ICE_USERNAME_FRAGMENT_LENGTH + 1];
     char ice_password[ICE_PASSWORD_LENGTH + 1];
     struct trice* ice;
     struct trice_conf ice_config;
-    struct dnsc* dns_client;
+    struct dnsc* dns_client; // NULL in case of ICE lite
+    bool ice_lite;
+    ice_estab_h* nomination_handler; // nullable, ICE lite only
+    void* nomination_arg; // nullable
 };
 
 /*
@@ -740,6 +900,21 @@ struct rawrtc_ice_transport {
     void* arg; // nullable
     struct rawrtc_ice_parameters* remote_parameters; // referenced
     struct rawrtc_dtls_transport* dtls_transport; // referenced, nullable
+    struct stun* stun;
+};
+
+/*
+ * ICE transport demultiplexing statistics (datagrams received on the
+ * gatherer's local candidates by class).
+ * https://tools.ietf.org/html/rfc7983#section-7
+ */
+struct rawrtc_ice_transport_demux_statistics {
+    uint64_t stun;
+    uint64_t dtls;
+    uint64_t turn_channel;
+    uint64_t rtp; // and RTCP
+    uint64_t other; // ZRTP, unassigned or empty
+    uint64_t dropped; // no handler for the class
 };
 
 /*
@@ -761,6 +936,18 @@ struct rawrtc_dtls_parameters {
     struct rawrtc_dtls_fingerprints* fingerprints;
 };
 
+/*
+ * DTLS transport statistics.
+ */
+struct rawrtc_dtls_transport_statistics {
+    uint64_t datagrams_sent;
+    uint64_t send_calls;
+    uint64_t path_cache_hits;
+    uint64_t path_updates;
+    uint64_t datagrams_discarded; // exceeding the artificial path MTU limit
+    uint64_t sessions_resumed;
+};
+
 /*
  * DTLS transport.
  * TODO: private
@@ -778,14 +965,43 @@ struct rawrtc_dtls_transport {
     struct list buffered_messages_in;
     struct list buffered_messages_out;
     struct list fingerprints;
-    struct tls* context;
+    bool context_sharing;
+    struct rawrtc_dtls_context* context; // referenced
     struct dtls_sock* socket;
     struct tls_conn* connection;
+    struct rawrtc_dtls_handshake* handshake; // referenced, nullable
+    SSL_SESSION* session; // referenced, nullable
     rawrtc_dtls_transport_receive_handler* receive_handler;
+    rawrtc_dtls_transport_path_mtu_handler* path_mtu_handler; // nullable
     void* receive_handler_arg;
+    bool batching;
+    struct list batched_datagrams_out;
+    struct udp_sock* active_socket; // referenced, nullable
+    struct sa active_remote_address;
+    struct rawrtc_path_mtu* path_mtu; // referenced
+    struct rawrtc_dtls_transport_statistics statistics;
 };
 
 #ifdef SCTP_REDIRECT_TRANSPORT
+/*
+ * Maximum amount of packets received or sent by the redirect
+ * transport with a single system call.
+ * TODO: private
+ */
+enum {
+    RAWRTC_SCTP_REDIRECT_TRANSPORT_BATCH_SIZE = 32
+};
+
+/*
+ * Redirect transport statistics.
+ */
+struct rawrtc_sctp_redirect_transport_statistics {
+    uint64_t packets_received;
+    uint64_t receive_calls;
+    uint64_t packets_sent;
+    uint64_t send_calls;
+};
+
 /*
  * Redirect transport.
  */
@@ -795,8 +1011,12 @@ struct rawrtc_sctp_redirect_transport {
     uint16_t local_port;
     uint16_t remote_port;
     struct sa redirect_address;
-    struct mbuf* buffer;
-    int socket;
+    struct rawrtc_sctp_redirect_demux* demux; // referenced
+    struct rawrtc_sctp_redirect_demux_entry* demux_entry; // referenced, nullable
+    struct list buffers_out;
+    struct tmr flush_timer;
+    bool incremental_checksum;
+    struct rawrtc_sctp_redirect_transport_statistics statistics;
 };
 #endif
 
@@ -810,6 +1030,9 @@ struct rawrtc_data_transport {
     rawrtc_data_transport_channel_create_handler* channel_create;
     rawrtc_data_transport_channel_close_handler* channel_close;
     rawrtc_data_transport_channel_send_handler* channel_send;
+    rawrtc_data_transport_channel_send_batch_handler* channel_send_batch; // nullable
+    rawrtc_data_transport_channel_send_stream_handler* channel_send_stream; // nullable
+    rawrtc_data_transport_channel_get_buffered_amount_handler* channel_get_buffered_amount;
 };
 
 /*
@@ -823,6 +1046,7 @@ struct rawrtc_data_channel_parameters {
     char* protocol; // copied
     bool negotiated;
     uint16_t id;
+    uint16_t priority;
 };
 
 /*
@@ -841,6 +1065,36 @@ struct rawrtc_sctp_capabilities {
     uint64_t max_message_size;
 };
 
+/*
+ * SCTP transport statistics.
+ */
+struct rawrtc_sctp_transport_statistics {
+    uint64_t receive_calls;
+    uint64_t receive_buffer_allocations;
+    uint64_t messages_received;
+};
+
+/*
+ * SCTP timer statistics (shared by all SCTP transports).
+ */
+struct rawrtc_sctp_timer_statistics {
+    uint64_t ticks;
+    uint64_t idle_ticks;
+};
+
+/*
+ * SCTP callback statistics (shared by all SCTP transports).
+ * usrsctp callbacks invoked on a thread other than the transport's
+ * shard either lock the event loop or are handed off to the shard.
+ */
+struct rawrtc_sctp_callback_statistics {
+    uint64_t callbacks;
+    uint64_t locked_callbacks;
+    uint64_t lock_wait_time; // in microseconds
+    uint64_t handed_off_callbacks;
+    uint64_t handoff_latency; // in microseconds
+};
+
 /*
  * SCTP transport.
  * TODO: private
@@ -853,15 +1107,26 @@ struct rawrtc_sctp_transport {
     rawrtc_data_channel_handler* data_channel_handler; // nullable
     rawrtc_sctp_transport_state_change_handler* state_change_handler; // nullable
     void* arg; // nullable
-    struct list buffered_messages_outgoing;
+    struct list contexts_outgoing; // contexts with buffered outgoing messages
+    struct rawrtc_sctp_data_channel_context* context_default; // used for raw messages
+    struct rawrtc_sctp_data_channel_context* context_sending; // nullable, partially sent
+    uint64_t virtual_time;
     struct mbuf* buffer_dcep_inbound;
     struct sctp_rcvinfo info_dcep_inbound;
-    struct rawrtc_data_channel** channels;
+    struct rawrtc_sid_map* channels; // referenced
     uint_fast16_t n_channels;
     uint_fast16_t current_channel_sid;
     FILE* trace_handle;
     struct socket* socket;
     uint_fast8_t flags;
+    struct mbuf* buffer_receive; // recycled, nullable
+    struct rawrtc_sctp_transport_statistics statistics;
+    struct le batch_le;
+    struct rawrtc_shard* shard; // pinned
+    uintptr_t address; // usrsctp address, unique (never re-used)
+    bool callback_handoff; // accessed atomically
+    struct le shard_le;
+    struct le global_le;
 };
 
 /*
@@ -869,9 +1134,17 @@ struct rawrtc_sctp_transport {
  * TODO: private
  */
 struct rawrtc_sctp_data_channel_context {
+    struct le le;
     uint16_t sid;
     uint_fast8_t flags;
+    uint_fast16_t priority;
+    uint64_t virtual_finish_time;
+    struct list buffered_messages_outgoing;
+    uint64_t buffered_amount;
+    struct rawrtc_sctp_message_stream* stream; // nullable
     struct mbuf* buffer_inbound;
+    struct list chunks_inbound;
+    uint64_t length_inbound;
     struct sctp_rcvinfo info_inbound;
 };
 
@@ -891,7 +1164,10 @@ struct rawrtc_data_channel {
     rawrtc_data_channel_error_handler* error_handler; // nullable
     rawrtc_data_channel_close_handler* close_handler; // nullable
     rawrtc_data_channel_message_handler* message_handler; // nullable
+    rawrtc_data_channel_message_view_handler* message_view_handler; // nullable
     void* arg; // nullable
+    uint64_t buffered_amount_low_threshold;
+    uint64_t message_size_hint;
 };
 
 /*
@@ -901,7 +1177,18 @@ struct rawrtc_peer_connection_configuration {
     enum rawrtc_ice_gather_policy gather_policy;
     struct list ice_servers;
     struct list certificates;
+    struct rawrtc_certificate_pool* certificate_pool; // referenced, nullable
     bool sctp_sdp_05;
+    uint32_t path_mtu_min; // UDP payload size in bytes
+    uint32_t path_mtu_max; // UDP payload size in bytes
+    bool dtls_context_sharing;
+    bool ice_udp_mux;
+    uint16_t ice_udp_mux_port; // 0 binds to an ephemeral port
+    bool ice_lite;
+    uint32_t udp_receive_batch_size; // datagrams per wakeup (host candidates), 0 disables
+    uint16_t ice_gatherer_buffer_slots; // 0 disables buffering
+    uint16_t ice_gatherer_buffer_slot_size; // in bytes
+    enum rawrtc_ice_gatherer_buffer_drop_policy ice_gatherer_buffer_drop_policy;
 };
 
 /*
@@ -981,10 +1268,13 @@ struct rawrtc_peer_connection {
  */
 enum {
     RAWRTC_LAYER_SCTP = 20,
-    RAWRTC_LAYER_DTLS_SRTP_STUN = 10, // TODO: Pretty sure we are able to detect STUN earlier
+    RAWRTC_LAYER_DTLS_SRTP_STUN = 10, // packets that came through the layers below
     RAWRTC_LAYER_ICE = 0,
     RAWRTC_LAYER_STUN = -10,
-    RAWRTC_LAYER_TURN = -10
+    RAWRTC_LAYER_TURN = -10,
+    RAWRTC_LAYER_PACKET_DEMUX = -15, // classifies packets before STUN/TURN parsing
+    RAWRTC_LAYER_UDP_MUX = -15, // hands datagrams of shared sockets to the ICE agents
+    RAWRTC_LAYER_UDP_BATCH = -20 // dispatches batched datagrams to the layers above
 };
 
 
@@ -1047,6 +1337,39 @@ enum rawrtc_code rawrtc_init();
  */
 enum rawrtc_code rawrtc_close();
 
+/*
+ * Initialise the calling thread as a shard running its own event loop.
+ * All instances created on this thread are pinned to it and MUST only
+ * be used from this thread. Call `re_main` to run the event loop.
+ *
+ * This allows to spread peer connections across several threads.
+ */
+enum rawrtc_code rawrtc_thread_init();
+
+/*
+ * Close the shard of the calling thread. All instances pinned to the
+ * shard MUST have been destroyed before.
+ */
+enum rawrtc_code rawrtc_thread_close();
+
+/*
+ * Set the maximum amount of DTLS client sessions the shard of the
+ * calling thread caches for resumption (RFC 5077). `0` disables
+ * resumption for DTLS transports created afterwards. Resumption
+ * requires DTLS context sharing.
+ */
+enum rawrtc_code rawrtc_shard_set_dtls_session_cache_size(
+    uint32_t const size
+);
+
+/*
+ * Get a snapshot of the batched UDP receive statistics of the calling
+ * thread's shard.
+ */
+enum rawrtc_code rawrtc_shard_get_receive_statistics(
+    struct rawrtc_udp_receive_statistics* const statisticsp // written into
+);
+
 /*
  * Create certificate options.
  *
@@ -1083,9 +1406,89 @@ enum rawrtc_code rawrtc_certificate_generate(
     struct rawrtc_certificate_options* options // nullable
 );
 
+/*
+ * Get PEM of the certificate and/or the private key if requested.
+ * *pemp will NOT be null-terminated!
+ */
+enum rawrtc_code rawrtc_certificate_get_pem(
+    char** const pemp,  // de-referenced
+    size_t* const pem_lengthp,  // de-referenced
+    struct rawrtc_certificate* const certificate,
+    enum rawrtc_certificate_encode const to_encode
+);
+
+/*
+ * Get DER of the certificate and/or the private key if requested.
+ * *derp will NOT be null-terminated!
+ */
+enum rawrtc_code rawrtc_certificate_get_der(
+    uint8_t** const derp,  // de-referenced
+    size_t* const der_lengthp,  // de-referenced
+    struct rawrtc_certificate* const certificate,
+    enum rawrtc_certificate_encode const to_encode
+);
+
+/*
+ * Create a certificate from a PEM encoded x509 certificate and its
+ * PEM encoded private key, as returned by
+ * `rawrtc_certificate_get_pem` with `RAWRTC_CERTIFICATE_ENCODE_BOTH`.
+ * The order of both sections does not matter.
+ * `pem` does not need to be null-terminated.
+ */
+enum rawrtc_code rawrtc_certificate_from_pem(
+    struct rawrtc_certificate** const certificatep, // de-referenced
+    char const* const pem,
+    size_t const pem_length
+);
+
+/*
+ * Create a certificate from a DER encoded x509 certificate directly
+ * followed by its DER encoded private key, as returned by
+ * `rawrtc_certificate_get_der` with `RAWRTC_CERTIFICATE_ENCODE_BOTH`.
+ */
+enum rawrtc_code rawrtc_certificate_from_der(
+    struct rawrtc_certificate** const certificatep, // de-referenced
+    uint8_t const* const der,
+    size_t const der_length
+);
+
+/*
+ * Create a certificate pool that keeps `n_certificates` self-signed
+ * certificates pre-generated by `n_workers` background threads.
+ *
+ * Sane and safe default options will be applied if `options` is
+ * `NULL`.
+ *
+ * The pool can be used from any thread. However, like all other
+ * instances, it MUST be referenced and un-referenced on a single
+ * thread only.
+ */
+enum rawrtc_code rawrtc_certificate_pool_create(
+    struct rawrtc_certificate_pool** const poolp, // de-referenced
+    struct rawrtc_certificate_options* const options, // nullable, referenced
+    uint32_t const n_certificates,
+    uint32_t const n_workers
+);
+
+/*
+ * Take a pre-generated certificate from the pool. Generates the
+ * certificate on the calling thread in case the pool is empty.
+ */
+enum rawrtc_code rawrtc_certificate_pool_get(
+    struct rawrtc_certificate** const certificatep, // de-referenced
+    struct rawrtc_certificate_pool* const pool
+);
+
+/*
+ * Get the certificate pool's statistics.
+ */
+enum rawrtc_code rawrtc_certificate_pool_get_statistics(
+    struct rawrtc_certificate_pool_statistics* const statisticsp, // de-referenced
+    struct rawrtc_certificate_pool* const pool
+);
+
 /*
  * TODO http://draft.ortc.org/#dom-rtccertificate
- * rawrtc_certificate_from_bytes
  * rawrtc_certificate_get_expires
  * rawrtc_certificate_get_fingerprint
  * rawrtc_certificate_get_algorithm
@@ -1249,6 +1652,79 @@ enum rawrtc_code rawrtc_ice_gather_options_add_server(
     enum rawrtc_ice_credential_type const credential_type
 );
 
+/*
+ * Set the minimum and maximum path MTU (UDP payload size in bytes) of
+ * the path MTU discovery (RFC 8899). The minimum must be at least 576
+ * bytes. Probing is disabled in case both are equal.
+ */
+enum rawrtc_code rawrtc_ice_gather_options_set_path_mtu(
+    struct rawrtc_ice_gather_options* const options,
+    uint32_t const minimum,
+    uint32_t const maximum
+);
+
+/*
+ * Set an artificial path MTU limit (UDP payload size in bytes). Larger
+ * datagrams are discarded silently as if they were lost on the path.
+ * For testing only, `0` disables the limit (default).
+ */
+enum rawrtc_code rawrtc_ice_gather_options_set_path_mtu_artificial_limit(
+    struct rawrtc_ice_gather_options* const options,
+    uint32_t const limit
+);
+
+/*
+ * Set whether host candidates share one UDP socket per interface and
+ * shard with the host candidates of other ICE gatherers (mux). The
+ * shared sockets are bound to `port` or, if `0`, to an ephemeral port.
+ * Muxes of different shards bound to the same port share it, incoming
+ * datagrams are handed to the shard of the ICE gatherer they belong
+ * to.
+ */
+enum rawrtc_code rawrtc_ice_gather_options_set_udp_mux(
+    struct rawrtc_ice_gather_options* const options,
+    bool const enable,
+    uint16_t const port
+);
+
+/*
+ * Set whether ICE gatherers act as ICE lite agents (RFC 8445). A lite
+ * agent only gathers host candidates and answers connectivity checks
+ * of the remote agent.
+ */
+enum rawrtc_code rawrtc_ice_gather_options_set_ice_lite(
+    struct rawrtc_ice_gather_options* const options,
+    bool const lite
+);
+
+/*
+ * Set the maximum amount of datagrams received on a host candidate's
+ * UDP socket per wakeup with a single system call. `0` and `1`
+ * disable batching (default). The receive buffers hold datagrams up to
+ * the maximum path MTU (but at least 8192 bytes), larger datagrams are
+ * discarded and counted as truncated, see
+ * `rawrtc_shard_get_receive_statistics`.
+ */
+enum rawrtc_code rawrtc_ice_gather_options_set_udp_receive_batch_size(
+    struct rawrtc_ice_gather_options* const options,
+    uint32_t const size
+);
+
+/*
+ * Set the early packet buffer of the ICE gatherer which holds DTLS
+ * records arriving before a DTLS transport has been attached. The
+ * buffer consists of `slots` preallocated slots of `slot_size` bytes
+ * each (`0` slots disable buffering). Larger packets are dropped, the
+ * drop policy decides which packet is being dropped once the buffer
+ * is full.
+ */
+enum rawrtc_code rawrtc_ice_gather_options_set_buffer(
+    struct rawrtc_ice_gather_options* const options,
+    uint16_t const slots,
+    uint16_t const slot_size,
+    enum rawrtc_ice_gatherer_buffer_drop_policy const drop_policy
+);
+
 /*
  * TODO (from RTCIceServer interface)
  * rawrtc_ice_server_set_username
@@ -1319,6 +1795,16 @@ enum rawrtc_code rawrtc_ice_gatherer_get_local_candidates(
     struct rawrtc_ice_gatherer* const gatherer
 );
 
+/*
+ * Get a snapshot of the ICE gatherer's early packet buffer
+ * statistics.
+ */
+enum rawrtc_code rawrtc_ice_gatherer_get_buffer_statistics(
+    struct rawrtc_ice_gatherer_buffer_statistics* const statisticsp, // written into
+    struct rawrtc_ice_gatherer* const gatherer
+);
+
+
 /*
  * TODO (from RTCIceGatherer interface)
  * rawrtc_ice_gatherer_create_associated_gatherer (unsupported)
@@ -1388,6 +1874,14 @@ enum rawrtc_code rawrtc_ice_transport_get_state(
     struct rawrtc_ice_transport* const transport
 );
 
+/*
+ * Get a snapshot of the ICE transport's demultiplexing statistics.
+ */
+enum rawrtc_code rawrtc_ice_transport_get_demux_statistics(
+    struct rawrtc_ice_transport_demux_statistics* const statisticsp, // written into
+    struct rawrtc_ice_transport* const transport
+);
+
 /*
  * rawrtc_ice_transport_get_remote_candidates
  * rawrtc_ice_transport_get_selected_candidate_pair
@@ -1499,6 +1993,16 @@ enum rawrtc_code rawrtc_dtls_transport_create(
     void* const arg // nullable
 );
 
+/*
+ * Set whether the DTLS transport shares its DTLS context with other
+ * DTLS transports of the shard that use identical certificates
+ * (default). Must be called before the DTLS transport is started.
+ */
+enum rawrtc_code rawrtc_dtls_transport_set_context_sharing(
+    struct rawrtc_dtls_transport* const transport,
+    bool const share
+);
+
 /*
  * Start the DTLS transport.
  */
@@ -1537,6 +2041,24 @@ enum rawrtc_code rawrtc_dtls_transport_get_local_parameters(
     struct rawrtc_dtls_transport* const transport
 );
 
+/*
+ * Get a snapshot of the DTLS transport's statistics.
+ */
+enum rawrtc_code rawrtc_dtls_transport_get_statistics(
+    struct rawrtc_dtls_transport_statistics* const statisticsp, // written into
+    struct rawrtc_dtls_transport* const transport
+);
+
+/*
+ * Get the current path MTU (maximum UDP payload size) of the DTLS
+ * transport and whether the search for it has been completed.
+ */
+enum rawrtc_code rawrtc_dtls_transport_get_path_mtu(
+    size_t* const path_mtup, // de-referenced
+    bool* const completep, // de-referenced
+    struct rawrtc_dtls_transport* const transport
+);
+
 /*
  * TODO (from RTCIceTransport interface)
  * rawrtc_dtls_transport_get_remote_parameters
@@ -1573,6 +2095,19 @@ enum rawrtc_code rawrtc_sctp_redirect_transport_stop(
     struct rawrtc_sctp_redirect_transport* const transport
 );
 
+/*
+ * Set whether the checksum of redirected packets is being patched
+ * incrementally (`true`) or recalculated over the whole packet
+ * (`false`, default) when their ports are being rewritten.
+ * Only enable this if the captured packets carry valid checksums which
+ * is not the case on interfaces with checksum offloading (such as
+ * loopback).
+ */
+enum rawrtc_code rawrtc_sctp_redirect_transport_set_incremental_checksum(
+    struct rawrtc_sctp_redirect_transport* const transport,
+    bool const incremental
+);
+
 /*
  * Get the redirected local SCTP port of the SCTP redirect transport.
  */
@@ -1580,6 +2115,14 @@ enum rawrtc_code rawrtc_sctp_redirect_transport_get_port(
     uint16_t* const portp, // de-referenced
     struct rawrtc_sctp_redirect_transport* const transport
 );
+
+/*
+ * Get a snapshot of the SCTP redirect transport's statistics.
+ */
+enum rawrtc_code rawrtc_sctp_redirect_transport_get_statistics(
+    struct rawrtc_sctp_redirect_transport_statistics* const statisticsp, // written into
+    struct rawrtc_sctp_redirect_transport* const transport
+);
 #endif
 
 /*
@@ -1647,6 +2190,18 @@ enum rawrtc_code rawrtc_sctp_transport_stop(
  * rawrtc_sctp_transport_get_state
  */
 
+/*
+ * Set whether usrsctp callbacks invoked on a thread other than the
+ * transport's shard are handed off to the shard (`true`) or lock the
+ * event loop (`false`, default).
+ * Note: In case usrsctp runs its own threads, callbacks invoked on
+ *       these threads are always handed off.
+ */
+enum rawrtc_code rawrtc_sctp_transport_set_callback_handoff(
+    struct rawrtc_sctp_transport* const transport,
+    bool const handoff
+);
+
 /*
  * Get the local port of the SCTP transport.
  */
@@ -1662,6 +2217,38 @@ enum rawrtc_code rawrtc_sctp_transport_get_capabilities(
     struct rawrtc_sctp_capabilities** const capabilitiesp // de-referenced
 );
 
+/*
+ * Get a snapshot of the SCTP transport's statistics.
+ */
+enum rawrtc_code rawrtc_sctp_transport_get_statistics(
+    struct rawrtc_sctp_transport_statistics* const statisticsp, // written into
+    struct rawrtc_sctp_transport* const transport
+);
+
+/*
+ * Get the (approximate) amount of memory in bytes used by the SCTP
+ * transport and its data channels. Memory held by usrsctp's
+ * association is not included.
+ */
+enum rawrtc_code rawrtc_sctp_transport_get_memory_usage(
+    size_t* const sizep, // de-referenced
+    struct rawrtc_sctp_transport* const transport
+);
+
+/*
+ * Get a snapshot of the (global) SCTP timer's statistics.
+ */
+enum rawrtc_code rawrtc_sctp_transport_get_timer_statistics(
+    struct rawrtc_sctp_timer_statistics* const statisticsp // written into
+);
+
+/*
+ * Get a snapshot of the (global) SCTP callback statistics.
+ */
+enum rawrtc_code rawrtc_sctp_transport_get_callback_statistics(
+    struct rawrtc_sctp_callback_statistics* const statisticsp // written into
+);
+
 /*
  * TODO (from RTCSctpTransport interface)
  * rawrtc_sctp_transport_set_data_channel_handler
@@ -1727,6 +2314,27 @@ enum rawrtc_code rawrtc_data_channel_parameters_get_protocol(
  * rawrtc_data_channel_parameters_get_id
  */
 
+/*
+ * Set the priority of the data channel parameters.
+ * Commonly used values are the priorities defined for DCEP: `128`
+ * (below normal), `256` (normal), `512` (high) and `1024` (extra
+ * high). A channel's share of the available bandwidth is proportional
+ * to its priority, the priority must not be `0`.
+ * Defaults to `256` (normal).
+ */
+enum rawrtc_code rawrtc_data_channel_parameters_set_priority(
+    struct rawrtc_data_channel_parameters* const parameters,
+    uint16_t const priority
+);
+
+/*
+ * Get the priority from the data channel parameters.
+ */
+enum rawrtc_code rawrtc_data_channel_parameters_get_priority(
+    uint16_t* const priorityp, // de-referenced
+    struct rawrtc_data_channel_parameters* const parameters
+);
+
 /*
  * Create data channel options.
  *
@@ -1794,6 +2402,43 @@ enum rawrtc_code rawrtc_data_channel_send(
     bool const is_binary
 );
 
+/*
+ * Send a batch of messages via the data channel.
+ * All messages will be sent with the same `is_binary` flag. Entries
+ * of `buffers` may be `NULL` (or of length 0) to send empty messages.
+ * `*n_sentp` will contain the amount of messages that have been sent
+ * or queued, even if an error is being returned.
+ */
+enum rawrtc_code rawrtc_data_channel_send_batch(
+    size_t* const n_sentp, // de-referenced, nullable
+    struct rawrtc_data_channel* const channel,
+    struct mbuf* const * const buffers, // referenced
+    size_t const n_buffers,
+    bool const is_binary
+);
+
+/*
+ * Send a (large) message via the data channel without providing the
+ * whole message at once. `producer` will be called repeatedly to
+ * write the next part of the message until it indicates the last
+ * part. At most `window` bytes of the message (plus one part that is
+ * held back) will be buffered at any time (0 applies a default window
+ * of 1 MiB). Producing continues once buffered parts have been handed
+ * to the underlying transport.
+ *
+ * No other message may be sent on the data channel until the message
+ * is complete. If the producer fails after parts of the message have
+ * been sent, the message will be terminated early and the data channel
+ * will be closed.
+ */
+enum rawrtc_code rawrtc_data_channel_send_stream(
+    struct rawrtc_data_channel* const channel,
+    rawrtc_data_channel_message_producer* const producer,
+    size_t const window,
+    bool const is_binary,
+    void* const arg // nullable
+);
+
 /*
  * Close the data channel.
  */
@@ -1805,11 +2450,36 @@ enum rawrtc_code rawrtc_data_channel_close(
  * TODO (from RTCDataChannel interface)
  * rawrtc_data_channel_get_transport
  * rawrtc_data_channel_get_ready_state
- * rawrtc_data_channel_get_buffered_amount
- * rawrtc_data_channel_get_buffered_amount_low_threshold
- * rawrtc_data_channel_set_buffered_amount_low_threshold
  */
 
+/*
+ * Get the amount of bytes that have been queued for sending on the
+ * data channel but have not yet been handed to the underlying transport.
+ */
+enum rawrtc_code rawrtc_data_channel_get_buffered_amount(
+    uint64_t* const buffered_amountp, // de-referenced
+    struct rawrtc_data_channel* const channel
+);
+
+/*
+ * Get the data channel's buffered amount low threshold.
+ */
+enum rawrtc_code rawrtc_data_channel_get_buffered_amount_low_threshold(
+    uint64_t* const buffered_amount_low_thresholdp, // de-referenced
+    struct rawrtc_data_channel* const channel
+);
+
+/*
+ * Set the data channel's buffered amount low threshold.
+ * The buffered amount low handler will be called once the buffered
+ * amount decreases from above the threshold to or below the threshold.
+ * Defaults to `0`.
+ */
+enum rawrtc_code rawrtc_data_channel_set_buffered_amount_low_threshold(
+    struct rawrtc_data_channel* const channel,
+    uint64_t const buffered_amount_low_threshold
+);
+
 /*
  * Unset the handler argument and all handlers of the data channel.
  */
@@ -1910,6 +2580,39 @@ enum rawrtc_code rawrtc_data_channel_get_message_handler(
     struct rawrtc_data_channel* const channel
 );
 
+/*
+ * Set the data channel's message view handler.
+ * If set, complete messages will be handed out as scatter-gather views
+ * instead of being merged into a single buffer. Has no effect in case
+ * partial delivery has been requested.
+ */
+enum rawrtc_code rawrtc_data_channel_set_message_view_handler(
+    struct rawrtc_data_channel* const channel,
+    rawrtc_data_channel_message_view_handler* const message_view_handler // nullable
+);
+
+/*
+ * Get the data channel's message view handler.
+ * Returns `RAWRTC_CODE_NO_VALUE` in case no handler has been set.
+ */
+enum rawrtc_code rawrtc_data_channel_get_message_view_handler(
+    rawrtc_data_channel_message_view_handler** const message_view_handlerp, // de-referenced
+    struct rawrtc_data_channel* const channel
+);
+
+/*
+ * Announce the size of the next message that will be received on the
+ * data channel (e.g. because the application's protocol advertises
+ * it). The reassembly buffer will then be allocated once with that
+ * size. The hint applies to a single message only. Has no effect in
+ * case partial delivery has been requested or a message view handler
+ * has been set.
+ */
+enum rawrtc_code rawrtc_data_channel_set_message_size_hint(
+    struct rawrtc_data_channel* const channel,
+    uint64_t const size
+);
+
 /*
  * Get the corresponding name for a signaling state.
  */
@@ -1978,6 +2681,78 @@ enum rawrtc_code rawrtc_peer_connection_configuration_set_sctp_sdp_05(
     bool const on
 );
 
+/*
+ * Set the minimum and maximum path MTU (UDP payload size in bytes) of
+ * the path MTU discovery (RFC 8899). The minimum must be at least 576
+ * bytes. Probing is disabled in case both are equal.
+ */
+enum rawrtc_code rawrtc_peer_connection_configuration_set_path_mtu(
+    struct rawrtc_peer_connection_configuration* configuration,
+    uint32_t const minimum,
+    uint32_t const maximum
+);
+
+/*
+ * Set whether the DTLS transport of a peer connection shares its DTLS
+ * context with other DTLS transports of the shard that use identical
+ * certificates (default).
+ */
+enum rawrtc_code rawrtc_peer_connection_configuration_set_dtls_context_sharing(
+    struct rawrtc_peer_connection_configuration* configuration,
+    bool const share
+);
+
+/*
+ * Set whether the host candidates of a peer connection share one UDP
+ * socket per interface and shard with other peer connections, see
+ * `rawrtc_ice_gather_options_set_udp_mux`.
+ */
+enum rawrtc_code rawrtc_peer_connection_configuration_set_ice_udp_mux(
+    struct rawrtc_peer_connection_configuration* configuration,
+    bool const enable,
+    uint16_t const port
+);
+
+/*
+ * Set whether a peer connection acts as an ICE lite agent, see
+ * `rawrtc_ice_gather_options_set_ice_lite`.
+ */
+enum rawrtc_code rawrtc_peer_connection_configuration_set_ice_lite(
+    struct rawrtc_peer_connection_configuration* configuration,
+    bool const lite
+);
+
+/*
+ * Set the maximum amount of datagrams received on a host candidate's
+ * UDP socket per wakeup, see
+ * `rawrtc_ice_gather_options_set_udp_receive_batch_size`.
+ */
+enum rawrtc_code rawrtc_peer_connection_configuration_set_udp_receive_batch_size(
+    struct rawrtc_peer_connection_configuration* configuration,
+    uint32_t const size
+);
+
+/*
+ * Set the early packet buffer of the ICE gatherer, see
+ * `rawrtc_ice_gather_options_set_buffer`.
+ */
+enum rawrtc_code rawrtc_peer_connection_configuration_set_ice_gatherer_buffer(
+    struct rawrtc_peer_connection_configuration* configuration,
+    uint16_t const slots,
+    uint16_t const slot_size,
+    enum rawrtc_ice_gatherer_buffer_drop_policy const drop_policy
+);
+
+/*
+ * Set the certificate pool a certificate is taken from in case no
+ * certificates have been added to the peer connection configuration.
+ * `pool` may be `NULL` to generate certificates on demand (default).
+ */
+enum rawrtc_code rawrtc_peer_connection_configuration_set_certificate_pool(
+    struct rawrtc_peer_connection_configuration* configuration,
+    struct rawrtc_certificate_pool* const pool // nullable, referenced
+);
+
 /*
  * Create a description by parsing it from SDP.
  */
@@ -1,5 +1,30 @@
 #include <rawrtc.h>
 #include "candidate_helper.h"
+#include "ice_lite.h"
+#include "packet_demux.h"
+#include "udp_batch.h"
+#include "udp_mux.h"
+
+#define DEBUG_MODULE "candidate-helper"
+//#define RAWRTC_DEBUG_MODULE_LEVEL 7 // Note: Uncomment this to debug this module only
+#include "debug.h"
+
+/*
+ * Hand STUN messages of a multiplexed candidate to the ICE agent.
+ */
+static bool stun_receive_handler(
+        struct sa* source,
+        struct mbuf* buffer,
+        void* arg
+) {
+    struct rawrtc_candidate_helper* const candidate_helper = arg;
+
+    // Receive
+    trice_lcand_recv_packet(candidate_helper->candidate, source, buffer);
+
+    // Handled
+    return true;
+}
 
 /*
  * Destructor for an existing candidate helper.
@@ -10,23 +35,32 @@ static void rawrtc_candidate_helper_destroy(
     struct rawrtc_candidate_helper* const local_candidate = arg;
 
     // Un-reference
+    mem_deref(local_candidate->udp_batch);
+    mem_deref(local_candidate->mux_entry);
     list_flush(&local_candidate->stun_sessions);
-    mem_deref(local_candidate->udp_helper);
+    mem_deref(local_candidate->demux);
     mem_deref(local_candidate->candidate);
     mem_deref(local_candidate->gatherer);
 }
 
 /*
  * Create a candidate helper.
+ * In case `mux` is set, the candidate is registered with the mux
+ * (instead of attaching a packet demultiplexer to the candidate's
+ * socket).
+ * In case the gatherer is an ICE lite agent, STUN messages will be
+ * answered by the candidate helper (instead of the ICE agent).
  */
 enum rawrtc_code rawrtc_candidate_helper_create(
         struct rawrtc_candidate_helper** const candidate_helperp, // de-referenced
         struct rawrtc_ice_gatherer* gatherer,
         struct ice_lcand* const candidate,
+        struct rawrtc_udp_mux* const mux, // nullable
         udp_helper_recv_h* const receive_handler,
         void* const arg
 ) {
     struct rawrtc_candidate_helper* candidate_helper;
+    struct udp_sock* udp_socket = NULL;
     enum rawrtc_code error;
 
     // Check arguments
@@ -46,12 +80,63 @@ enum rawrtc_code rawrtc_candidate_helper_create(
     candidate_helper->srflx_pending_count = 0;
     candidate_helper->relay_pending_count = 0;
 
+    // Get local candidate's UDP socket (unless multiplexed)
+    // Note: The mux hands datagrams to the packet demultiplexer directly.
+    if (!mux) {
+        udp_socket = trice_lcand_sock(gatherer->ice, candidate);
+        if (!udp_socket) {
+            error = RAWRTC_CODE_NO_SOCKET;
+            goto out;
+        }
+    }
+
+    // Create packet demultiplexer
+    error = rawrtc_packet_demux_create(&candidate_helper->demux, udp_socket);
+    if (error) {
+        goto out;
+    }
+
+    // Answer STUN messages (ICE lite) or hand them to the ICE agent (multiplexed)
+    // Note: Otherwise, STUN messages are left to the ICE agent's UDP helper. In case of
+    //       ICE lite, the demultiplexer consumes them before they reach the agent's helper.
+    if (gatherer->ice_lite) {
+        rawrtc_packet_demux_set_handler(
+                candidate_helper->demux, RAWRTC_PACKET_DEMUX_CLASS_STUN,
+                rawrtc_ice_lite_receive_handler, candidate_helper);
+    } else if (mux) {
+        rawrtc_packet_demux_set_handler(
+                candidate_helper->demux, RAWRTC_PACKET_DEMUX_CLASS_STUN,
+                stun_receive_handler, candidate_helper);
+    }
+
+    // Register with mux (if any)
+    if (mux) {
+        error = rawrtc_udp_mux_register(&candidate_helper->mux_entry, mux, candidate_helper);
+        if (error) {
+            goto out;
+        }
+    }
+
     // Set receive handler
     error = rawrtc_candidate_helper_set_receive_handler(candidate_helper, receive_handler, arg);
     if (error) {
         goto out;
     }
 
+    // Receive in batches (if enabled, unless multiplexed)
+    // Note: The mux receives in batches on the shared socket instead.
+    if (udp_socket) {
+        error = rawrtc_udp_batch_attach(
+                &candidate_helper->udp_batch, udp_socket, sa_af(&candidate->attr.addr),
+                gatherer->options->udp_receive_batch_size, gatherer->options->path_mtu_max);
+        if (error && error != RAWRTC_CODE_NO_VALUE) {
+            DEBUG_WARNING("Could not receive in batches, reason: %s\n",
+                          rawrtc_code_to_str(error));
+            // Note: Considered non-critical, continuing
+        }
+        error = RAWRTC_CODE_SUCCESS;
+    }
+
 out:
     if (error) {
         mem_deref(candidate_helper);
@@ -63,46 +148,38 @@ out:
 }
 
 /*
- * Set a candidate helper's receive handler.
+ * Set a candidate helper's receive handler (for DTLS records).
  */
 enum rawrtc_code rawrtc_candidate_helper_set_receive_handler(
         struct rawrtc_candidate_helper* const candidate_helper,
         udp_helper_recv_h* const receive_handler,
         void* const arg
 ) {
-    enum rawrtc_code error;
-    struct udp_helper* udp_helper;
-
     // Check arguments
     if (!candidate_helper || !receive_handler) {
         return RAWRTC_CODE_INVALID_ARGUMENT;
     }
 
-    // Get local candidate's UDP socket
-    struct udp_sock* const udp_socket = trice_lcand_sock(
-            candidate_helper->gatherer->ice, candidate_helper->candidate);
-    if (!udp_socket) {
-        return RAWRTC_CODE_NO_SOCKET;
-    }
-
-    // Create UDP helper
-    error = rawrtc_error_to_code(udp_register_helper(
-            &udp_helper, udp_socket, RAWRTC_LAYER_DTLS_SRTP_STUN, NULL,
-            receive_handler, arg));
-    if (error) {
-        return error;
-    }
-
-    // Unset current helper (if any) and set new helper
-    mem_deref(candidate_helper->udp_helper);
-    candidate_helper->udp_helper = udp_helper;
-
-    // TODO: What about TCP helpers?
+    // Replace the handler of the packet demultiplexer
+    // TODO: What about TCP?
+    rawrtc_packet_demux_set_handler(
+            candidate_helper->demux, RAWRTC_PACKET_DEMUX_CLASS_DTLS, receive_handler, arg);
 
     // Done
     return RAWRTC_CODE_SUCCESS;
 }
 
+/*
+ * Unset a candidate helper's receive handler (if any).
+ * Received DTLS records will be dropped from now on.
+ */
+void rawrtc_candidate_helper_unset_receive_handler(
+        struct rawrtc_candidate_helper* const candidate_helper // not checked
+) {
+    rawrtc_packet_demux_set_handler(
+            candidate_helper->demux, RAWRTC_PACKET_DEMUX_CLASS_DTLS, NULL, NULL);
+}
+
 /*
  * Find a specific candidate helper by re candidate.
  */
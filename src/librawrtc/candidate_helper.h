@@ -17,7 +17,9 @@ struct rawrtc_candidate_helper {
     struct le le;
     struct rawrtc_ice_gatherer* gatherer;
     struct ice_lcand* candidate;
-    struct udp_helper* udp_helper;
+    struct rawrtc_packet_demux* demux; // referenced
+    struct rawrtc_udp_batch* udp_batch; // referenced, nullable
+    struct rawrtc_udp_mux_entry* mux_entry; // referenced, nullable
     uint_fast8_t srflx_pending_count;
     struct list stun_sessions;
     uint_fast8_t relay_pending_count;
@@ -27,6 +29,7 @@ enum rawrtc_code rawrtc_candidate_helper_create(
     struct rawrtc_candidate_helper** const candidate_helperp, // de-referenced
     struct rawrtc_ice_gatherer* gatherer,
     struct ice_lcand* const candidate,
+    struct rawrtc_udp_mux* const mux, // nullable
     udp_helper_recv_h* const receive_handler,
     void* const arg
 );
@@ -37,6 +40,10 @@ enum rawrtc_code rawrtc_candidate_helper_set_receive_handler(
     void* const arg
 );
 
+void rawrtc_candidate_helper_unset_receive_handler(
+    struct rawrtc_candidate_helper* const candidate_helper // not checked
+);
+
 enum rawrtc_code rawrtc_candidate_helper_find(
     struct rawrtc_candidate_helper** const candidate_helperp,
     struct list* const candidate_helpers,
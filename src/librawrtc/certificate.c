@@ -20,6 +20,25 @@
 //#define RAWRTC_DEBUG_MODULE_LEVEL 7 // Note: Uncomment this to debug this module only
 #include "debug.h"
 
+/*
+ * Length of the random serial number of self-signed certificates
+ * (in bits, the most significant bit is always set).
+ */
+#define RAWRTC_CERTIFICATE_SERIAL_BITS 64
+
+/*
+ * Refuse to provide a passphrase for an encrypted private key.
+ */
+static int no_passphrase_callback(
+        char* buffer,
+        int size,
+        int rwflag,
+        void* arg
+) {
+    (void) buffer; (void) size; (void) rwflag; (void) arg;
+    return -1;
+}
+
 /*
  * Print and flush the OpenSSL error queue.
  */
@@ -203,6 +222,7 @@ static enum rawrtc_code generate_self_signed_certificate(
     enum rawrtc_code error = RAWRTC_CODE_UNKNOWN_ERROR;
     X509* certificate = NULL;
     X509_NAME* name = NULL;
+    BIGNUM* serial = NULL;
     EVP_MD const* sign_function;
 
     // Check arguments
@@ -236,7 +256,10 @@ static enum rawrtc_code generate_self_signed_certificate(
     }
 
     // Set the serial number randomly (doesn't need to be unique as we are self-signing)
-    if (!ASN1_INTEGER_set(X509_get_serialNumber(certificate), rand_u32())) {
+    // Note: OpenSSL's random generator is thread-safe, so this works on certificate pool workers.
+    serial = BN_new();
+    if (!serial || !BN_rand(serial, RAWRTC_CERTIFICATE_SERIAL_BITS, 0, 0)
+            || !BN_to_ASN1_INTEGER(serial, X509_get_serialNumber(certificate))) {
         DEBUG_WARNING("Could not set x509 serial number\n");
         goto out;
     }
@@ -286,6 +309,9 @@ static enum rawrtc_code generate_self_signed_certificate(
     error = RAWRTC_CODE_SUCCESS;
 
 out:
+    if (serial) {
+        BN_free(serial);
+    }
     if (name) {
         X509_NAME_free(name);
     }
@@ -456,68 +482,295 @@ static void rawrtc_certificate_destroy(
 }
 
 /*
- * Create and generate a self-signed certificate.
- *
- * Sane and safe default options will be applied if `options` is
- * `NULL`.
+ * Create a certificate from an x509 certificate and its private key.
+ * Both are handed over to the certificate, even in case of an error.
  */
-enum rawrtc_code rawrtc_certificate_generate(
-        struct rawrtc_certificate** const certificatep,
-        struct rawrtc_certificate_options* options // nullable
+enum rawrtc_code rawrtc_certificate_create_raw(
+        struct rawrtc_certificate** const certificatep, // de-referenced
+        X509* const x509, // handed over
+        EVP_PKEY* const key // handed over
 ) {
+    enum rawrtc_code error = RAWRTC_CODE_SUCCESS;
     struct rawrtc_certificate* certificate;
-    enum rawrtc_code error;
+    enum rawrtc_certificate_key_type key_type;
 
     // Check arguments
-    if (!certificatep) {
-        return RAWRTC_CODE_INVALID_ARGUMENT;
+    if (!certificatep || !x509 || !key) {
+        error = RAWRTC_CODE_INVALID_ARGUMENT;
+        goto out;
     }
 
-    // Default options
-    if (!options) {
-        options = &rawrtc_default_certificate_options;
+    // Get key type
+    switch (EVP_PKEY_base_id(key)) {
+        case EVP_PKEY_RSA:
+            key_type = RAWRTC_CERTIFICATE_KEY_TYPE_RSA;
+            break;
+        case EVP_PKEY_EC:
+            key_type = RAWRTC_CERTIFICATE_KEY_TYPE_EC;
+            break;
+        default:
+            error = RAWRTC_CODE_UNSUPPORTED_ALGORITHM;
+            goto out;
     }
 
     // Allocate
     certificate = mem_zalloc(sizeof(*certificate), rawrtc_certificate_destroy);
     if (!certificate) {
-        return RAWRTC_CODE_NO_MEMORY;
+        error = RAWRTC_CODE_NO_MEMORY;
+        goto out;
+    }
+
+    // Set fields
+    certificate->certificate = x509;
+    certificate->key = key;
+    certificate->key_type = key_type;
+
+    // Set pointer
+    *certificatep = certificate;
+
+out:
+    if (error) {
+        if (x509) {
+            X509_free(x509);
+        }
+        if (key) {
+            EVP_PKEY_free(key);
+        }
     }
+    return error;
+}
+
+/*
+ * Generate a key pair and a self-signed certificate.
+ * Does not allocate any re objects and can therefore be called from
+ * any thread.
+ * Caller must call `X509_free(*x509p)` and `EVP_PKEY_free(*keyp)`
+ * when done.
+ */
+enum rawrtc_code rawrtc_certificate_generate_raw(
+        X509** const x509p, // de-referenced
+        EVP_PKEY** const keyp, // de-referenced
+        struct rawrtc_certificate_options* const options // not checked
+) {
+    enum rawrtc_code error;
+    EVP_PKEY* key;
+    X509* x509;
 
     // Generate key pair
     switch (options->key_type) {
         case RAWRTC_CERTIFICATE_KEY_TYPE_RSA:
-            error = generate_key_rsa(&certificate->key, options->modulus_length);
+            error = generate_key_rsa(&key, options->modulus_length);
             break;
         case RAWRTC_CERTIFICATE_KEY_TYPE_EC:
-            error = generate_key_ecc(&certificate->key, options->named_curve);
+            error = generate_key_ecc(&key, options->named_curve);
             break;
         default:
             return RAWRTC_CODE_INVALID_STATE;
     }
     if (error) {
-        goto out;
+        return error;
     }
 
     // Generate certificate
     error = generate_self_signed_certificate(
-            &certificate->certificate, certificate->key,
-            options->common_name, options->valid_until, options->sign_algorithm);
+            &x509, key, options->common_name, options->valid_until, options->sign_algorithm);
+    if (error) {
+        EVP_PKEY_free(key);
+        return error;
+    }
+
+    // Set pointers
+    *x509p = x509;
+    *keyp = key;
+    return RAWRTC_CODE_SUCCESS;
+}
+
+/*
+ * Create and generate a self-signed certificate.
+ *
+ * Sane and safe default options will be applied if `options` is
+ * `NULL`.
+ */
+enum rawrtc_code rawrtc_certificate_generate(
+        struct rawrtc_certificate** const certificatep,
+        struct rawrtc_certificate_options* options // nullable
+) {
+    enum rawrtc_code error;
+    X509* x509;
+    EVP_PKEY* key;
+
+    // Check arguments
+    if (!certificatep) {
+        return RAWRTC_CODE_INVALID_ARGUMENT;
+    }
+
+    // Default options
+    if (!options) {
+        options = &rawrtc_default_certificate_options;
+    }
+
+    // Generate key pair and certificate
+    error = rawrtc_certificate_generate_raw(&x509, &key, options);
+    if (error) {
+        return error;
+    }
+
+    // Create certificate
+    return rawrtc_certificate_create_raw(certificatep, x509, key);
+}
+
+/*
+ * Create a certificate from a PEM encoded x509 certificate and its
+ * PEM encoded private key, as returned by
+ * `rawrtc_certificate_get_pem` with `RAWRTC_CERTIFICATE_ENCODE_BOTH`.
+ * The order of both sections does not matter.
+ * `pem` does not need to be null-terminated.
+ */
+enum rawrtc_code rawrtc_certificate_from_pem(
+        struct rawrtc_certificate** const certificatep, // de-referenced
+        char const* const pem,
+        size_t const pem_length
+) {
+    enum rawrtc_code error = RAWRTC_CODE_INVALID_ARGUMENT;
+    BIO* bio;
+    X509* x509 = NULL;
+    EVP_PKEY* key = NULL;
+
+    // Check arguments
+    if (!certificatep || !pem || pem_length == 0) {
+        return RAWRTC_CODE_INVALID_ARGUMENT;
+    }
+#if (SIZE_MAX > INT_MAX)
+    if (pem_length > INT_MAX) {
+        return RAWRTC_CODE_INVALID_ARGUMENT;
+    }
+#endif
+
+    // Create read-only bio structure
+    bio = BIO_new_mem_buf((void*) pem, (int) pem_length);
+    if (!bio) {
+        return RAWRTC_CODE_NO_MEMORY;
+    }
+
+    // Read certificate
+    x509 = PEM_read_bio_X509(bio, NULL, NULL, NULL);
+    if (!x509) {
+        DEBUG_WARNING("Could not read x509 certificate from PEM\n");
+        goto out;
+    }
+
+    // Read private key
+    // Note: Rewinding the bio allows the private key to precede the certificate.
+    if (BIO_reset(bio) <= 0) {
+        error = RAWRTC_CODE_UNKNOWN_ERROR;
+        goto out;
+    }
+    // Note: Encrypted private keys are not supported. The passphrase callback fails instead of
+    //       letting OpenSSL prompt for a passphrase on the terminal.
+    key = PEM_read_bio_PrivateKey(bio, NULL, no_passphrase_callback, NULL);
+    if (!key) {
+        DEBUG_WARNING("Could not read private key from PEM\n");
+        goto out;
+    }
+
+    // Check that the private key belongs to the certificate
+    if (!X509_check_private_key(x509, key)) {
+        DEBUG_WARNING("Private key does not match the x509 certificate\n");
+        goto out;
+    }
+
+    // Done
+    error = RAWRTC_CODE_SUCCESS;
+
+out:
+    BIO_free(bio);
     if (error) {
+        if (x509) {
+            X509_free(x509);
+        }
+        if (key) {
+            EVP_PKEY_free(key);
+        }
+        ERR_print_errors_cb(print_openssl_error, NULL);
+        return error;
+    }
+
+    // Create certificate
+    return rawrtc_certificate_create_raw(certificatep, x509, key);
+}
+
+/*
+ * Create a certificate from a DER encoded x509 certificate directly
+ * followed by its DER encoded private key, as returned by
+ * `rawrtc_certificate_get_der` with `RAWRTC_CERTIFICATE_ENCODE_BOTH`.
+ */
+enum rawrtc_code rawrtc_certificate_from_der(
+        struct rawrtc_certificate** const certificatep, // de-referenced
+        uint8_t const* const der,
+        size_t const der_length
+) {
+    enum rawrtc_code error = RAWRTC_CODE_INVALID_ARGUMENT;
+    uint8_t const* der_d2i = der;
+    uint8_t const* der_end;
+    X509* x509 = NULL;
+    EVP_PKEY* key = NULL;
+
+    // Check arguments
+    if (!certificatep || !der || der_length == 0) {
+        return RAWRTC_CODE_INVALID_ARGUMENT;
+    }
+#if (SIZE_MAX > LONG_MAX)
+    if (der_length > LONG_MAX) {
+        return RAWRTC_CODE_INVALID_ARGUMENT;
+    }
+#endif
+
+    // Read certificate
+    // Note: This advances `der_d2i` to the private key.
+    der_end = der + der_length;
+    x509 = d2i_X509(NULL, &der_d2i, (long) der_length);
+    if (!x509) {
+        DEBUG_WARNING("Could not read x509 certificate from DER\n");
+        goto out;
+    }
+
+    // Read private key (RSA or EC, detected automatically)
+    key = d2i_AutoPrivateKey(NULL, &der_d2i, (long) (der_end - der_d2i));
+    if (!key) {
+        DEBUG_WARNING("Could not read private key from DER\n");
+        goto out;
+    }
+
+    // Trailing bytes?
+    if (der_d2i != der_end) {
+        DEBUG_WARNING("%zu trailing bytes after private key in DER\n",
+                      (size_t) (der_end - der_d2i));
         goto out;
     }
 
-    // Set key type
-    certificate->key_type = options->key_type;
+    // Check that the private key belongs to the certificate
+    if (!X509_check_private_key(x509, key)) {
+        DEBUG_WARNING("Private key does not match the x509 certificate\n");
+        goto out;
+    }
+
+    // Done
+    error = RAWRTC_CODE_SUCCESS;
 
 out:
     if (error) {
-        mem_deref(certificate);
-    } else {
-        // Set pointer
-        *certificatep = certificate;
+        if (x509) {
+            X509_free(x509);
+        }
+        if (key) {
+            EVP_PKEY_free(key);
+        }
+        ERR_print_errors_cb(print_openssl_error, NULL);
+        return error;
     }
-    return error;
+
+    // Create certificate
+    return rawrtc_certificate_create_raw(certificatep, x509, key);
 }
 
 /*
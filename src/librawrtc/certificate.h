@@ -9,23 +9,21 @@ enum {
     RAWRTC_FINGERPRINT_MAX_SIZE_HEX = (EVP_MAX_MD_SIZE * 2)
 };
 
-enum rawrtc_code rawrtc_certificate_copy(
+enum rawrtc_code rawrtc_certificate_create_raw(
     struct rawrtc_certificate** const certificatep, // de-referenced
-    struct rawrtc_certificate* const source_certificate
+    X509* const x509, // handed over
+    EVP_PKEY* const key // handed over
 );
 
-enum rawrtc_code rawrtc_certificate_get_pem(
-    char** const pemp,  // de-referenced
-    size_t* const pem_lengthp,  // de-referenced
-    struct rawrtc_certificate* const certificate,
-    enum rawrtc_certificate_encode const to_encode
+enum rawrtc_code rawrtc_certificate_generate_raw(
+    X509** const x509p, // de-referenced
+    EVP_PKEY** const keyp, // de-referenced
+    struct rawrtc_certificate_options* const options // not checked
 );
 
-enum rawrtc_code rawrtc_certificate_get_der(
-    uint8_t** const derp,  // de-referenced
-    size_t* const der_lengthp,  // de-referenced
-    struct rawrtc_certificate* const certificate,
-    enum rawrtc_certificate_encode const to_encode
+enum rawrtc_code rawrtc_certificate_copy(
+    struct rawrtc_certificate** const certificatep, // de-referenced
+    struct rawrtc_certificate* const source_certificate
 );
 
 enum rawrtc_code rawrtc_certificate_get_fingerprint(
@@ -0,0 +1,251 @@
+#include <pthread.h> // pthread_*
+#include <rawrtc.h>
+#include "certificate.h"
+#include "certificate_pool.h"
+#include "utils.h"
+
+#define DEBUG_MODULE "certificate-pool"
+//#define RAWRTC_DEBUG_MODULE_LEVEL 7 // Note: Uncomment this to debug this module only
+#include "debug.h"
+
+/*
+ * Free a pre-generated certificate.
+ */
+static void item_free(
+        struct rawrtc_certificate_pool_item* const item // not checked
+) {
+    X509_free(item->certificate);
+    EVP_PKEY_free(item->key);
+}
+
+/*
+ * Worker thread generating certificates until the pool is full.
+ * Waits for certificates to be taken in case the pool is full.
+ * Note: Key generation is done without holding the lock.
+ */
+static void* worker_thread(
+        void* arg
+) {
+    struct rawrtc_certificate_pool* const pool = arg;
+    struct rawrtc_certificate_options* const options =
+            pool->options ? pool->options : &rawrtc_default_certificate_options;
+    enum rawrtc_code error;
+    struct rawrtc_certificate_pool_item item;
+
+    pthread_mutex_lock(&pool->mutex);
+    while (!pool->closing) {
+        // Full? Wait until a certificate has been taken.
+        if (pool->count + pool->generating >= pool->size) {
+            pthread_cond_wait(&pool->condition, &pool->mutex);
+            continue;
+        }
+
+        // Generate certificate
+        ++pool->generating;
+        pthread_mutex_unlock(&pool->mutex);
+        error = rawrtc_certificate_generate_raw(&item.certificate, &item.key, options);
+        pthread_mutex_lock(&pool->mutex);
+        --pool->generating;
+
+        // Stop on error
+        // Note: Certificates will be generated on demand from now on which surfaces the error.
+        if (error) {
+            DEBUG_WARNING("Could not generate certificate, reason: %s\n",
+                          rawrtc_code_to_str(error));
+            break;
+        }
+
+        // Closing in the meantime?
+        if (pool->closing) {
+            item_free(&item);
+            break;
+        }
+
+        // Add to the ring buffer
+        pool->items[(pool->head + pool->count) % pool->size] = item;
+        ++pool->count;
+        ++pool->statistics.generated;
+    }
+    pthread_mutex_unlock(&pool->mutex);
+    return NULL;
+}
+
+/*
+ * Destructor for an existing certificate pool.
+ */
+static void rawrtc_certificate_pool_destroy(
+        void* arg
+) {
+    struct rawrtc_certificate_pool* const pool = arg;
+    uint32_t i;
+
+    // Stop and join workers
+    pthread_mutex_lock(&pool->mutex);
+    pool->closing = true;
+    pthread_cond_broadcast(&pool->condition);
+    pthread_mutex_unlock(&pool->mutex);
+    for (i = 0; i < pool->n_workers; ++i) {
+        pthread_join(pool->workers[i], NULL);
+    }
+
+    // Free remaining certificates
+    for (i = 0; i < pool->count; ++i) {
+        item_free(&pool->items[(pool->head + i) % pool->size]);
+    }
+
+    // Destroy mutex & condition
+    pthread_cond_destroy(&pool->condition);
+    pthread_mutex_destroy(&pool->mutex);
+
+    // Un-reference
+    mem_deref(pool->workers);
+    mem_deref(pool->items);
+    mem_deref(pool->options);
+}
+
+/*
+ * Create a certificate pool that keeps `n_certificates` self-signed
+ * certificates pre-generated by `n_workers` background threads.
+ *
+ * Sane and safe default options will be applied if `options` is
+ * `NULL`.
+ *
+ * The pool can be used from any thread. However, like all other
+ * instances, it MUST be referenced and un-referenced on a single
+ * thread only.
+ */
+enum rawrtc_code rawrtc_certificate_pool_create(
+        struct rawrtc_certificate_pool** const poolp, // de-referenced
+        struct rawrtc_certificate_options* const options, // nullable, referenced
+        uint32_t const n_certificates,
+        uint32_t const n_workers
+) {
+    struct rawrtc_certificate_pool* pool;
+    enum rawrtc_code error;
+    int err;
+    uint32_t i;
+
+    // Check arguments
+    if (!poolp || n_certificates == 0 || n_workers == 0) {
+        return RAWRTC_CODE_INVALID_ARGUMENT;
+    }
+
+    // Allocate
+    // Note: The destructor is set once the mutex and the condition have been initialised.
+    pool = mem_zalloc(sizeof(*pool), NULL);
+    if (!pool) {
+        return RAWRTC_CODE_NO_MEMORY;
+    }
+
+    // Initialise mutex & condition
+    err = pthread_mutex_init(&pool->mutex, NULL);
+    if (err) {
+        DEBUG_WARNING("Failed to initialise mutex, reason: %m\n", err);
+        mem_deref(pool);
+        return rawrtc_error_to_code(err);
+    }
+    err = pthread_cond_init(&pool->condition, NULL);
+    if (err) {
+        DEBUG_WARNING("Failed to initialise condition, reason: %m\n", err);
+        pthread_mutex_destroy(&pool->mutex);
+        mem_deref(pool);
+        return rawrtc_error_to_code(err);
+    }
+    mem_destructor(pool, rawrtc_certificate_pool_destroy);
+
+    // Set fields/reference
+    pool->options = mem_ref(options);
+    pool->size = n_certificates;
+
+    // Allocate ring buffer and workers
+    pool->items = mem_zalloc(n_certificates * sizeof(*pool->items), NULL);
+    pool->workers = mem_zalloc(n_workers * sizeof(*pool->workers), NULL);
+    if (!pool->items || !pool->workers) {
+        error = RAWRTC_CODE_NO_MEMORY;
+        goto out;
+    }
+
+    // Start workers
+    // Note: Workers already started will be joined by the destructor in case of an error.
+    for (i = 0; i < n_workers; ++i) {
+        err = pthread_create(&pool->workers[i], NULL, worker_thread, pool);
+        if (err) {
+            DEBUG_WARNING("Failed to start worker, reason: %m\n", err);
+            error = rawrtc_error_to_code(err);
+            goto out;
+        }
+        ++pool->n_workers;
+    }
+
+    // Done
+    error = RAWRTC_CODE_SUCCESS;
+
+out:
+    if (error) {
+        mem_deref(pool);
+    } else {
+        // Set pointer
+        *poolp = pool;
+    }
+    return error;
+}
+
+/*
+ * Take a pre-generated certificate from the pool. Generates the
+ * certificate on the calling thread in case the pool is empty.
+ */
+enum rawrtc_code rawrtc_certificate_pool_get(
+        struct rawrtc_certificate** const certificatep, // de-referenced
+        struct rawrtc_certificate_pool* const pool
+) {
+    struct rawrtc_certificate_pool_item item;
+    bool available;
+
+    // Check arguments
+    if (!certificatep || !pool) {
+        return RAWRTC_CODE_INVALID_ARGUMENT;
+    }
+
+    // Take the oldest certificate (if any) and wake up a worker to replace it
+    pthread_mutex_lock(&pool->mutex);
+    available = pool->count > 0;
+    if (available) {
+        item = pool->items[pool->head];
+        pool->head = (pool->head + 1) % pool->size;
+        --pool->count;
+        ++pool->statistics.taken;
+        pthread_cond_signal(&pool->condition);
+    } else {
+        ++pool->statistics.generated_on_demand;
+    }
+    pthread_mutex_unlock(&pool->mutex);
+
+    // Empty? Generate on demand.
+    if (!available) {
+        DEBUG_PRINTF("Pool is empty, generating certificate on demand\n");
+        return rawrtc_certificate_generate(certificatep, pool->options);
+    }
+
+    // Create certificate
+    return rawrtc_certificate_create_raw(certificatep, item.certificate, item.key);
+}
+
+/*
+ * Get the certificate pool's statistics.
+ */
+enum rawrtc_code rawrtc_certificate_pool_get_statistics(
+        struct rawrtc_certificate_pool_statistics* const statisticsp, // de-referenced
+        struct rawrtc_certificate_pool* const pool
+) {
+    // Check arguments
+    if (!statisticsp || !pool) {
+        return RAWRTC_CODE_INVALID_ARGUMENT;
+    }
+
+    // Copy statistics
+    pthread_mutex_lock(&pool->mutex);
+    *statisticsp = pool->statistics;
+    statisticsp->available = pool->count;
+    pthread_mutex_unlock(&pool->mutex);
+    return RAWRTC_CODE_SUCCESS;
+}
@@ -0,0 +1,32 @@
+#pragma once
+#include <pthread.h> // pthread_*
+#include <rawrtc.h>
+
+/*
+ * Pre-generated x509 certificate and its private key.
+ * Note: These are plain OpenSSL objects since they are created on
+ *       worker threads which cannot allocate re objects.
+ */
+struct rawrtc_certificate_pool_item {
+    X509* certificate;
+    EVP_PKEY* key;
+};
+
+/*
+ * Certificate pool that keeps a fixed amount of self-signed
+ * certificates pre-generated by background worker threads.
+ */
+struct rawrtc_certificate_pool {
+    struct rawrtc_certificate_options* options; // referenced, nullable
+    pthread_mutex_t mutex;
+    pthread_cond_t condition; // signalled when a certificate has been taken or on close
+    bool closing;
+    struct rawrtc_certificate_pool_item* items; // ring buffer
+    uint32_t size;
+    uint32_t head;
+    uint32_t count;
+    uint32_t generating;
+    pthread_t* workers;
+    uint32_t n_workers; // running
+    struct rawrtc_certificate_pool_statistics statistics;
+};
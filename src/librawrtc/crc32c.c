@@ -31,6 +31,15 @@
 /* Version history:
    1.0  10 Feb 2013  First version
    1.1   1 Aug 2013  Correct comments on why three crc instructions in parallel
+
+   Altered for rawrtc:
+   - Detect CPU features once and dispatch to the best kernel afterwards
+     instead of executing cpuid on every call
+   - Add carry-less multiplication folding kernels (PCLMULQDQ and AVX-512
+     VPCLMULQDQ) for large buffers on x86-64
+   - Add a kernel using the ARMv8 CRC instructions
+   - Expose the kernels for benchmarking
+   - Add incremental updates of a CRC-32C after bytes have been changed
  */
 
 #include <stdio.h>
@@ -38,6 +47,19 @@
 #include <stdint.h>
 #include <unistd.h>
 #include <pthread.h>
+#include "crc32c.h"
+
+#if defined(__x86_64__)
+#  define CRC32C_X86_64
+#  include <immintrin.h>
+#elif defined(__aarch64__)
+#  define CRC32C_ARMV8
+#  include <arm_acle.h>
+#  if defined(__linux__)
+#    include <sys/auxv.h>
+#    include <asm/hwcap.h>
+#  endif
+#endif
 
 /* CRC-32C (iSCSI) polynomial in reversed bit order. */
 #define POLY 0x82f63b78
@@ -106,6 +128,8 @@ static uint32_t crc32c_sw(uint32_t crci, const void *buf, size_t len)
     return (uint32_t)crc ^ 0xffffffff;
 }
 
+#if defined(CRC32C_X86_64) || defined(CRC32C_ARMV8)
+
 /* Multiply a matrix times a vector over the Galois field of two elements,
    GF(2).  Each element is a bit in an unsigned integer.  mat must have at
    least as many entries as the power of two for most significant one bit in
@@ -221,6 +245,10 @@ static void crc32c_init_hw(void)
     crc32c_zeros(crc32c_short, SHORT);
 }
 
+#endif
+
+#if defined(CRC32C_X86_64)
+
 /* Compute CRC-32C using the Intel hardware instruction. */
 static uint32_t crc32c_hw(uint32_t crc, const void *buf, size_t len)
 {
@@ -310,28 +338,499 @@ static uint32_t crc32c_hw(uint32_t crc, const void *buf, size_t len)
     return (uint32_t)crc0 ^ 0xffffffff;
 }
 
-/* Check for SSE 4.2.  SSE 4.2 was first supported in Nehalem processors
-   introduced in November, 2008.  This does not check for the existence of the
-   cpuid instruction itself, which was introduced on the 486SL in 1992, so this
-   will fail on earlier x86 processors.  cpuid works on all Pentium and later
-   processors. */
-#define SSE42(have) \
-    do { \
-        uint32_t eax, ecx; \
-        eax = 1; \
-        __asm__("cpuid" \
-                : "=c"(ecx) \
-                : "a"(eax) \
-                : "%ebx", "%edx"); \
-        (have) = (ecx >> 20) & 1; \
-    } while (0)
-
-/* Compute a CRC-32C.  If the crc32 instruction is available, use the hardware
-   version.  Otherwise, use the software version. */
-uint32_t crc32c(uint32_t crc, const void *buf, size_t len)
+
+/* Fold constants for the carry-less multiplication kernels.  Folding a 128-bit
+   lane forward by n bits multiplies its low and high 64 bits by x^(n+31) and
+   x^(n-33) modulo the polynomial (the extra factors account for the 32-bit
+   placement of the constants and the bit-reflected product). */
+static pthread_once_t crc32c_once_fold = PTHREAD_ONCE_INIT;
+static uint32_t crc32c_fold_128[2];     /* one lane */
+static uint32_t crc32c_fold_512[2];     /* four lanes, or one 512-bit register */
+static uint32_t crc32c_fold_2048[2];    /* four 512-bit registers */
+
+/* Compute x^n modulo the CRC-32C polynomial, bit-reflected. */
+static uint32_t crc32c_xpow(size_t n)
+{
+    uint32_t crc = 0x80000000;          /* x^0 */
+
+    while (n--)
+        crc = crc & 1 ? (crc >> 1) ^ POLY : crc >> 1;
+    return crc;
+}
+
+/* Initialize fold constants. */
+static void crc32c_init_fold(void)
+{
+    crc32c_fold_128[0] = crc32c_xpow(128 + 31);
+    crc32c_fold_128[1] = crc32c_xpow(128 - 33);
+    crc32c_fold_512[0] = crc32c_xpow(512 + 31);
+    crc32c_fold_512[1] = crc32c_xpow(512 - 33);
+    crc32c_fold_2048[0] = crc32c_xpow(2048 + 31);
+    crc32c_fold_2048[1] = crc32c_xpow(2048 - 33);
+}
+
+/* Minimum lengths for the folding kernels.  Shorter buffers are handed to the
+   next smaller kernel as setting up the lanes does not pay off. */
+#define FOLD_MIN 256
+#define FOLD_WIDE_MIN 1024
+
+/* Fold a 128-bit lane forward and add the data found at its new position. */
+__attribute__((target("sse4.2,pclmul")))
+static inline __m128i crc32c_fold(__m128i x, __m128i k, __m128i data)
+{
+    return _mm_xor_si128(_mm_xor_si128(_mm_clmulepi64_si128(x, k, 0x00),
+                                       _mm_clmulepi64_si128(x, k, 0x11)),
+                         data);
+}
+
+/* Fold the remaining 16-byte blocks into a single lane, reduce it with the crc
+   instruction and compute the crc of the trailing bytes. */
+__attribute__((target("sse4.2,pclmul")))
+static uint32_t crc32c_fold_finish(__m128i x0, const unsigned char *next,
+                                   size_t len)
+{
+    __m128i const k = _mm_setr_epi32((int)crc32c_fold_128[0], 0,
+                                     (int)crc32c_fold_128[1], 0);
+    uint64_t crc0;
+
+    /* fold 16 bytes at a time */
+    while (len >= 16) {
+        x0 = crc32c_fold(x0, k, _mm_loadu_si128((const __m128i *)next));
+        next += 16;
+        len -= 16;
+    }
+
+    /* the crc of the folded lane is the crc of everything folded so far */
+    crc0 = _mm_crc32_u64(0, (uint64_t)_mm_cvtsi128_si64(x0));
+    crc0 = _mm_crc32_u64(crc0, (uint64_t)_mm_extract_epi64(x0, 1));
+
+    /* compute the crc for the trailing bytes */
+    return crc32c_hw((uint32_t)crc0 ^ 0xffffffff, next, len);
+}
+
+/* Compute CRC-32C by folding four 128-bit lanes with carry-less
+   multiplication.  This processes 64 bytes per iteration with independent
+   multiplications and outperforms the crc instruction for large buffers. */
+__attribute__((target("sse4.2,pclmul")))
+static uint32_t crc32c_pclmul(uint32_t crc, const void *buf, size_t len)
+{
+    const unsigned char *next = buf;
+    __m128i x0, x1, x2, x3, k;
+
+    /* use the crc instruction for short buffers */
+    if (len < FOLD_MIN)
+        return crc32c_hw(crc, buf, len);
+    pthread_once(&crc32c_once_fold, crc32c_init_fold);
+
+    /* load the first 64 bytes and add the pre-processed crc */
+    x0 = _mm_loadu_si128((const __m128i *)next);
+    x1 = _mm_loadu_si128((const __m128i *)(next + 16));
+    x2 = _mm_loadu_si128((const __m128i *)(next + 32));
+    x3 = _mm_loadu_si128((const __m128i *)(next + 48));
+    x0 = _mm_xor_si128(x0, _mm_cvtsi32_si128((int)(crc ^ 0xffffffff)));
+    next += 64;
+    len -= 64;
+
+    /* fold each lane forward by 64 bytes */
+    k = _mm_setr_epi32((int)crc32c_fold_512[0], 0, (int)crc32c_fold_512[1], 0);
+    while (len >= 64) {
+        x0 = crc32c_fold(x0, k, _mm_loadu_si128((const __m128i *)next));
+        x1 = crc32c_fold(x1, k, _mm_loadu_si128((const __m128i *)(next + 16)));
+        x2 = crc32c_fold(x2, k, _mm_loadu_si128((const __m128i *)(next + 32)));
+        x3 = crc32c_fold(x3, k, _mm_loadu_si128((const __m128i *)(next + 48)));
+        next += 64;
+        len -= 64;
+    }
+
+    /* fold the four lanes into one */
+    k = _mm_setr_epi32((int)crc32c_fold_128[0], 0, (int)crc32c_fold_128[1], 0);
+    x1 = crc32c_fold(x0, k, x1);
+    x2 = crc32c_fold(x1, k, x2);
+    x0 = crc32c_fold(x2, k, x3);
+
+    /* fold and compute the crc of the remaining bytes */
+    return crc32c_fold_finish(x0, next, len);
+}
+
+/* Fold four 128-bit lanes of a 512-bit register forward and add data. */
+__attribute__((target("avx512f,vpclmulqdq")))
+static inline __m512i crc32c_fold_wide(__m512i x, __m512i k, __m512i data)
+{
+    return _mm512_ternarylogic_epi64(_mm512_clmulepi64_epi128(x, k, 0x00),
+                                     _mm512_clmulepi64_epi128(x, k, 0x11),
+                                     data, 0x96);
+}
+
+/* Compute CRC-32C by folding four 512-bit registers (sixteen lanes) with the
+   AVX-512 carry-less multiplication.  This processes 256 bytes per
+   iteration. */
+__attribute__((target("avx512f,vpclmulqdq,sse4.2,pclmul")))
+static uint32_t crc32c_vpclmul(uint32_t crc, const void *buf, size_t len)
+{
+    const unsigned char *next = buf;
+    __m512i z0, z1, z2, z3, k;
+    __m128i x0, k128;
+
+    /* use the 128-bit folding kernel for shorter buffers */
+    if (len < FOLD_WIDE_MIN)
+        return crc32c_pclmul(crc, buf, len);
+    pthread_once(&crc32c_once_fold, crc32c_init_fold);
+
+    /* load the first 256 bytes and add the pre-processed crc */
+    z0 = _mm512_loadu_si512(next);
+    z1 = _mm512_loadu_si512(next + 64);
+    z2 = _mm512_loadu_si512(next + 128);
+    z3 = _mm512_loadu_si512(next + 192);
+    z0 = _mm512_xor_si512(z0, _mm512_zextsi128_si512(
+            _mm_cvtsi32_si128((int)(crc ^ 0xffffffff))));
+    next += 256;
+    len -= 256;
+
+    /* fold each register forward by 256 bytes */
+    k = _mm512_broadcast_i32x4(_mm_setr_epi32((int)crc32c_fold_2048[0], 0,
+                                              (int)crc32c_fold_2048[1], 0));
+    while (len >= 256) {
+        z0 = crc32c_fold_wide(z0, k, _mm512_loadu_si512(next));
+        z1 = crc32c_fold_wide(z1, k, _mm512_loadu_si512(next + 64));
+        z2 = crc32c_fold_wide(z2, k, _mm512_loadu_si512(next + 128));
+        z3 = crc32c_fold_wide(z3, k, _mm512_loadu_si512(next + 192));
+        next += 256;
+        len -= 256;
+    }
+
+    /* fold the four registers into one */
+    k = _mm512_broadcast_i32x4(_mm_setr_epi32((int)crc32c_fold_512[0], 0,
+                                              (int)crc32c_fold_512[1], 0));
+    z1 = crc32c_fold_wide(z0, k, z1);
+    z2 = crc32c_fold_wide(z1, k, z2);
+    z0 = crc32c_fold_wide(z2, k, z3);
+
+    /* fold the four lanes of the register into one */
+    k128 = _mm_setr_epi32((int)crc32c_fold_128[0], 0, (int)crc32c_fold_128[1], 0);
+    x0 = crc32c_fold(_mm512_extracti32x4_epi32(z0, 0), k128,
+                     _mm512_extracti32x4_epi32(z0, 1));
+    x0 = crc32c_fold(x0, k128, _mm512_extracti32x4_epi32(z0, 2));
+    x0 = crc32c_fold(x0, k128, _mm512_extracti32x4_epi32(z0, 3));
+
+    /* fold and compute the crc of the remaining bytes */
+    return crc32c_fold_finish(x0, next, len);
+}
+
+#endif
+
+#if defined(CRC32C_ARMV8)
+
+/* Compute CRC-32C using the ARMv8 crc32c instructions.  Like the Intel
+   version, three independent crcs are computed in parallel to hide the
+   latency of the instruction and combined using the shift tables. */
+__attribute__((target("+crc")))
+static uint32_t crc32c_armv8(uint32_t crc, const void *buf, size_t len)
+{
+    const unsigned char *next = buf;
+    const unsigned char *end;
+    uint32_t crc0, crc1, crc2;
+
+    /* populate shift tables the first time through */
+    pthread_once(&crc32c_once_hw, crc32c_init_hw);
+
+    /* pre-process the crc */
+    crc0 = crc ^ 0xffffffff;
+
+    /* compute the crc for up to seven leading bytes to bring the data pointer
+       to an eight-byte boundary */
+    while (len && ((uintptr_t)next & 7) != 0) {
+        crc0 = __crc32cb(crc0, *next);
+        next++;
+        len--;
+    }
+
+    /* compute the crc on sets of LONG*3 bytes */
+    while (len >= LONG*3) {
+        crc1 = 0;
+        crc2 = 0;
+        end = next + LONG;
+        do {
+            crc0 = __crc32cd(crc0, *(const uint64_t *)next);
+            crc1 = __crc32cd(crc1, *(const uint64_t *)(next + LONG));
+            crc2 = __crc32cd(crc2, *(const uint64_t *)(next + LONG*2));
+            next += 8;
+        } while (next < end);
+        crc0 = crc32c_shift(crc32c_long, crc0) ^ crc1;
+        crc0 = crc32c_shift(crc32c_long, crc0) ^ crc2;
+        next += LONG*2;
+        len -= LONG*3;
+    }
+
+    /* do the same thing, but now on SHORT*3 blocks */
+    while (len >= SHORT*3) {
+        crc1 = 0;
+        crc2 = 0;
+        end = next + SHORT;
+        do {
+            crc0 = __crc32cd(crc0, *(const uint64_t *)next);
+            crc1 = __crc32cd(crc1, *(const uint64_t *)(next + SHORT));
+            crc2 = __crc32cd(crc2, *(const uint64_t *)(next + SHORT*2));
+            next += 8;
+        } while (next < end);
+        crc0 = crc32c_shift(crc32c_short, crc0) ^ crc1;
+        crc0 = crc32c_shift(crc32c_short, crc0) ^ crc2;
+        next += SHORT*2;
+        len -= SHORT*3;
+    }
+
+    /* compute the crc on the remaining eight-byte units */
+    end = next + (len - (len & 7));
+    while (next < end) {
+        crc0 = __crc32cd(crc0, *(const uint64_t *)next);
+        next += 8;
+    }
+    len &= 7;
+
+    /* compute the crc for up to seven trailing bytes */
+    while (len) {
+        crc0 = __crc32cb(crc0, *next);
+        next++;
+        len--;
+    }
+
+    /* return a post-processed crc */
+    return crc0 ^ 0xffffffff;
+}
+
+#endif
+
+/* Check whether the CPU supports a kernel.  The x86 checks include operating
+   system support for the AVX-512 register state. */
+static int crc32c_supported(enum crc32c_kernel kernel)
+{
+    switch (kernel) {
+        case CRC32C_KERNEL_SOFTWARE:
+            return 1;
+#if defined(CRC32C_X86_64)
+        case CRC32C_KERNEL_SSE42:
+            return __builtin_cpu_supports("sse4.2");
+        case CRC32C_KERNEL_PCLMUL:
+            return __builtin_cpu_supports("sse4.2") &&
+                   __builtin_cpu_supports("pclmul");
+        case CRC32C_KERNEL_VPCLMUL:
+            return __builtin_cpu_supports("sse4.2") &&
+                   __builtin_cpu_supports("pclmul") &&
+                   __builtin_cpu_supports("avx512f") &&
+                   __builtin_cpu_supports("vpclmulqdq");
+#endif
+#if defined(CRC32C_ARMV8)
+        case CRC32C_KERNEL_ARMV8:
+#  if defined(__linux__)
+            return (getauxval(AT_HWCAP) & HWCAP_CRC32) != 0;
+#  elif defined(__ARM_FEATURE_CRC32)
+            return 1;
+#  else
+            return 0;
+#  endif
+#endif
+        default:
+            return 0;
+    }
+}
+
+/* Kernels by identifier. */
+static crc32c_function *const crc32c_kernels[CRC32C_KERNEL_MAX] = {
+    [CRC32C_KERNEL_SOFTWARE] = crc32c_sw,
+#if defined(CRC32C_X86_64)
+    [CRC32C_KERNEL_SSE42] = crc32c_hw,
+    [CRC32C_KERNEL_PCLMUL] = crc32c_pclmul,
+    [CRC32C_KERNEL_VPCLMUL] = crc32c_vpclmul,
+#endif
+#if defined(CRC32C_ARMV8)
+    [CRC32C_KERNEL_ARMV8] = crc32c_armv8,
+#endif
+};
+
+/* Best supported kernel, selected once. */
+static pthread_once_t crc32c_once = PTHREAD_ONCE_INIT;
+static crc32c_function *crc32c_best;
+
+/* Select the fastest kernel the CPU supports. */
+static void crc32c_init(void)
+{
+    static enum crc32c_kernel const preferred[] = {
+        CRC32C_KERNEL_VPCLMUL,
+        CRC32C_KERNEL_PCLMUL,
+        CRC32C_KERNEL_SSE42,
+        CRC32C_KERNEL_ARMV8,
+    };
+    size_t i;
+
+    crc32c_best = crc32c_sw;
+    for (i = 0; i < sizeof(preferred) / sizeof(preferred[0]); i++) {
+        if (crc32c_kernels[preferred[i]] && crc32c_supported(preferred[i])) {
+            crc32c_best = crc32c_kernels[preferred[i]];
+            break;
+        }
+    }
+}
+
+/* Get a kernel by its identifier.  Return NULL if the kernel has not been
+   built for this architecture or the CPU does not support it. */
+crc32c_function *crc32c_get_kernel(enum crc32c_kernel kernel)
+{
+    if (kernel >= CRC32C_KERNEL_MAX || !crc32c_kernels[kernel] ||
+        !crc32c_supported(kernel))
+        return NULL;
+    return crc32c_kernels[kernel];
+}
+
+/* Get the name of a kernel. */
+char const *crc32c_kernel_to_name(enum crc32c_kernel kernel)
+{
+    switch (kernel) {
+        case CRC32C_KERNEL_SOFTWARE:
+            return "software";
+        case CRC32C_KERNEL_SSE42:
+            return "sse4.2";
+        case CRC32C_KERNEL_PCLMUL:
+            return "pclmul";
+        case CRC32C_KERNEL_VPCLMUL:
+            return "vpclmul";
+        case CRC32C_KERNEL_ARMV8:
+            return "armv8";
+        default:
+            return "???";
+    }
+}
+
+/* Multiply a and b modulo the CRC-32C polynomial, both bit-reflected. */
+static uint32_t crc32c_multmodp(uint32_t a, uint32_t b)
+{
+    uint32_t m, p;
+
+    m = (uint32_t)1 << 31;
+    p = 0;
+    for (;;) {
+        if (a & m) {
+            p ^= b;
+            if ((a & (m - 1)) == 0)
+                break;
+        }
+        m >>= 1;
+        b = b & 1 ? (b >> 1) ^ POLY : b >> 1;
+    }
+    return p;
+}
+
+#if defined(CRC32C_X86_64)
+/* Multiply a and b modulo the CRC-32C polynomial, both bit-reflected, with a
+   carry-less multiply followed by a crc of the 64-bit product.  The result
+   carries an extra factor of x^33, which callers compensate for by scaling one
+   of the factors by x^-33 in advance. */
+__attribute__((target("sse4.2,pclmul")))
+static uint32_t crc32c_multmodp_x33(uint32_t a, uint32_t b)
 {
-    int sse42;
+    __m128i prod;
 
-    SSE42(sse42);
-    return sse42 ? crc32c_hw(crc, buf, len) : crc32c_sw(crc, buf, len);
+    prod = _mm_clmulepi64_si128(_mm_cvtsi32_si128((int)a),
+                                _mm_cvtsi32_si128((int)b), 0);
+    return (uint32_t)_mm_crc32_u64(0, (uint64_t)_mm_cvtsi128_si64(prod));
+}
+#endif
+
+/* Table of x^2^n modulo the CRC-32C polynomial, bit-reflected.  Large enough
+   to shift over any length in bytes that fits into a size_t.  If carry-less
+   multiplication is available, the entries are scaled by x^-33 for use with
+   crc32c_multmodp_x33(), and crc32c_x2n_scale holds x^-33. */
+#define X2N_TABLE_SIZE (sizeof(size_t) * 8 + 3)
+static pthread_once_t crc32c_once_x2n = PTHREAD_ONCE_INIT;
+static uint32_t crc32c_x2n_table[X2N_TABLE_SIZE];
+static uint32_t crc32c_x2n_scale;
+static int crc32c_x2n_clmul;
+
+/* Initialize the x^2^n table by repeated squaring. */
+static void crc32c_init_x2n(void)
+{
+    uint32_t p;
+#if defined(CRC32C_X86_64)
+    uint32_t xinv, scale;
+#endif
+    int n;
+
+    p = (uint32_t)1 << 30;          /* x^1 */
+    crc32c_x2n_table[0] = p;
+    for (n = 1; n < (int)X2N_TABLE_SIZE; n++)
+        crc32c_x2n_table[n] = p = crc32c_multmodp(p, p);
+
+#if defined(CRC32C_X86_64)
+    if (!crc32c_supported(CRC32C_KERNEL_PCLMUL))
+        return;
+
+    /* x^-1 is p(x) without its constant term divided by x */
+    xinv = (POLY << 1) | 1;
+    scale = (uint32_t)1 << 31;      /* x^0 */
+    for (n = 0; n < 33; n++)
+        scale = crc32c_multmodp(scale, xinv);
+    for (n = 0; n < (int)X2N_TABLE_SIZE; n++)
+        crc32c_x2n_table[n] = crc32c_multmodp(crc32c_x2n_table[n], scale);
+    crc32c_x2n_scale = scale;
+    crc32c_x2n_clmul = 1;
+#endif
+}
+
+/* Multiply crc by x^(len*8) modulo the CRC-32C polynomial, bit-reflected,
+   with O(log(len)) multiplications. */
+static uint32_t crc32c_shift_x8n(uint32_t crc, size_t len)
+{
+    uint32_t p;
+    int k;
+
+    pthread_once(&crc32c_once_x2n, crc32c_init_x2n);
+#if defined(CRC32C_X86_64)
+    if (crc32c_x2n_clmul) {
+        p = crc32c_x2n_scale;       /* x^-33 */
+        for (k = 3; len; len >>= 1, k++)
+            if (len & 1)
+                p = crc32c_multmodp_x33(crc32c_x2n_table[k], p);
+        return crc32c_multmodp_x33(p, crc);
+    }
+#endif
+    p = (uint32_t)1 << 31;          /* x^0 */
+    for (k = 3; len; len >>= 1, k++)
+        if (len & 1)
+            p = crc32c_multmodp(crc32c_x2n_table[k], p);
+    return crc32c_multmodp(p, crc);
+}
+
+/* Update the CRC-32C of a buffer of len bytes after the n bytes at offset
+   have been changed from old to new.  As the crc is linear, the difference of
+   the crcs only depends on the difference of the changed bytes and on how many
+   bytes follow them.  This costs O(n + log(len)) instead of O(len). */
+uint32_t crc32c_patch(uint32_t crc, size_t len, size_t offset,
+                      const void *from, const void *to, size_t n)
+{
+    const unsigned char *a = from;
+    const unsigned char *b = to;
+    unsigned char delta[64];
+    uint32_t diff;
+    size_t i, chunk;
+
+    /* compute the crc of the difference without pre- and post-processing */
+    diff = 0;
+    while (n) {
+        chunk = n < sizeof(delta) ? n : sizeof(delta);
+        for (i = 0; i < chunk; i++)
+            delta[i] = a[i] ^ b[i];
+        diff = crc32c(diff ^ 0xffffffff, delta, chunk) ^ 0xffffffff;
+        a += chunk;
+        b += chunk;
+        offset += chunk;
+        n -= chunk;
+    }
+
+    /* shift the difference over the bytes that follow and apply it */
+    return crc ^ crc32c_shift_x8n(diff, len - offset);
+}
+
+/* Compute a CRC-32C.  Use the fastest kernel the CPU supports. */
+uint32_t crc32c(uint32_t crc, const void *buf, size_t len)
+{
+    pthread_once(&crc32c_once, crc32c_init);
+    return crc32c_best(crc, buf, len);
 }
@@ -3,11 +3,61 @@
 #include <stdlib.h>
 
 /*
- * Compute a CRC-32C.  If the crc32 instruction is available, use the hardware
- * version.  Otherwise, use the software version.
+ * CRC-32C kernels.
+ */
+enum crc32c_kernel {
+    CRC32C_KERNEL_SOFTWARE,
+    CRC32C_KERNEL_SSE42,
+    CRC32C_KERNEL_PCLMUL,
+    CRC32C_KERNEL_VPCLMUL,
+    CRC32C_KERNEL_ARMV8,
+    CRC32C_KERNEL_MAX
+};
+
+/*
+ * Compute a CRC-32C.
+ */
+typedef uint32_t (crc32c_function)(
+    uint32_t crc,
+    void const* buf,
+    size_t len
+);
+
+/*
+ * Compute a CRC-32C.  The fastest kernel the CPU supports is selected
+ * on the first call.
  */
 uint32_t crc32c(
     uint32_t crc,
     void const* buf,
     size_t len
 );
+
+/*
+ * Update the CRC-32C of a buffer of `len` bytes after the `n` bytes at
+ * `offset` have been changed from `from` to `to`.  Costs
+ * O(n + log(len)) instead of recomputing the CRC.
+ */
+uint32_t crc32c_patch(
+    uint32_t crc,
+    size_t len,
+    size_t offset,
+    void const* from,
+    void const* to,
+    size_t n
+);
+
+/*
+ * Get a specific kernel (e.g. for benchmarking).  Returns `NULL` in
+ * case the kernel is not available on this CPU.
+ */
+crc32c_function* crc32c_get_kernel(
+    enum crc32c_kernel const kernel
+);
+
+/*
+ * Get the name of a kernel.
+ */
+char const* crc32c_kernel_to_name(
+    enum crc32c_kernel const kernel
+);
@@ -300,6 +300,89 @@ enum rawrtc_code rawrtc_data_channel_send(
     return channel->transport->channel_send(channel, buffer, is_binary);
 }
 
+/*
+ * Send a batch of messages via the data channel.
+ * All messages will be sent with the same `is_binary` flag. Entries
+ * of `buffers` may be `NULL` (or of length 0) to send empty messages.
+ * `*n_sentp` will contain the amount of messages that have been sent
+ * or queued, even if an error is being returned.
+ */
+enum rawrtc_code rawrtc_data_channel_send_batch(
+        size_t* const n_sentp, // de-referenced, nullable
+        struct rawrtc_data_channel* const channel,
+        struct mbuf* const * const buffers, // referenced
+        size_t const n_buffers,
+        bool const is_binary
+) {
+    size_t n_sent = 0;
+    enum rawrtc_code error = RAWRTC_CODE_SUCCESS;
+
+    // Check arguments
+    if (!channel || (!buffers && n_buffers > 0)) {
+        return RAWRTC_CODE_INVALID_ARGUMENT;
+    }
+
+    // Check state
+    if (channel->state != RAWRTC_DATA_CHANNEL_STATE_OPEN) {
+        return RAWRTC_CODE_INVALID_STATE;
+    }
+
+    // Clear options flag
+    channel->flags &= ~RAWRTC_DATA_CHANNEL_FLAGS_CAN_SET_OPTIONS;
+
+    // Call handler (or send each message separately if the transport cannot batch)
+    if (channel->transport->channel_send_batch) {
+        error = channel->transport->channel_send_batch(
+                &n_sent, channel, buffers, n_buffers, is_binary);
+    } else {
+        for (; n_sent < n_buffers; ++n_sent) {
+            error = channel->transport->channel_send(channel, buffers[n_sent], is_binary);
+            if (error) {
+                break;
+            }
+        }
+    }
+
+    // Set amount of messages sent (if requested)
+    if (n_sentp) {
+        *n_sentp = n_sent;
+    }
+    return error;
+}
+
+/*
+ * Send a (large) message via the data channel without providing the
+ * whole message at once.
+ */
+enum rawrtc_code rawrtc_data_channel_send_stream(
+        struct rawrtc_data_channel* const channel,
+        rawrtc_data_channel_message_producer* const producer,
+        size_t const window,
+        bool const is_binary,
+        void* const arg // nullable
+) {
+    // Check arguments
+    if (!channel || !producer) {
+        return RAWRTC_CODE_INVALID_ARGUMENT;
+    }
+
+    // Check state
+    if (channel->state != RAWRTC_DATA_CHANNEL_STATE_OPEN) {
+        return RAWRTC_CODE_INVALID_STATE;
+    }
+
+    // Check handler
+    if (!channel->transport->channel_send_stream) {
+        return RAWRTC_CODE_NOT_IMPLEMENTED;
+    }
+
+    // Clear options flag
+    channel->flags &= ~RAWRTC_DATA_CHANNEL_FLAGS_CAN_SET_OPTIONS;
+
+    // Call handler
+    return channel->transport->channel_send_stream(channel, producer, window, is_binary, arg);
+}
+
 /*
  * Close the data channel.
  */
@@ -331,6 +414,65 @@ enum rawrtc_code rawrtc_data_channel_close(
     return channel->transport->channel_close(channel);
 }
 
+/*
+ * Get the amount of bytes that have been queued for sending on the
+ * data channel but have not yet been handed to the underlying transport.
+ */
+enum rawrtc_code rawrtc_data_channel_get_buffered_amount(
+        uint64_t* const buffered_amountp, // de-referenced
+        struct rawrtc_data_channel* const channel
+) {
+    // Check arguments
+    if (!buffered_amountp || !channel) {
+        return RAWRTC_CODE_INVALID_ARGUMENT;
+    }
+
+    // Check handler
+    if (!channel->transport->channel_get_buffered_amount) {
+        return RAWRTC_CODE_NOT_IMPLEMENTED;
+    }
+
+    // Call handler
+    return channel->transport->channel_get_buffered_amount(buffered_amountp, channel);
+}
+
+/*
+ * Get the data channel's buffered amount low threshold.
+ */
+enum rawrtc_code rawrtc_data_channel_get_buffered_amount_low_threshold(
+        uint64_t* const buffered_amount_low_thresholdp, // de-referenced
+        struct rawrtc_data_channel* const channel
+) {
+    // Check arguments
+    if (!buffered_amount_low_thresholdp || !channel) {
+        return RAWRTC_CODE_INVALID_ARGUMENT;
+    }
+
+    // Set value
+    *buffered_amount_low_thresholdp = channel->buffered_amount_low_threshold;
+    return RAWRTC_CODE_SUCCESS;
+}
+
+/*
+ * Set the data channel's buffered amount low threshold.
+ * The buffered amount low handler will be called once the buffered
+ * amount decreases from above the threshold to or below the threshold.
+ * Defaults to `0`.
+ */
+enum rawrtc_code rawrtc_data_channel_set_buffered_amount_low_threshold(
+        struct rawrtc_data_channel* const channel,
+        uint64_t const buffered_amount_low_threshold
+) {
+    // Check arguments
+    if (!channel) {
+        return RAWRTC_CODE_INVALID_ARGUMENT;
+    }
+
+    // Set value
+    channel->buffered_amount_low_threshold = buffered_amount_low_threshold;
+    return RAWRTC_CODE_SUCCESS;
+}
+
 /*
  * Unset the handler argument and all handlers of the data channel.
  */
@@ -346,6 +488,7 @@ enum rawrtc_code rawrtc_data_channel_unset_handlers(
     channel->arg = NULL;
 
     // Unset all handlers
+    channel->message_view_handler = NULL;
     channel->message_handler = NULL;
     channel->close_handler = NULL;
     channel->error_handler = NULL;
@@ -567,3 +710,65 @@ enum rawrtc_code rawrtc_data_channel_get_message_handler(
         return RAWRTC_CODE_NO_VALUE;
     }
 }
+
+/*
+ * Set the data channel's message view handler.
+ */
+enum rawrtc_code rawrtc_data_channel_set_message_view_handler(
+        struct rawrtc_data_channel* const channel,
+        rawrtc_data_channel_message_view_handler* const message_view_handler // nullable
+) {
+    // Check arguments
+    if (!channel) {
+        return RAWRTC_CODE_INVALID_ARGUMENT;
+    }
+
+    // Set message view handler & done
+    channel->message_view_handler = message_view_handler;
+    return RAWRTC_CODE_SUCCESS;
+}
+
+/*
+ * Get the data channel's message view handler.
+ * Returns `RAWRTC_CODE_NO_VALUE` in case no handler has been set.
+ */
+enum rawrtc_code rawrtc_data_channel_get_message_view_handler(
+        rawrtc_data_channel_message_view_handler** const message_view_handlerp, // de-referenced
+        struct rawrtc_data_channel* const channel
+) {
+    // Check arguments
+    if (!message_view_handlerp || !channel) {
+        return RAWRTC_CODE_INVALID_ARGUMENT;
+    }
+
+    // Get message view handler (if any)
+    if (channel->message_view_handler) {
+        *message_view_handlerp = channel->message_view_handler;
+        return RAWRTC_CODE_SUCCESS;
+    } else {
+        return RAWRTC_CODE_NO_VALUE;
+    }
+}
+
+/*
+ * Announce the size of the next message that will be received on the
+ * data channel.
+ */
+enum rawrtc_code rawrtc_data_channel_set_message_size_hint(
+        struct rawrtc_data_channel* const channel,
+        uint64_t const size
+) {
+    // Check arguments
+    if (!channel) {
+        return RAWRTC_CODE_INVALID_ARGUMENT;
+    }
+#if (UINT64_MAX > SIZE_MAX)
+    if (size > SIZE_MAX) {
+        return RAWRTC_CODE_INVALID_ARGUMENT;
+    }
+#endif
+
+    // Set size hint & done
+    channel->message_size_hint = size;
+    return RAWRTC_CODE_SUCCESS;
+}
@@ -1,5 +1,6 @@
 #include <rawrtc.h>
 #include "data_channel_parameters.h"
+#include "sctp_transport.h"
 
 /*
  * Destructor for existing data channel parameters.
@@ -40,6 +41,7 @@ enum rawrtc_code data_parameters_create(
     parameters->label = label;
     parameters->protocol = protocol;
     parameters->channel_type = channel_type;
+    parameters->priority = RAWRTC_DCEP_CHANNEL_PRIORITY_NORMAL;
     parameters->negotiated = negotiated;
     if (negotiated) {
         parameters->id = id;
@@ -192,3 +194,42 @@ enum rawrtc_code rawrtc_data_channel_parameters_get_protocol(
         return RAWRTC_CODE_NO_VALUE;
     }
 }
+
+/*
+ * Set the priority of the data channel parameters.
+ * Commonly used values are the priorities defined for DCEP: `128`
+ * (below normal), `256` (normal), `512` (high) and `1024` (extra
+ * high). A channel's share of the available bandwidth is proportional
+ * to its priority, the priority must not be `0`.
+ * Defaults to `256` (normal).
+ */
+enum rawrtc_code rawrtc_data_channel_parameters_set_priority(
+        struct rawrtc_data_channel_parameters* const parameters,
+        uint16_t const priority
+) {
+    // Check arguments
+    if (!parameters || priority == 0) {
+        return RAWRTC_CODE_INVALID_ARGUMENT;
+    }
+
+    // Set value
+    parameters->priority = priority;
+    return RAWRTC_CODE_SUCCESS;
+}
+
+/*
+ * Get the priority from the data channel parameters.
+ */
+enum rawrtc_code rawrtc_data_channel_parameters_get_priority(
+        uint16_t* const priorityp, // de-referenced
+        struct rawrtc_data_channel_parameters* const parameters
+) {
+    // Check arguments
+    if (!priorityp || !parameters) {
+        return RAWRTC_CODE_INVALID_ARGUMENT;
+    }
+
+    // Set value
+    *priorityp = parameters->priority;
+    return RAWRTC_CODE_SUCCESS;
+}
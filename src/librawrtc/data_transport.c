@@ -27,7 +27,13 @@ enum rawrtc_code rawrtc_data_transport_create(
         void* const internal_transport, // referenced
         rawrtc_data_transport_channel_create_handler* const channel_create_handler,
         rawrtc_data_transport_channel_close_handler* const channel_close_handler,
-        rawrtc_data_transport_channel_send_handler* const channel_send_handler
+        rawrtc_data_transport_channel_send_handler* const channel_send_handler,
+        rawrtc_data_transport_channel_send_batch_handler* const
+            channel_send_batch_handler, // nullable
+        rawrtc_data_transport_channel_send_stream_handler* const
+            channel_send_stream_handler, // nullable
+        rawrtc_data_transport_channel_get_buffered_amount_handler* const
+            channel_get_buffered_amount_handler // nullable
 ) {
     struct rawrtc_data_transport* transport;
 
@@ -48,6 +54,9 @@ enum rawrtc_code rawrtc_data_transport_create(
     transport->channel_create = channel_create_handler;
     transport->channel_close = channel_close_handler;
     transport->channel_send = channel_send_handler;
+    transport->channel_send_batch = channel_send_batch_handler;
+    transport->channel_send_stream = channel_send_stream_handler;
+    transport->channel_get_buffered_amount = channel_get_buffered_amount_handler;
 
     // Set pointer & done
     DEBUG_PRINTF("Created data transport of type %s\n", rawrtc_data_transport_type_to_str(type));
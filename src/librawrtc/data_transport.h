@@ -19,7 +19,11 @@ enum rawrtc_code rawrtc_data_transport_create(
     void* const internal_transport, // referenced
     rawrtc_data_transport_channel_create_handler* const channel_create_handler,
     rawrtc_data_transport_channel_close_handler* const channel_close_handler,
-    rawrtc_data_transport_channel_send_handler* const channel_send_handler
+    rawrtc_data_transport_channel_send_handler* const channel_send_handler,
+    rawrtc_data_transport_channel_send_batch_handler* const channel_send_batch_handler, // nullable
+    rawrtc_data_transport_channel_send_stream_handler* const channel_send_stream_handler, // nullable
+    rawrtc_data_transport_channel_get_buffered_amount_handler* const
+        channel_get_buffered_amount_handler // nullable
 );
 
 enum rawrtc_code rawrtc_data_channel_create_internal(
@@ -0,0 +1,715 @@
+#include <time.h> // time
+#include <openssl/x509.h> // X509_cmp, X509_digest
+#include <openssl/evp.h> // EVP_PKEY_cmp, EVP_sha256
+#include <openssl/ssl.h> // SSL_*
+#include <rawrtc.h>
+#include "main.h"
+#include "certificate.h"
+#include "utils.h"
+#include "dtls_context.h"
+
+#define DEBUG_MODULE "dtls-context"
+//#define RAWRTC_DEBUG_MODULE_LEVEL 7 // Note: Uncomment this to debug this module only
+#include "debug.h"
+
+/*
+ * Length of the session ticket keys (key name, HMAC and AES key).
+ */
+#if OPENSSL_VERSION_NUMBER >= 0x10100000L
+#define RAWRTC_DTLS_CONTEXT_TICKET_KEYS_LENGTH (16 + 32 + 32)
+#else
+#define RAWRTC_DTLS_CONTEXT_TICKET_KEYS_LENGTH (16 + 16 + 16)
+#endif
+
+/*
+ * Embedded DH parameters in DER encoding (bits: 2048)
+ */
+uint8_t const rawrtc_default_dh_parameters[] = {
+    0x30, 0x82, 0x01, 0x08, 0x02, 0x82, 0x01, 0x01, 0x00, 0xaa, 0x4c, 0x1f,
+    0x1e, 0xc9, 0xed, 0xfe, 0x5c, 0x50, 0x2d, 0xff, 0xf4, 0x95, 0xf4, 0x80,
+    0x69, 0xcf, 0xc3, 0x84, 0x29, 0x87, 0xd5, 0x2c, 0x4f, 0xf6, 0x9e, 0x88,
+    0xa2, 0x5b, 0x61, 0xd2, 0x7d, 0x78, 0x97, 0xce, 0x47, 0x39, 0x9d, 0xc0,
+    0x95, 0x14, 0x98, 0x1f, 0xa9, 0xa3, 0x42, 0x93, 0x58, 0x49, 0x3d, 0xad,
+    0xeb, 0x6c, 0x3d, 0x79, 0x2d, 0x27, 0x94, 0x67, 0x4c, 0xdc, 0x94, 0x31,
+    0xbf, 0xc1, 0x00, 0x9d, 0x96, 0x4a, 0x91, 0xa7, 0x4f, 0xab, 0x48, 0x44,
+    0xcc, 0x54, 0x1a, 0x4e, 0x2a, 0x8e, 0xa1, 0x81, 0x4b, 0xeb, 0xea, 0xc3,
+    0xba, 0xd6, 0x03, 0xfb, 0xf2, 0x9a, 0x48, 0x1f, 0xc8, 0xba, 0x73, 0x89,
+    0x86, 0x25, 0x2e, 0xba, 0x10, 0x80, 0x2a, 0xeb, 0xf9, 0xe2, 0x28, 0xf1,
+    0xcf, 0x85, 0x0d, 0xeb, 0x2f, 0x61, 0x51, 0x11, 0xe1, 0xe7, 0x82, 0xe5,
+    0xa7, 0x5d, 0x71, 0x0a, 0xef, 0x8a, 0xe1, 0x97, 0x48, 0x41, 0xac, 0xd7,
+    0xc5, 0xf7, 0xce, 0xd5, 0xcd, 0x66, 0x1e, 0x6b, 0x0e, 0x82, 0x4e, 0x77,
+    0x5d, 0x89, 0x3b, 0xe2, 0x94, 0x7a, 0x10, 0xee, 0x5b, 0x5d, 0x36, 0x07,
+    0x29, 0x8b, 0x06, 0xb6, 0x49, 0x1e, 0x17, 0x17, 0x57, 0xc8, 0xc1, 0x80,
+    0x24, 0x15, 0x22, 0x9c, 0xb8, 0x59, 0x55, 0x08, 0x41, 0x67, 0x07, 0xca,
+    0xa8, 0x54, 0x1a, 0xd1, 0xb7, 0x91, 0x2f, 0x41, 0x78, 0xc0, 0xcd, 0x2f,
+    0x07, 0x49, 0x4b, 0xb9, 0x05, 0xf4, 0xea, 0x72, 0x3a, 0xcf, 0x04, 0x69,
+    0xcb, 0x5b, 0xe4, 0xcb, 0x4f, 0x72, 0x40, 0xe4, 0x56, 0x1f, 0xca, 0xee,
+    0x33, 0x2b, 0x29, 0x1a, 0x80, 0xda, 0x01, 0x3f, 0x03, 0xa6, 0xbf, 0x32,
+    0x02, 0x6c, 0xfb, 0xb1, 0xb5, 0x81, 0xda, 0x32, 0x6f, 0xa1, 0x4b, 0x9f,
+    0x42, 0x2e, 0x17, 0xc9, 0x95, 0x30, 0xda, 0x16, 0xb7, 0x9a, 0x7c, 0xf4,
+    0x83, 0x02, 0x01, 0x02
+};
+size_t const rawrtc_default_dh_parameters_length = ARRAY_SIZE(rawrtc_default_dh_parameters);
+
+/*
+ * List of default DTLS cipher suites.
+ */
+char const* rawrtc_default_dtls_cipher_suites[] = {
+    "ECDHE-ECDSA-CHACHA20-POLY1305",
+    "ECDHE-RSA-CHACHA20-POLY1305",
+    "ECDHE-ECDSA-AES128-GCM-SHA256", // recommended
+    "ECDHE-RSA-AES128-GCM-SHA256",
+    "ECDHE-ECDSA-AES256-GCM-SHA384",
+    "ECDHE-RSA-AES256-GCM-SHA384",
+    "DHE-RSA-AES128-GCM-SHA256",
+    "DHE-RSA-AES256-GCM-SHA384",
+    "ECDHE-ECDSA-AES128-SHA256",
+    "ECDHE-RSA-AES128-SHA256",
+    "ECDHE-ECDSA-AES128-SHA", // required
+    "ECDHE-RSA-AES256-SHA384",
+    "ECDHE-RSA-AES128-SHA",
+    "ECDHE-ECDSA-AES256-SHA384",
+    "ECDHE-ECDSA-AES256-SHA",
+    "ECDHE-RSA-AES256-SHA",
+    "DHE-RSA-AES128-SHA256",
+    "DHE-RSA-AES128-SHA",
+    "DHE-RSA-AES256-SHA256",
+    "DHE-RSA-AES256-SHA"
+};
+size_t const rawrtc_default_dtls_cipher_suites_length =
+        ARRAY_SIZE(rawrtc_default_dtls_cipher_suites);
+
+/*
+ * Destructor for an existing DTLS context.
+ */
+static void rawrtc_dtls_context_destroy(
+        void* arg
+) {
+    struct rawrtc_dtls_context* const context = arg;
+
+    // Remove from the shard's cache (if cached)
+    list_unlink(&context->le);
+
+    // Un-reference
+    mem_deref(context->tls);
+    list_flush(&context->certificates);
+}
+
+/*
+ * Destructor for an existing cached DTLS session.
+ */
+static void rawrtc_dtls_session_destroy(
+        void* arg
+) {
+    struct rawrtc_dtls_session* const session = arg;
+
+    // Remove from the shard's cache
+    list_unlink(&session->le);
+
+    // Un-reference
+    if (session->session) {
+        SSL_SESSION_free(session->session);
+    }
+    mem_deref(session->fingerprint);
+    mem_deref(session->context);
+}
+
+/*
+ * Destructor for an existing DTLS handshake.
+ */
+static void rawrtc_dtls_handshake_destroy(
+        void* arg
+) {
+    struct rawrtc_dtls_handshake* const handshake = arg;
+
+    // Un-reference
+    if (handshake->session_new) {
+        SSL_SESSION_free(handshake->session_new);
+    }
+    if (handshake->session_offer) {
+        SSL_SESSION_free(handshake->session_offer);
+    }
+}
+
+/*
+ * Attach the pending handshake of our DTLS context to a new OpenSSL
+ * connection and offer its session (if any).
+ * Note: OpenSSL calls this from `SSL_new`. As `dtls_connect` creates
+ *       and connects the connection in one go, this is the only point
+ *       where a session can be set before the client hello is composed.
+ */
+static int handshake_new_handler(
+        void* parent,
+        void* ptr,
+        CRYPTO_EX_DATA* ad,
+        int index,
+        long argl,
+        void* argp
+) {
+    SSL* const ssl = parent;
+    struct rawrtc_dtls_context* context;
+    struct rawrtc_dtls_handshake* handshake;
+    (void) ptr; (void) argl; (void) argp;
+
+    // Get our DTLS context (if any) & the pending handshake
+    context = SSL_CTX_get_ex_data(SSL_get_SSL_CTX(ssl), rawrtc_global.dtls_context_index);
+    if (!context || !context->handshake_pending) {
+        return 1;
+    }
+    handshake = context->handshake_pending;
+
+    // Attach handshake
+    if (!CRYPTO_set_ex_data(ad, index, mem_ref(handshake))) {
+        mem_deref(handshake);
+        return 0;
+    }
+
+    // Offer session
+    if (handshake->session_offer && !SSL_set_session(ssl, handshake->session_offer)) {
+        DEBUG_NOTICE("Could not offer DTLS session for resumption\n");
+    }
+    return 1;
+}
+
+/*
+ * Detach the handshake from an OpenSSL connection that is being freed.
+ */
+static void handshake_free_handler(
+        void* parent,
+        void* ptr,
+        CRYPTO_EX_DATA* ad,
+        int index,
+        long argl,
+        void* argp
+) {
+    (void) parent; (void) ad; (void) index; (void) argl; (void) argp;
+
+    // Un-reference
+    mem_deref(ptr);
+}
+
+/*
+ * Get the handshake of an OpenSSL connection.
+ */
+static struct rawrtc_dtls_handshake* get_handshake(
+        SSL const* const ssl
+) {
+    return SSL_get_ex_data(ssl, rawrtc_global.dtls_handshake_index);
+}
+
+/*
+ * Handle handshake progress. Records whether a session has been
+ * resumed once the handshake is done.
+ */
+static void info_handler(
+        SSL const* ssl,
+        int where,
+        int ret
+) {
+    struct rawrtc_dtls_handshake* const handshake = get_handshake(ssl);
+    (void) ret;
+
+    // Resumed?
+    if ((where & SSL_CB_HANDSHAKE_DONE) && handshake) {
+        handshake->session_reused = SSL_session_reused((SSL*) ssl) == 1;
+    }
+}
+
+/*
+ * Handle a new session of a client connection. The session is kept
+ * until the DTLS transport takes it (once the handshake is done).
+ */
+static int new_session_handler(
+        SSL* ssl,
+        SSL_SESSION* session
+) {
+    struct rawrtc_dtls_handshake* const handshake = get_handshake(ssl);
+
+    // No handshake attached? Let OpenSSL free the session.
+    if (!handshake) {
+        return 0;
+    }
+
+    // Replace a session that has not been taken
+    if (handshake->session_new) {
+        SSL_SESSION_free(handshake->session_new);
+    }
+    handshake->session_new = session;
+
+    // Note: Returning 1 tells OpenSSL that we keep the reference.
+    return 1;
+}
+
+/*
+ * Enable session resumption on a DTLS context. Clients cache sessions
+ * per shard while servers resume by session ticket only.
+ */
+static enum rawrtc_code enable_session_resumption(
+        struct rawrtc_dtls_context* const context, // not checked
+        struct rawrtc_certificate* const certificate // not checked
+) {
+    SSL_CTX* const ssl_context = tls_openssl_context(context->tls);
+    uint8_t id[EVP_MAX_MD_SIZE];
+    unsigned int id_length;
+
+    // Bind sessions to our certificate
+    // Note: A server only resumes sessions with the same session ID context.
+    if (!X509_digest(certificate->certificate, EVP_sha256(), id, &id_length)
+            || !SSL_CTX_set_session_id_context(ssl_context, id, id_length)) {
+        return RAWRTC_CODE_UNKNOWN_ERROR;
+    }
+
+    // Encrypt session tickets with the process-wide keys
+    // Note: This allows resuming sessions after the context has been re-created.
+    if (!SSL_CTX_set_tlsext_ticket_keys(
+            ssl_context, rawrtc_global.dtls_ticket_keys,
+            RAWRTC_DTLS_CONTEXT_TICKET_KEYS_LENGTH)) {
+        return RAWRTC_CODE_UNKNOWN_ERROR;
+    }
+
+    // Hand new client sessions to us, don't cache server sessions
+    SSL_CTX_set_session_cache_mode(
+            ssl_context, SSL_SESS_CACHE_CLIENT | SSL_SESS_CACHE_NO_INTERNAL);
+    SSL_CTX_sess_set_new_cb(ssl_context, new_session_handler);
+    SSL_CTX_set_info_callback(ssl_context, info_handler);
+    if (!SSL_CTX_set_ex_data(ssl_context, rawrtc_global.dtls_context_index, context)) {
+        return RAWRTC_CODE_UNKNOWN_ERROR;
+    }
+    return RAWRTC_CODE_SUCCESS;
+}
+
+/*
+ * Check whether a cached session belongs to a fingerprint.
+ */
+static bool session_matches(
+        struct rawrtc_dtls_session* const session, // not checked
+        struct rawrtc_dtls_fingerprint* const fingerprint // not checked
+) {
+    return session->algorithm == fingerprint->algorithm
+            && str_casecmp(session->fingerprint, fingerprint->value) == 0;
+}
+
+/*
+ * Check whether a session has expired.
+ */
+static bool session_expired(
+        SSL_SESSION* const session // not checked
+) {
+    return (long) time(NULL) >= SSL_SESSION_get_time(session) + SSL_SESSION_get_timeout(session);
+}
+
+/*
+ * Check whether two certificates are identical (certificate and
+ * private key).
+ */
+static bool certificate_equals(
+        struct rawrtc_certificate* const a, // not checked
+        struct rawrtc_certificate* const b // not checked
+) {
+    // Copies share the certificate and the private key
+    if (a->certificate == b->certificate && a->key == b->key) {
+        return true;
+    }
+
+    // Compare content
+    return a->key_type == b->key_type
+            && X509_cmp(a->certificate, b->certificate) == 0
+            && EVP_PKEY_cmp(a->key, b->key) == 1;
+}
+
+/*
+ * Check whether two certificate lists are identical (including order).
+ */
+static bool certificate_list_equals(
+        struct list* const a, // not checked
+        struct list* const b // not checked
+) {
+    struct le* le_a;
+    struct le* le_b;
+
+    for (le_a = list_head(a), le_b = list_head(b);
+         le_a != NULL && le_b != NULL; le_a = le_a->next, le_b = le_b->next) {
+        if (!certificate_equals(le_a->data, le_b->data)) {
+            return false;
+        }
+    }
+    return le_a == NULL && le_b == NULL;
+}
+
+/*
+ * Create a new DTLS context.
+ */
+static enum rawrtc_code dtls_context_create(
+        struct rawrtc_dtls_context** const contextp, // de-referenced
+        struct list* const certificates, // not checked
+        bool const share,
+        bool const resumption
+) {
+    struct rawrtc_dtls_context* context;
+    enum rawrtc_code error;
+    struct rawrtc_certificate* certificate;
+    uint8_t* certificate_der;
+    size_t certificate_der_length;
+
+    // Allocate
+    context = mem_zalloc(sizeof(*context), rawrtc_dtls_context_destroy);
+    if (!context) {
+        return RAWRTC_CODE_NO_MEMORY;
+    }
+
+    // Set fields
+    context->shared = share;
+    context->resumption = resumption;
+
+    // Copy certificates
+    // Note: This keeps the certificates alive while the context may be looked up.
+    error = rawrtc_certificate_list_copy(&context->certificates, certificates);
+    if (error) {
+        goto out;
+    }
+
+    // Create (D)TLS context
+    DEBUG_PRINTF("Creating DTLS context\n");
+    error = rawrtc_error_to_code(tls_alloc(&context->tls, TLS_METHOD_DTLS, NULL, NULL));
+    if (error) {
+        goto out;
+    }
+
+    // Get DER encoded certificate of choice
+    // TODO: Which certificate should we use?
+    certificate = list_ledata(list_head(&context->certificates));
+    error = rawrtc_certificate_get_der(
+            &certificate_der, &certificate_der_length, certificate, RAWRTC_CERTIFICATE_ENCODE_BOTH);
+    if (error) {
+        goto out;
+    }
+
+    // Set certificate
+    DEBUG_PRINTF("Setting certificate on DTLS context\n");
+    error = rawrtc_error_to_code(tls_set_certificate_der(
+            context->tls, rawrtc_certificate_key_type_to_tls_keytype(certificate->key_type),
+            certificate_der, certificate_der_length, NULL, 0));
+    mem_deref(certificate_der);
+    if (error) {
+        goto out;
+    }
+
+    // Set Diffie-Hellman parameters
+    // TODO: Get DH params from config
+    DEBUG_PRINTF("Setting DH parameters on DTLS context\n");
+    error = rawrtc_error_to_code(tls_set_dh_params_der(
+            context->tls, rawrtc_default_dh_parameters, rawrtc_default_dh_parameters_length));
+    if (error) {
+        goto out;
+    }
+
+    // Set cipher suites
+    // TODO: Get cipher suites from config
+    DEBUG_PRINTF("Setting cipher suites on DTLS context\n");
+    error = rawrtc_error_to_code(tls_set_ciphers(
+            context->tls, rawrtc_default_dtls_cipher_suites,
+            rawrtc_default_dtls_cipher_suites_length));
+    if (error) {
+        goto out;
+    }
+
+    // Send client certificate (client) / request client certificate (server)
+    tls_set_verify_client(context->tls);
+
+    // Enable session resumption (if requested)
+    if (resumption) {
+        error = enable_session_resumption(context, certificate);
+        if (error) {
+            goto out;
+        }
+    }
+
+out:
+    if (error) {
+        mem_deref(context);
+    } else {
+        // Set pointer
+        *contextp = context;
+    }
+    return error;
+}
+
+/*
+ * Register the OpenSSL ex_data indexes of DTLS contexts and
+ * handshakes. Must be called once from `rawrtc_init`.
+ */
+enum rawrtc_code rawrtc_dtls_context_init() {
+    // Register index of our DTLS context on an OpenSSL context
+    rawrtc_global.dtls_context_index = SSL_CTX_get_ex_new_index(0, NULL, NULL, NULL, NULL);
+    if (rawrtc_global.dtls_context_index < 0) {
+        return RAWRTC_CODE_INITIALISE_FAIL;
+    }
+
+    // Register index of the handshake on an OpenSSL connection
+    rawrtc_global.dtls_handshake_index = SSL_get_ex_new_index(
+            0, NULL, handshake_new_handler, NULL, handshake_free_handler);
+    if (rawrtc_global.dtls_handshake_index < 0) {
+        return RAWRTC_CODE_INITIALISE_FAIL;
+    }
+
+    // Done
+    return RAWRTC_CODE_SUCCESS;
+}
+
+/*
+ * Get a DTLS context for a certificate list. If `share` is `true` and
+ * another DTLS transport of the current shard already uses a shared
+ * context with identical certificates, that context will be referenced
+ * instead of creating a new one.
+ * Session resumption is enabled on shared contexts in case the shard
+ * caches sessions.
+ */
+enum rawrtc_code rawrtc_dtls_context_get(
+        struct rawrtc_dtls_context** const contextp, // de-referenced
+        struct list* const certificates, // not checked
+        bool const share
+) {
+    struct rawrtc_shard* const shard = rawrtc_shard_current();
+    struct rawrtc_dtls_context* context;
+    enum rawrtc_code error;
+    struct le* le;
+    bool resumption;
+
+    // Check arguments
+    if (!contextp || list_isempty(certificates)) {
+        return RAWRTC_CODE_INVALID_ARGUMENT;
+    }
+
+    // Don't share? Always create a new context.
+    // Note: A cached session references its context. An unshared context will never be used
+    //       again, so its sessions could never be resumed and would only keep it alive.
+    if (!share) {
+        return dtls_context_create(contextp, certificates, false, false);
+    }
+
+    // Already exists?
+    resumption = shard->dtls_session_cache_size > 0;
+    for (le = list_head(&shard->dtls_contexts); le != NULL; le = le->next) {
+        context = le->data;
+        if (context->resumption == resumption
+                && certificate_list_equals(&context->certificates, certificates)) {
+            *contextp = mem_ref(context);
+            return RAWRTC_CODE_SUCCESS;
+        }
+    }
+
+    // Create
+    error = dtls_context_create(&context, certificates, true, resumption);
+    if (error) {
+        return error;
+    }
+
+    // Add to the shard's cache
+    // Note: The cache does not reference the context, it removes itself once unused.
+    list_append(&shard->dtls_contexts, &context->le, context);
+
+    // Set pointer & done
+    *contextp = context;
+    return RAWRTC_CODE_SUCCESS;
+}
+
+/*
+ * Find a cached session of a context matching any of the fingerprints.
+ */
+static SSL_SESSION* find_session(
+        struct rawrtc_dtls_context* const context, // not checked
+        struct rawrtc_dtls_fingerprints* const fingerprints // not checked
+) {
+    struct rawrtc_shard* const shard = rawrtc_shard_current();
+    struct le* le;
+    size_t i;
+
+    // Find a session of this context
+    le = list_head(&shard->dtls_sessions);
+    while (le) {
+        struct rawrtc_dtls_session* const session = le->data;
+        le = le->next;
+
+        // Same context?
+        if (session->context != context) {
+            continue;
+        }
+
+        // Drop expired session
+        if (session_expired(session->session)) {
+            mem_deref(session);
+            continue;
+        }
+
+        // Check if any of the fingerprints provided matches
+        for (i = 0; i < fingerprints->n_fingerprints; ++i) {
+            if (session_matches(session, fingerprints->fingerprints[i])) {
+                // Mark as most recently used
+                list_unlink(&session->le);
+                list_prepend(&shard->dtls_sessions, &session->le, session);
+                return session->session;
+            }
+        }
+    }
+
+    // Not found
+    return NULL;
+}
+
+/*
+ * Create the session state of a new handshake. In case fingerprints
+ * have been provided, a cached session matching any of them will be
+ * offered once the handshake starts.
+ */
+enum rawrtc_code rawrtc_dtls_handshake_create(
+        struct rawrtc_dtls_handshake** const handshakep, // de-referenced
+        struct rawrtc_dtls_context* const context, // not checked
+        struct rawrtc_dtls_fingerprints* const fingerprints // nullable
+) {
+    struct rawrtc_dtls_handshake* handshake;
+
+    // Check arguments
+    if (!handshakep) {
+        return RAWRTC_CODE_INVALID_ARGUMENT;
+    }
+
+    // Allocate
+    handshake = mem_zalloc(sizeof(*handshake), rawrtc_dtls_handshake_destroy);
+    if (!handshake) {
+        return RAWRTC_CODE_NO_MEMORY;
+    }
+
+    // Find cached session to be offered (if any)
+    if (fingerprints && context->resumption) {
+        SSL_SESSION* const session = find_session(context, fingerprints);
+        if (session) {
+            DEBUG_PRINTF("Offering cached DTLS session for resumption\n");
+#if OPENSSL_VERSION_NUMBER >= 0x10100000L
+            if (SSL_SESSION_up_ref(session)) {
+                handshake->session_offer = session;
+            }
+#else
+            if (CRYPTO_add(&session->references, 1, CRYPTO_LOCK_SSL_SESSION)) {
+                handshake->session_offer = session;
+            }
+#endif
+        }
+    }
+
+    // Set pointer & done
+    *handshakep = handshake;
+    return RAWRTC_CODE_SUCCESS;
+}
+
+/*
+ * Set the handshake that will be attached to the next OpenSSL
+ * connection created from the context. Passing `NULL` clears it.
+ * Note: Set this only while calling `dtls_connect` or `dtls_accept`.
+ */
+void rawrtc_dtls_context_set_pending_handshake(
+        struct rawrtc_dtls_context* const context, // not checked
+        struct rawrtc_dtls_handshake* const handshake // nullable
+) {
+    context->handshake_pending = handshake;
+}
+
+/*
+ * Take the new session (if any) and whether a session has been resumed
+ * from a handshake.
+ * Must be called from the connection established handler.
+ */
+void rawrtc_dtls_handshake_take_session(
+        SSL_SESSION** const sessionp, // de-referenced
+        bool* const reusedp, // de-referenced
+        struct rawrtc_dtls_handshake* const handshake // not checked
+) {
+    // Hand over
+    *sessionp = handshake->session_new;
+    *reusedp = handshake->session_reused;
+
+    // Reset
+    handshake->session_new = NULL;
+}
+
+/*
+ * Evict least recently used sessions of the current shard until at
+ * most `size` sessions are cached.
+ */
+static void evict_sessions(
+        struct rawrtc_shard* const shard, // not checked
+        uint32_t const size
+) {
+    while (list_count(&shard->dtls_sessions) > size) {
+        mem_deref(list_ledata(list_tail(&shard->dtls_sessions)));
+    }
+}
+
+/*
+ * Cache a client's session for the server's verified fingerprint.
+ * Evicts the least recently used session if the cache is full.
+ */
+void rawrtc_dtls_context_store_session(
+        struct rawrtc_dtls_context* const context, // not checked
+        struct rawrtc_dtls_fingerprint* const fingerprint, // not checked
+        SSL_SESSION* const ssl_session // handed over
+) {
+    struct rawrtc_shard* const shard = rawrtc_shard_current();
+    uint32_t const size = shard->dtls_session_cache_size;
+    struct rawrtc_dtls_session* session;
+    struct le* le;
+
+    // Remove previous session for the same fingerprint
+    le = list_head(&shard->dtls_sessions);
+    while (le) {
+        session = le->data;
+        le = le->next;
+        if (session->context == context && session_matches(session, fingerprint)) {
+            mem_deref(session);
+        }
+    }
+
+    // Caching disabled? (or not enabled on the context, see `rawrtc_dtls_context_get`)
+    if (size == 0 || !context->resumption) {
+        SSL_SESSION_free(ssl_session);
+        return;
+    }
+
+    // Allocate
+    session = mem_zalloc(sizeof(*session), rawrtc_dtls_session_destroy);
+    if (!session) {
+        SSL_SESSION_free(ssl_session);
+        return;
+    }
+
+    // Set fields/reference
+    session->context = mem_ref(context);
+    session->algorithm = fingerprint->algorithm;
+    session->session = ssl_session;
+    if (rawrtc_strdup(&session->fingerprint, fingerprint->value)) {
+        mem_deref(session);
+        return;
+    }
+
+    // Add as most recently used
+    DEBUG_PRINTF("Caching DTLS session for resumption\n");
+    list_prepend(&shard->dtls_sessions, &session->le, session);
+
+    // Evict least recently used sessions
+    evict_sessions(shard, size);
+}
+
+/*
+ * Set the maximum amount of DTLS client sessions the shard of the
+ * calling thread caches for resumption (RFC 5077). `0` disables
+ * resumption for DTLS transports created afterwards.
+ */
+enum rawrtc_code rawrtc_shard_set_dtls_session_cache_size(
+        uint32_t const size
+) {
+    struct rawrtc_shard* const shard = rawrtc_shard_current();
+
+    // Set size & evict sessions that exceed it
+    shard->dtls_session_cache_size = size;
+    evict_sessions(shard, size);
+    return RAWRTC_CODE_SUCCESS;
+}
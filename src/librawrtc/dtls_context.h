@@ -0,0 +1,70 @@
+#pragma once
+#include <openssl/ssl.h> // SSL_SESSION
+#include <rawrtc.h>
+
+/*
+ * (D)TLS context holding a certificate, the DH parameters and the
+ * cipher suites. Shared by all DTLS transports of a shard that use the
+ * same certificates.
+ */
+struct rawrtc_dtls_context {
+    struct le le; // cached in the shard's list while in use
+    struct list certificates; // deep-copied
+    struct tls* tls;
+    bool shared; // cached in the shard's list
+    bool resumption;
+    struct rawrtc_dtls_handshake* handshake_pending; // not referenced, nullable
+};
+
+/*
+ * Session state of a single DTLS handshake. Attached to the OpenSSL
+ * connection once it has been created (SSL ex_data).
+ */
+struct rawrtc_dtls_handshake {
+    SSL_SESSION* session_offer; // referenced, nullable
+    SSL_SESSION* session_new; // referenced, nullable
+    bool session_reused;
+};
+
+/*
+ * Cached DTLS session of a client for resumption (RFC 5077). Keyed by
+ * the DTLS context and the verified fingerprint of the server.
+ */
+struct rawrtc_dtls_session {
+    struct le le;
+    struct rawrtc_dtls_context* context; // referenced
+    enum rawrtc_certificate_sign_algorithm algorithm;
+    char* fingerprint; // copied
+    SSL_SESSION* session; // referenced
+};
+
+enum rawrtc_code rawrtc_dtls_context_init();
+
+enum rawrtc_code rawrtc_dtls_context_get(
+    struct rawrtc_dtls_context** const contextp, // de-referenced
+    struct list* const certificates, // not checked
+    bool const share
+);
+
+enum rawrtc_code rawrtc_dtls_handshake_create(
+    struct rawrtc_dtls_handshake** const handshakep, // de-referenced
+    struct rawrtc_dtls_context* const context, // not checked
+    struct rawrtc_dtls_fingerprints* const fingerprints // nullable
+);
+
+void rawrtc_dtls_context_set_pending_handshake(
+    struct rawrtc_dtls_context* const context, // not checked
+    struct rawrtc_dtls_handshake* const handshake // nullable
+);
+
+void rawrtc_dtls_handshake_take_session(
+    SSL_SESSION** const sessionp, // de-referenced
+    bool* const reusedp, // de-referenced
+    struct rawrtc_dtls_handshake* const handshake // not checked
+);
+
+void rawrtc_dtls_context_store_session(
+    struct rawrtc_dtls_context* const context, // not checked
+    struct rawrtc_dtls_fingerprint* const fingerprint, // not checked
+    SSL_SESSION* const ssl_session // handed over
+);
@@ -1,10 +1,21 @@
-#include <string.h> // memcmp
+#ifdef __linux__
+#ifndef _GNU_SOURCE
+#define _GNU_SOURCE // sendmmsg
+#endif
+#define RAWRTC_HAVE_SENDMMSG
+#include <errno.h> // errno
+#include <sys/socket.h> // sendmmsg, struct mmsghdr
+#endif
+#include <string.h> // memcmp, memset
 #include <rawrtc.h>
 #include "dtls_transport.h"
 #include "dtls_parameters.h"
 #include "message_buffer.h"
+#include "packet_ring.h"
 #include "candidate_helper.h"
 #include "certificate.h"
+#include "dtls_context.h"
+#include "path_mtu.h"
 #include "utils.h"
 
 #define DEBUG_MODULE "dtls-transport"
@@ -12,62 +23,15 @@
 #include "debug.h"
 
 /*
- * Embedded DH parameters in DER encoding (bits: 2048)
+ * Maximum amount of datagrams handed to `sendmmsg` at once.
  */
-uint8_t const rawrtc_default_dh_parameters[] = {
-    0x30, 0x82, 0x01, 0x08, 0x02, 0x82, 0x01, 0x01, 0x00, 0xaa, 0x4c, 0x1f,
-    0x1e, 0xc9, 0xed, 0xfe, 0x5c, 0x50, 0x2d, 0xff, 0xf4, 0x95, 0xf4, 0x80,
-    0x69, 0xcf, 0xc3, 0x84, 0x29, 0x87, 0xd5, 0x2c, 0x4f, 0xf6, 0x9e, 0x88,
-    0xa2, 0x5b, 0x61, 0xd2, 0x7d, 0x78, 0x97, 0xce, 0x47, 0x39, 0x9d, 0xc0,
-    0x95, 0x14, 0x98, 0x1f, 0xa9, 0xa3, 0x42, 0x93, 0x58, 0x49, 0x3d, 0xad,
-    0xeb, 0x6c, 0x3d, 0x79, 0x2d, 0x27, 0x94, 0x67, 0x4c, 0xdc, 0x94, 0x31,
-    0xbf, 0xc1, 0x00, 0x9d, 0x96, 0x4a, 0x91, 0xa7, 0x4f, 0xab, 0x48, 0x44,
-    0xcc, 0x54, 0x1a, 0x4e, 0x2a, 0x8e, 0xa1, 0x81, 0x4b, 0xeb, 0xea, 0xc3,
-    0xba, 0xd6, 0x03, 0xfb, 0xf2, 0x9a, 0x48, 0x1f, 0xc8, 0xba, 0x73, 0x89,
-    0x86, 0x25, 0x2e, 0xba, 0x10, 0x80, 0x2a, 0xeb, 0xf9, 0xe2, 0x28, 0xf1,
-    0xcf, 0x85, 0x0d, 0xeb, 0x2f, 0x61, 0x51, 0x11, 0xe1, 0xe7, 0x82, 0xe5,
-    0xa7, 0x5d, 0x71, 0x0a, 0xef, 0x8a, 0xe1, 0x97, 0x48, 0x41, 0xac, 0xd7,
-    0xc5, 0xf7, 0xce, 0xd5, 0xcd, 0x66, 0x1e, 0x6b, 0x0e, 0x82, 0x4e, 0x77,
-    0x5d, 0x89, 0x3b, 0xe2, 0x94, 0x7a, 0x10, 0xee, 0x5b, 0x5d, 0x36, 0x07,
-    0x29, 0x8b, 0x06, 0xb6, 0x49, 0x1e, 0x17, 0x17, 0x57, 0xc8, 0xc1, 0x80,
-    0x24, 0x15, 0x22, 0x9c, 0xb8, 0x59, 0x55, 0x08, 0x41, 0x67, 0x07, 0xca,
-    0xa8, 0x54, 0x1a, 0xd1, 0xb7, 0x91, 0x2f, 0x41, 0x78, 0xc0, 0xcd, 0x2f,
-    0x07, 0x49, 0x4b, 0xb9, 0x05, 0xf4, 0xea, 0x72, 0x3a, 0xcf, 0x04, 0x69,
-    0xcb, 0x5b, 0xe4, 0xcb, 0x4f, 0x72, 0x40, 0xe4, 0x56, 0x1f, 0xca, 0xee,
-    0x33, 0x2b, 0x29, 0x1a, 0x80, 0xda, 0x01, 0x3f, 0x03, 0xa6, 0xbf, 0x32,
-    0x02, 0x6c, 0xfb, 0xb1, 0xb5, 0x81, 0xda, 0x32, 0x6f, 0xa1, 0x4b, 0x9f,
-    0x42, 0x2e, 0x17, 0xc9, 0x95, 0x30, 0xda, 0x16, 0xb7, 0x9a, 0x7c, 0xf4,
-    0x83, 0x02, 0x01, 0x02
-};
-size_t const rawrtc_default_dh_parameters_length = ARRAY_SIZE(rawrtc_default_dh_parameters);
+#define RAWRTC_DTLS_TRANSPORT_SENDMMSG_MAX 64
 
 /*
- * List of default DTLS cipher suites.
+ * Maximum overhead of a DTLS record for the default cipher suites:
+ * Header (13), explicit IV (16), MAC (48, SHA-384) and padding (16).
  */
-char const* rawrtc_default_dtls_cipher_suites[] = {
-    "ECDHE-ECDSA-CHACHA20-POLY1305",
-    "ECDHE-RSA-CHACHA20-POLY1305",
-    "ECDHE-ECDSA-AES128-GCM-SHA256", // recommended
-    "ECDHE-RSA-AES128-GCM-SHA256",
-    "ECDHE-ECDSA-AES256-GCM-SHA384",
-    "ECDHE-RSA-AES256-GCM-SHA384",
-    "DHE-RSA-AES128-GCM-SHA256",
-    "DHE-RSA-AES256-GCM-SHA384",
-    "ECDHE-ECDSA-AES128-SHA256",
-    "ECDHE-RSA-AES128-SHA256",
-    "ECDHE-ECDSA-AES128-SHA", // required
-    "ECDHE-RSA-AES256-SHA384",
-    "ECDHE-RSA-AES128-SHA",
-    "ECDHE-ECDSA-AES256-SHA384",
-    "ECDHE-ECDSA-AES256-SHA",
-    "ECDHE-RSA-AES256-SHA",
-    "DHE-RSA-AES128-SHA256",
-    "DHE-RSA-AES128-SHA",
-    "DHE-RSA-AES256-SHA256",
-    "DHE-RSA-AES256-SHA"
-};
-size_t const rawrtc_default_dtls_cipher_suites_length =
-        ARRAY_SIZE(rawrtc_default_dtls_cipher_suites);
+#define RAWRTC_DTLS_TRANSPORT_RECORD_OVERHEAD_MAX (13 + 16 + 48 + 16)
 
 /*
  * Get the corresponding name for an ICE transport state.
@@ -129,6 +93,11 @@ static void set_state(
         // Remove connection
         transport->connection = mem_deref(transport->connection);
 
+        // Stop path MTU discovery (if any)
+        if (transport->path_mtu) {
+            rawrtc_path_mtu_stop(transport->path_mtu);
+        }
+
         // Remove self from ICE transport (if attached)
         transport->ice_transport->dtls_transport = NULL;
     }
@@ -244,7 +213,7 @@ static void verify_certificate(
 ) {
     size_t i;
     enum rawrtc_code error = RAWRTC_CODE_SUCCESS;
-    bool valid = false;
+    struct rawrtc_dtls_fingerprint* verified_fingerprint = NULL;
     enum tls_fingerprint algorithm;
     uint8_t expected_fingerprint[RAWRTC_FINGERPRINT_MAX_SIZE];
     uint8_t actual_fingerprint[RAWRTC_FINGERPRINT_MAX_SIZE];
@@ -258,6 +227,8 @@ static void verify_certificate(
 //    DEBUG_PRINTF("Peer's certificate verified\n");
 
     // Check if any of the fingerprints provided matches
+    // Note: A resumed session carries the peer's certificate of the original handshake, so this
+    //       applies to resumed sessions as well.
     // TODO: Is this correct?
     for (i = 0; i < transport->remote_parameters->fingerprints->n_fingerprints; ++i) {
         struct rawrtc_dtls_fingerprint* const fingerprint =
@@ -315,12 +286,12 @@ static void verify_certificate(
         // TODO: Constant-time equality comparison needed?
         if (memcmp(expected_fingerprint, actual_fingerprint, length) == 0) {
             DEBUG_PRINTF("Peer's certificate fingerprint is valid\n");
-            valid = true;
+            verified_fingerprint = fingerprint;
         }
     }
 
 out:
-    if (error || !valid) {
+    if (error || !verified_fingerprint) {
         DEBUG_WARNING("Verifying certificate failed, reason: %s\n", rawrtc_code_to_str(error));
         if (!is_closed(transport)) {
             set_state(transport, RAWRTC_DTLS_TRANSPORT_STATE_FAILED);
@@ -333,6 +304,13 @@ out:
                           rawrtc_code_to_str(error));
         }
     } else {
+        // Cache new session for resumption (if client)
+        if (transport->session) {
+            rawrtc_dtls_context_store_session(
+                    transport->context, verified_fingerprint, transport->session);
+            transport->session = NULL;
+        }
+
         // Connected
         set_state(transport, RAWRTC_DTLS_TRANSPORT_STATE_CONNECTED);
     }
@@ -345,6 +323,18 @@ static void establish_handler(
         void* arg
 ) {
     struct rawrtc_dtls_transport* const transport = arg;
+    bool resumed;
+
+    // Take new session (if any) & check if the session has been resumed
+    // Note: The session is cached once the peer's fingerprint has been verified.
+    if (transport->session) {
+        SSL_SESSION_free(transport->session);
+    }
+    rawrtc_dtls_handshake_take_session(&transport->session, &resumed, transport->handshake);
+    if (resumed) {
+        DEBUG_INFO("DTLS session resumed\n");
+        ++transport->statistics.sessions_resumed;
+    }
 
     // Check state
     if (is_closed(transport)) {
@@ -373,6 +363,7 @@ static void connect_handler(
     struct rawrtc_dtls_transport* const transport = arg;
     bool role_is_server;
     bool have_connection;
+    enum rawrtc_code error;
     int err;
     (void) peer;
 
@@ -397,10 +388,22 @@ static void connect_handler(
             set_state(transport, RAWRTC_DTLS_TRANSPORT_STATE_CONNECTING);
         }
 
+        // Create handshake state
+        transport->handshake = mem_deref(transport->handshake);
+        error = rawrtc_dtls_handshake_create(&transport->handshake, transport->context, NULL);
+        if (error) {
+            DEBUG_WARNING("Could not create DTLS handshake, reason: %s\n",
+                          rawrtc_code_to_str(error));
+            return;
+        }
+
         // Accept and create connection
+        // Note: The handshake is attached to the connection once it has been created.
         DEBUG_PRINTF("Accepting incoming DTLS connection from %J\n", peer);
-        err = dtls_accept(&transport->connection, transport->context, transport->socket,
+        rawrtc_dtls_context_set_pending_handshake(transport->context, transport->handshake);
+        err = dtls_accept(&transport->connection, transport->context->tls, transport->socket,
                           establish_handler, dtls_receive_handler, close_handler, transport);
+        rawrtc_dtls_context_set_pending_handshake(transport->context, NULL);
         if (err) {
             DEBUG_WARNING("Could not accept incoming DTLS connection, reason: %m\n", err);
         }
@@ -419,28 +422,41 @@ static void connect_handler(
  */
 static enum rawrtc_code do_connect(
         struct rawrtc_dtls_transport* const transport,
-        const struct sa* const peer
+        const struct sa* const peer,
+        struct rawrtc_dtls_fingerprints* const fingerprints // not checked
 ) {
+    enum rawrtc_code error;
+    int err;
+
+    // Create handshake state & offer cached session for the remote fingerprints (if any)
+    transport->handshake = mem_deref(transport->handshake);
+    error = rawrtc_dtls_handshake_create(&transport->handshake, transport->context, fingerprints);
+    if (error) {
+        return error;
+    }
+
     // Connect
+    // Note: The handshake is attached to the connection (and the session is offered) once it
+    //       has been created, before the client hello is being sent.
     DEBUG_PRINTF("Starting DTLS connection to %J\n", peer);
-    return rawrtc_error_to_code(dtls_connect(
-            &transport->connection, transport->context, transport->socket, peer,
-            establish_handler, dtls_receive_handler, close_handler, transport));
+    rawrtc_dtls_context_set_pending_handshake(transport->context, transport->handshake);
+    err = dtls_connect(
+            &transport->connection, transport->context->tls, transport->socket, peer,
+            establish_handler, dtls_receive_handler, close_handler, transport);
+    rawrtc_dtls_context_set_pending_handshake(transport->context, NULL);
+    return rawrtc_error_to_code(err);
 }
 
 /*
- * Handle outgoing DTLS messages.
+ * Get the selected candidate pair and its local UDP socket.
  */
-static int send_handler(
-        struct tls_conn* tc,
-        struct sa const* original_destination,
-        struct mbuf* buffer,
-        void* arg
+static int get_selected_path(
+        struct ice_candpair** const candidate_pairp, // de-referenced
+        struct udp_sock** const udp_socketp, // de-referenced
+        struct rawrtc_dtls_transport* const transport // not checked
 ) {
-    struct rawrtc_dtls_transport* const transport = arg;
     struct trice* const ice = transport->ice_transport->gatherer->ice;
     bool closed = is_closed(transport);
-    (void) tc; (void) original_destination;
 
     // Note: No need to check if closed as only non-application data may be sent if the
     //       transport is already closed.
@@ -464,18 +480,168 @@ static int send_handler(
         return ECONNRESET;
     }
 
+    // Set pointers
+    *candidate_pairp = candidate_pair;
+    *udp_socketp = udp_socket;
+    return 0;
+}
+
+/*
+ * Get the active path (local UDP socket and remote address). Looks up
+ * the selected candidate pair in case the cached path has been
+ * invalidated.
+ */
+static int get_active_path(
+        struct udp_sock** const udp_socketp, // de-referenced
+        struct sa** const remote_addressp, // de-referenced
+        struct rawrtc_dtls_transport* const transport // not checked
+) {
+    struct ice_candpair* candidate_pair;
+    struct udp_sock* udp_socket;
+    int err;
+
+    // Cached?
+    if (transport->active_socket) {
+        ++transport->statistics.path_cache_hits;
+        goto out;
+    }
+
+    // Get selected candidate pair and socket
+    err = get_selected_path(&candidate_pair, &udp_socket, transport);
+    if (err) {
+        return err;
+    }
+
+    // Cache path
+    DEBUG_PRINTF("Active path: %J -> %J\n",
+                 &candidate_pair->lcand->attr.addr, &candidate_pair->rcand->attr.addr);
+    transport->active_socket = mem_ref(udp_socket);
+    transport->active_remote_address = candidate_pair->rcand->attr.addr;
+    ++transport->statistics.path_updates;
+
+    // Discover the path MTU (restarts if the path has changed)
+    if (!is_closed(transport)) {
+        rawrtc_path_mtu_set_path(transport->path_mtu, candidate_pair);
+    }
+
+out:
+    // Set pointers
+    *udp_socketp = transport->active_socket;
+    *remote_addressp = &transport->active_remote_address;
+    return 0;
+}
+
+/*
+ * Handle outgoing DTLS messages.
+ */
+static int send_handler(
+        struct tls_conn* tc,
+        struct sa const* original_destination,
+        struct mbuf* buffer,
+        void* arg
+) {
+    struct rawrtc_dtls_transport* const transport = arg;
+    struct udp_sock* udp_socket;
+    struct sa* remote_address;
+    int err;
+    (void) tc; (void) original_destination;
+
+    // Exceeds artificial path MTU limit? Discard as if it had been lost.
+    if (rawrtc_path_mtu_exceeds_artificial_limit(transport->path_mtu, mbuf_get_left(buffer))) {
+        ++transport->statistics.datagrams_discarded;
+        return 0;
+    }
+
+    // Batching? Queue the datagram until the batch is being flushed.
+    // Note: libre allocates a buffer for each record, so we can safely reference it instead of
+    //       copying. This may change in the future, so be aware!
+    if (transport->batching) {
+        enum rawrtc_code const error = rawrtc_message_buffer_append(
+                &transport->batched_datagrams_out, buffer, NULL);
+        if (!error) {
+            return 0;
+        }
+        DEBUG_WARNING("Could not batch outgoing datagram, reason: %s\n",
+                      rawrtc_code_to_str(error));
+    }
+
+    // Get active path
+    err = get_active_path(&udp_socket, &remote_address, transport);
+    if (err) {
+        return err;
+    }
+
     // Send
-    // TODO: Is destination correct?
-    DEBUG_PRINTF("Sending DTLS message (%zu bytes) to %J (originally: %J) from %J\n",
-                 mbuf_get_left(buffer), &candidate_pair->rcand->attr.addr, original_destination,
-                 &candidate_pair->lcand->attr.addr);
-    int err = udp_send(udp_socket, &candidate_pair->rcand->attr.addr, buffer);
+    err = udp_send(udp_socket, remote_address, buffer);
+    ++transport->statistics.send_calls;
     if (err) {
         DEBUG_WARNING("Could not send, error: %m\n", err);
+    } else {
+        ++transport->statistics.datagrams_sent;
     }
     return err;
 }
 
+#ifdef RAWRTC_HAVE_SENDMMSG
+/*
+ * Send batched datagrams with as few `sendmmsg` calls as possible.
+ * Sent datagrams will be removed from the batch.
+ */
+static void send_batched_datagrams_mmsg(
+        struct rawrtc_dtls_transport* const transport, // not checked
+        struct udp_sock* const udp_socket, // not checked
+        struct sa* const destination // not checked
+) {
+    struct mmsghdr messages[RAWRTC_DTLS_TRANSPORT_SENDMMSG_MAX];
+    struct iovec vectors[RAWRTC_DTLS_TRANSPORT_SENDMMSG_MAX];
+    struct le* le;
+    unsigned int n;
+    int n_sent;
+    int i;
+
+    // Get file descriptor
+    // Note: No UDP send helpers are registered on candidate sockets, so it's safe to bypass
+    //       `udp_send` here.
+    int const fd = udp_sock_fd(udp_socket, sa_af(destination));
+    if (fd < 0) {
+        return;
+    }
+
+    while (!list_isempty(&transport->batched_datagrams_out)) {
+        // Prepare messages
+        memset(messages, 0, sizeof(messages));
+        for (n = 0, le = list_head(&transport->batched_datagrams_out);
+             le != NULL && n < RAWRTC_DTLS_TRANSPORT_SENDMMSG_MAX; ++n, le = le->next) {
+            struct rawrtc_buffered_message* const buffered_message = le->data;
+            vectors[n].iov_base = mbuf_buf(buffered_message->buffer);
+            vectors[n].iov_len = mbuf_get_left(buffered_message->buffer);
+            messages[n].msg_hdr.msg_name = &destination->u.sa;
+            messages[n].msg_hdr.msg_namelen = destination->len;
+            messages[n].msg_hdr.msg_iov = &vectors[n];
+            messages[n].msg_hdr.msg_iovlen = 1;
+        }
+
+        // Send
+        DEBUG_PRINTF("Sending %u DTLS messages to %J\n", n, destination);
+        n_sent = sendmmsg(fd, messages, n, 0);
+        ++transport->statistics.send_calls;
+        if (n_sent < 0) {
+            // Note: Remaining datagrams will be sent one by one
+            DEBUG_WARNING("Could not send batch, error: %m\n", errno);
+            return;
+        }
+        transport->statistics.datagrams_sent += (uint64_t) n_sent;
+
+        // Remove sent datagrams
+        for (i = 0; i < n_sent; ++i) {
+            le = list_head(&transport->batched_datagrams_out);
+            list_unlink(le);
+            mem_deref(le->data);
+        }
+    }
+}
+#endif
+
 /*
  * Handle MTU queries.
  */
@@ -483,9 +649,34 @@ static size_t mtu_handler(
         struct tls_conn* tc,
         void* arg
 ) {
-    (void) tc; (void) arg;
-    // TODO: Choose a sane value.
-    return 1400;
+    struct rawrtc_dtls_transport* const transport = arg;
+    (void) tc;
+
+    // Current path MTU (the minimum until discovered)
+    return transport->path_mtu->path_mtu;
+}
+
+/*
+ * Handle path MTU changes.
+ */
+static void path_mtu_change_handler(
+        size_t const path_mtu,
+        void* const arg
+) {
+    struct rawrtc_dtls_transport* const transport = arg;
+    DEBUG_INFO("Path MTU: %zu bytes\n", path_mtu);
+
+    // Apply on connection (if any)
+    if (transport->connection) {
+        dtls_set_mtu(transport->connection, path_mtu);
+    }
+
+    // Notify data transport (if any)
+    if (transport->path_mtu_handler) {
+        transport->path_mtu_handler(
+                path_mtu - RAWRTC_DTLS_TRANSPORT_RECORD_OVERHEAD_MAX,
+                transport->receive_handler_arg);
+    }
 }
 
 /*
@@ -500,15 +691,16 @@ static bool udp_receive_handler(
     struct sa* source = context;
     struct sa const* peer;
 
-    // TODO: Check if DTLS or SRTP packet
-    // TODO: This handler should also be moved into ICE transport
+    // Note: Only DTLS records are handed to this handler by the candidate helper's packet
+    //       demultiplexer (or have been buffered by the gatherer).
     // https://tools.ietf.org/search/rfc7983#section-7
 
     // Update remote peer address (if changed and connection exists)
     if (transport->connection) {
         // TODO: It would be cleaner to check if source is in our list of remote candidates
 
-        // TODO: SCTP - Retest path MTU and reset congestion state to the initial state
+        // TODO: SCTP - Reset congestion state to the initial state
+        // Note: The path MTU is discovered again once the selected candidate pair changes.
         // https://tools.ietf.org/html/draft-ietf-rtcweb-data-channel-13#section-5
 
         // Update if changed
@@ -560,15 +752,22 @@ static void rawrtc_dtls_transport_destroy(
     for (le = list_head(&transport->ice_transport->gatherer->local_candidates);
          le != NULL; le = le->next) {
         struct rawrtc_candidate_helper* const candidate_helper = le->data;
-        mem_deref(candidate_helper->udp_helper);
-        // TODO: Be aware that UDP packets go to nowhere now...
+        rawrtc_candidate_helper_unset_receive_handler(candidate_helper);
+        // Note: DTLS records are dropped (and counted) by the packet demultiplexer now.
     }
 
     // Un-reference
+    mem_deref(transport->path_mtu);
+    mem_deref(transport->active_socket);
     mem_deref(transport->connection);
+    mem_deref(transport->handshake);
+    if (transport->session) {
+        SSL_SESSION_free(transport->session);
+    }
     mem_deref(transport->socket);
     mem_deref(transport->context);
     list_flush(&transport->fingerprints);
+    list_flush(&transport->batched_datagrams_out);
     list_flush(&transport->buffered_messages_out);
     list_flush(&transport->buffered_messages_in);
     mem_deref(transport->remote_parameters);
@@ -583,6 +782,7 @@ enum rawrtc_code rawrtc_dtls_transport_create_internal(
         struct rawrtc_dtls_transport** const transportp, // de-referenced
         struct rawrtc_ice_transport* const ice_transport, // referenced
         struct list* certificates, // de-referenced, copied (shallow)
+        bool const context_sharing,
         rawrtc_dtls_transport_state_change_handler* const state_change_handler, // nullable
         rawrtc_dtls_transport_error_handler* const error_handler, // nullable
         void* const arg // nullable
@@ -590,9 +790,6 @@ enum rawrtc_code rawrtc_dtls_transport_create_internal(
     struct rawrtc_dtls_transport* transport;
     enum rawrtc_code error;
     struct le* le;
-    struct rawrtc_certificate* certificate;
-    uint8_t* certificate_der;
-    size_t certificate_der_length;
 
     // Check arguments
     if (!transportp || !ice_transport || !certificates) {
@@ -626,58 +823,27 @@ enum rawrtc_code rawrtc_dtls_transport_create_internal(
     transport->arg = arg;
     transport->role = RAWRTC_DTLS_ROLE_AUTO;
     transport->connection_established = false;
+    transport->context_sharing = context_sharing;
     list_init(&transport->buffered_messages_in);
     list_init(&transport->buffered_messages_out);
     list_init(&transport->fingerprints);
+    transport->batching = false;
+    list_init(&transport->batched_datagrams_out);
 
-    // Create (D)TLS context
-    DEBUG_PRINTF("Creating DTLS context\n");
-    error = rawrtc_error_to_code(tls_alloc(&transport->context, TLS_METHOD_DTLS, NULL, NULL));
+    // Create path MTU discovery instance
+    error = rawrtc_path_mtu_create(
+            &transport->path_mtu, ice_transport, path_mtu_change_handler, transport);
     if (error) {
         goto out;
     }
 
-    // Get DER encoded certificate of choice
-    // TODO: Which certificate should we use?
-    certificate = list_ledata(list_head(&transport->certificates));
-    error = rawrtc_certificate_get_der(
-            &certificate_der, &certificate_der_length, certificate, RAWRTC_CERTIFICATE_ENCODE_BOTH);
+    // Get (D)TLS context
+    error = rawrtc_dtls_context_get(
+            &transport->context, &transport->certificates, transport->context_sharing);
     if (error) {
         goto out;
     }
 
-    // Set certificate
-    DEBUG_PRINTF("Setting certificate on DTLS context\n");
-    error = rawrtc_error_to_code(tls_set_certificate_der(
-            transport->context, rawrtc_certificate_key_type_to_tls_keytype(certificate->key_type),
-            certificate_der, certificate_der_length, NULL, 0));
-    mem_deref(certificate_der);
-    if (error) {
-        goto out;
-    }
-
-    // Set Diffie-Hellman parameters
-    // TODO: Get DH params from config
-    DEBUG_PRINTF("Setting DH parameters on DTLS context\n");
-    error = rawrtc_error_to_code(tls_set_dh_params_der(
-            transport->context, rawrtc_default_dh_parameters, rawrtc_default_dh_parameters_length));
-    if (error) {
-        goto out;
-    }
-
-    // Set cipher suites
-    // TODO: Get cipher suites from config
-    DEBUG_PRINTF("Setting cipher suites on DTLS context\n");
-    error = rawrtc_error_to_code(tls_set_ciphers(
-            transport->context, rawrtc_default_dtls_cipher_suites,
-            rawrtc_default_dtls_cipher_suites_length));
-    if (error) {
-        goto out;
-    }
-
-    // Send client certificate (client) / request client certificate (server)
-    tls_set_verify_client(transport->context);
-
     // Create DTLS socket
     DEBUG_PRINTF("Creating DTLS socket\n");
     error = rawrtc_error_to_code(dtls_socketless(
@@ -734,10 +900,49 @@ enum rawrtc_code rawrtc_dtls_transport_create(
 
     // Create DTLS transport
     return rawrtc_dtls_transport_create_internal(
-            transportp, ice_transport, &certificates_list, state_change_handler, error_handler,
+            transportp, ice_transport, &certificates_list,
+            rawrtc_default_config.dtls_context_sharing, state_change_handler, error_handler,
             arg);
 }
 
+/*
+ * Set whether the DTLS transport shares its DTLS context with other
+ * DTLS transports of the shard that use identical certificates.
+ */
+enum rawrtc_code rawrtc_dtls_transport_set_context_sharing(
+        struct rawrtc_dtls_transport* const transport,
+        bool const share
+) {
+    struct rawrtc_dtls_context* context;
+    enum rawrtc_code error;
+
+    // Check arguments
+    if (!transport) {
+        return RAWRTC_CODE_INVALID_ARGUMENT;
+    }
+
+    // Check state
+    // Note: The context is in use once a connection has been created.
+    if (transport->remote_parameters || transport->connection || is_closed(transport)) {
+        return RAWRTC_CODE_INVALID_STATE;
+    }
+
+    // Unchanged?
+    if (transport->context_sharing == share) {
+        return RAWRTC_CODE_SUCCESS;
+    }
+
+    // Replace (D)TLS context
+    error = rawrtc_dtls_context_get(&context, &transport->certificates, share);
+    if (error) {
+        return error;
+    }
+    mem_deref(transport->context);
+    transport->context = context;
+    transport->context_sharing = share;
+    return RAWRTC_CODE_SUCCESS;
+}
+
 /*
  * Let the DTLS transport attach itself to a candidate pair.
  * TODO: Separate ICE transport and DTLS transport properly (like data transport)
@@ -772,8 +977,8 @@ enum rawrtc_code rawrtc_dtls_transport_add_candidate_pair(
     }
 
     // Receive buffered packets
-    error = rawrtc_message_buffer_clear(
-            &transport->ice_transport->gatherer->buffered_messages, udp_receive_handler, transport);
+    error = rawrtc_packet_ring_replay(
+            transport->ice_transport->gatherer->buffered_packets, udp_receive_handler, transport);
     if (error) {
         DEBUG_WARNING("Could not handle buffered packets on candidate pair, reason: %s\n",
                       rawrtc_code_to_str(error));
@@ -791,7 +996,9 @@ enum rawrtc_code rawrtc_dtls_transport_add_candidate_pair(
 
     // Do connect (if client and no connection)
     if (transport->role == RAWRTC_DTLS_ROLE_CLIENT && !transport->connection) {
-        error = do_connect(transport, &candidate_pair->rcand->attr.addr);
+        error = do_connect(
+                transport, &candidate_pair->rcand->attr.addr,
+                transport->remote_parameters->fingerprints);
         if (error) {
             DEBUG_WARNING("Could not start DTLS connection for candidate pair, reason: %s\n",
                           rawrtc_code_to_str(error));
@@ -802,10 +1009,24 @@ enum rawrtc_code rawrtc_dtls_transport_add_candidate_pair(
 out:
     if (!error) {
         DEBUG_PRINTF("Attached DTLS transport to candidate pair\n");
+
+        // The selected candidate pair may have changed
+        rawrtc_dtls_transport_invalidate_active_path(transport);
     }
     return error;
 }
 
+/*
+ * Invalidate the cached active path of the DTLS transport. The path
+ * will be looked up again when the next datagram is being sent.
+ * Must be called whenever the selected candidate pair may have changed.
+ */
+void rawrtc_dtls_transport_invalidate_active_path(
+        struct rawrtc_dtls_transport* const transport // not checked
+) {
+    transport->active_socket = mem_deref(transport->active_socket);
+}
+
 /*
  * Start the DTLS transport.
  */
@@ -884,7 +1105,8 @@ enum rawrtc_code rawrtc_dtls_transport_start(
 
         // Do connect (if we have a valid candidate pair)
         if (candidate_pair) {
-            error = do_connect(transport, &candidate_pair->rcand->attr.addr);
+            error = do_connect(
+                    transport, &candidate_pair->rcand->attr.addr, remote_parameters->fingerprints);
             if (error) {
                 goto out;
             }
@@ -956,6 +1178,7 @@ static bool intermediate_receive_handler(
 enum rawrtc_code rawrtc_dtls_transport_set_data_transport(
         struct rawrtc_dtls_transport* const transport,
         rawrtc_dtls_transport_receive_handler* const receive_handler,
+        rawrtc_dtls_transport_path_mtu_handler* const path_mtu_handler, // nullable
         void* const arg
 ) {
     enum rawrtc_code error;
@@ -975,10 +1198,17 @@ enum rawrtc_code rawrtc_dtls_transport_set_data_transport(
         return RAWRTC_CODE_INVALID_STATE;
     }
 
-    // Set handler
+    // Set handlers
     transport->receive_handler = receive_handler;
+    transport->path_mtu_handler = path_mtu_handler;
     transport->receive_handler_arg = arg;
 
+    // Announce current path MTU
+    if (path_mtu_handler) {
+        path_mtu_handler(
+                transport->path_mtu->path_mtu - RAWRTC_DTLS_TRANSPORT_RECORD_OVERHEAD_MAX, arg);
+    }
+
     // Receive buffered messages
     error = rawrtc_message_buffer_clear(
             &transport->buffered_messages_in, intermediate_receive_handler, transport);
@@ -1003,8 +1233,9 @@ enum rawrtc_code rawrtc_dtls_transport_clear_data_transport(
 
     // TODO: Clear buffered messages (?)
 
-    // Clear handler and argument
+    // Clear handlers and argument
     transport->receive_handler = NULL;
+    transport->path_mtu_handler = NULL;
     transport->receive_handler_arg = NULL;
 
     // Done
@@ -1048,6 +1279,69 @@ enum rawrtc_code rawrtc_dtls_transport_send(
     return RAWRTC_CODE_SUCCESS;
 }
 
+/*
+ * Start batching outgoing datagrams of the DTLS transport.
+ * Datagrams will be queued until `rawrtc_dtls_transport_batch_flush`
+ * is being called.
+ */
+void rawrtc_dtls_transport_batch_start(
+        struct rawrtc_dtls_transport* const transport // not checked
+) {
+    transport->batching = true;
+}
+
+/*
+ * Stop batching and send all batched datagrams of the DTLS transport
+ * using as few system calls as possible.
+ */
+void rawrtc_dtls_transport_batch_flush(
+        struct rawrtc_dtls_transport* const transport // not checked
+) {
+    struct udp_sock* udp_socket;
+    struct sa* remote_address;
+    struct le* le;
+    int err;
+
+    // Stop batching
+    transport->batching = false;
+
+    // Nothing to send?
+    if (list_isempty(&transport->batched_datagrams_out)) {
+        return;
+    }
+
+    // Get active path
+    err = get_active_path(&udp_socket, &remote_address, transport);
+    if (err) {
+        goto out;
+    }
+
+#ifdef RAWRTC_HAVE_SENDMMSG
+    // Send datagrams in batches
+    send_batched_datagrams_mmsg(transport, udp_socket, remote_address);
+#endif
+
+    // Send remaining datagrams one by one
+    while ((le = list_head(&transport->batched_datagrams_out))) {
+        struct rawrtc_buffered_message* const buffered_message = le->data;
+        list_unlink(le);
+
+        // Send
+        err = udp_send(udp_socket, remote_address, buffered_message->buffer);
+        ++transport->statistics.send_calls;
+        if (err) {
+            DEBUG_WARNING("Could not send, error: %m\n", err);
+        } else {
+            ++transport->statistics.datagrams_sent;
+        }
+        mem_deref(buffered_message);
+    }
+
+out:
+    // Drop datagrams that could not be sent (SCTP will retransmit)
+    list_flush(&transport->batched_datagrams_out);
+}
+
 /*
  * Stop and close the DTLS transport.
  */
@@ -1137,3 +1431,42 @@ enum rawrtc_code rawrtc_dtls_transport_get_local_parameters(
     return rawrtc_dtls_parameters_create_internal(
             parametersp, transport->role, &transport->fingerprints);
 }
+
+/*
+ * Get a snapshot of the DTLS transport's statistics.
+ */
+enum rawrtc_code rawrtc_dtls_transport_get_statistics(
+        struct rawrtc_dtls_transport_statistics* const statisticsp, // written into
+        struct rawrtc_dtls_transport* const transport
+) {
+    // Check arguments
+    if (!statisticsp || !transport) {
+        return RAWRTC_CODE_INVALID_ARGUMENT;
+    }
+
+    // Copy statistics
+    *statisticsp = transport->statistics;
+
+    // Done
+    return RAWRTC_CODE_SUCCESS;
+}
+
+/*
+ * Get the current path MTU (maximum UDP payload size) of the DTLS
+ * transport and whether the search for it has been completed.
+ */
+enum rawrtc_code rawrtc_dtls_transport_get_path_mtu(
+        size_t* const path_mtup, // de-referenced
+        bool* const completep, // de-referenced
+        struct rawrtc_dtls_transport* const transport
+) {
+    // Check arguments
+    if (!path_mtup || !completep || !transport) {
+        return RAWRTC_CODE_INVALID_ARGUMENT;
+    }
+
+    // Set pointers & done
+    *path_mtup = transport->path_mtu->path_mtu;
+    *completep = rawrtc_path_mtu_is_complete(transport->path_mtu);
+    return RAWRTC_CODE_SUCCESS;
+}
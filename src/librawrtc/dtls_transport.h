@@ -4,6 +4,7 @@ enum rawrtc_code rawrtc_dtls_transport_create_internal(
     struct rawrtc_dtls_transport** const transportp, // de-referenced
     struct rawrtc_ice_transport* const ice_transport, // referenced
     struct list* certificates, // de-referenced, copied (shallow)
+    bool const context_sharing,
     rawrtc_dtls_transport_state_change_handler* const state_change_handler, // nullable
     rawrtc_dtls_transport_error_handler* const error_handler, // nullable
     void* const arg // nullable
@@ -14,6 +15,10 @@ enum rawrtc_code rawrtc_dtls_transport_add_candidate_pair(
     struct ice_candpair* const candidate_pair
 );
 
+void rawrtc_dtls_transport_invalidate_active_path(
+    struct rawrtc_dtls_transport* const transport // not checked
+);
+
 enum rawrtc_code rawrtc_dtls_transport_have_data_transport(
     bool* const have_data_transportp, // de-referenced
     struct rawrtc_dtls_transport* const transport
@@ -22,6 +27,7 @@ enum rawrtc_code rawrtc_dtls_transport_have_data_transport(
 enum rawrtc_code rawrtc_dtls_transport_set_data_transport(
     struct rawrtc_dtls_transport* const transport,
     rawrtc_dtls_transport_receive_handler* const receive_handler,
+    rawrtc_dtls_transport_path_mtu_handler* const path_mtu_handler, // nullable
     void* const arg
 );
 
@@ -33,3 +39,11 @@ enum rawrtc_code rawrtc_dtls_transport_send(
     struct rawrtc_dtls_transport* const transport,
     struct mbuf* const buffer
 );
+
+void rawrtc_dtls_transport_batch_start(
+    struct rawrtc_dtls_transport* const transport // not checked
+);
+
+void rawrtc_dtls_transport_batch_flush(
+    struct rawrtc_dtls_transport* const transport // not checked
+);
@@ -1,6 +1,8 @@
 #include <rawrtc.h>
 #include "ice_server.h"
 #include "ice_gather_options.h"
+#include "path_mtu.h"
+#include "utils.h"
 
 #define DEBUG_MODULE "ice-gather-options"
 //#define RAWRTC_DEBUG_MODULE_LEVEL 7 // Note: Uncomment this to debug this module only
@@ -41,6 +43,15 @@ enum rawrtc_code rawrtc_ice_gather_options_create(
     // Set fields/reference
     options->gather_policy = gather_policy;
     list_init(&options->ice_servers);
+    options->path_mtu_min = rawrtc_default_config.path_mtu_min;
+    options->path_mtu_max = rawrtc_default_config.path_mtu_max;
+    options->udp_mux = rawrtc_default_config.ice_udp_mux;
+    options->udp_mux_port = rawrtc_default_config.ice_udp_mux_port;
+    options->ice_lite = rawrtc_default_config.ice_lite;
+    options->udp_receive_batch_size = rawrtc_default_config.udp_receive_batch_size;
+    options->buffer_slots = rawrtc_default_config.ice_gatherer_buffer_slots;
+    options->buffer_slot_size = rawrtc_default_config.ice_gatherer_buffer_slot_size;
+    options->buffer_drop_policy = rawrtc_default_config.ice_gatherer_buffer_drop_policy;
 
     // Set pointer and return
     *optionsp = options;
@@ -99,6 +110,120 @@ enum rawrtc_code rawrtc_ice_gather_options_add_server(
     return rawrtc_ice_gather_options_add_server_internal(options, server);
 }
 
+/*
+ * Set the minimum and maximum path MTU (UDP payload size in bytes) of
+ * the path MTU discovery.
+ */
+enum rawrtc_code rawrtc_ice_gather_options_set_path_mtu(
+        struct rawrtc_ice_gather_options* const options,
+        uint32_t const minimum,
+        uint32_t const maximum
+) {
+    // Check arguments
+    // Note: The DTLS transport subtracts the record overhead from the path MTU.
+    if (!options || minimum < RAWRTC_PATH_MTU_MIN || minimum > maximum) {
+        return RAWRTC_CODE_INVALID_ARGUMENT;
+    }
+
+    // Set
+    options->path_mtu_min = minimum;
+    options->path_mtu_max = maximum;
+    return RAWRTC_CODE_SUCCESS;
+}
+
+/*
+ * Set an artificial path MTU limit (UDP payload size in bytes).
+ */
+enum rawrtc_code rawrtc_ice_gather_options_set_path_mtu_artificial_limit(
+        struct rawrtc_ice_gather_options* const options,
+        uint32_t const limit
+) {
+    // Check arguments
+    if (!options) {
+        return RAWRTC_CODE_INVALID_ARGUMENT;
+    }
+
+    // Set
+    options->path_mtu_artificial_limit = limit;
+    return RAWRTC_CODE_SUCCESS;
+}
+
+/*
+ * Set whether host candidates share one UDP socket per interface and
+ * shard with the host candidates of other ICE gatherers.
+ */
+enum rawrtc_code rawrtc_ice_gather_options_set_udp_mux(
+        struct rawrtc_ice_gather_options* const options,
+        bool const enable,
+        uint16_t const port
+) {
+    // Check arguments
+    if (!options) {
+        return RAWRTC_CODE_INVALID_ARGUMENT;
+    }
+
+    // Set
+    options->udp_mux = enable;
+    options->udp_mux_port = port;
+    return RAWRTC_CODE_SUCCESS;
+}
+
+/*
+ * Set whether ICE gatherers act as ICE lite agents.
+ */
+enum rawrtc_code rawrtc_ice_gather_options_set_ice_lite(
+        struct rawrtc_ice_gather_options* const options,
+        bool const lite
+) {
+    // Check arguments
+    if (!options) {
+        return RAWRTC_CODE_INVALID_ARGUMENT;
+    }
+
+    // Set
+    options->ice_lite = lite;
+    return RAWRTC_CODE_SUCCESS;
+}
+
+/*
+ * Set the maximum amount of datagrams received on a host candidate's
+ * UDP socket per wakeup.
+ */
+enum rawrtc_code rawrtc_ice_gather_options_set_udp_receive_batch_size(
+        struct rawrtc_ice_gather_options* const options,
+        uint32_t const size
+) {
+    // Check arguments
+    if (!options) {
+        return RAWRTC_CODE_INVALID_ARGUMENT;
+    }
+
+    // Set
+    options->udp_receive_batch_size = size;
+    return RAWRTC_CODE_SUCCESS;
+}
+
+/*
+ * Set the early packet buffer of the ICE gatherer.
+ */
+enum rawrtc_code rawrtc_ice_gather_options_set_buffer(
+        struct rawrtc_ice_gather_options* const options,
+        uint16_t const slots,
+        uint16_t const slot_size,
+        enum rawrtc_ice_gatherer_buffer_drop_policy const drop_policy
+) {
+    // Check arguments
+    if (!options) {
+        return RAWRTC_CODE_INVALID_ARGUMENT;
+    }
+
+    // Set
+    options->buffer_slots = slots;
+    options->buffer_slot_size = slot_size;
+    options->buffer_drop_policy = drop_policy;
+    return RAWRTC_CODE_SUCCESS;
+}
+
 /*
  * Destroy all ICE server URL DNS contexts.
  */
@@ -148,6 +273,34 @@ int rawrtc_ice_gather_options_debug(
     err |= re_hprintf(pf, "  gather_policy=%s\n",
                       rawrtc_ice_gather_policy_to_str(options->gather_policy));
 
+    // Path MTU
+    err |= re_hprintf(pf, "  path_mtu=%"PRIu32"-%"PRIu32"\n",
+                      options->path_mtu_min, options->path_mtu_max);
+    if (options->path_mtu_artificial_limit > 0) {
+        err |= re_hprintf(pf, "  path_mtu_artificial_limit=%"PRIu32"\n",
+                          options->path_mtu_artificial_limit);
+    }
+
+    // ICE lite
+    err |= re_hprintf(pf, "  ice_lite=%s\n", options->ice_lite ? "yes" : "no");
+
+    // UDP receive batch size
+    if (options->udp_receive_batch_size > 1) {
+        err |= re_hprintf(pf, "  udp_receive_batch_size=%"PRIu32"\n",
+                          options->udp_receive_batch_size);
+    }
+
+    // Early packet buffer
+    err |= re_hprintf(pf, "  buffer=%"PRIu16" slots of %"PRIu16" bytes, drop %s\n",
+                      options->buffer_slots, options->buffer_slot_size,
+                      options->buffer_drop_policy == RAWRTC_ICE_GATHERER_BUFFER_DROP_OLDEST
+                      ? "oldest" : "newest");
+
+    // UDP mux
+    if (options->udp_mux) {
+        err |= re_hprintf(pf, "  udp_mux_port=%"PRIu16"\n", options->udp_mux_port);
+    }
+
     // ICE servers
     for (le = list_head(&options->ice_servers); le != NULL; le = le->next) {
         struct rawrtc_ice_server* const server = le->data;
@@ -1,14 +1,15 @@
 #include <sys/socket.h> // AF_INET, AF_INET6
 #include <netinet/in.h> // IPPROTO_UDP, IPPROTO_TCP
-#include <string.h> // memcpy
+#include <errno.h> // ENOMEM
 #include <rawrtc.h>
 #include "utils.h"
 #include "ice_candidate.h"
-#include "message_buffer.h"
+#include "packet_ring.h"
 #include "candidate_helper.h"
 #include "ice_server.h"
 #include "ice_gather_options.h"
 #include "ice_gatherer.h"
+#include "udp_mux.h"
 
 #define DEBUG_MODULE "ice-gatherer"
 //#define RAWRTC_DEBUG_MODULE_LEVEL 7 // Note: Uncomment this to debug this module only
@@ -51,7 +52,7 @@ static void rawrtc_ice_gatherer_destroy(
     mem_deref(gatherer->dns_client);
     mem_deref(gatherer->ice);
     list_flush(&gatherer->local_candidates);
-    list_flush(&gatherer->buffered_messages);
+    mem_deref(gatherer->buffered_packets);
     mem_deref(gatherer->options);
 }
 
@@ -90,9 +91,18 @@ enum rawrtc_code rawrtc_ice_gatherer_create(
     gatherer->error_handler = error_handler;
     gatherer->local_candidate_handler = local_candidate_handler;
     gatherer->arg = arg;
-    list_init(&gatherer->buffered_messages);
+    gatherer->ice_lite = options->ice_lite;
     list_init(&gatherer->local_candidates);
 
+    // Create early packet buffer (until a DTLS transport is attached)
+    // Note: This can only fail due to lack of memory.
+    if (rawrtc_packet_ring_create(
+            &gatherer->buffered_packets, options->buffer_slots, options->buffer_slot_size,
+            options->buffer_drop_policy)) {
+        err = ENOMEM;
+        goto out;
+    }
+
     // Generate random username fragment and password for ICE
     rand_str(gatherer->ice_username_fragment, sizeof(gatherer->ice_username_fragment));
     rand_str(gatherer->ice_password, sizeof(gatherer->ice_password));
@@ -112,6 +122,11 @@ enum rawrtc_code rawrtc_ice_gatherer_create(
         goto out;
     }
 
+    // ICE lite: No ICE servers will be used, so no DNS client is required
+    if (gatherer->ice_lite) {
+        goto out;
+    }
+
     // Get local DNS servers
     err = dns_srv_get(NULL, 0, dns_servers, &n_dns_servers);
     if (err) {
@@ -207,7 +222,7 @@ enum rawrtc_code rawrtc_ice_gatherer_close(
 }
 
 /*
- * Handle received UDP messages.
+ * Handle received UDP messages (until a DTLS transport is attached).
  */
 static bool udp_receive_handler(
         struct sa * source,
@@ -215,33 +230,27 @@ static bool udp_receive_handler(
         void* arg
 ) {
     struct rawrtc_ice_gatherer* const gatherer = arg;
+    size_t const length = mbuf_get_left(buffer);
     enum rawrtc_code error;
 
-    // Allocate context and copy source address
-    void* const context = mem_zalloc(sizeof(*source), NULL);
-    if (!context) {
-        error = RAWRTC_CODE_NO_MEMORY;
-        goto out;
-    }
-    memcpy(context, source, sizeof(*source));
-
     // Buffer message
-    error = rawrtc_message_buffer_append(&gatherer->buffered_messages, buffer, context);
-    if (error) {
-        goto out;
-    }
-
-    // Done
-    DEBUG_PRINTF("Buffered UDP packet of size %zu\n", mbuf_get_left(buffer));
-
-out:
-    if (error) {
-        DEBUG_WARNING("Could not buffer UDP packet, reason: %s\n", rawrtc_code_to_str(error));
+    error = rawrtc_packet_ring_push(gatherer->buffered_packets, source, buffer);
+    switch (error) {
+        case RAWRTC_CODE_SUCCESS:
+            DEBUG_PRINTF("Buffered UDP packet of size %zu\n", length);
+            break;
+        case RAWRTC_CODE_INSUFFICIENT_SPACE:
+        case RAWRTC_CODE_MESSAGE_TOO_LONG:
+            // Note: Dropped packets are counted, so don't flood the log.
+            DEBUG_PRINTF("Dropped UDP packet of size %zu, reason: %s\n",
+                         length, rawrtc_code_to_str(error));
+            break;
+        default:
+            DEBUG_WARNING("Could not buffer UDP packet, reason: %s\n",
+                          rawrtc_code_to_str(error));
+            break;
     }
 
-    // Un-reference
-    mem_deref(context);
-
     // Handled
     return true;
 }
@@ -589,6 +598,12 @@ static void gather_candidates(
 ) {
     enum rawrtc_code error;
 
+    // Skip candidates on a shared UDP socket
+    // Note: A server using a shared socket is expected to be reachable on its host candidates.
+    if (candidate->mux_entry) {
+        return;
+    }
+
     // Gather reflexive candidates
     error = gather_reflexive_candidates(candidate, server_address, url);
     if (error) {
@@ -680,26 +695,40 @@ static enum rawrtc_code add_candidate(
 ) {
     uint32_t priority;
     int const ipproto = rawrtc_ice_protocol_to_ipproto(protocol);
+    struct rawrtc_udp_mux* mux = NULL;
     struct ice_lcand* re_candidate;
     int err;
     struct rawrtc_candidate_helper* candidate;
     enum rawrtc_code error;
 
+    // Get shared UDP socket of the interface (if enabled)
+    if (gatherer->options->udp_mux && protocol == RAWRTC_ICE_PROTOCOL_UDP) {
+        error = rawrtc_udp_mux_get(&mux, address, gatherer->options);
+        if (error) {
+            DEBUG_WARNING("Could not get shared UDP socket, reason: %s\n",
+                          rawrtc_code_to_str(error));
+            return error;
+        }
+    }
+
     // Add host candidate
     priority = rawrtc_ice_candidate_calculate_priority(
             ICE_CAND_TYPE_HOST, ipproto, sa_af(address), tcp_type);
     // TODO: Set component id properly
     err = trice_lcand_add(
             &re_candidate, gatherer->ice, 1, ipproto, priority, address,
-            NULL, ICE_CAND_TYPE_HOST, NULL, tcp_type, NULL, RAWRTC_LAYER_ICE);
+            NULL, ICE_CAND_TYPE_HOST, NULL, tcp_type, mux ? mux->socket : NULL,
+            RAWRTC_LAYER_ICE);
     if (err) {
         DEBUG_WARNING("Could not add host candidate, reason: %m\n", err);
+        mem_deref(mux);
         return rawrtc_error_to_code(err);
     }
 
     // Create candidate helper (attaches receive handler)
     error = rawrtc_candidate_helper_create(
-            &candidate, gatherer, re_candidate, udp_receive_handler, gatherer);
+            &candidate, gatherer, re_candidate, mux, udp_receive_handler, gatherer);
+    mem_deref(mux);
     if (error) {
         DEBUG_WARNING("Could not create candidate helper, reason: %s\n",
                       rawrtc_code_to_str(error));
@@ -727,8 +756,10 @@ static enum rawrtc_code add_candidate(
         return RAWRTC_CODE_SUCCESS;
     }
 
-    // Gather server reflexive and relay candidates
-    gather_candidates_using_resolved_servers(gatherer, candidate);
+    // Gather server reflexive and relay candidates (unless ICE lite)
+    if (!gatherer->ice_lite) {
+        gather_candidates_using_resolved_servers(gatherer, candidate);
+    }
 
     // Done
     return RAWRTC_CODE_SUCCESS;
@@ -1033,10 +1064,12 @@ enum rawrtc_code rawrtc_ice_gatherer_gather(
         return RAWRTC_CODE_SUCCESS;
     }
 
-    // Resolve ICE server IP addresses
-    error = resolve_ice_servers_address(gatherer, options);
-    if (error) {
-        return error;
+    // Resolve ICE server IP addresses (unless ICE lite, host candidates only)
+    if (!gatherer->ice_lite) {
+        error = resolve_ice_servers_address(gatherer, options);
+        if (error) {
+            return error;
+        }
     }
 
     // Update state
@@ -1090,7 +1123,8 @@ enum rawrtc_code rawrtc_ice_gatherer_get_local_parameters(
 
     // Create and return ICE parameters instance
     return rawrtc_ice_parameters_create(
-            parametersp, gatherer->ice_username_fragment, gatherer->ice_password, false);
+            parametersp, gatherer->ice_username_fragment, gatherer->ice_password,
+            gatherer->ice_lite);
 }
 
 /*
@@ -1108,6 +1142,24 @@ static void rawrtc_ice_gatherer_local_candidates_destroy(
     }
 }
 
+/*
+ * Get a snapshot of the ICE gatherer's early packet buffer
+ * statistics.
+ */
+enum rawrtc_code rawrtc_ice_gatherer_get_buffer_statistics(
+        struct rawrtc_ice_gatherer_buffer_statistics* const statisticsp, // written into
+        struct rawrtc_ice_gatherer* const gatherer
+) {
+    // Check arguments
+    if (!statisticsp || !gatherer) {
+        return RAWRTC_CODE_INVALID_ARGUMENT;
+    }
+
+    // Copy statistics & done
+    *statisticsp = gatherer->buffered_packets->statistics;
+    return RAWRTC_CODE_SUCCESS;
+}
+
 /*
  * Get local ICE candidates of an ICE gatherer.
  */
@@ -0,0 +1,194 @@
+#include <netinet/in.h> // IPPROTO_UDP
+#include <string.h> // strlen
+#include <rawrtc.h>
+#include "candidate_helper.h"
+#include "ice_lite.h"
+
+#define DEBUG_MODULE "ice-lite"
+//#define RAWRTC_DEBUG_MODULE_LEVEL 7 // Note: Uncomment this to debug this module only
+#include "debug.h"
+
+static char const prflx_foundation[] = "prflx";
+
+/*
+ * Check whether a binding request's USERNAME attribute starts with
+ * the local username fragment (`<local>:<remote>`).
+ */
+static bool username_matches(
+        struct stun_attr const* const attribute, // not checked
+        char const* const username_fragment // not checked
+) {
+    size_t const length = strlen(username_fragment);
+    return strncmp(attribute->v.username, username_fragment, length) == 0
+            && attribute->v.username[length] == ':';
+}
+
+/*
+ * Select the candidate pair the remote (controlling) agent nominated
+ * and hand it to the nomination handler.
+ * A peer-reflexive remote candidate will be added in case the source
+ * address is unknown.
+ */
+static void nominate(
+        struct rawrtc_candidate_helper* const candidate_helper, // not checked
+        struct sa const* const source, // not checked
+        struct stun_msg const* const request // not checked
+) {
+    struct rawrtc_ice_gatherer* const gatherer = candidate_helper->gatherer;
+    struct ice_lcand* const local_candidate = candidate_helper->candidate;
+    struct ice_rcand* remote_candidate;
+    struct ice_candpair* candidate_pair;
+    struct stun_attr* priority;
+    int err;
+
+    // Get remote candidate (or add a peer-reflexive candidate)
+    remote_candidate = trice_rcand_find(
+            gatherer->ice, local_candidate->attr.compid, IPPROTO_UDP, source);
+    if (!remote_candidate) {
+        priority = stun_msg_attr(request, STUN_ATTR_PRIORITY);
+        err = trice_rcand_add(
+                &remote_candidate, gatherer->ice, local_candidate->attr.compid, prflx_foundation,
+                IPPROTO_UDP, priority->v.priority, source, ICE_CAND_TYPE_PRFLX, ICE_TCP_ACTIVE);
+        if (err) {
+            DEBUG_WARNING("Could not add peer-reflexive candidate %J, reason: %m\n", source, err);
+            return;
+        }
+    }
+
+    // Already nominated?
+    if (trice_candpair_find(trice_validl(gatherer->ice), local_candidate, remote_candidate)) {
+        return;
+    }
+
+    // Get candidate pair (or create it)
+    candidate_pair = trice_candpair_find(
+            trice_checkl(gatherer->ice), local_candidate, remote_candidate);
+    if (!candidate_pair) {
+        err = trice_candpair_alloc(
+                &candidate_pair, gatherer->ice, local_candidate, remote_candidate);
+        if (err) {
+            DEBUG_WARNING("Could not create candidate pair, reason: %m\n", err);
+            return;
+        }
+    }
+
+    // Move to the valid list
+    candidate_pair->nominated = true;
+    trice_candpair_make_valid(gatherer->ice, candidate_pair);
+    DEBUG_PRINTF("Candidate pair nominated: %H\n", trice_candpair_debug, candidate_pair);
+
+    // Notify
+    gatherer->nomination_handler(candidate_pair, request, gatherer->nomination_arg);
+}
+
+/*
+ * Handle STUN messages received on a local candidate of an ICE lite
+ * agent (in place of the ICE agent's STUN server).
+ * Binding requests are answered and nominations are handed to the
+ * gatherer's nomination handler. A lite agent never sends requests, so
+ * all other STUN messages are dropped. Datagrams other than STUN are
+ * left to the next handler.
+ */
+bool rawrtc_ice_lite_receive_handler(
+        struct sa* source,
+        struct mbuf* buffer,
+        void* arg
+) {
+    struct rawrtc_candidate_helper* const candidate_helper = arg;
+    struct rawrtc_ice_gatherer* const gatherer = candidate_helper->gatherer;
+    uint8_t const* const password = (uint8_t const*) gatherer->ice_password;
+    size_t const password_length = strlen(gatherer->ice_password);
+    struct stun_msg* request = NULL;
+    struct stun_attr* username;
+    void* socket;
+    int err = 0;
+
+    // Not STUN? Leave it to the next handler.
+    // https://tools.ietf.org/html/rfc7983#section-7
+    if (mbuf_get_left(buffer) < 1 || mbuf_buf(buffer)[0] >= 4) {
+        return false;
+    }
+
+    // Decode
+    if (stun_msg_decode(&request, buffer, NULL)) {
+        goto out;
+    }
+
+    // Binding request?
+    if (stun_msg_method(request) != STUN_METHOD_BINDING
+            || stun_msg_class(request) != STUN_CLASS_REQUEST) {
+        goto out;
+    }
+
+    // Transport not started yet?
+    // Note: The request is dropped, so the remote agent retransmits it (including its
+    //       nomination).
+    if (!gatherer->nomination_handler) {
+        DEBUG_PRINTF("Dropping binding request from %J, transport not started\n", source);
+        goto out;
+    }
+
+    // Verify fingerprint
+    if (stun_msg_chk_fingerprint(request)) {
+        goto out;
+    }
+
+    // Get socket of the local candidate
+    socket = trice_lcand_sock(gatherer->ice, candidate_helper->candidate);
+    if (!socket) {
+        goto out;
+    }
+
+    // Check mandatory attributes
+    // https://tools.ietf.org/html/rfc8445#section-7.3
+    username = stun_msg_attr(request, STUN_ATTR_USERNAME);
+    if (!username || !stun_msg_attr(request, STUN_ATTR_MSG_INTEGRITY)
+            || !stun_msg_attr(request, STUN_ATTR_PRIORITY)) {
+        err = stun_ereply(
+                IPPROTO_UDP, socket, source, 0, request, 400, "Bad Request",
+                NULL, 0, true, 0);
+        goto out;
+    }
+
+    // Verify credentials
+    if (!username_matches(username, gatherer->ice_username_fragment)
+            || stun_msg_chk_mi(request, password, password_length)) {
+        err = stun_ereply(
+                IPPROTO_UDP, socket, source, 0, request, 401, "Unauthorized",
+                NULL, 0, true, 0);
+        goto out;
+    }
+
+    // A lite agent is always controlled and cannot switch roles
+    // https://tools.ietf.org/html/rfc8445#section-6.1.1
+    if (!stun_msg_attr(request, STUN_ATTR_CONTROLLING)) {
+        err = stun_ereply(
+                IPPROTO_UDP, socket, source, 0, request, 487, "Role Conflict",
+                password, password_length, true, 0);
+        goto out;
+    }
+
+    // Answer
+    err = stun_reply(
+            IPPROTO_UDP, socket, source, 0, request, password, password_length, true,
+            1, STUN_ATTR_XOR_MAPPED_ADDR, source);
+    if (err) {
+        goto out;
+    }
+
+    // Nominated?
+    if (stun_msg_attr(request, STUN_ATTR_USE_CAND)) {
+        nominate(candidate_helper, source, request);
+    }
+
+out:
+    if (err) {
+        DEBUG_WARNING("Could not answer binding request from %J, reason: %m\n", source, err);
+    }
+
+    // Un-reference
+    mem_deref(request);
+
+    // Handled
+    return true;
+}
@@ -0,0 +1,8 @@
+#pragma once
+#include <rawrtc.h>
+
+bool rawrtc_ice_lite_receive_handler(
+    struct sa* source,
+    struct mbuf* buffer,
+    void* arg
+);
@@ -1,6 +1,10 @@
+#include <netinet/in.h> // IPPROTO_UDP
 #include <rawrtc.h>
 #include "ice_transport.h"
 #include "dtls_transport.h"
+#include "candidate_helper.h"
+#include "packet_demux.h"
+#include "udp_mux.h"
 #include "utils.h"
 
 #define DEBUG_MODULE "ice-transport"
@@ -46,6 +50,7 @@ static void rawrtc_ice_transport_destroy(
     rawrtc_ice_transport_stop(transport);
 
     // Un-reference
+    mem_deref(transport->stun);
     mem_deref(transport->remote_parameters);
     mem_deref(transport->gatherer);
 }
@@ -61,6 +66,7 @@ enum rawrtc_code rawrtc_ice_transport_create(
         void* const arg // nullable
 ) {
     struct rawrtc_ice_transport* transport;
+    enum rawrtc_code error;
 
     // Check arguments
     if (!transportp || !gatherer) {
@@ -86,9 +92,23 @@ enum rawrtc_code rawrtc_ice_transport_create(
     transport->candidate_pair_change_handler = candidate_pair_change_handler;
     transport->arg = arg;
 
-    // Set pointer
-    *transportp = transport;
-    return RAWRTC_CODE_SUCCESS;
+    // Create STUN instance
+    // Note: Shared by the checklist and path MTU probes, so responses to the latter will be
+    //       handed to us by trice.
+    error = rawrtc_error_to_code(stun_alloc(
+            &transport->stun, &rawrtc_default_config.stun_config, NULL, NULL));
+    if (error) {
+        goto out;
+    }
+
+out:
+    if (error) {
+        mem_deref(transport);
+    } else {
+        // Set pointer
+        *transportp = transport;
+    }
+    return error;
 }
 
 /*
@@ -169,6 +189,93 @@ static void ice_established_handler(
     }
 }
 
+/*
+ * Check whether both agents are ICE lite agents.
+ */
+static bool both_lite(
+        struct rawrtc_ice_transport* const transport // not checked
+) {
+    return transport->gatherer->ice_lite
+            && transport->remote_parameters && transport->remote_parameters->ice_lite;
+}
+
+/*
+ * Select the candidate pair in case both agents are ICE lite agents.
+ * As neither agent sends connectivity checks, both agents select the
+ * pair of local and remote UDP candidate of the same address family
+ * with the highest pair priority. The pair priority does not depend
+ * on the perspective, so both agents end up with the same pair.
+ * https://tools.ietf.org/html/rfc8445#section-6.1.1
+ */
+static void select_lite_candidate_pair(
+        struct rawrtc_ice_transport* const transport // not checked
+) {
+    struct trice* const ice = transport->gatherer->ice;
+    bool const controlling = trice_local_role(ice) == ICE_ROLE_CONTROLLING;
+    struct le* local_le;
+    struct le* remote_le;
+    struct ice_lcand* selected_local = NULL;
+    struct ice_rcand* selected_remote = NULL;
+    uint64_t selected_priority = 0;
+    struct ice_candpair* candidate_pair;
+    int err;
+
+    // Find the pair with the highest priority
+    for (local_le = list_head(trice_lcandl(ice)); local_le != NULL; local_le = local_le->next) {
+        struct ice_lcand* const local = local_le->data;
+        if (local->attr.proto != IPPROTO_UDP) {
+            continue;
+        }
+        for (remote_le = list_head(trice_rcandl(ice)); remote_le != NULL;
+             remote_le = remote_le->next) {
+            struct ice_rcand* const remote = remote_le->data;
+            uint64_t priority;
+
+            // Same protocol, component and address family?
+            if (remote->attr.proto != IPPROTO_UDP || remote->attr.compid != local->attr.compid
+                    || sa_af(&remote->attr.addr) != sa_af(&local->attr.addr)) {
+                continue;
+            }
+
+            // Higher priority?
+            priority = controlling
+                    ? ice_calc_pair_prio(local->attr.prio, remote->attr.prio)
+                    : ice_calc_pair_prio(remote->attr.prio, local->attr.prio);
+            if (!selected_local || priority > selected_priority) {
+                selected_local = local;
+                selected_remote = remote;
+                selected_priority = priority;
+            }
+        }
+    }
+    if (!selected_local) {
+        return;
+    }
+
+    // Already selected?
+    if (trice_candpair_find(trice_validl(ice), selected_local, selected_remote)) {
+        return;
+    }
+
+    // Get candidate pair (or create it)
+    candidate_pair = trice_candpair_find(trice_checkl(ice), selected_local, selected_remote);
+    if (!candidate_pair) {
+        err = trice_candpair_alloc(&candidate_pair, ice, selected_local, selected_remote);
+        if (err) {
+            DEBUG_WARNING("Could not create candidate pair, reason: %m\n", err);
+            return;
+        }
+    }
+
+    // Move to the valid list & hand it over as if it had been nominated
+    // TODO: Replace a previously selected pair of lower priority
+    candidate_pair->nominated = true;
+    trice_candpair_make_valid(ice, candidate_pair);
+    DEBUG_PRINTF("Candidate pair selected (both ICE lite): %H\n",
+                 trice_candpair_debug, candidate_pair);
+    ice_established_handler(candidate_pair, NULL, transport);
+}
+
 /*
  * ICE connection failed callback.
  */
@@ -184,6 +291,11 @@ static void ice_failed_handler(
     DEBUG_PRINTF("Candidate pair failed: %H (%m %"PRIu16")\n",
                  trice_candpair_debug, candidate_pair, err, stun_code);
 
+    // The selected candidate pair may have changed
+    if (transport->dtls_transport) {
+        rawrtc_dtls_transport_invalidate_active_path(transport->dtls_transport);
+    }
+
     // Ignore if closed
     if (transport->state == RAWRTC_ICE_TRANSPORT_STATE_CLOSED) {
         return;
@@ -240,9 +352,18 @@ enum rawrtc_code rawrtc_ice_transport_start(
         return RAWRTC_CODE_INVALID_ARGUMENT;
     }
 
-    // TODO: Handle ICE lite
-    if (remote_parameters->ice_lite) {
-        return RAWRTC_CODE_NOT_IMPLEMENTED;
+    // ICE lite: The full agent is always controlling. In case both agents are lite, the
+    // initiating agent (offerer) is controlling which is up to the caller.
+    // https://tools.ietf.org/html/rfc8445#section-6.1.1
+    if (remote_parameters->ice_lite && gatherer->ice_lite) {
+        if (role != RAWRTC_ICE_ROLE_CONTROLLING && role != RAWRTC_ICE_ROLE_CONTROLLED) {
+            DEBUG_WARNING("Invalid ICE role for ICE lite: %s\n", rawrtc_ice_role_to_str(role));
+            return RAWRTC_CODE_INVALID_ARGUMENT;
+        }
+    } else if ((remote_parameters->ice_lite && role != RAWRTC_ICE_ROLE_CONTROLLING)
+            || (gatherer->ice_lite && role != RAWRTC_ICE_ROLE_CONTROLLED)) {
+        DEBUG_WARNING("Invalid ICE role for ICE lite: %s\n", rawrtc_ice_role_to_str(role));
+        return RAWRTC_CODE_INVALID_ARGUMENT;
     }
 
     // TODO: Check that components of ICE gatherer and ICE transport match
@@ -296,6 +417,23 @@ enum rawrtc_code rawrtc_ice_transport_start(
     // TODO: Is this actually correct if we don't have any remote candidates?
     set_state(transport, RAWRTC_ICE_TRANSPORT_STATE_CHECKING);
 
+    // Both ICE lite: Select the candidate pair without any checks
+    // Note: The pair will be selected once remote candidates have been added otherwise.
+    if (both_lite(transport)) {
+        DEBUG_INFO("Selecting candidate pair (both ICE lite)\n");
+        select_lite_candidate_pair(transport);
+        return RAWRTC_CODE_SUCCESS;
+    }
+
+    // ICE lite: Wait for the remote agent to nominate a candidate pair
+    // Note: No checklist, no pacing and no keep-alive timers will be started.
+    if (gatherer->ice_lite) {
+        DEBUG_INFO("Waiting for nomination (ICE lite)\n");
+        gatherer->nomination_handler = ice_established_handler;
+        gatherer->nomination_arg = transport;
+        return RAWRTC_CODE_SUCCESS;
+    }
+
     // Start checklist (if remote candidates exist)
     if (!list_isempty(trice_rcandl(transport->gatherer->ice))) {
         // TODO: Get config from struct
@@ -303,7 +441,7 @@ enum rawrtc_code rawrtc_ice_transport_start(
         // TODO: Set 'use_cand' properly
         DEBUG_INFO("Starting checklist due to start event\n");
         error = rawrtc_error_to_code(trice_checklist_start(
-                transport->gatherer->ice, NULL, rawrtc_default_config.pacing_interval,
+                transport->gatherer->ice, transport->stun, rawrtc_default_config.pacing_interval,
                 ice_established_handler, ice_failed_handler, transport));
         if (error) {
             return error;
@@ -335,6 +473,17 @@ enum rawrtc_code rawrtc_ice_transport_stop(
         trice_checklist_stop(transport->gatherer->ice);
     }
 
+    // Stop handling nominations (ICE lite)
+    if (transport->gatherer->nomination_arg == transport) {
+        transport->gatherer->nomination_handler = NULL;
+        transport->gatherer->nomination_arg = NULL;
+    }
+
+    // Drop the DTLS transport's cached path
+    if (transport->dtls_transport) {
+        rawrtc_dtls_transport_invalidate_active_path(transport->dtls_transport);
+    }
+
     // TODO: Remove remote candidates, role, username fragment and password from rew
 
     // TODO: Remove from RTCICETransportController (once we have it)
@@ -396,6 +545,66 @@ enum rawrtc_code rawrtc_ice_transport_get_state(
     return RAWRTC_CODE_SUCCESS;
 }
 
+/*
+ * Get a snapshot of the ICE transport's demultiplexing statistics.
+ */
+enum rawrtc_code rawrtc_ice_transport_get_demux_statistics(
+        struct rawrtc_ice_transport_demux_statistics* const statisticsp, // written into
+        struct rawrtc_ice_transport* const transport
+) {
+    struct rawrtc_ice_transport_demux_statistics statistics = {0};
+    struct le* le;
+
+    // Check arguments
+    if (!statisticsp || !transport) {
+        return RAWRTC_CODE_INVALID_ARGUMENT;
+    }
+
+    // Sum up the packet counters of the local candidates
+    for (le = list_head(&transport->gatherer->local_candidates); le != NULL; le = le->next) {
+        struct rawrtc_candidate_helper* const candidate_helper = le->data;
+        rawrtc_packet_demux_add_statistics(&statistics, candidate_helper->demux);
+    }
+
+    // Set statistics & done
+    *statisticsp = statistics;
+    return RAWRTC_CODE_SUCCESS;
+}
+
+/*
+ * Bind a remote address to the gatherer's candidates on shared UDP
+ * sockets of the same address family, so that the responses to our
+ * connectivity checks are handed to this transport's ICE agent.
+ * Remote candidates are not authenticated, so an address that has
+ * already been bound by another ICE agent will not be taken over.
+ */
+static void bind_remote_address(
+        struct rawrtc_ice_transport* const transport, // not checked
+        struct sa const* const address // not checked
+) {
+    struct le* le;
+    enum rawrtc_code error;
+
+    for (le = list_head(&transport->gatherer->local_candidates); le != NULL; le = le->next) {
+        struct rawrtc_candidate_helper* const candidate_helper = le->data;
+
+        // Multiplexed and same address family?
+        if (!candidate_helper->mux_entry
+                || sa_af(&candidate_helper->candidate->attr.addr) != sa_af(address)) {
+            continue;
+        }
+
+        // Bind (unless bound by another ICE agent)
+        error = rawrtc_udp_mux_entry_bind(candidate_helper->mux_entry, address, false);
+        if (error == RAWRTC_CODE_STILL_IN_USE) {
+            DEBUG_NOTICE("Remote address %J is already bound by another ICE agent\n", address);
+        } else if (error) {
+            DEBUG_WARNING("Could not bind remote address %J, reason: %s\n",
+                          address, rawrtc_code_to_str(error));
+        }
+    }
+}
+
 /*
  * Add a remote candidate ot the ICE transport.
  * Note: 'candidate' must be NULL to inform the transport that the
@@ -528,21 +737,31 @@ enum rawrtc_code rawrtc_ice_transport_add_remote_candidate(
         goto out;
     }
 
+    // Bind address on shared UDP sockets (if any)
+    if (protocol == RAWRTC_ICE_PROTOCOL_UDP) {
+        bind_remote_address(transport, &address);
+    }
+
     // TODO: Add TURN permission
 
     // Done
     DEBUG_PRINTF("Added remote candidate: %J\n", &address);
     error = RAWRTC_CODE_SUCCESS;
 
-    // Start checklist (if not started)
+    // Both ICE lite: Select the candidate pair (if started)
+    if (transport->state != RAWRTC_ICE_TRANSPORT_STATE_NEW && both_lite(transport)) {
+        select_lite_candidate_pair(transport);
+    }
+
+    // Start checklist (if not started and not ICE lite)
     // TODO: Get config from struct
     // TODO: Why are there no keep-alive messages?
     // TODO: Set 'use_cand' properly
-    if (transport->state != RAWRTC_ICE_TRANSPORT_STATE_NEW &&
+    if (transport->state != RAWRTC_ICE_TRANSPORT_STATE_NEW && !transport->gatherer->ice_lite &&
             !trice_checklist_isrunning(transport->gatherer->ice)) {
         DEBUG_INFO("Starting checklist due to new remote candidate\n");
         error = rawrtc_error_to_code(trice_checklist_start(
-                transport->gatherer->ice, NULL, rawrtc_default_config.pacing_interval,
+                transport->gatherer->ice, transport->stun, rawrtc_default_config.pacing_interval,
                 ice_established_handler, ice_failed_handler, transport));
         if (error) {
             DEBUG_WARNING("Could not start checklist, reason: %s\n", rawrtc_code_to_str(error));
@@ -1,6 +1,14 @@
 #include <pthread.h> // pthread_*
+#include <unistd.h> // read, write, close, pipe
+#include <errno.h> // errno
+#ifdef __linux__
+#include <sys/eventfd.h> // eventfd
+#define RAWRTC_HAVE_EVENTFD
+#endif
 #include <rawrtc.h>
 #include "main.h"
+#include "utils.h"
+#include "dtls_context.h"
 
 #define DEBUG_MODULE "rawrtc-main"
 //#define RAWRTC_DEBUG_MODULE_LEVEL 7 // Note: Uncomment this to debug this module only
@@ -8,12 +16,241 @@
 
 struct rawrtc_global rawrtc_global;
 
+/*
+ * Shard call (passed through the shard's call queue).
+ */
+struct shard_call {
+    struct rawrtc_mpsc_node node;
+    rawrtc_shard_call_handler* handler;
+    void* arg; // handed over
+};
+
+/*
+ * Destructor for an existing shard call.
+ */
+static void shard_call_destroy(
+        void* arg
+) {
+    struct shard_call* const call = arg;
+
+    // Un-reference
+    mem_deref(call->arg);
+}
+
+/*
+ * Wake up the shard's event loop (if not already pending).
+ * May be called from any thread.
+ */
+static void shard_wakeup(
+        struct rawrtc_shard* const shard // not checked
+) {
+    ssize_t length;
+#ifdef RAWRTC_HAVE_EVENTFD
+    uint64_t const value = 1;
+#else
+    uint8_t const value = 1;
+#endif
+
+    // Already pending?
+    if (__atomic_exchange_n(&shard->wakeup_pending, true, __ATOMIC_SEQ_CST)) {
+        return;
+    }
+
+    // Signal
+    // Note: EAGAIN means the file descriptor is readable already, so we can ignore it.
+    length = write(shard->wakeup_fds[1], &value, sizeof(value));
+    if (length < 0 && errno != EAGAIN) {
+        DEBUG_WARNING("Could not wake up shard, reason: %m\n", errno);
+    }
+}
+
+/*
+ * Handle pending shard calls on the shard's thread.
+ */
+static void shard_wakeup_handler(
+        int flags,
+        void* arg
+) {
+    struct rawrtc_shard* const shard = arg;
+    struct shard_call* call;
+#ifdef RAWRTC_HAVE_EVENTFD
+    uint64_t value;
+#else
+    uint8_t value[64];
+#endif
+    (void) flags;
+
+    // Consume signal
+    while (read(shard->wakeup_fds[0], &value, sizeof(value)) == sizeof(value)) {}
+
+    // Reset pending flag
+    // Note: This MUST happen before popping, so pushes from now on will wake us up again.
+    __atomic_store_n(&shard->wakeup_pending, false, __ATOMIC_SEQ_CST);
+
+    // Call & un-reference
+    while ((call = rawrtc_mpsc_queue_pop(&shard->calls)) != NULL) {
+        call->handler(call->arg);
+        mem_deref(call);
+    }
+}
+
+/*
+ * Close the wake up file descriptors of a shard.
+ */
+static void shard_wakeup_close(
+        struct rawrtc_shard* const shard // not checked
+) {
+    if (shard->wakeup_fds[0] >= 0) {
+        fd_close(shard->wakeup_fds[0]);
+        (void) close(shard->wakeup_fds[0]);
+    }
+    if (shard->wakeup_fds[1] >= 0 && shard->wakeup_fds[1] != shard->wakeup_fds[0]) {
+        (void) close(shard->wakeup_fds[1]);
+    }
+    shard->wakeup_fds[0] = -1;
+    shard->wakeup_fds[1] = -1;
+}
+
+/*
+ * Open the wake up file descriptors of a shard and listen for events.
+ */
+static enum rawrtc_code shard_wakeup_open(
+        struct rawrtc_shard* const shard // not checked
+) {
+    int err;
+
+    // Create eventfd (or pipe)
+#ifdef RAWRTC_HAVE_EVENTFD
+    shard->wakeup_fds[0] = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+    if (shard->wakeup_fds[0] < 0) {
+        return rawrtc_error_to_code(errno);
+    }
+    shard->wakeup_fds[1] = shard->wakeup_fds[0];
+#else
+    if (pipe(shard->wakeup_fds)) {
+        shard->wakeup_fds[0] = -1;
+        shard->wakeup_fds[1] = -1;
+        return rawrtc_error_to_code(errno);
+    }
+    err = net_sockopt_blocking_set(shard->wakeup_fds[0], false);
+    if (!err) {
+        err = net_sockopt_blocking_set(shard->wakeup_fds[1], false);
+    }
+    if (err) {
+        goto out;
+    }
+#endif
+
+    // Listen on the calling thread's event loop
+    err = fd_listen(shard->wakeup_fds[0], FD_READ, shard_wakeup_handler, shard);
+
+#ifndef RAWRTC_HAVE_EVENTFD
+out:
+#endif
+    if (err) {
+        shard_wakeup_close(shard);
+    }
+    return rawrtc_error_to_code(err);
+}
+
+/*
+ * Destructor for an existing shard.
+ */
+static void rawrtc_shard_destroy(
+        void* arg
+) {
+    struct rawrtc_shard* const shard = arg;
+    struct shard_call* call;
+    size_t i;
+
+    // Stop timer
+    tmr_cancel(&shard->usrsctp_tick_timer);
+
+    // Stop listening & close
+    shard_wakeup_close(shard);
+
+    // Un-reference SCTP transport table
+    // Note: All SCTP transports of the shard have been destroyed at this point.
+    mem_deref(shard->sctp_transports);
+
+    // Drop cached DTLS sessions & detach cached DTLS contexts and shared UDP sockets
+    list_flush(&shard->dtls_sessions);
+    list_clear(&shard->dtls_contexts);
+    list_clear(&shard->udp_muxes);
+
+    // Free batched UDP receive buffers
+    for (i = 0; i < RAWRTC_UDP_BATCH_SIZE_MAX; ++i) {
+        mem_deref(shard->udp_receive_buffers[i]);
+    }
+
+    // Drop pending calls
+    while ((call = rawrtc_mpsc_queue_pop(&shard->calls)) != NULL) {
+        mem_deref(call);
+    }
+}
+
+/*
+ * Create a shard for the calling thread.
+ */
+static enum rawrtc_code shard_create(
+        struct rawrtc_shard** const shardp // de-referenced
+) {
+    struct rawrtc_shard* shard;
+    enum rawrtc_code error;
+
+    // Allocate
+    shard = mem_zalloc(sizeof(*shard), rawrtc_shard_destroy);
+    if (!shard) {
+        return RAWRTC_CODE_NO_MEMORY;
+    }
+
+    // Set fields
+    shard->thread = pthread_self();
+    rawrtc_mpsc_queue_init(&shard->calls);
+    shard->wakeup_fds[0] = -1;
+    shard->wakeup_fds[1] = -1;
+    tmr_init(&shard->usrsctp_tick_timer);
+    list_init(&shard->usrsctp_batch_transports);
+    list_init(&shard->dtls_contexts);
+    list_init(&shard->dtls_sessions);
+    shard->dtls_session_cache_size = rawrtc_default_config.dtls_session_cache_size;
+    list_init(&shard->udp_muxes);
+
+    // Create SCTP transport table
+    error = rawrtc_error_to_code(hash_alloc(&shard->sctp_transports, 16));
+    if (error) {
+        goto out;
+    }
+
+    // Open wake up file descriptors (for calls from other threads)
+    error = shard_wakeup_open(shard);
+    if (error) {
+        goto out;
+    }
+
+    // Bind to the calling thread
+    error = rawrtc_error_to_code(pthread_setspecific(rawrtc_global.shard_key, shard));
+    if (error) {
+        goto out;
+    }
+
+out:
+    if (error) {
+        mem_deref(shard);
+    } else {
+        // Set pointer
+        *shardp = shard;
+    }
+    return error;
+}
+
 /*
  * Initialise rawrtc. Must be called before making a call to any other
  * function.
  */
 enum rawrtc_code rawrtc_init() {
     int err;
+    enum rawrtc_code error;
     pthread_mutexattr_t mutex_attribute;
 
     // Initialise re
@@ -41,13 +278,76 @@ enum rawrtc_code rawrtc_init() {
         return rawrtc_error_to_code(err);
     }
 
-    // Set main thread and counter
-    rawrtc_global.mutex_main_thread = pthread_self();
+    // Set counter
     rawrtc_global.mutex_counter = 0;
 
+    // Initialise usrsctp mutex
+    err = pthread_mutex_init(&rawrtc_global.usrsctp_mutex, NULL);
+    if (err) {
+        DEBUG_WARNING("Failed to initialise usrsctp mutex, reason: %m\n", err);
+        return rawrtc_error_to_code(err);
+    }
+
     // Set usrsctp initialised counter
     rawrtc_global.usrsctp_initialized = 0;
 
+    // Initialise usrsctp timer mutex
+    err = pthread_mutex_init(&rawrtc_global.usrsctp_timer_mutex, NULL);
+    if (err) {
+        DEBUG_WARNING("Failed to initialise usrsctp timer mutex, reason: %m\n", err);
+        return rawrtc_error_to_code(err);
+    }
+
+    // Initialise SCTP transport table & its mutex
+    err = pthread_mutex_init(&rawrtc_global.sctp_transports_mutex, NULL);
+    if (err) {
+        DEBUG_WARNING("Failed to initialise SCTP transports mutex, reason: %m\n", err);
+        return rawrtc_error_to_code(err);
+    }
+    err = hash_alloc(&rawrtc_global.sctp_transports, 256);
+    if (err) {
+        DEBUG_WARNING("Failed to create SCTP transport table, reason: %m\n", err);
+        return rawrtc_error_to_code(err);
+    }
+    rawrtc_global.sctp_transport_address = 0;
+
+    // Initialise UDP mux route table & its mutex
+    err = pthread_mutex_init(&rawrtc_global.udp_mux_routes_mutex, NULL);
+    if (err) {
+        DEBUG_WARNING("Failed to initialise UDP mux routes mutex, reason: %m\n", err);
+        return rawrtc_error_to_code(err);
+    }
+    err = hash_alloc(&rawrtc_global.udp_mux_routes, 256);
+    if (err) {
+        DEBUG_WARNING("Failed to create UDP mux route table, reason: %m\n", err);
+        return rawrtc_error_to_code(err);
+    }
+
+    // Generate DTLS session ticket keys
+    rand_bytes(rawrtc_global.dtls_ticket_keys, sizeof(rawrtc_global.dtls_ticket_keys));
+
+    // Register DTLS context & handshake indexes
+    error = rawrtc_dtls_context_init();
+    if (error) {
+        DEBUG_WARNING("Failed to register DTLS indexes, reason: %s\n",
+                      rawrtc_code_to_str(error));
+        return error;
+    }
+
+    // Create shard key
+    err = pthread_key_create(&rawrtc_global.shard_key, NULL);
+    if (err) {
+        DEBUG_WARNING("Failed to create shard key, reason: %m\n", err);
+        return rawrtc_error_to_code(err);
+    }
+
+    // Create main shard (the calling thread)
+    error = shard_create(&rawrtc_global.main_shard);
+    if (error) {
+        DEBUG_WARNING("Failed to create main shard, reason: %s\n", rawrtc_code_to_str(error));
+        return error;
+    }
+
     // Done
     return RAWRTC_CODE_SUCCESS;
 }
@@ -60,7 +360,37 @@ enum rawrtc_code rawrtc_close() {
 
     // TODO: Close usrsctp if initialised
 
-    // Destroy mutex
+    // Remove main shard
+    pthread_setspecific(rawrtc_global.shard_key, NULL);
+    rawrtc_global.main_shard = mem_deref(rawrtc_global.main_shard);
+
+    // Delete shard key
+    err = pthread_key_delete(rawrtc_global.shard_key);
+    if (err) {
+        DEBUG_WARNING("Failed to delete shard key, reason: %m\n", err);
+    }
+
+    // Un-reference SCTP transport & UDP mux route tables
+    rawrtc_global.sctp_transports = mem_deref(rawrtc_global.sctp_transports);
+    rawrtc_global.udp_mux_routes = mem_deref(rawrtc_global.udp_mux_routes);
+
+    // Destroy mutexes
+    err = pthread_mutex_destroy(&rawrtc_global.udp_mux_routes_mutex);
+    if (err) {
+        DEBUG_WARNING("Failed to destroy UDP mux routes mutex, reason: %m\n", err);
+    }
+    err = pthread_mutex_destroy(&rawrtc_global.sctp_transports_mutex);
+    if (err) {
+        DEBUG_WARNING("Failed to destroy SCTP transports mutex, reason: %m\n", err);
+    }
+    err = pthread_mutex_destroy(&rawrtc_global.usrsctp_timer_mutex);
+    if (err) {
+        DEBUG_WARNING("Failed to destroy usrsctp timer mutex, reason: %m\n", err);
+    }
+    err = pthread_mutex_destroy(&rawrtc_global.usrsctp_mutex);
+    if (err) {
+        DEBUG_WARNING("Failed to destroy usrsctp mutex, reason: %m\n", err);
+    }
     err = pthread_mutex_destroy(&rawrtc_global.mutex);
     if (err) {
         DEBUG_WARNING("Failed to destroy mutex, reason: %m\n", err);
@@ -73,14 +403,118 @@ enum rawrtc_code rawrtc_close() {
     return RAWRTC_CODE_SUCCESS;
 }
 
+/*
+ * Initialise the calling thread as a shard running its own event loop.
+ * All instances created on this thread are pinned to it and MUST only
+ * be used from this thread. Call `re_main` to run the event loop.
+ */
+enum rawrtc_code rawrtc_thread_init() {
+    struct rawrtc_shard* shard;
+    enum rawrtc_code error;
+
+    // Already a shard?
+    if (pthread_getspecific(rawrtc_global.shard_key)) {
+        return RAWRTC_CODE_INVALID_STATE;
+    }
+
+    // Initialise re for this thread
+    if (re_thread_init()) {
+        return RAWRTC_CODE_INITIALISE_FAIL;
+    }
+
+    // Create shard
+    error = shard_create(&shard);
+    if (error) {
+        re_thread_close();
+        return error;
+    }
+
+    // Done
+    DEBUG_PRINTF("Initialised shard %p\n", shard);
+    return RAWRTC_CODE_SUCCESS;
+}
+
+/*
+ * Close the shard of the calling thread. All instances pinned to the
+ * shard MUST have been destroyed before.
+ */
+enum rawrtc_code rawrtc_thread_close() {
+    struct rawrtc_shard* const shard = pthread_getspecific(rawrtc_global.shard_key);
+
+    // Check state
+    if (!shard || shard == rawrtc_global.main_shard) {
+        return RAWRTC_CODE_INVALID_STATE;
+    }
+
+    // Un-bind & un-reference
+    pthread_setspecific(rawrtc_global.shard_key, NULL);
+    mem_deref(shard);
+
+    // Close re for this thread
+    re_thread_close();
+
+    // Done
+    return RAWRTC_CODE_SUCCESS;
+}
+
+/*
+ * Get the shard of the calling thread.
+ * Threads that are not a shard are being treated as if they were on the
+ * main shard. In this case, the event loop mutex MUST be locked.
+ */
+struct rawrtc_shard* rawrtc_shard_current() {
+    struct rawrtc_shard* const shard = pthread_getspecific(rawrtc_global.shard_key);
+    return shard ? shard : rawrtc_global.main_shard;
+}
+
+/*
+ * Get the shard of the calling thread or `NULL` in case the calling
+ * thread is not a shard.
+ */
+struct rawrtc_shard* rawrtc_shard_self() {
+    return pthread_getspecific(rawrtc_global.shard_key);
+}
+
+/*
+ * Call a handler on the shard's thread (asynchronously).
+ * May be called from any thread and does not block. The argument is
+ * being handed over to the shard and un-referenced after the call (or
+ * on error), so the caller MUST NOT use it afterwards.
+ */
+enum rawrtc_code rawrtc_shard_call(
+        struct rawrtc_shard* const shard, // not checked
+        rawrtc_shard_call_handler* const handler, // not checked
+        void* const arg // handed over
+) {
+    struct shard_call* call;
+
+    // Allocate
+    call = mem_zalloc(sizeof(*call), shard_call_destroy);
+    if (!call) {
+        mem_deref(arg);
+        return RAWRTC_CODE_NO_MEMORY;
+    }
+
+    // Set fields
+    call->handler = handler;
+    call->arg = arg;
+
+    // Push to the shard's call queue & wake up the shard
+    rawrtc_mpsc_queue_push(&shard->calls, &call->node, call);
+    shard_wakeup(shard);
+    return RAWRTC_CODE_SUCCESS;
+}
+
 /*
  * Lock event loop mutex (re-entrant).
+ * Note: Shards run their own event loop, so no locking is required on
+ *       a shard's thread. Other threads lock the main event loop.
  */
 void rawrtc_thread_enter() {
     int err;
 
     // Need locking?
-    if (pthread_equal(rawrtc_global.mutex_main_thread, pthread_self())) {
+    if (pthread_getspecific(rawrtc_global.shard_key)) {
         DEBUG_PRINTF("Already on event loop thread, no locking required\n");
         return;
     }
@@ -109,7 +543,7 @@ void rawrtc_thread_leave() {
     int err;
 
     // Need unlocking?
-    if (pthread_equal(rawrtc_global.mutex_main_thread, pthread_self())) {
+    if (pthread_getspecific(rawrtc_global.shard_key)) {
         DEBUG_PRINTF("Already on event loop thread, no unlocking required\n");
         return;
     }
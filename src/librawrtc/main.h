@@ -1,19 +1,78 @@
 #pragma once
 #include <rawrtc.h>
+#include "mpsc_queue.h"
+#include "udp_batch.h"
+
+/*
+ * Event loop shard: A thread running its own re event loop.
+ * Instances are pinned to the shard they have been created on.
+ */
+struct rawrtc_shard {
+    pthread_t thread;
+    struct rawrtc_mpsc_queue calls;
+    int wakeup_fds[2]; // read & write end (identical for eventfd)
+    bool wakeup_pending;
+    struct hash* sctp_transports; // not referenced, by usrsctp address
+    uint_fast32_t usrsctp_transports;
+    struct tmr usrsctp_tick_timer;
+    uint32_t usrsctp_tick_interval;
+    uint64_t usrsctp_activity_time;
+    uint_fast32_t usrsctp_busy_transports;
+    uint_fast32_t usrsctp_batch_depth;
+    struct list usrsctp_batch_transports;
+    struct list dtls_contexts; // not referenced
+    struct list dtls_sessions; // referenced, most recently used first
+    uint32_t dtls_session_cache_size; // 0 disables resumption
+    struct list udp_muxes; // not referenced
+    struct mbuf* udp_receive_buffers[RAWRTC_UDP_BATCH_SIZE_MAX]; // referenced, lazily allocated
+    struct rawrtc_udp_receive_statistics udp_receive_statistics;
+#ifdef SCTP_REDIRECT_TRANSPORT
+    struct rawrtc_sctp_redirect_demux* sctp_redirect_demux; // not referenced, nullable
+#endif
+};
 
 /*
  * Global rawrtc vars.
  */
 struct rawrtc_global {
     pthread_mutex_t mutex;
-    pthread_t mutex_main_thread;
     uint_fast16_t mutex_counter;
+    pthread_key_t shard_key;
+    struct rawrtc_shard* main_shard;
+    pthread_mutex_t usrsctp_mutex; // guards the usrsctp vars below
     uint_fast32_t usrsctp_initialized;
-    struct tmr usrsctp_tick_timer;
+    struct rawrtc_sctp_timer_statistics usrsctp_timer_statistics;
+    pthread_mutex_t usrsctp_timer_mutex; // guards usrsctp's timers and the tick time
+    uint64_t usrsctp_tick_time;
+    pthread_mutex_t sctp_transports_mutex; // guards the SCTP transport vars below
+    struct hash* sctp_transports; // not referenced, by usrsctp address (all shards)
+    uintptr_t sctp_transport_address; // last assigned
+    struct rawrtc_sctp_callback_statistics usrsctp_callback_statistics; // atomic
     size_t usrsctp_chunk_size;
+    uint8_t dtls_ticket_keys[80]; // session ticket key name, HMAC and AES key
+    int dtls_context_index; // OpenSSL ex_data index on SSL_CTX
+    int dtls_handshake_index; // OpenSSL ex_data index on SSL
+    pthread_mutex_t udp_mux_routes_mutex; // guards the UDP mux routes below
+    struct hash* udp_mux_routes; // not referenced, by local address and username fragment or
+                                 // remote address (all shards)
 };
 
 extern struct rawrtc_global rawrtc_global;
 
+/*
+ * Shard call handler.
+ */
+typedef void (rawrtc_shard_call_handler)(void* const arg);
+
 void rawrtc_thread_enter();
 void rawrtc_thread_leave();
+
+struct rawrtc_shard* rawrtc_shard_current();
+
+struct rawrtc_shard* rawrtc_shard_self();
+
+enum rawrtc_code rawrtc_shard_call(
+    struct rawrtc_shard* const shard, // not checked
+    rawrtc_shard_call_handler* const handler, // not checked
+    void* const arg // handed over
+);
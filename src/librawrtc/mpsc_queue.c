@@ -0,0 +1,98 @@
+#include <rawrtc.h>
+#include "mpsc_queue.h"
+
+#define DEBUG_MODULE "mpsc-queue"
+//#define RAWRTC_DEBUG_MODULE_LEVEL 7 // Note: Uncomment this to debug this module only
+#include "debug.h"
+
+/*
+ * Initialise a multi-producer single-consumer queue.
+ */
+void rawrtc_mpsc_queue_init(
+        struct rawrtc_mpsc_queue* const queue // not checked
+) {
+    queue->stub.next = NULL;
+    queue->stub.data = NULL;
+    queue->head = &queue->stub;
+    queue->tail = &queue->stub;
+}
+
+/*
+ * Link a node (without setting the data).
+ */
+static void link_node(
+        struct rawrtc_mpsc_queue* const queue, // not checked
+        struct rawrtc_mpsc_node* const node // not checked
+) {
+    struct rawrtc_mpsc_node* previous;
+
+    // Swap head & link the previous head to the node
+    // Note: Until the previous head has been linked, the consumer cannot see the node.
+    __atomic_store_n(&node->next, NULL, __ATOMIC_RELAXED);
+    previous = __atomic_exchange_n(&queue->head, node, __ATOMIC_ACQ_REL);
+    __atomic_store_n(&previous->next, node, __ATOMIC_RELEASE);
+}
+
+/*
+ * Push an item into the queue. May be called from any thread.
+ * Note: The queue does not wake the consumer. The caller needs to do
+ *       that after the item has been pushed.
+ */
+void rawrtc_mpsc_queue_push(
+        struct rawrtc_mpsc_queue* const queue, // not checked
+        struct rawrtc_mpsc_node* const node, // not checked
+        void* const data
+) {
+    // Set data & link
+    node->data = data;
+    link_node(queue, node);
+}
+
+/*
+ * Pop an item from the queue. MUST only be called from the consumer
+ * thread.
+ *
+ * Return the item's data or `NULL` in case the queue is empty.
+ * Note: `NULL` may also be returned while a producer is in the middle
+ *       of pushing. That producer wakes the consumer afterwards.
+ */
+void* rawrtc_mpsc_queue_pop(
+        struct rawrtc_mpsc_queue* const queue // not checked
+) {
+    struct rawrtc_mpsc_node* tail = queue->tail;
+    struct rawrtc_mpsc_node* next = __atomic_load_n(&tail->next, __ATOMIC_ACQUIRE);
+    struct rawrtc_mpsc_node* head;
+
+    // Skip stub
+    if (tail == &queue->stub) {
+        if (!next) {
+            return NULL;
+        }
+        queue->tail = next;
+        tail = next;
+        next = __atomic_load_n(&tail->next, __ATOMIC_ACQUIRE);
+    }
+
+    // More items after this one?
+    if (next) {
+        queue->tail = next;
+        return tail->data;
+    }
+
+    // Producer in the middle of pushing?
+    head = __atomic_load_n(&queue->head, __ATOMIC_ACQUIRE);
+    if (tail != head) {
+        return NULL;
+    }
+
+    // Last item: Re-insert stub so the tail can be advanced
+    link_node(queue, &queue->stub);
+    next = __atomic_load_n(&tail->next, __ATOMIC_ACQUIRE);
+    if (next) {
+        queue->tail = next;
+        return tail->data;
+    }
+
+    // Producer in the middle of pushing
+    return NULL;
+}
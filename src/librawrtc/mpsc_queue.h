@@ -0,0 +1,34 @@
+#pragma once
+
+/*
+ * Node of a multi-producer single-consumer queue.
+ * Embed this into the item that should be queued.
+ */
+struct rawrtc_mpsc_node {
+    struct rawrtc_mpsc_node* next;
+    void* data;
+};
+
+/*
+ * Lock-free, intrusive multi-producer single-consumer queue.
+ * Any thread may push, only the owning thread may pop.
+ */
+struct rawrtc_mpsc_queue {
+    struct rawrtc_mpsc_node* head; // producers
+    struct rawrtc_mpsc_node* tail; // consumer
+    struct rawrtc_mpsc_node stub;
+};
+
+void rawrtc_mpsc_queue_init(
+    struct rawrtc_mpsc_queue* const queue // not checked
+);
+
+void rawrtc_mpsc_queue_push(
+    struct rawrtc_mpsc_queue* const queue, // not checked
+    struct rawrtc_mpsc_node* const node, // not checked
+    void* const data
+);
+
+void* rawrtc_mpsc_queue_pop(
+    struct rawrtc_mpsc_queue* const queue // not checked
+);
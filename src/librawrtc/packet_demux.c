@@ -0,0 +1,208 @@
+#include <rawrtc.h>
+#include "packet_demux.h"
+
+#define DEBUG_MODULE "packet-demux"
+//#define RAWRTC_DEBUG_MODULE_LEVEL 7 // Note: Uncomment this to debug this module only
+#include "debug.h"
+
+/*
+ * Classify a datagram by its first byte.
+ * https://tools.ietf.org/html/rfc7983#section-7
+ */
+static enum rawrtc_packet_demux_class classify(
+        struct mbuf* const buffer // not checked
+) {
+    uint8_t first;
+
+    // Empty?
+    if (mbuf_get_left(buffer) < 1) {
+        return RAWRTC_PACKET_DEMUX_CLASS_OTHER;
+    }
+
+    // Classify
+    first = mbuf_buf(buffer)[0];
+    if (first < 4) {
+        return RAWRTC_PACKET_DEMUX_CLASS_STUN;
+    } else if (first >= 20 && first <= 63) {
+        return RAWRTC_PACKET_DEMUX_CLASS_DTLS;
+    } else if (first >= 64 && first <= 79) {
+        return RAWRTC_PACKET_DEMUX_CLASS_TURN_CHANNEL;
+    } else if (first >= 128 && first <= 191) {
+        return RAWRTC_PACKET_DEMUX_CLASS_RTP;
+    } else {
+        return RAWRTC_PACKET_DEMUX_CLASS_OTHER;
+    }
+}
+
+/*
+ * Hand a datagram to the handler of its class or drop it.
+ */
+static void dispatch(
+        struct rawrtc_packet_demux* const demux, // not checked
+        enum rawrtc_packet_demux_class const class,
+        struct sa* const source,
+        struct mbuf* const buffer // not checked
+) {
+    struct rawrtc_packet_demux_entry* const entry = &demux->entries[class];
+
+    // Drop if no handler has been registered
+    if (!entry->handler) {
+        ++demux->packets_dropped;
+        return;
+    }
+
+    // Dispatch
+    entry->handler(source, buffer, entry->arg);
+}
+
+/*
+ * Classify datagrams before any other layer sees them (UDP helper).
+ * Datagrams of a class without a handler are left to the layers above.
+ */
+static bool classify_helper(
+        struct sa* source,
+        struct mbuf* buffer,
+        void* arg
+) {
+    struct rawrtc_packet_demux* const demux = arg;
+    enum rawrtc_packet_demux_class const class = classify(buffer);
+
+    // Update statistics
+    ++demux->packets[class];
+
+    // Leave it to the next layer?
+    if (!demux->entries[class].handler) {
+        return false;
+    }
+
+    // Dispatch & handled
+    dispatch(demux, class, source, buffer);
+    return true;
+}
+
+/*
+ * Handle datagrams that made it through all other layers (UDP helper),
+ * e.g. those decapsulated by the TURN client or STUN messages the ICE
+ * agent did not consume.
+ */
+static bool fallback_helper(
+        struct sa* source,
+        struct mbuf* buffer,
+        void* arg
+) {
+    struct rawrtc_packet_demux* const demux = arg;
+
+    // Dispatch (or drop) & handled
+    dispatch(demux, classify(buffer), source, buffer);
+    return true;
+}
+
+/*
+ * Destructor for an existing packet demultiplexer.
+ */
+static void rawrtc_packet_demux_destroy(
+        void* arg
+) {
+    struct rawrtc_packet_demux* const demux = arg;
+
+    // Un-reference
+    mem_deref(demux->fallback_helper);
+    mem_deref(demux->classify_helper);
+}
+
+/*
+ * Create a packet demultiplexer.
+ * In case `socket` is set, the demultiplexer attaches to it.
+ * Otherwise, datagrams need to be handed to
+ * `rawrtc_packet_demux_receive`.
+ */
+enum rawrtc_code rawrtc_packet_demux_create(
+        struct rawrtc_packet_demux** const demuxp, // de-referenced
+        struct udp_sock* const socket // nullable
+) {
+    struct rawrtc_packet_demux* demux;
+    enum rawrtc_code error = RAWRTC_CODE_SUCCESS;
+
+    // Check arguments
+    if (!demuxp) {
+        return RAWRTC_CODE_INVALID_ARGUMENT;
+    }
+
+    // Allocate
+    demux = mem_zalloc(sizeof(*demux), rawrtc_packet_demux_destroy);
+    if (!demux) {
+        return RAWRTC_CODE_NO_MEMORY;
+    }
+
+    // Attach to socket (if any)
+    if (socket) {
+        error = rawrtc_error_to_code(udp_register_helper(
+                &demux->classify_helper, socket, RAWRTC_LAYER_PACKET_DEMUX, NULL,
+                classify_helper, demux));
+        if (error) {
+            goto out;
+        }
+        error = rawrtc_error_to_code(udp_register_helper(
+                &demux->fallback_helper, socket, RAWRTC_LAYER_DTLS_SRTP_STUN, NULL,
+                fallback_helper, demux));
+        if (error) {
+            goto out;
+        }
+    }
+
+out:
+    if (error) {
+        mem_deref(demux);
+    } else {
+        // Set pointer
+        *demuxp = demux;
+    }
+    return error;
+}
+
+/*
+ * Set (or unset) the handler of a packet class.
+ */
+void rawrtc_packet_demux_set_handler(
+        struct rawrtc_packet_demux* const demux, // not checked
+        enum rawrtc_packet_demux_class const class,
+        udp_helper_recv_h* const handler, // nullable
+        void* const arg
+) {
+    demux->entries[class].handler = handler;
+    demux->entries[class].arg = handler ? arg : NULL;
+}
+
+/*
+ * Classify a datagram and hand it to the handler of its class (or
+ * drop it). Used in case the demultiplexer is not attached to a
+ * socket.
+ */
+void rawrtc_packet_demux_receive(
+        struct rawrtc_packet_demux* const demux, // not checked
+        struct sa* const source,
+        struct mbuf* const buffer
+) {
+    enum rawrtc_packet_demux_class const class = classify(buffer);
+
+    // Update statistics
+    ++demux->packets[class];
+
+    // Dispatch (or drop)
+    dispatch(demux, class, source, buffer);
+}
+
+/*
+ * Add the packet counters of a demultiplexer to the statistics.
+ */
+void rawrtc_packet_demux_add_statistics(
+        struct rawrtc_ice_transport_demux_statistics* const statistics, // not checked
+        struct rawrtc_packet_demux const* const demux // not checked
+) {
+    statistics->stun += demux->packets[RAWRTC_PACKET_DEMUX_CLASS_STUN];
+    statistics->dtls += demux->packets[RAWRTC_PACKET_DEMUX_CLASS_DTLS];
+    statistics->turn_channel += demux->packets[RAWRTC_PACKET_DEMUX_CLASS_TURN_CHANNEL];
+    statistics->rtp += demux->packets[RAWRTC_PACKET_DEMUX_CLASS_RTP];
+    statistics->other += demux->packets[RAWRTC_PACKET_DEMUX_CLASS_OTHER];
+    statistics->dropped += demux->packets_dropped;
+}
@@ -0,0 +1,62 @@
+#pragma once
+#include <rawrtc.h>
+
+/*
+ * Packet classes, determined by the first byte of a datagram.
+ * https://tools.ietf.org/html/rfc7983#section-7
+ */
+enum rawrtc_packet_demux_class {
+    RAWRTC_PACKET_DEMUX_CLASS_STUN, // [0..3]
+    RAWRTC_PACKET_DEMUX_CLASS_DTLS, // [20..63]
+    RAWRTC_PACKET_DEMUX_CLASS_TURN_CHANNEL, // [64..79]
+    RAWRTC_PACKET_DEMUX_CLASS_RTP, // [128..191], RTP and RTCP
+    RAWRTC_PACKET_DEMUX_CLASS_OTHER, // ZRTP, unassigned or empty
+    RAWRTC_PACKET_DEMUX_CLASS_MAX
+};
+
+/*
+ * Packet demultiplexer entry.
+ */
+struct rawrtc_packet_demux_entry {
+    udp_helper_recv_h* handler; // nullable
+    void* arg;
+};
+
+/*
+ * Packet demultiplexer of a local candidate: Classifies each datagram
+ * by its first byte before any further work and hands it to the
+ * handler registered for its class.
+ * Classes without a handler are left to the layers below the handler
+ * layer (e.g. STUN to the ICE agent, TURN channel data to the TURN
+ * client) and dropped if they come through.
+ */
+struct rawrtc_packet_demux {
+    struct rawrtc_packet_demux_entry entries[RAWRTC_PACKET_DEMUX_CLASS_MAX];
+    struct udp_helper* classify_helper; // nullable
+    struct udp_helper* fallback_helper; // nullable
+    uint64_t packets[RAWRTC_PACKET_DEMUX_CLASS_MAX];
+    uint64_t packets_dropped;
+};
+
+enum rawrtc_code rawrtc_packet_demux_create(
+    struct rawrtc_packet_demux** const demuxp, // de-referenced
+    struct udp_sock* const socket // nullable
+);
+
+void rawrtc_packet_demux_set_handler(
+    struct rawrtc_packet_demux* const demux, // not checked
+    enum rawrtc_packet_demux_class const class,
+    udp_helper_recv_h* const handler, // nullable
+    void* const arg
+);
+
+void rawrtc_packet_demux_receive(
+    struct rawrtc_packet_demux* const demux, // not checked
+    struct sa* const source,
+    struct mbuf* const buffer
+);
+
+void rawrtc_packet_demux_add_statistics(
+    struct rawrtc_ice_transport_demux_statistics* const statistics, // not checked
+    struct rawrtc_packet_demux const* const demux // not checked
+);
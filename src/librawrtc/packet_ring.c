@@ -0,0 +1,183 @@
+#include <rawrtc.h>
+#include "packet_ring.h"
+
+#define DEBUG_MODULE "packet-ring"
+//#define RAWRTC_DEBUG_MODULE_LEVEL 7 // Note: Uncomment this to debug this module only
+#include "debug.h"
+
+/*
+ * Destructor for an existing packet ring.
+ */
+static void rawrtc_packet_ring_destroy(
+        void* arg
+) {
+    struct rawrtc_packet_ring* const ring = arg;
+    uint16_t i;
+
+    // Un-reference slot buffers
+    if (ring->slots) {
+        for (i = 0; i < ring->capacity; ++i) {
+            mem_deref(ring->slots[i].buffer);
+        }
+    }
+
+    // Un-reference
+    mem_deref(ring->slots);
+}
+
+/*
+ * Create a packet ring.
+ * A capacity of 0 creates a ring that drops all packets.
+ */
+enum rawrtc_code rawrtc_packet_ring_create(
+        struct rawrtc_packet_ring** const ringp, // de-referenced
+        uint16_t const capacity,
+        size_t const slot_size,
+        enum rawrtc_ice_gatherer_buffer_drop_policy const drop_policy
+) {
+    struct rawrtc_packet_ring* ring;
+    uint16_t i;
+    enum rawrtc_code error = RAWRTC_CODE_SUCCESS;
+
+    // Check arguments
+    if (!ringp) {
+        return RAWRTC_CODE_INVALID_ARGUMENT;
+    }
+
+    // Allocate
+    ring = mem_zalloc(sizeof(*ring), rawrtc_packet_ring_destroy);
+    if (!ring) {
+        return RAWRTC_CODE_NO_MEMORY;
+    }
+
+    // Set fields
+    ring->slot_size = slot_size;
+    ring->drop_policy = drop_policy;
+
+    // Allocate slots
+    if (capacity > 0) {
+        ring->slots = mem_zalloc(capacity * sizeof(*ring->slots), NULL);
+        if (!ring->slots) {
+            error = RAWRTC_CODE_NO_MEMORY;
+            goto out;
+        }
+        ring->capacity = capacity;
+    }
+
+    // Allocate slot buffers
+    for (i = 0; i < ring->capacity; ++i) {
+        ring->slots[i].buffer = mbuf_alloc(slot_size);
+        if (!ring->slots[i].buffer) {
+            error = RAWRTC_CODE_NO_MEMORY;
+            goto out;
+        }
+    }
+
+out:
+    if (error) {
+        mem_deref(ring);
+    } else {
+        // Set pointer
+        *ringp = ring;
+    }
+    return error;
+}
+
+/*
+ * Copy a packet into the next free slot of the ring.
+ * In case the ring is full, either the packet or the oldest packet
+ * will be dropped, depending on the drop policy.
+ * Return `RAWRTC_CODE_INSUFFICIENT_SPACE` or
+ * `RAWRTC_CODE_MESSAGE_TOO_LONG` in case the packet has been dropped.
+ */
+enum rawrtc_code rawrtc_packet_ring_push(
+        struct rawrtc_packet_ring* const ring, // not checked
+        struct sa const* const source, // not checked
+        struct mbuf* const buffer // not checked, copied
+) {
+    size_t const length = mbuf_get_left(buffer);
+    struct rawrtc_packet_ring_slot* slot;
+
+    // Larger than a slot?
+    if (length > ring->slot_size) {
+        ++ring->statistics.packets_oversized;
+        return RAWRTC_CODE_MESSAGE_TOO_LONG;
+    }
+
+    // Full?
+    if (ring->count == ring->capacity) {
+        ++ring->statistics.packets_dropped;
+
+        // Drop the packet (or the oldest packet)
+        if (ring->capacity == 0 || ring->drop_policy == RAWRTC_ICE_GATHERER_BUFFER_DROP_NEWEST) {
+            return RAWRTC_CODE_INSUFFICIENT_SPACE;
+        }
+        ring->head = (uint16_t) ((ring->head + 1) % ring->capacity);
+        --ring->count;
+    }
+
+    // Get slot
+    slot = &ring->slots[(ring->head + ring->count) % ring->capacity];
+
+    // Copy packet & source address
+    // Note: This cannot fail as the buffer is large enough.
+    mbuf_rewind(slot->buffer);
+    (void) mbuf_write_mem(slot->buffer, mbuf_buf(buffer), length);
+    mbuf_set_pos(slot->buffer, 0);
+    slot->source = *source;
+
+    // Done
+    ++ring->count;
+    ++ring->statistics.packets_buffered;
+    return RAWRTC_CODE_SUCCESS;
+}
+
+/*
+ * Hand copies of the buffered packets to a handler, oldest first. The
+ * source address is being passed as context. The handler may keep a
+ * reference to the copy.
+ *
+ * Will stop iterating and return `RAWRTC_CODE_STOP_ITERATION` in case
+ * the packet handler returned `false`.
+ */
+enum rawrtc_code rawrtc_packet_ring_replay(
+        struct rawrtc_packet_ring* const ring,
+        rawrtc_message_buffer_handler* const packet_handler,
+        void* const arg
+) {
+    // Check arguments
+    if (!ring || !packet_handler) {
+        return RAWRTC_CODE_INVALID_ARGUMENT;
+    }
+
+    // Handle each packet
+    while (ring->count > 0) {
+        struct rawrtc_packet_ring_slot* const slot = &ring->slots[ring->head];
+        size_t const length = mbuf_get_left(slot->buffer);
+        struct mbuf* buffer;
+        bool handled;
+
+        // Copy packet (the slot's buffer is being reused)
+        buffer = mbuf_alloc(length);
+        if (!buffer) {
+            return RAWRTC_CODE_NO_MEMORY;
+        }
+        (void) mbuf_write_mem(buffer, mbuf_buf(slot->buffer), length);
+        mbuf_set_pos(buffer, 0);
+
+        // Handle packet
+        handled = packet_handler(buffer, &slot->source, arg);
+        mem_deref(buffer);
+        if (!handled) {
+            return RAWRTC_CODE_STOP_ITERATION;
+        }
+
+        // Remove packet
+        ring->head = (uint16_t) ((ring->head + 1) % ring->capacity);
+        --ring->count;
+        ++ring->statistics.packets_replayed;
+    }
+
+    // Done
+    return RAWRTC_CODE_SUCCESS;
+}
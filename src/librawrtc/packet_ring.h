@@ -0,0 +1,46 @@
+#pragma once
+#include <rawrtc.h>
+#include "message_buffer.h"
+
+/*
+ * Packet ring slot.
+ */
+struct rawrtc_packet_ring_slot {
+    struct sa source;
+    struct mbuf* buffer; // referenced, never handed out
+};
+
+/*
+ * Fixed-capacity ring of packets. The slots and their buffers are
+ * allocated with the ring, so buffering packets never allocates
+ * memory. Packets are copied into a slot when being pushed and copied
+ * out of it when being replayed.
+ */
+struct rawrtc_packet_ring {
+    struct rawrtc_packet_ring_slot* slots; // referenced, nullable
+    uint16_t capacity;
+    uint16_t head; // oldest packet
+    uint16_t count;
+    size_t slot_size;
+    enum rawrtc_ice_gatherer_buffer_drop_policy drop_policy;
+    struct rawrtc_ice_gatherer_buffer_statistics statistics;
+};
+
+enum rawrtc_code rawrtc_packet_ring_create(
+    struct rawrtc_packet_ring** const ringp, // de-referenced
+    uint16_t const capacity,
+    size_t const slot_size,
+    enum rawrtc_ice_gatherer_buffer_drop_policy const drop_policy
+);
+
+enum rawrtc_code rawrtc_packet_ring_push(
+    struct rawrtc_packet_ring* const ring, // not checked
+    struct sa const* const source, // not checked
+    struct mbuf* const buffer // not checked, copied
+);
+
+enum rawrtc_code rawrtc_packet_ring_replay(
+    struct rawrtc_packet_ring* const ring,
+    rawrtc_message_buffer_handler* const packet_handler,
+    void* const arg
+);
@@ -0,0 +1,650 @@
+#include <errno.h> // errno
+#include <string.h> // strlen
+#include <sys/socket.h> // setsockopt
+#include <netinet/in.h> // IPPROTO_IP, IPPROTO_IPV6, IP_MTU_DISCOVER, IPV6_MTU_DISCOVER
+#include <rawrtc.h>
+#include "path_mtu.h"
+#include "udp_mux.h"
+#include "utils.h"
+
+#define DEBUG_MODULE "path-mtu"
+//#define RAWRTC_DEBUG_MODULE_LEVEL 7 // Note: Uncomment this to debug this module only
+#include "debug.h"
+
+/*
+ * Amount of consecutive unanswered probes after which a probe size
+ * is considered to have failed (MAX_PROBES).
+ */
+#define RAWRTC_PATH_MTU_MAX_PROBES 3
+
+/*
+ * Probe timeout until the round-trip time of the path is known
+ * (in milliseconds).
+ */
+#define RAWRTC_PATH_MTU_PROBE_TIMEOUT_INITIAL 3000
+
+/*
+ * Lower bound of the probe timeout once the round-trip time is known
+ * (in milliseconds).
+ */
+#define RAWRTC_PATH_MTU_PROBE_TIMEOUT_MIN 250
+
+/*
+ * Interval after which the search for a larger path MTU will be
+ * repeated (in milliseconds).
+ */
+#define RAWRTC_PATH_MTU_RAISE_INTERVAL (600 * 1000)
+
+/*
+ * Interval of the probes confirming the current path MTU once the
+ * search has been completed (in milliseconds). Shorter than the raise
+ * interval, so a black hole is detected long before SCTP would give
+ * up on the association.
+ */
+#define RAWRTC_PATH_MTU_CONFIRMATION_INTERVAL (30 * 1000)
+
+/*
+ * Size of a STUN probe without the value of the PADDING attribute:
+ * Header (20), PRIORITY (8), ICE-CONTROLLING/-CONTROLLED (12),
+ * MESSAGE-INTEGRITY (24), FINGERPRINT (8) and the attribute headers
+ * of USERNAME and PADDING (4 each).
+ */
+#define RAWRTC_PATH_MTU_PROBE_OVERHEAD (20 + 8 + 12 + 24 + 8 + 4 + 4)
+
+static void probe_handler(void* arg);
+static void confirm_handler(void* arg);
+
+/*
+ * Get the corresponding name for a path MTU discovery state.
+ */
+char const * const rawrtc_path_mtu_state_to_name(
+        enum rawrtc_path_mtu_state const state
+) {
+    switch (state) {
+        case RAWRTC_PATH_MTU_STATE_DISABLED:
+            return "disabled";
+        case RAWRTC_PATH_MTU_STATE_BASE:
+            return "base";
+        case RAWRTC_PATH_MTU_STATE_SEARCHING:
+            return "searching";
+        case RAWRTC_PATH_MTU_STATE_SEARCH_COMPLETE:
+            return "search-complete";
+        case RAWRTC_PATH_MTU_STATE_ERROR:
+            return "error";
+        default:
+            return "???";
+    }
+}
+
+/*
+ * Check whether a datagram of a specific size exceeds the artificial
+ * path MTU limit (if any). Such datagrams must be discarded silently
+ * as if they were lost on the path.
+ */
+bool rawrtc_path_mtu_exceeds_artificial_limit(
+        struct rawrtc_path_mtu* const path_mtu, // not checked
+        size_t const size
+) {
+    return path_mtu->artificial_limit > 0 && size > path_mtu->artificial_limit;
+}
+
+/*
+ * Update the path MTU. Will call the change handler (if changed).
+ */
+static void set_path_mtu(
+        struct rawrtc_path_mtu* const path_mtu, // not checked
+        size_t const value
+) {
+    // Unchanged?
+    if (path_mtu->path_mtu == value) {
+        return;
+    }
+
+    // Set path MTU
+    DEBUG_PRINTF("Path MTU: %zu -> %zu\n", path_mtu->path_mtu, value);
+    path_mtu->path_mtu = value;
+
+    // Call handler (if any)
+    if (path_mtu->change_handler) {
+        path_mtu->change_handler(value, path_mtu->arg);
+    }
+}
+
+/*
+ * Change the state of the path MTU discovery.
+ */
+static void set_state(
+        struct rawrtc_path_mtu* const path_mtu, // not checked
+        enum rawrtc_path_mtu_state const state
+) {
+    DEBUG_PRINTF("State: %s -> %s\n", rawrtc_path_mtu_state_to_name(path_mtu->state),
+                 rawrtc_path_mtu_state_to_name(state));
+    path_mtu->state = state;
+}
+
+/*
+ * Abort a pending probe (if any).
+ */
+static void cancel_probe(
+        struct rawrtc_path_mtu* const path_mtu // not checked
+) {
+    tmr_cancel(&path_mtu->timer);
+    path_mtu->transaction = mem_deref(path_mtu->transaction);
+}
+
+/*
+ * Let the kernel set the Don't Fragment bit on outgoing datagrams of
+ * the path's socket instead of fragmenting them. Return `false` in
+ * case this is not supported, probing would be pointless then.
+ */
+static bool set_dont_fragment(
+        struct rawrtc_path_mtu* const path_mtu // not checked
+) {
+    int const af = sa_af(&path_mtu->remote_address);
+    int const fd = udp_sock_fd(path_mtu->socket, af);
+    int value;
+    int level;
+    int name;
+
+    // Get file descriptor
+    if (fd < 0) {
+        return false;
+    }
+
+    // Choose option by address family
+    // Note: 'probe' ignores the path MTU cached by the kernel, so it does not interfere with
+    //       our own discovery.
+    switch (af) {
+#if defined(IP_MTU_DISCOVER) && defined(IP_PMTUDISC_PROBE)
+        case AF_INET:
+            level = IPPROTO_IP;
+            name = IP_MTU_DISCOVER;
+            value = IP_PMTUDISC_PROBE;
+            break;
+#endif
+#if defined(IPV6_MTU_DISCOVER) && defined(IPV6_PMTUDISC_PROBE)
+        case AF_INET6:
+            level = IPPROTO_IPV6;
+            name = IPV6_MTU_DISCOVER;
+            value = IPV6_PMTUDISC_PROBE;
+            break;
+#endif
+        default:
+            (void) level; (void) name; (void) value;
+            return false;
+    }
+
+    // Set option
+    if (setsockopt(fd, level, name, &value, sizeof(value))) {
+        DEBUG_WARNING("Could not set Don't Fragment option, reason: %m\n", errno);
+        return false;
+    }
+    return true;
+}
+
+/*
+ * (Re)start the search from the base, i.e. the minimum path MTU.
+ */
+static void search_start(
+        struct rawrtc_path_mtu* const path_mtu // not checked
+) {
+    set_state(path_mtu, RAWRTC_PATH_MTU_STATE_BASE);
+    set_path_mtu(path_mtu, path_mtu->minimum);
+    path_mtu->search_high = path_mtu->maximum + 1;
+    path_mtu->probe_size = path_mtu->minimum;
+    path_mtu->probe_count = 0;
+    tmr_start(&path_mtu->timer, 0, probe_handler, path_mtu);
+}
+
+/*
+ * Complete the search. The path MTU will be confirmed regularly and a
+ * larger path MTU will be searched for again after a while.
+ */
+static void search_complete(
+        struct rawrtc_path_mtu* const path_mtu // not checked
+) {
+    DEBUG_INFO("Search complete, path MTU: %zu\n", path_mtu->path_mtu);
+    set_state(path_mtu, RAWRTC_PATH_MTU_STATE_SEARCH_COMPLETE);
+
+    // Confirm regularly & search again later
+    path_mtu->raise_time = tmr_jiffies() + RAWRTC_PATH_MTU_RAISE_INTERVAL;
+    tmr_start(&path_mtu->timer, RAWRTC_PATH_MTU_CONFIRMATION_INTERVAL, confirm_handler, path_mtu);
+}
+
+/*
+ * Send a probe confirming the current path MTU or, once the raise
+ * interval has elapsed, search for a larger path MTU.
+ */
+static void confirm_handler(
+        void* arg
+) {
+    struct rawrtc_path_mtu* const path_mtu = arg;
+
+    // Search again or confirm
+    if (tmr_jiffies() >= path_mtu->raise_time) {
+        set_state(path_mtu, RAWRTC_PATH_MTU_STATE_SEARCHING);
+        path_mtu->search_high = path_mtu->maximum + 1;
+        path_mtu->probe_size = path_mtu->maximum;
+    } else {
+        path_mtu->probe_size = path_mtu->path_mtu;
+    }
+
+    // Send probe
+    path_mtu->probe_count = 0;
+    probe_handler(path_mtu);
+}
+
+/*
+ * Choose the next probe size and send it or complete the search.
+ */
+static void search_next(
+        struct rawrtc_path_mtu* const path_mtu // not checked
+) {
+    size_t size;
+
+    // Done?
+    if (path_mtu->search_high - path_mtu->path_mtu <= RAWRTC_PATH_MTU_GRANULARITY) {
+        search_complete(path_mtu);
+        return;
+    }
+
+    // Try the maximum first (common case), then bisect
+    if (path_mtu->search_high > path_mtu->maximum) {
+        size = path_mtu->maximum;
+    } else {
+        size = path_mtu->path_mtu + (path_mtu->search_high - path_mtu->path_mtu) / 2;
+        size -= size % RAWRTC_PATH_MTU_GRANULARITY;
+        if (size <= path_mtu->path_mtu) {
+            size = path_mtu->path_mtu + RAWRTC_PATH_MTU_GRANULARITY;
+        }
+    }
+
+    // Send probe
+    path_mtu->probe_size = size;
+    path_mtu->probe_count = 0;
+    tmr_start(&path_mtu->timer, 0, probe_handler, path_mtu);
+}
+
+/*
+ * Handle a probe that has been confirmed by the peer.
+ */
+static void probe_confirmed(
+        struct rawrtc_path_mtu* const path_mtu // not checked
+) {
+    uint64_t const rtt = tmr_jiffies() - path_mtu->probe_time;
+    uint64_t timeout = 3 * rtt;
+    DEBUG_PRINTF("Probe of %zu bytes confirmed (rtt: %"PRIu64" ms)\n", path_mtu->probe_size, rtt);
+
+    // Update probe timeout from the round-trip time
+    if (timeout < RAWRTC_PATH_MTU_PROBE_TIMEOUT_MIN) {
+        timeout = RAWRTC_PATH_MTU_PROBE_TIMEOUT_MIN;
+    } else if (timeout > RAWRTC_PATH_MTU_PROBE_TIMEOUT_INITIAL) {
+        timeout = RAWRTC_PATH_MTU_PROBE_TIMEOUT_INITIAL;
+    }
+    path_mtu->probe_timeout = (uint32_t) timeout;
+
+    // Current path MTU confirmed? Confirm again later.
+    if (path_mtu->state == RAWRTC_PATH_MTU_STATE_SEARCH_COMPLETE) {
+        tmr_start(&path_mtu->timer, RAWRTC_PATH_MTU_CONFIRMATION_INTERVAL,
+                  confirm_handler, path_mtu);
+        return;
+    }
+
+    // Confirmed: base -> searching, error -> searching
+    if (path_mtu->state != RAWRTC_PATH_MTU_STATE_SEARCHING) {
+        set_state(path_mtu, RAWRTC_PATH_MTU_STATE_SEARCHING);
+    }
+
+    // Apply and continue
+    set_path_mtu(path_mtu, path_mtu->probe_size);
+    search_next(path_mtu);
+}
+
+/*
+ * Handle a probe size that has failed.
+ */
+static void probe_failed(
+        struct rawrtc_path_mtu* const path_mtu // not checked
+) {
+    DEBUG_PRINTF("Probe of %zu bytes failed\n", path_mtu->probe_size);
+
+    switch (path_mtu->state) {
+        case RAWRTC_PATH_MTU_STATE_SEARCHING:
+            // Narrow the search
+            path_mtu->search_high = path_mtu->probe_size;
+            search_next(path_mtu);
+            break;
+        case RAWRTC_PATH_MTU_STATE_SEARCH_COMPLETE:
+            // Black hole: Packets of the current path MTU no longer arrive. Fall back to the
+            // base and search again (RFC 8899, section 4.3).
+            DEBUG_NOTICE("Black hole detected, could not confirm path MTU of %zu bytes\n",
+                         path_mtu->probe_size);
+            search_start(path_mtu);
+            break;
+        default:
+            // Base failed? Fall back to the minimum and try again later.
+            DEBUG_WARNING("Could not confirm minimum path MTU of %zu bytes\n",
+                          path_mtu->probe_size);
+            set_state(path_mtu, RAWRTC_PATH_MTU_STATE_ERROR);
+            set_path_mtu(path_mtu, path_mtu->minimum);
+            path_mtu->probe_count = 0;
+            tmr_start(&path_mtu->timer, RAWRTC_PATH_MTU_RAISE_INTERVAL, probe_handler, path_mtu);
+            break;
+    }
+}
+
+/*
+ * Handle an unanswered probe.
+ */
+static void probe_timeout_handler(
+        void* arg
+) {
+    struct rawrtc_path_mtu* const path_mtu = arg;
+
+    // Drop transaction
+    path_mtu->transaction = mem_deref(path_mtu->transaction);
+
+    // Retry or give up on this size
+    if (path_mtu->probe_count < RAWRTC_PATH_MTU_MAX_PROBES) {
+        probe_handler(path_mtu);
+    } else {
+        probe_failed(path_mtu);
+    }
+}
+
+/*
+ * Handle a STUN response to a probe.
+ */
+static void probe_response_handler(
+        int err,
+        uint16_t scode,
+        char const* reason,
+        struct stun_msg const* message,
+        void* arg
+) {
+    struct rawrtc_path_mtu* const path_mtu = arg;
+    (void) reason; (void) message;
+
+    // Transaction failed? Leave it to the probe timer.
+    // Note: Any response (including an error response) proves that the probe has arrived.
+    if (err) {
+        DEBUG_PRINTF("Probe transaction failed, reason: %m\n", err);
+        return;
+    }
+    if (scode) {
+        DEBUG_PRINTF("Probe answered with error %"PRIu16" %s\n", scode, reason);
+    }
+
+    // Confirmed
+    tmr_cancel(&path_mtu->timer);
+    path_mtu->transaction = mem_deref(path_mtu->transaction);
+    probe_confirmed(path_mtu);
+}
+
+/*
+ * Send a probe of the current probe size.
+ */
+static void probe_handler(
+        void* arg
+) {
+    struct rawrtc_path_mtu* const path_mtu = arg;
+    struct rawrtc_ice_transport* const ice_transport = path_mtu->ice_transport;
+    struct rawrtc_ice_parameters* const remote_parameters = ice_transport->remote_parameters;
+    char const* const local_username_fragment = ice_transport->gatherer->ice_username_fragment;
+    enum rawrtc_ice_role role;
+    uint32_t const priority = path_mtu->candidate_pair->lcand->attr.prio;
+    char* username = NULL;
+    size_t username_length;
+    struct mbuf* padding = NULL;
+    size_t overhead;
+    enum rawrtc_code error;
+
+    // Get ICE role
+    error = rawrtc_ice_transport_get_role(&role, ice_transport);
+    if (error) {
+        goto out;
+    }
+
+    // Compose username ('<remote ufrag>:<local ufrag>')
+    error = rawrtc_sdprintf(
+            &username, "%s:%s", remote_parameters->username_fragment, local_username_fragment);
+    if (error) {
+        goto out;
+    }
+
+    // Calculate padding (attributes are padded to a multiple of four)
+    username_length = strlen(username);
+    overhead = RAWRTC_PATH_MTU_PROBE_OVERHEAD + username_length + ((4 - username_length % 4) % 4);
+    if (path_mtu->probe_size < overhead) {
+        error = RAWRTC_CODE_INVALID_ARGUMENT;
+        goto out;
+    }
+    padding = mbuf_alloc(path_mtu->probe_size - overhead);
+    if (!padding) {
+        error = RAWRTC_CODE_NO_MEMORY;
+        goto out;
+    }
+    error = rawrtc_error_to_code(mbuf_fill(padding, 0x00, path_mtu->probe_size - overhead));
+    if (error) {
+        goto out;
+    }
+    mbuf_set_pos(padding, 0);
+
+    // Start probe timer
+    ++path_mtu->probe_count;
+    path_mtu->probe_time = tmr_jiffies();
+    tmr_start(&path_mtu->timer, path_mtu->probe_timeout, probe_timeout_handler, path_mtu);
+
+    // Exceeds artificial limit? Pretend it has been lost.
+    if (rawrtc_path_mtu_exceeds_artificial_limit(path_mtu, path_mtu->probe_size)) {
+        DEBUG_PRINTF("Discarding probe of %zu bytes (artificial limit)\n", path_mtu->probe_size);
+        goto out;
+    }
+
+    // Send probe
+    DEBUG_PRINTF("Sending probe of %zu bytes to %J\n",
+                 path_mtu->probe_size, &path_mtu->remote_address);
+    error = rawrtc_error_to_code(stun_request(
+            &path_mtu->transaction, ice_transport->stun, IPPROTO_UDP, path_mtu->socket,
+            &path_mtu->remote_address, 0, STUN_METHOD_BINDING,
+            (uint8_t*) remote_parameters->password, strlen(remote_parameters->password), true,
+            probe_response_handler, path_mtu, 4,
+            STUN_ATTR_USERNAME, username,
+            STUN_ATTR_PRIORITY, &priority,
+            role == RAWRTC_ICE_ROLE_CONTROLLING ? STUN_ATTR_CONTROLLING : STUN_ATTR_CONTROLLED,
+            &path_mtu->tiebreaker,
+            STUN_ATTR_PADDING, padding));
+    if (error) {
+        // Note: Typically the kernel refuses datagrams exceeding the MTU of the local
+        //       interface, so the size has failed without having to wait.
+        DEBUG_PRINTF("Could not send probe of %zu bytes, reason: %s\n",
+                     path_mtu->probe_size, rawrtc_code_to_str(error));
+        tmr_cancel(&path_mtu->timer);
+        path_mtu->probe_count = RAWRTC_PATH_MTU_MAX_PROBES;
+        error = RAWRTC_CODE_SUCCESS;
+        probe_timeout_handler(path_mtu);
+    }
+
+out:
+    if (error) {
+        DEBUG_WARNING("Could not create probe, reason: %s\n", rawrtc_code_to_str(error));
+        cancel_probe(path_mtu);
+        set_state(path_mtu, RAWRTC_PATH_MTU_STATE_DISABLED);
+        set_path_mtu(path_mtu, path_mtu->minimum);
+    }
+
+    // Un-reference
+    mem_deref(padding);
+    mem_deref(username);
+}
+
+/*
+ * Destructor for an existing path MTU discovery instance.
+ */
+static void rawrtc_path_mtu_destroy(
+        void* arg
+) {
+    struct rawrtc_path_mtu* const path_mtu = arg;
+
+    // Stop
+    rawrtc_path_mtu_stop(path_mtu);
+
+    // Un-reference
+    mem_deref(path_mtu->ice_transport);
+}
+
+/*
+ * Create a path MTU discovery instance. Probing starts once a path
+ * has been set.
+ */
+enum rawrtc_code rawrtc_path_mtu_create(
+        struct rawrtc_path_mtu** const path_mtup, // de-referenced
+        struct rawrtc_ice_transport* const ice_transport, // referenced
+        rawrtc_path_mtu_change_handler* const change_handler, // nullable
+        void* const arg // nullable
+) {
+    struct rawrtc_path_mtu* path_mtu;
+    struct rawrtc_ice_gather_options* options;
+
+    // Check arguments
+    if (!path_mtup || !ice_transport) {
+        return RAWRTC_CODE_INVALID_ARGUMENT;
+    }
+    options = ice_transport->gatherer->options;
+
+    // Allocate
+    path_mtu = mem_zalloc(sizeof(*path_mtu), rawrtc_path_mtu_destroy);
+    if (!path_mtu) {
+        return RAWRTC_CODE_NO_MEMORY;
+    }
+
+    // Set fields/reference
+    path_mtu->state = RAWRTC_PATH_MTU_STATE_DISABLED;
+    path_mtu->ice_transport = mem_ref(ice_transport);
+    path_mtu->change_handler = change_handler;
+    path_mtu->arg = arg;
+    tmr_init(&path_mtu->timer);
+    path_mtu->tiebreaker = rand_u64();
+    path_mtu->minimum = options->path_mtu_min;
+    path_mtu->maximum = options->path_mtu_max;
+    path_mtu->artificial_limit = options->path_mtu_artificial_limit;
+    path_mtu->path_mtu = path_mtu->minimum;
+
+    // Set pointer & done
+    *path_mtup = path_mtu;
+    return RAWRTC_CODE_SUCCESS;
+}
+
+/*
+ * Start the discovery on the current path.
+ */
+static void start_handler(
+        void* arg
+) {
+    struct rawrtc_path_mtu* const path_mtu = arg;
+    struct rawrtc_ice_transport* const ice_transport = path_mtu->ice_transport;
+
+    // Reset to the minimum
+    set_path_mtu(path_mtu, path_mtu->minimum);
+
+    // Nothing to discover?
+    // Note: Relayed paths are not probed as TURN adds its own framing and the relay's path
+    //       would need to be taken into account as well. An ICE lite agent does not send
+    //       binding requests at all.
+    if (path_mtu->minimum == path_mtu->maximum
+            || path_mtu->candidate_pair->lcand->attr.type == ICE_CAND_TYPE_RELAY
+            || ice_transport->gatherer->ice_lite
+            || !ice_transport->stun || !ice_transport->remote_parameters) {
+        DEBUG_PRINTF("Path MTU discovery disabled for %J\n", &path_mtu->remote_address);
+        return;
+    }
+
+    // Shared socket? The Don't Fragment option would apply to the paths of all ICE agents using
+    // the socket which do not necessarily probe their path MTU.
+    // Note: Linux does not allow to set the Don't Fragment bit per IPv4 datagram.
+    if (rawrtc_udp_mux_is_shared_socket(path_mtu->socket)) {
+        DEBUG_NOTICE("Shared UDP socket, path MTU discovery disabled for %J\n",
+                     &path_mtu->remote_address);
+        return;
+    }
+
+    // Set Don't Fragment bit (or disable)
+    if (!set_dont_fragment(path_mtu)) {
+        DEBUG_NOTICE("Cannot set Don't Fragment bit, path MTU discovery disabled for %J\n",
+                     &path_mtu->remote_address);
+        return;
+    }
+
+    // Start probing the base
+    DEBUG_PRINTF("Starting path MTU discovery for %J\n", &path_mtu->remote_address);
+    path_mtu->probe_timeout = RAWRTC_PATH_MTU_PROBE_TIMEOUT_INITIAL;
+    search_start(path_mtu);
+}
+
+/*
+ * Set the path to be probed. Restarts the discovery in case the path
+ * has changed.
+ */
+void rawrtc_path_mtu_set_path(
+        struct rawrtc_path_mtu* const path_mtu, // not checked
+        struct ice_candpair* const candidate_pair // not checked
+) {
+    struct udp_sock* const socket = trice_lcand_sock(
+            path_mtu->ice_transport->gatherer->ice, candidate_pair->lcand);
+
+    // Unchanged?
+    if (path_mtu->socket == socket &&
+            sa_cmp(&path_mtu->remote_address, &candidate_pair->rcand->attr.addr, SA_ALL)) {
+        return;
+    }
+
+    // Forget previous path
+    rawrtc_path_mtu_stop(path_mtu);
+    if (!socket) {
+        return;
+    }
+
+    // Set path
+    path_mtu->candidate_pair = mem_ref(candidate_pair);
+    path_mtu->socket = mem_ref(socket);
+    path_mtu->remote_address = candidate_pair->rcand->attr.addr;
+
+    // Start discovery
+    // Note: Deferred as the path is usually being set while the DTLS transport is sending a
+    //       datagram, so the path MTU must not change right away.
+    tmr_start(&path_mtu->timer, 0, start_handler, path_mtu);
+}
+
+/*
+ * Check whether the search on the current path has been completed
+ * (or the path cannot be probed).
+ */
+bool rawrtc_path_mtu_is_complete(
+        struct rawrtc_path_mtu* const path_mtu // not checked
+) {
+    switch (path_mtu->state) {
+        case RAWRTC_PATH_MTU_STATE_DISABLED:
+            // Note: Without a path, there is nothing that could have been completed.
+            return path_mtu->socket && !tmr_isrunning(&path_mtu->timer);
+        case RAWRTC_PATH_MTU_STATE_SEARCH_COMPLETE:
+            return true;
+        default:
+            return false;
+    }
+}
+
+/*
+ * Stop probing and forget the path.
+ */
+void rawrtc_path_mtu_stop(
+        struct rawrtc_path_mtu* const path_mtu // not checked
+) {
+    // Stop probing
+    cancel_probe(path_mtu);
+    path_mtu->state = RAWRTC_PATH_MTU_STATE_DISABLED;
+
+    // Forget path
+    path_mtu->socket = mem_deref(path_mtu->socket);
+    path_mtu->candidate_pair = mem_deref(path_mtu->candidate_pair);
+    sa_init(&path_mtu->remote_address, AF_UNSPEC);
+}
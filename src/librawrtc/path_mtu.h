@@ -0,0 +1,94 @@
+#pragma once
+#include <rawrtc.h>
+
+/*
+ * Probe sizes are multiples of this value (in bytes). The search is
+ * complete once the gap between the largest confirmed and the
+ * smallest failed size is no larger than this.
+ */
+#define RAWRTC_PATH_MTU_GRANULARITY 4
+
+/*
+ * Lowest acceptable minimum path MTU (in bytes). Leaves room for the
+ * overhead of a DTLS record carrying an SCTP packet.
+ */
+#define RAWRTC_PATH_MTU_MIN 576
+
+/*
+ * Path MTU discovery states (RFC 8899, section 5.2).
+ */
+enum rawrtc_path_mtu_state {
+    RAWRTC_PATH_MTU_STATE_DISABLED,
+    RAWRTC_PATH_MTU_STATE_BASE,
+    RAWRTC_PATH_MTU_STATE_SEARCHING,
+    RAWRTC_PATH_MTU_STATE_SEARCH_COMPLETE,
+    RAWRTC_PATH_MTU_STATE_ERROR
+};
+
+/*
+ * Path MTU change handler.
+ */
+typedef void (rawrtc_path_mtu_change_handler)(
+    size_t const path_mtu,
+    void* const arg
+);
+
+/*
+ * Datagram packetisation layer path MTU discovery (RFC 8899) on the
+ * selected candidate pair of an ICE transport.
+ *
+ * Probes are STUN binding requests padded to the probed size which
+ * are answered by the peer's ICE agent. The path MTU is the maximum
+ * UDP payload size in bytes.
+ */
+struct rawrtc_path_mtu {
+    enum rawrtc_path_mtu_state state;
+    struct rawrtc_ice_transport* ice_transport; // referenced
+    rawrtc_path_mtu_change_handler* change_handler;
+    void* arg;
+    struct ice_candpair* candidate_pair; // referenced, nullable
+    struct udp_sock* socket; // referenced, nullable
+    struct sa remote_address;
+    struct stun_ctrans* transaction; // nullable
+    struct tmr timer;
+    uint64_t tiebreaker;
+    size_t minimum; // base path MTU
+    size_t maximum;
+    size_t artificial_limit; // 0 if disabled
+    size_t path_mtu;
+    size_t search_high; // smallest size that failed (or maximum + 1)
+    size_t probe_size;
+    unsigned int probe_count;
+    uint64_t probe_time;
+    uint32_t probe_timeout; // in milliseconds
+    uint64_t raise_time; // search for a larger path MTU from this time on
+};
+
+enum rawrtc_code rawrtc_path_mtu_create(
+    struct rawrtc_path_mtu** const path_mtup, // de-referenced
+    struct rawrtc_ice_transport* const ice_transport, // referenced
+    rawrtc_path_mtu_change_handler* const change_handler, // nullable
+    void* const arg // nullable
+);
+
+void rawrtc_path_mtu_set_path(
+    struct rawrtc_path_mtu* const path_mtu, // not checked
+    struct ice_candpair* const candidate_pair // not checked
+);
+
+bool rawrtc_path_mtu_is_complete(
+    struct rawrtc_path_mtu* const path_mtu // not checked
+);
+
+void rawrtc_path_mtu_stop(
+    struct rawrtc_path_mtu* const path_mtu // not checked
+);
+
+bool rawrtc_path_mtu_exceeds_artificial_limit(
+    struct rawrtc_path_mtu* const path_mtu, // not checked
+    size_t const size
+);
+
+char const * const rawrtc_path_mtu_state_to_name(
+    enum rawrtc_path_mtu_state const state
+);
@@ -154,6 +154,7 @@ static enum rawrtc_code peer_connection_start(
     struct rawrtc_peer_connection_context* const context = &connection->context;
     struct rawrtc_peer_connection_description* description;
     enum rawrtc_ice_role ice_role;
+    bool remote_lite;
     struct le* le;
 
     // Check if it's too early to start
@@ -179,6 +180,16 @@ static enum rawrtc_code peer_connection_start(
             return RAWRTC_CODE_UNKNOWN_ERROR;
     }
 
+    // In case one of the agents is lite, the full agent is controlling. In case both agents
+    // are lite, the offerer stays controlling.
+    // https://tools.ietf.org/html/rfc8445#section-6.1.1
+    remote_lite = description->ice_parameters && description->ice_parameters->ice_lite;
+    if (context->ice_gatherer->ice_lite && !remote_lite) {
+        ice_role = RAWRTC_ICE_ROLE_CONTROLLED;
+    } else if (remote_lite && !context->ice_gatherer->ice_lite) {
+        ice_role = RAWRTC_ICE_ROLE_CONTROLLING;
+    }
+
     // Start ICE transport
     error = rawrtc_ice_transport_start(
             context->ice_transport, context->ice_gatherer, description->ice_parameters, ice_role);
@@ -476,6 +487,44 @@ static enum rawrtc_code get_ice_gatherer(
         }
     }
 
+    // Apply path MTU range
+    error = rawrtc_ice_gather_options_set_path_mtu(
+            options, connection->configuration->path_mtu_min,
+            connection->configuration->path_mtu_max);
+    if (error) {
+        goto out;
+    }
+
+    // Apply UDP mux
+    error = rawrtc_ice_gather_options_set_udp_mux(
+            options, connection->configuration->ice_udp_mux,
+            connection->configuration->ice_udp_mux_port);
+    if (error) {
+        goto out;
+    }
+
+    // Apply ICE lite
+    error = rawrtc_ice_gather_options_set_ice_lite(options, connection->configuration->ice_lite);
+    if (error) {
+        goto out;
+    }
+
+    // Apply UDP receive batch size
+    error = rawrtc_ice_gather_options_set_udp_receive_batch_size(
+            options, connection->configuration->udp_receive_batch_size);
+    if (error) {
+        goto out;
+    }
+
+    // Apply early packet buffer
+    error = rawrtc_ice_gather_options_set_buffer(
+            options, connection->configuration->ice_gatherer_buffer_slots,
+            connection->configuration->ice_gatherer_buffer_slot_size,
+            connection->configuration->ice_gatherer_buffer_drop_policy);
+    if (error) {
+        goto out;
+    }
+
     // Create ICE gatherer
     error = rawrtc_ice_gatherer_create(
             &gatherer, options, ice_gatherer_state_change_handler,
@@ -569,8 +618,12 @@ static enum rawrtc_code get_certificates(
         return rawrtc_certificate_list_copy(&context->certificates, &configuration->certificates);
     }
 
-    // Generate a certificate
-    error = rawrtc_certificate_generate(&certificate, NULL);
+    // Take a pre-generated certificate from the pool or generate one
+    if (configuration->certificate_pool) {
+        error = rawrtc_certificate_pool_get(&certificate, configuration->certificate_pool);
+    } else {
+        error = rawrtc_certificate_generate(&certificate, NULL);
+    }
     if (error) {
         return error;
     }
@@ -639,7 +692,8 @@ static enum rawrtc_code get_dtls_transport(
     // Create DTLS transport
     return rawrtc_dtls_transport_create_internal(
             &context->dtls_transport, context->ice_transport, &certificates,
-            dtls_transport_state_change_handler, dtls_transport_error_handler, connection);
+            connection->configuration->dtls_context_sharing, dtls_transport_state_change_handler,
+            dtls_transport_error_handler, connection);
 }
 
 static void sctp_transport_state_change_handler(
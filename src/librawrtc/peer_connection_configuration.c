@@ -2,6 +2,7 @@
 #include "utils.h"
 #include "certificate.h"
 #include "ice_server.h"
+#include "path_mtu.h"
 #include "peer_connection_configuration.h"
 
 #define DEBUG_MODULE "peer-connection-configuration"
@@ -17,6 +18,7 @@ static void rawrtc_peer_connection_configuration_destroy(
     struct rawrtc_peer_connection_configuration* const configuration = arg;
 
     // Un-reference
+    mem_deref(configuration->certificate_pool);
     list_flush(&configuration->certificates);
     list_flush(&configuration->ice_servers);
 }
@@ -47,6 +49,18 @@ enum rawrtc_code rawrtc_peer_connection_configuration_create(
     list_init(&configuration->ice_servers);
     list_init(&configuration->certificates);
     configuration->sctp_sdp_05 = true;
+    configuration->path_mtu_min = rawrtc_default_config.path_mtu_min;
+    configuration->path_mtu_max = rawrtc_default_config.path_mtu_max;
+    configuration->dtls_context_sharing = rawrtc_default_config.dtls_context_sharing;
+    configuration->ice_udp_mux = rawrtc_default_config.ice_udp_mux;
+    configuration->ice_udp_mux_port = rawrtc_default_config.ice_udp_mux_port;
+    configuration->ice_lite = rawrtc_default_config.ice_lite;
+    configuration->udp_receive_batch_size = rawrtc_default_config.udp_receive_batch_size;
+    configuration->ice_gatherer_buffer_slots = rawrtc_default_config.ice_gatherer_buffer_slots;
+    configuration->ice_gatherer_buffer_slot_size =
+            rawrtc_default_config.ice_gatherer_buffer_slot_size;
+    configuration->ice_gatherer_buffer_drop_policy =
+            rawrtc_default_config.ice_gatherer_buffer_drop_policy;
 
     // Set pointer and return
     *configurationp = configuration;
@@ -188,3 +202,138 @@ enum rawrtc_code rawrtc_peer_connection_configuration_set_sctp_sdp_05(
     configuration->sctp_sdp_05 = on;
     return RAWRTC_CODE_SUCCESS;
 }
+
+/*
+ * Set the minimum and maximum path MTU (UDP payload size in bytes) of
+ * the path MTU discovery.
+ */
+enum rawrtc_code rawrtc_peer_connection_configuration_set_path_mtu(
+        struct rawrtc_peer_connection_configuration* configuration,
+        uint32_t const minimum,
+        uint32_t const maximum
+) {
+    // Check parameters
+    if (!configuration || minimum < RAWRTC_PATH_MTU_MIN || minimum > maximum) {
+        return RAWRTC_CODE_INVALID_ARGUMENT;
+    }
+
+    // Set
+    configuration->path_mtu_min = minimum;
+    configuration->path_mtu_max = maximum;
+    return RAWRTC_CODE_SUCCESS;
+}
+
+/*
+ * Set whether the DTLS transport of a peer connection shares its DTLS
+ * context with other DTLS transports of the shard that use identical
+ * certificates.
+ */
+enum rawrtc_code rawrtc_peer_connection_configuration_set_dtls_context_sharing(
+        struct rawrtc_peer_connection_configuration* configuration,
+        bool const share
+) {
+    // Check parameters
+    if (!configuration) {
+        return RAWRTC_CODE_INVALID_ARGUMENT;
+    }
+
+    // Set
+    configuration->dtls_context_sharing = share;
+    return RAWRTC_CODE_SUCCESS;
+}
+
+/*
+ * Set whether the host candidates of a peer connection share one UDP
+ * socket per interface and shard with other peer connections.
+ */
+enum rawrtc_code rawrtc_peer_connection_configuration_set_ice_udp_mux(
+        struct rawrtc_peer_connection_configuration* configuration,
+        bool const enable,
+        uint16_t const port
+) {
+    // Check parameters
+    if (!configuration) {
+        return RAWRTC_CODE_INVALID_ARGUMENT;
+    }
+
+    // Set
+    configuration->ice_udp_mux = enable;
+    configuration->ice_udp_mux_port = port;
+    return RAWRTC_CODE_SUCCESS;
+}
+
+/*
+ * Set whether a peer connection acts as an ICE lite agent.
+ */
+enum rawrtc_code rawrtc_peer_connection_configuration_set_ice_lite(
+        struct rawrtc_peer_connection_configuration* configuration,
+        bool const lite
+) {
+    // Check parameters
+    if (!configuration) {
+        return RAWRTC_CODE_INVALID_ARGUMENT;
+    }
+
+    // Set
+    configuration->ice_lite = lite;
+    return RAWRTC_CODE_SUCCESS;
+}
+
+/*
+ * Set the maximum amount of datagrams received on a host candidate's
+ * UDP socket per wakeup.
+ */
+enum rawrtc_code rawrtc_peer_connection_configuration_set_udp_receive_batch_size(
+        struct rawrtc_peer_connection_configuration* configuration,
+        uint32_t const size
+) {
+    // Check parameters
+    if (!configuration) {
+        return RAWRTC_CODE_INVALID_ARGUMENT;
+    }
+
+    // Set
+    configuration->udp_receive_batch_size = size;
+    return RAWRTC_CODE_SUCCESS;
+}
+
+/*
+ * Set the early packet buffer of the ICE gatherer.
+ */
+enum rawrtc_code rawrtc_peer_connection_configuration_set_ice_gatherer_buffer(
+        struct rawrtc_peer_connection_configuration* configuration,
+        uint16_t const slots,
+        uint16_t const slot_size,
+        enum rawrtc_ice_gatherer_buffer_drop_policy const drop_policy
+) {
+    // Check parameters
+    if (!configuration) {
+        return RAWRTC_CODE_INVALID_ARGUMENT;
+    }
+
+    // Set
+    configuration->ice_gatherer_buffer_slots = slots;
+    configuration->ice_gatherer_buffer_slot_size = slot_size;
+    configuration->ice_gatherer_buffer_drop_policy = drop_policy;
+    return RAWRTC_CODE_SUCCESS;
+}
+
+/*
+ * Set the certificate pool a certificate is taken from in case no
+ * certificates have been added to the peer connection configuration.
+ * `pool` may be `NULL` to generate certificates on demand (default).
+ */
+enum rawrtc_code rawrtc_peer_connection_configuration_set_certificate_pool(
+        struct rawrtc_peer_connection_configuration* configuration,
+        struct rawrtc_certificate_pool* const pool // nullable, referenced
+) {
+    // Check parameters
+    if (!configuration) {
+        return RAWRTC_CODE_INVALID_ARGUMENT;
+    }
+
+    // Replace
+    mem_deref(configuration->certificate_pool);
+    configuration->certificate_pool = mem_ref(pool);
+    return RAWRTC_CODE_SUCCESS;
+}
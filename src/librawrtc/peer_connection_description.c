@@ -80,14 +80,20 @@ static enum rawrtc_code set_session_boilerplate(
  */
 static enum rawrtc_code set_session_attributes(
         struct mbuf* const sdp, // not checked
+        bool const ice_lite,
         bool const trickle_ice,
         char const* const bundled_mids
 ) {
     int err = 0;
 
+    // ICE lite
+    if (ice_lite) {
+        err = mbuf_write_str(sdp, "a=ice-lite\r\n");
+    }
+
     // Trickle ICE
     if (trickle_ice) {
-        err = mbuf_write_str(sdp, "a=ice-options:trickle\r\n");
+        err |= mbuf_write_str(sdp, "a=ice-options:trickle\r\n");
     }
 
     // WebRTC identity not supported as of now
@@ -707,7 +713,8 @@ enum rawrtc_code rawrtc_peer_connection_description_create_internal(
 
     // Set session attributes
     error = set_session_attributes(
-            sdp, local_description->trickle_ice, local_description->bundled_mids);
+            sdp, context->ice_gatherer->ice_lite, local_description->trickle_ice,
+            local_description->bundled_mids);
     if (error) {
         goto out;
     }
@@ -0,0 +1,409 @@
+#ifdef __linux__
+#ifndef _GNU_SOURCE
+#define _GNU_SOURCE // recvmmsg
+#endif
+#define RAWRTC_HAVE_MMSG
+#endif
+#include <string.h> // memset
+#include <sys/types.h>
+#include <sys/socket.h> // AF_INET, SOCK_RAW, recvfrom, recvmmsg
+#include <netinet/in.h> // IPPROTO_SCTP, ntohs
+#include <unistd.h> // close
+#include <errno.h>
+#include <rawrtc.h>
+#include "main.h"
+#include "dtls_transport.h"
+#include "sctp_redirect_transport.h"
+#include "sctp_redirect_demux.h"
+
+#define DEBUG_MODULE "redirect-demux"
+//#define RAWRTC_DEBUG_MODULE_LEVEL 7 // Note: Uncomment this to debug this module only
+#include "debug.h"
+
+/*
+ * Prepare the receive buffers of the demultiplexer for another batch.
+ */
+static enum rawrtc_code prepare_receive_buffers(
+        struct rawrtc_sctp_redirect_demux* const demux // not checked
+) {
+    size_t i;
+
+    for (i = 0; i < RAWRTC_SCTP_REDIRECT_TRANSPORT_BATCH_SIZE; ++i) {
+        // Replace buffer if it is still referenced elsewhere
+        // Note: The DTLS transport references outgoing packets until it is connected.
+        if (mem_nrefs(demux->buffers[i]) > 1) {
+            mem_deref(demux->buffers[i]);
+            demux->buffers[i] = mbuf_alloc(RAWRTC_SCTP_REDIRECT_TRANSPORT_BUFFER_SIZE);
+            if (!demux->buffers[i]) {
+                return RAWRTC_CODE_NO_MEMORY;
+            }
+        }
+
+        // Rewind buffer
+        mbuf_rewind(demux->buffers[i]);
+    }
+
+    // Done
+    return RAWRTC_CODE_SUCCESS;
+}
+
+#ifdef RAWRTC_HAVE_MMSG
+/*
+ * Receive a batch of packets from the raw socket with a single
+ * `recvmmsg` call.
+ * Return the amount of packets received or `-1` in case of an error.
+ */
+static int receive_batch(
+        struct rawrtc_sctp_redirect_demux* const demux, // not checked
+        struct sockaddr_in* const addresses // not checked
+) {
+    struct mmsghdr messages[RAWRTC_SCTP_REDIRECT_TRANSPORT_BATCH_SIZE];
+    struct iovec vectors[RAWRTC_SCTP_REDIRECT_TRANSPORT_BATCH_SIZE];
+    int n_received;
+    int i;
+
+    // Prepare messages
+    memset(messages, 0, sizeof(messages));
+    for (i = 0; i < RAWRTC_SCTP_REDIRECT_TRANSPORT_BATCH_SIZE; ++i) {
+        vectors[i].iov_base = mbuf_buf(demux->buffers[i]);
+        vectors[i].iov_len = mbuf_get_space(demux->buffers[i]);
+        messages[i].msg_hdr.msg_name = &addresses[i];
+        messages[i].msg_hdr.msg_namelen = sizeof(addresses[i]);
+        messages[i].msg_hdr.msg_iov = &vectors[i];
+        messages[i].msg_hdr.msg_iovlen = 1;
+    }
+
+    // Receive (whatever is pending)
+    n_received = recvmmsg(demux->socket, messages, RAWRTC_SCTP_REDIRECT_TRANSPORT_BATCH_SIZE,
+                          MSG_DONTWAIT, NULL);
+    ++demux->receive_calls;
+    if (n_received < 0) {
+        return -1;
+    }
+
+    // Set lengths
+    for (i = 0; i < n_received; ++i) {
+        mbuf_set_end(demux->buffers[i], messages[i].msg_len);
+    }
+    return n_received;
+}
+#else
+/*
+ * Receive a single packet from the raw socket.
+ * Return the amount of packets received or `-1` in case of an error.
+ */
+static int receive_batch(
+        struct rawrtc_sctp_redirect_demux* const demux, // not checked
+        struct sockaddr_in* const addresses // not checked
+) {
+    struct mbuf* const buffer = demux->buffers[0];
+    socklen_t address_length = sizeof(addresses[0]);
+    ssize_t length;
+
+    // Receive
+    length = recvfrom(demux->socket, mbuf_buf(buffer), mbuf_get_space(buffer),
+            0, (struct sockaddr*) &addresses[0], &address_length);
+    ++demux->receive_calls;
+    if (length == -1) {
+        return -1;
+    }
+    mbuf_set_end(buffer, (size_t) length);
+    return 1;
+}
+#endif
+
+/*
+ * Get the key of a transport's local port and redirect port.
+ */
+static uint32_t entry_key(
+        uint16_t const local_port,
+        uint16_t const redirect_port
+) {
+    return (uint32_t) local_port << 16 | redirect_port;
+}
+
+/*
+ * Compare the key of an entry.
+ */
+static bool entry_key_equals(
+        struct le* le,
+        void* arg
+) {
+    struct rawrtc_sctp_redirect_demux_entry* const entry = le->data;
+    uint32_t const* const key = arg;
+    return entry->key == *key;
+}
+
+/*
+ * Look up the entry of a local port and redirect port.
+ */
+static struct rawrtc_sctp_redirect_demux_entry* lookup_entry(
+        struct rawrtc_sctp_redirect_demux* const demux, // not checked
+        uint32_t key
+) {
+    return list_ledata(hash_lookup(demux->transports, key, entry_key_equals, &key));
+}
+
+/*
+ * Look up the transport a raw packet is destined to.
+ * Return the (not referenced) transport or `NULL` in case the packet
+ * is malformed or unclaimed.
+ */
+static struct rawrtc_sctp_redirect_transport* lookup_transport(
+        struct rawrtc_sctp_redirect_demux* const demux, // not checked
+        struct mbuf* const buffer // not checked
+) {
+    size_t const length = mbuf_get_left(buffer);
+    uint8_t const* const packet = mbuf_buf(buffer);
+    size_t header_length;
+    uint16_t source;
+    uint16_t destination;
+    struct rawrtc_sctp_redirect_demux_entry* entry;
+
+    // Check IP version & get IPv4 header length
+    // Note: The header length is in 32-bit words and includes the 20 bytes of the fixed header.
+    if (length < 1 || (packet[0] >> 4) != 4) {
+        return NULL;
+    }
+    header_length = (size_t) (packet[0] & 0xf) * 4;
+    if (header_length < 20) {
+        return NULL;
+    }
+
+    // Read source and destination port (without moving the position)
+    if (length < header_length + 4) {
+        return NULL;
+    }
+    source = (uint16_t) (packet[header_length] << 8 | packet[header_length + 1]);
+    destination = (uint16_t) (packet[header_length + 2] << 8 | packet[header_length + 3]);
+
+    // Look up transport
+    entry = lookup_entry(demux, entry_key(destination, source));
+    return entry ? entry->transport : NULL;
+}
+
+/*
+ * Handle outgoing messages (that came in from the raw socket) and
+ * hand them to the owning transports.
+ */
+static void demux_from_raw(
+        int flags,
+        void* arg
+) {
+    struct rawrtc_sctp_redirect_demux* const demux = arg;
+    struct sockaddr_in from_addresses[RAWRTC_SCTP_REDIRECT_TRANSPORT_BATCH_SIZE];
+    struct rawrtc_dtls_transport* batched[RAWRTC_SCTP_REDIRECT_TRANSPORT_BATCH_SIZE];
+    size_t n_batched = 0;
+    enum rawrtc_code error;
+    int n_received;
+    int i;
+
+    if ((flags & FD_READ) == FD_READ) {
+        // Prepare buffers
+        error = prepare_receive_buffers(demux);
+        if (error) {
+            DEBUG_WARNING("Unable to prepare receive buffers: %s\n", rawrtc_code_to_str(error));
+            return;
+        }
+
+        // Receive
+        n_received = receive_batch(demux, from_addresses);
+        if (n_received == -1) {
+            if (errno != EAGAIN && errno != EWOULDBLOCK) {
+                DEBUG_WARNING("Unable to receive raw message: %m\n", errno);
+            }
+            return;
+        }
+
+        // Hand packets to their transports
+        // Note: Each DTLS transport sends the resulting records with as few system calls as
+        //       possible once the batch is being flushed.
+        for (i = 0; i < n_received; ++i) {
+            struct rawrtc_sctp_redirect_transport* const transport =
+                    lookup_transport(demux, demux->buffers[i]);
+            if (!transport) {
+                ++demux->packets_unclaimed;
+                continue;
+            }
+
+            // Start batching on the transport's DTLS transport (if not already started)
+            if (!transport->dtls_transport->batching) {
+                rawrtc_dtls_transport_batch_start(transport->dtls_transport);
+                batched[n_batched++] = mem_ref(transport->dtls_transport);
+            }
+
+            // Redirect
+            rawrtc_sctp_redirect_transport_receive(
+                    transport, demux->buffers[i], &from_addresses[i]);
+        }
+
+        // Flush batches
+        for (i = 0; i < (int) n_batched; ++i) {
+            rawrtc_dtls_transport_batch_flush(batched[i]);
+            mem_deref(batched[i]);
+        }
+    }
+}
+
+/*
+ * Destructor for an existing demultiplexer.
+ */
+static void sctp_redirect_demux_destroy(
+        void* arg
+) {
+    struct rawrtc_sctp_redirect_demux* const demux = arg;
+    size_t i;
+
+    // Detach from shard
+    if (demux->shard && demux->shard->sctp_redirect_demux == demux) {
+        demux->shard->sctp_redirect_demux = NULL;
+    }
+
+    // Stop listening and close raw socket
+    if (demux->socket != -1) {
+        fd_close(demux->socket);
+        if (close(demux->socket)) {
+            DEBUG_WARNING("Closing raw socket failed: %m\n", errno);
+        }
+    }
+
+    // Un-reference
+    for (i = 0; i < RAWRTC_SCTP_REDIRECT_TRANSPORT_BATCH_SIZE; ++i) {
+        mem_deref(demux->buffers[i]);
+    }
+    mem_deref(demux->transports);
+}
+
+/*
+ * Get the demultiplexer of the current shard. It will be created (and
+ * the raw socket will be opened) if it does not exist yet.
+ */
+enum rawrtc_code rawrtc_sctp_redirect_demux_get(
+        struct rawrtc_sctp_redirect_demux** const demuxp // de-referenced
+) {
+    struct rawrtc_shard* const shard = rawrtc_shard_current();
+    struct rawrtc_sctp_redirect_demux* demux;
+    enum rawrtc_code error;
+    size_t i;
+
+    // Check arguments
+    if (!demuxp) {
+        return RAWRTC_CODE_INVALID_ARGUMENT;
+    }
+
+    // Already exists?
+    if (shard->sctp_redirect_demux) {
+        *demuxp = mem_ref(shard->sctp_redirect_demux);
+        return RAWRTC_CODE_SUCCESS;
+    }
+
+    // Allocate
+    demux = mem_zalloc(sizeof(*demux), sctp_redirect_demux_destroy);
+    if (!demux) {
+        return RAWRTC_CODE_NO_MEMORY;
+    }
+
+    // Set fields
+    demux->socket = -1;
+
+    // Create hash of transports
+    error = rawrtc_error_to_code(hash_alloc(
+            &demux->transports, RAWRTC_SCTP_REDIRECT_DEMUX_HASH_SIZE));
+    if (error) {
+        goto out;
+    }
+
+    // Create receive buffers
+    for (i = 0; i < RAWRTC_SCTP_REDIRECT_TRANSPORT_BATCH_SIZE; ++i) {
+        demux->buffers[i] = mbuf_alloc(RAWRTC_SCTP_REDIRECT_TRANSPORT_BUFFER_SIZE);
+        if (!demux->buffers[i]) {
+            error = RAWRTC_CODE_NO_MEMORY;
+            goto out;
+        }
+    }
+
+    // Create raw socket
+    demux->socket = socket(AF_INET, SOCK_RAW, IPPROTO_SCTP);
+    if (demux->socket == -1) {
+        error = rawrtc_error_to_code(errno);
+        goto out;
+    }
+
+    // Listen on raw socket
+    error = rawrtc_error_to_code(fd_listen(demux->socket, FD_READ, demux_from_raw, demux));
+    if (error) {
+        goto out;
+    }
+
+    // Attach to shard
+    demux->shard = shard;
+    shard->sctp_redirect_demux = demux;
+
+out:
+    if (error) {
+        mem_deref(demux);
+    } else {
+        // Set pointer
+        *demuxp = demux;
+    }
+    return error;
+}
+
+/*
+ * Destructor for an existing entry.
+ */
+static void sctp_redirect_demux_entry_destroy(
+        void* arg
+) {
+    struct rawrtc_sctp_redirect_demux_entry* const entry = arg;
+
+    // Remove from hash
+    hash_unlink(&entry->le);
+}
+
+/*
+ * Register a transport with the demultiplexer. Packets destined to the
+ * transport's local port that originate from the port packets are
+ * redirected to will be handed to the transport from now on.
+ * Return `RAWRTC_CODE_STILL_IN_USE` in case another transport already
+ * uses the same local port and redirect port.
+ */
+enum rawrtc_code rawrtc_sctp_redirect_demux_register(
+        struct rawrtc_sctp_redirect_demux* const demux, // not checked
+        struct rawrtc_sctp_redirect_transport* const transport // not checked
+) {
+    uint32_t const key = entry_key(
+            transport->local_port, sa_port(&transport->redirect_address));
+    struct rawrtc_sctp_redirect_demux_entry* entry;
+
+    // Ports already in use?
+    if (lookup_entry(demux, key)) {
+        return RAWRTC_CODE_STILL_IN_USE;
+    }
+
+    // Create entry
+    entry = mem_zalloc(sizeof(*entry), sctp_redirect_demux_entry_destroy);
+    if (!entry) {
+        return RAWRTC_CODE_NO_MEMORY;
+    }
+    entry->key = key;
+    entry->transport = transport;
+
+    // Add to hash & set entry
+    hash_append(demux->transports, key, &entry->le, entry);
+    transport->demux_entry = entry;
+    return RAWRTC_CODE_SUCCESS;
+}
+
+/*
+ * Unregister a transport from the demultiplexer (if registered).
+ */
+void rawrtc_sctp_redirect_demux_unregister(
+        struct rawrtc_sctp_redirect_demux* const demux, // not checked
+        struct rawrtc_sctp_redirect_transport* const transport // not checked
+) {
+    (void) demux;
+
+    // Remove from hash & un-reference (if registered)
+    transport->demux_entry = mem_deref(transport->demux_entry);
+}
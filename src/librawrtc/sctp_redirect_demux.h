@@ -0,0 +1,46 @@
+#pragma once
+#include <rawrtc.h>
+
+enum {
+    RAWRTC_SCTP_REDIRECT_DEMUX_HASH_SIZE = 16 // buckets, must be a power of two
+};
+
+/*
+ * Registration of an SCTP redirect transport with a demultiplexer.
+ * Owned by the transport, so the demultiplexer does not keep the
+ * transport alive.
+ */
+struct rawrtc_sctp_redirect_demux_entry {
+    struct le le; // in the demultiplexer's hash of transports
+    uint32_t key; // local port (upper 16 bits) and redirect port (lower 16 bits)
+    struct rawrtc_sctp_redirect_transport* transport; // not referenced
+};
+
+/*
+ * Raw socket shared by all SCTP redirect transports of a shard.
+ * Incoming packets are demultiplexed by their SCTP destination port
+ * (the local port of the owning transport) and source port (the port
+ * packets are redirected to).
+ */
+struct rawrtc_sctp_redirect_demux {
+    struct rawrtc_shard* shard; // not referenced
+    int socket;
+    struct hash* transports; // not referenced, by local and redirect port
+    struct mbuf* buffers[RAWRTC_SCTP_REDIRECT_TRANSPORT_BATCH_SIZE];
+    uint64_t receive_calls;
+    uint64_t packets_unclaimed;
+};
+
+enum rawrtc_code rawrtc_sctp_redirect_demux_get(
+    struct rawrtc_sctp_redirect_demux** const demuxp // de-referenced
+);
+
+enum rawrtc_code rawrtc_sctp_redirect_demux_register(
+    struct rawrtc_sctp_redirect_demux* const demux, // not checked
+    struct rawrtc_sctp_redirect_transport* const transport // not checked
+);
+
+void rawrtc_sctp_redirect_demux_unregister(
+    struct rawrtc_sctp_redirect_demux* const demux, // not checked
+    struct rawrtc_sctp_redirect_transport* const transport // not checked
+);
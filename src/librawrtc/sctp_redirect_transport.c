@@ -1,13 +1,20 @@
+#ifdef __linux__
+#ifndef _GNU_SOURCE
+#define _GNU_SOURCE // sendmmsg
+#endif
+#define RAWRTC_HAVE_MMSG
+#endif
 #include <string.h> // memset
 #include <sys/types.h>
-#include <sys/socket.h> // AF_INET, SOCK_RAW, sendto, recvfrom
-#include <netinet/in.h> // IPPROTO_RAW, ntohs, htons
-#include <unistd.h> // close
+#include <sys/socket.h> // sendto, sendmmsg
+#include <netinet/in.h> // ntohs, htons
 #include <errno.h>
 #include <rawrtc.h>
 #include "crc32c.h"
 #include "dtls_transport.h"
+#include "message_buffer.h"
 #include "sctp_redirect_transport.h"
+#include "sctp_redirect_demux.h"
 
 #define DEBUG_MODULE "redirect-transport"
 //#define RAWRTC_DEBUG_MODULE_LEVEL 7 // Note: Uncomment this to debug this module only
@@ -17,14 +24,29 @@
  * Patch local and remote port in the SCTP packet header.
  */
 static void patch_sctp_header(
+        struct rawrtc_sctp_redirect_transport* const transport, // not checked
         struct mbuf* const buffer,
         uint16_t const source,
         uint16_t const destination
 ) {
     size_t const start = buffer->pos;
+    size_t const length = mbuf_get_left(buffer);
+    uint8_t ports[4];
     int err;
     uint32_t checksum;
 
+    // Check length (common header)
+    if (length < RAWRTC_SCTP_REDIRECT_TRANSPORT_COMMON_HEADER_SIZE) {
+        DEBUG_WARNING("Packet too short for an SCTP common header: %zu bytes\n", length);
+        return;
+    }
+
+    // Get previous ports & checksum
+    memcpy(ports, mbuf_buf(buffer), sizeof(ports));
+    mbuf_advance(buffer, 8);
+    checksum = mbuf_read_u32(buffer);
+    mbuf_set_pos(buffer, start);
+
     // Patch source port
     err = mbuf_write_u16(buffer, htons(source));
     if (err) {
@@ -38,15 +60,19 @@ static void patch_sctp_header(
         DEBUG_WARNING("Could not patch destination port, reason: %m\n", err);
         return;
     }
+    mbuf_set_pos(buffer, start);
 
-    // Skip verification tag
-    mbuf_advance(buffer, 4);
+    // Update checksum incrementally or recalculate it
+    // Note: The incremental update requires the previous checksum to be valid which is not the
+    //       case for packets whose checksum has been offloaded (e.g. on the loopback interface).
+    if (transport->incremental_checksum) {
+        checksum = crc32c_patch(checksum, length, 0, ports, mbuf_buf(buffer), sizeof(ports));
+    } else {
+        // Reset checksum field to '0' and recalculate checksum
+        memset(mbuf_buf(buffer) + 8, 0, 4);
+        checksum = crc32c(0, mbuf_buf(buffer), length);
+    }
 
-    // Reset checksum field to '0' and rewind back
-    memset(mbuf_buf(buffer), 0, 4);
-    mbuf_set_pos(buffer, start);
-    // Recalculate checksum
-    checksum = crc32c(0, mbuf_buf(buffer), mbuf_get_left(buffer));
     // Advance to checksum field, set it and rewind back
     mbuf_advance(buffer, 8);
     err = mbuf_write_u32(buffer, checksum);
@@ -58,85 +84,166 @@ static void patch_sctp_header(
 }
 
 /*
- * Handle outgoing messages (that came in from the raw socket).
+ * Redirect a single packet that came in from the (shared) raw socket
+ * to the DTLS transport.
  */
-static void redirect_from_raw(
-        int flags,
-        void* arg
+void rawrtc_sctp_redirect_transport_receive(
+        struct rawrtc_sctp_redirect_transport* const transport, // not checked
+        struct mbuf* const buffer, // not checked
+        struct sockaddr_in* const from_address // not checked
 ) {
-    struct rawrtc_sctp_redirect_transport* const transport = arg;
-    struct mbuf* buffer;
     enum rawrtc_code error;
-    struct sockaddr_in from_address;
-    socklen_t address_length;
-    ssize_t length;
     struct sa from = {{{0}}};
     size_t header_length;
     uint16_t source;
     uint16_t destination;
 
-    if ((flags & FD_READ) == FD_READ) {
-        buffer = transport->buffer;
+    // TODO: Receive remaining bytes (if any)
 
-        // Rewind buffer
-        mbuf_rewind(buffer);
+    // Check address
+    error = rawrtc_error_to_code(sa_set_sa(&from, (struct sockaddr*) from_address));
+    if (error) {
+        DEBUG_WARNING("Invalid sender address: %m\n", error);
+        return;
+    }
+    DEBUG_PRINTF("Received %zu bytes via RAW from %j\n", mbuf_get_left(buffer), &from);
+    if (!sa_isset(&from, SA_ADDR) && !sa_cmp(&transport->redirect_address, &from, SA_ADDR)) {
+        DEBUG_WARNING("Ignoring data from unknown address");
+        return;
+    }
 
-        // Receive
-        address_length = sizeof(from_address);
-        length = recvfrom(transport->socket, mbuf_buf(buffer), mbuf_get_space(buffer),
-                0, (struct sockaddr*) &from_address, &address_length);
-        if (length == -1) {
-            DEBUG_WARNING("Unable to receive raw message: %m\n", errno);
-            return;
-        }
-        mbuf_set_end(buffer, (size_t) length);
+    // Skip IPv4 header
+    header_length = (size_t) (mbuf_read_u8(buffer) & 0xf);
+    mbuf_advance(buffer, -1);
+    DEBUG_PRINTF("RAW IPv4 header length: %zu\n", header_length);
+    mbuf_advance(buffer, header_length * 4);
+
+    // Read source and destination port
+    source = ntohs(mbuf_read_u16(buffer));
+    destination = ntohs(mbuf_read_u16(buffer));
+    sa_set_port(&from, source);
+    (void) destination;
+    DEBUG_PRINTF("RAW from %J to %"PRIu16"\n", &from, destination);
+    mbuf_advance(buffer, -4);
+
+    // Is this from the correct source?
+    if (source != sa_port(&transport->redirect_address)) {
+        DEBUG_WARNING("Ignored data from different source\n");
+        return;
+    }
+    ++transport->statistics.packets_received;
 
-        // TODO: Receive remaining bytes (if any)
+    // Update SCTP header with changed ports
+    patch_sctp_header(transport, buffer, transport->local_port, transport->remote_port);
 
-        // Check address
-        error = rawrtc_error_to_code(sa_set_sa(&from, (struct sockaddr*) &from_address));
-        if (error) {
-            DEBUG_WARNING("Invalid sender address: %m\n", error);
-            return;
+    // Send data
+    error = rawrtc_dtls_transport_send(transport->dtls_transport, buffer);
+    if (error) {
+        DEBUG_WARNING("Could not send, error: %m\n", error);
+        return;
+    }
+}
+
+#ifdef RAWRTC_HAVE_MMSG
+/*
+ * Send queued packets with as few `sendmmsg` calls as possible.
+ * Sent packets will be removed from the queue.
+ */
+static void send_queued_packets_mmsg(
+        struct rawrtc_sctp_redirect_transport* const transport // not checked
+) {
+    struct mmsghdr messages[RAWRTC_SCTP_REDIRECT_TRANSPORT_BATCH_SIZE];
+    struct iovec vectors[RAWRTC_SCTP_REDIRECT_TRANSPORT_BATCH_SIZE];
+    struct sa* const destination = &transport->redirect_address;
+    struct le* le;
+    unsigned int n;
+    int n_sent;
+    int i;
+
+    while (!list_isempty(&transport->buffers_out)) {
+        // Prepare messages
+        memset(messages, 0, sizeof(messages));
+        for (n = 0, le = list_head(&transport->buffers_out);
+             le != NULL && n < RAWRTC_SCTP_REDIRECT_TRANSPORT_BATCH_SIZE; ++n, le = le->next) {
+            struct rawrtc_buffered_message* const buffered_message = le->data;
+            vectors[n].iov_base = mbuf_buf(buffered_message->buffer);
+            vectors[n].iov_len = mbuf_get_left(buffered_message->buffer);
+            messages[n].msg_hdr.msg_name = &destination->u.sa;
+            messages[n].msg_hdr.msg_namelen = destination->len;
+            messages[n].msg_hdr.msg_iov = &vectors[n];
+            messages[n].msg_hdr.msg_iovlen = 1;
         }
-        DEBUG_PRINTF("Received %zu bytes via RAW from %j\n", mbuf_get_left(buffer), &from);
-        if (!sa_isset(&from, SA_ADDR) && !sa_cmp(&transport->redirect_address, &from, SA_ADDR)) {
-            DEBUG_WARNING("Ignoring data from unknown address");
+
+        // Send
+        DEBUG_PRINTF("Redirecting %u messages to %J\n", n, destination);
+        n_sent = sendmmsg(transport->demux->socket, messages, n, 0);
+        ++transport->statistics.send_calls;
+        if (n_sent < 0) {
+            // Note: Remaining packets will be sent one by one
+            DEBUG_WARNING("Unable to redirect batch: %m\n", errno);
             return;
         }
+        transport->statistics.packets_sent += (uint64_t) n_sent;
 
-        // Skip IPv4 header
-        header_length = (size_t) (mbuf_read_u8(buffer) & 0xf);
-        mbuf_advance(buffer, -1);
-        DEBUG_PRINTF("RAW IPv4 header length: %zu\n", header_length);
-        mbuf_advance(buffer, header_length * 4);
-
-        // Read source and destination port
-        source = ntohs(mbuf_read_u16(buffer));
-        destination = ntohs(mbuf_read_u16(buffer));
-        sa_set_port(&from, source);
-        (void) destination;
-        DEBUG_PRINTF("RAW from %J to %"PRIu16"\n", &from, destination);
-        mbuf_advance(buffer, -4);
-
-        // Is this from the correct source?
-        if (source != sa_port(&transport->redirect_address)) {
-            DEBUG_WARNING("Ignored data from different source\n");
-            return;
+        // Remove sent packets
+        for (i = 0; i < n_sent; ++i) {
+            le = list_head(&transport->buffers_out);
+            list_unlink(le);
+            mem_deref(le->data);
         }
+    }
+}
+#endif
 
-        // Update SCTP header with changed ports
-        patch_sctp_header(buffer, transport->local_port, transport->remote_port);
+/*
+ * Send all queued packets over the raw socket.
+ */
+static void send_queued_packets(
+        struct rawrtc_sctp_redirect_transport* const transport // not checked
+) {
+    struct le* le;
+    ssize_t length;
 
-        // Send data
-        error = rawrtc_dtls_transport_send(transport->dtls_transport, buffer);
-        if (error) {
-            DEBUG_WARNING("Could not send, error: %m\n", error);
-            return;
+    // Stop flush timer
+    tmr_cancel(&transport->flush_timer);
+
+#ifdef RAWRTC_HAVE_MMSG
+    // Send packets in batches
+    send_queued_packets_mmsg(transport);
+#endif
+
+    // Send remaining packets one by one
+    while ((le = list_head(&transport->buffers_out))) {
+        struct rawrtc_buffered_message* const buffered_message = le->data;
+        struct mbuf* const buffer = buffered_message->buffer;
+        list_unlink(le);
+
+        // Send over raw socket
+        DEBUG_PRINTF("Redirecting message (%zu bytes) to %J\n",
+                mbuf_get_left(buffer), &transport->redirect_address);
+        length = sendto(transport->demux->socket, mbuf_buf(buffer), mbuf_get_left(buffer), 0,
+                &transport->redirect_address.u.sa, transport->redirect_address.len);
+        ++transport->statistics.send_calls;
+        if (length == -1) {
+            DEBUG_WARNING("Unable to redirect message: %m\n", errno);
+        } else {
+            ++transport->statistics.packets_sent;
         }
+        mem_deref(buffered_message);
     }
 }
 
+/*
+ * Flush queued packets once the event loop has handled all pending
+ * events.
+ */
+static void flush_timer_handler(
+        void* arg
+) {
+    struct rawrtc_sctp_redirect_transport* const transport = arg;
+    send_queued_packets(transport);
+}
+
 /*
  * Handle incoming messages (that are sent out via the raw socket).
  */
@@ -145,7 +252,7 @@ static void redirect_to_raw(
         void* const arg
 ) {
     struct rawrtc_sctp_redirect_transport* const transport = arg;
-    ssize_t length;
+    enum rawrtc_code error;
 
     // Check state
     if (transport->state != RAWRTC_SCTP_REDIRECT_TRANSPORT_STATE_OPEN) {
@@ -155,18 +262,24 @@ static void redirect_to_raw(
     }
 
     // Update SCTP header with changed ports
-    patch_sctp_header(buffer, transport->local_port, sa_port(&transport->redirect_address));
-
-    // Send over raw socket
-    DEBUG_PRINTF("Redirecting message (%zu bytes) to %J\n",
-            mbuf_get_left(buffer), &transport->redirect_address);
-    length = sendto(transport->socket, mbuf_buf(buffer), mbuf_get_left(buffer), 0,
-            &transport->redirect_address.u.sa, transport->redirect_address.len);
-    if (length == -1) {
-        DEBUG_WARNING("Unable to redirect message: %m\n", errno);
+    patch_sctp_header(
+            transport, buffer, transport->local_port, sa_port(&transport->redirect_address));
+
+    // Queue packet
+    // Note: libre allocates a buffer for each decrypted record, so we can safely reference it
+    //       instead of copying.
+    error = rawrtc_message_buffer_append(&transport->buffers_out, buffer, NULL);
+    if (error) {
+        DEBUG_WARNING("Could not queue packet, reason: %s\n", rawrtc_code_to_str(error));
         return;
     }
-    mbuf_advance(buffer, length);
+
+    // Send once the batch is full or all packets of this event loop iteration have been queued
+    if (list_count(&transport->buffers_out) >= RAWRTC_SCTP_REDIRECT_TRANSPORT_BATCH_SIZE) {
+        send_queued_packets(transport);
+    } else if (!tmr_isrunning(&transport->flush_timer)) {
+        tmr_start(&transport->flush_timer, 0, flush_timer_handler, transport);
+    }
 }
 
 /*
@@ -179,17 +292,18 @@ static void set_state(
 ) {
     // Closed?
     if (state == RAWRTC_SCTP_REDIRECT_TRANSPORT_STATE_CLOSED) {
-        // Stop listening and close raw socket
-        if (transport->socket != -1) {
-            fd_close(transport->socket);
-            if (close(transport->socket)) {
-                DEBUG_WARNING("Closing raw socket failed: %m\n", errno);
-            }
+        // Stop receiving from the shared raw socket
+        if (transport->demux) {
+            rawrtc_sctp_redirect_demux_unregister(transport->demux, transport);
         }
 
         // Remove from DTLS transport
         // Note: No NULL checking needed as the function will do that for us
         rawrtc_dtls_transport_clear_data_transport(transport->dtls_transport);
+
+        // Drop queued packets
+        tmr_cancel(&transport->flush_timer);
+        list_flush(&transport->buffers_out);
     }
 
     // Set state
@@ -210,8 +324,8 @@ static void rawrtc_sctp_redirect_transport_destroy(
     rawrtc_sctp_redirect_transport_stop(transport);
 
     // Un-reference
+    mem_deref(transport->demux);
     mem_deref(transport->dtls_transport);
-    mem_deref(transport->buffer);
 }
 
 /*
@@ -258,28 +372,20 @@ enum rawrtc_code rawrtc_sctp_redirect_transport_create(
     transport->state = RAWRTC_SCTP_REDIRECT_TRANSPORT_STATE_NEW;
     transport->dtls_transport = mem_ref(dtls_transport);
     transport->local_port = port ? port : RAWRTC_SCTP_REDIRECT_TRANSPORT_DEFAULT_PORT;
+    list_init(&transport->buffers_out);
+    tmr_init(&transport->flush_timer);
     error = rawrtc_error_to_code(sa_set_str(
             &transport->redirect_address, redirect_ip, redirect_port));
     if (error) {
         goto out;
     }
 
-    // Create buffer
-    transport->buffer = mbuf_alloc(2048);
-    if (!transport->buffer) {
-        error = RAWRTC_CODE_NO_MEMORY;
-        goto out;
-    }
-
-    // Create raw socket
-    transport->socket = socket(AF_INET, SOCK_RAW, IPPROTO_SCTP);
-    if (transport->socket == -1) {
-        error = rawrtc_error_to_code(errno);
+    // Get shared raw socket
+    error = rawrtc_sctp_redirect_demux_get(&transport->demux);
+    if (error) {
         goto out;
     }
 
-    // TODO: Set non-blocking
-
 out:
     if (error) {
         mem_deref(transport);
@@ -318,16 +424,15 @@ enum rawrtc_code rawrtc_sctp_redirect_transport_start(
     // Store remote port
     transport->remote_port = remote_port;
 
-    // Listen on raw socket
-    error = rawrtc_error_to_code(fd_listen(
-            transport->socket, FD_READ, redirect_from_raw, transport));
+    // Receive from the shared raw socket
+    error = rawrtc_sctp_redirect_demux_register(transport->demux, transport);
     if (error) {
         goto out;
     }
 
     // Attach to ICE transport
     error = rawrtc_dtls_transport_set_data_transport(
-            transport->dtls_transport, redirect_to_raw, transport);
+            transport->dtls_transport, redirect_to_raw, NULL, transport);
     if (error) {
         goto out;
     }
@@ -338,8 +443,8 @@ enum rawrtc_code rawrtc_sctp_redirect_transport_start(
 
 out:
     if (error) {
-        // Stop listening on raw socket
-        fd_close(transport->socket);
+        // Stop receiving from the shared raw socket
+        rawrtc_sctp_redirect_demux_unregister(transport->demux, transport);
     }
     return error;
 }
@@ -365,6 +470,25 @@ enum rawrtc_code rawrtc_sctp_redirect_transport_stop(
     return RAWRTC_CODE_SUCCESS;
 }
 
+/*
+ * Set whether the checksum of redirected packets is being patched
+ * incrementally (`true`) or recalculated over the whole packet
+ * (`false`, default) when their ports are being rewritten.
+ */
+enum rawrtc_code rawrtc_sctp_redirect_transport_set_incremental_checksum(
+        struct rawrtc_sctp_redirect_transport* const transport,
+        bool const incremental
+) {
+    // Check arguments
+    if (!transport) {
+        return RAWRTC_CODE_INVALID_ARGUMENT;
+    }
+
+    // Set setting
+    transport->incremental_checksum = incremental;
+    return RAWRTC_CODE_SUCCESS;
+}
+
 /*
  * Get the redirected local SCTP port of the SCTP redirect transport.
  */
@@ -383,3 +507,24 @@ enum rawrtc_code rawrtc_sctp_redirect_transport_get_port(
     // Done
     return RAWRTC_CODE_SUCCESS;
 }
+
+/*
+ * Get a snapshot of the SCTP redirect transport's statistics.
+ */
+enum rawrtc_code rawrtc_sctp_redirect_transport_get_statistics(
+        struct rawrtc_sctp_redirect_transport_statistics* const statisticsp, // written into
+        struct rawrtc_sctp_redirect_transport* const transport
+) {
+    // Check arguments
+    if (!statisticsp || !transport) {
+        return RAWRTC_CODE_INVALID_ARGUMENT;
+    }
+
+    // Copy statistics
+    // Note: Receive calls are those of the raw socket shared with other transports.
+    *statisticsp = transport->statistics;
+    statisticsp->receive_calls = transport->demux->receive_calls;
+
+    // Done
+    return RAWRTC_CODE_SUCCESS;
+}
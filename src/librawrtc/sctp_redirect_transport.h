@@ -1,4 +1,14 @@
 #pragma once
 #include <inttypes.h>
+#include <netinet/in.h> // struct sockaddr_in
+#include <rawrtc.h>
 
 #define RAWRTC_SCTP_REDIRECT_TRANSPORT_DEFAULT_PORT (uint16_t) 5000
+#define RAWRTC_SCTP_REDIRECT_TRANSPORT_COMMON_HEADER_SIZE 12
+#define RAWRTC_SCTP_REDIRECT_TRANSPORT_BUFFER_SIZE 2048
+
+void rawrtc_sctp_redirect_transport_receive(
+    struct rawrtc_sctp_redirect_transport* const transport, // not checked
+    struct mbuf* const buffer, // not checked
+    struct sockaddr_in* const from_address // not checked
+);
@@ -1,6 +1,8 @@
+#include <pthread.h> // pthread_mutex_*
 #include <stdio.h> // fopen
 #include <string.h> // memcpy, strlen
 #include <errno.h> // errno
+#include <time.h> // clock_gettime
 #include <sys/socket.h> // AF_INET, SOCK_STREAM, linger
 #include <netinet/in.h> // IPPROTO_UDP, IPPROTO_TCP, htons
 #if (RAWRTC_DEBUG_LEVEL >= 7)
@@ -11,6 +13,7 @@
 #include "main.h"
 #include "utils.h"
 #include "message_buffer.h"
+#include "sid_map.h"
 #include "dtls_transport.h"
 #include "data_transport.h"
 #include "data_channel_parameters.h"
@@ -30,6 +33,19 @@ struct send_context {
     int flags;
 };
 
+// Streamed outgoing message of a data channel
+struct rawrtc_sctp_message_stream {
+    rawrtc_data_channel_message_producer* producer;
+    void* arg; // nullable
+    size_t window;
+    struct sctp_sendv_spa spa;
+    struct mbuf* pending; // nullable, last part produced (held back until the next one)
+    uint64_t length;
+    bool is_binary;
+    bool started;
+    bool producing;
+};
+
 // Events to subscribe to
 static uint16_t const sctp_events[] = {
     SCTP_ASSOC_CHANGE,
@@ -48,6 +64,7 @@ static size_t const sctp_events_length = ARRAY_SIZE(sctp_events);
 static enum rawrtc_code channel_context_create(
     struct rawrtc_sctp_data_channel_context** const contextp, // de-referenced, not checked
     uint16_t const sid,
+    uint_fast16_t const priority,
     bool const can_send_unordered
 );
 
@@ -56,7 +73,7 @@ static bool channel_registered(
     struct rawrtc_data_channel* const channel // not checked
 );
 
-static void channel_register(
+static enum rawrtc_code channel_register(
     struct rawrtc_sctp_transport* const transport, // not checked
     struct rawrtc_data_channel* const channel, // referenced, not checked
     struct rawrtc_sctp_data_channel_context* const context, // referenced, not checked
@@ -72,12 +89,49 @@ enum rawrtc_code sctp_transport_send(
     int const flags
 );
 
+static enum rawrtc_code sctp_transport_send_or_buffer(
+    size_t* const n_sentp, // de-referenced, not checked
+    struct rawrtc_sctp_transport* const transport, // not checked
+    struct rawrtc_sctp_data_channel_context* const context, // not checked
+    struct mbuf* const * const buffers, // not checked
+    size_t const n_buffers,
+    void* const info, // not checked
+    socklen_t const info_size,
+    unsigned int const info_type,
+    int const flags
+);
+
+static enum rawrtc_code reset_outgoing_stream(
+    struct rawrtc_sctp_transport* const transport, // not checked
+    struct rawrtc_data_channel* const channel // not checked
+);
+
+static void stream_produce(
+    struct rawrtc_sctp_transport* const transport, // not checked
+    struct rawrtc_sctp_data_channel_context* const context // not checked
+);
+
+#ifdef RAWRTC_HAVE_USRSCTP_INIT_NOTHREADS
+static void timer_handler(
+    void* arg
+);
+#endif
+
+static void packet_send(
+    struct rawrtc_sctp_transport* const transport, // not checked
+    void* const buffer,
+    size_t const length
+);
+
+static void upcall_handle(
+    struct rawrtc_sctp_transport* const transport // not checked
+);
+
 /*
  * Parse a data channel open message.
  */
 static enum rawrtc_code data_channel_open_message_parse(
         struct rawrtc_data_channel_parameters** const parametersp, // de-referenced, not checked
-        uint_fast16_t* const priorityp, // de-referenced, not checked
         uint16_t const id,
         struct mbuf* const buffer // not checked
 ) {
@@ -159,15 +213,14 @@ static enum rawrtc_code data_channel_open_message_parse(
         goto out;
     }
 
+    // Set priority
+    (*parametersp)->priority = (uint16_t) priority;
+
 out:
     // Un-reference
     mem_deref(label);
     mem_deref(protocol);
 
-    if (!error) {
-        // Set priority value
-        *priorityp = priority;
-    }
     return error;
 }
 
@@ -203,7 +256,7 @@ static enum rawrtc_code data_channel_open_message_create(
     // Set fields
     err = mbuf_write_u8(buffer, RAWRTC_DCEP_MESSAGE_TYPE_OPEN);
     err |= mbuf_write_u8(buffer, parameters->channel_type);
-    err |= mbuf_write_u16(buffer, htons(RAWRTC_DCEP_CHANNEL_PRIORITY_NORMAL)); // TODO: Ok?
+    err |= mbuf_write_u16(buffer, htons(parameters->priority));
     err |= mbuf_write_u32(buffer, htonl(parameters->reliability_parameter));
     err |= mbuf_write_u16(buffer, htons((uint16_t) label_length));
     err |= mbuf_write_u16(buffer, htons((uint16_t) protocol_length));
@@ -302,6 +355,152 @@ static void trace_packet(
     }
 }
 
+/*
+ * Start gathering outgoing SCTP packets (re-entrant).
+ * Caller MUST hold the event loop mutex until the batch has been left.
+ */
+void rawrtc_sctp_transport_packet_batch_enter(void) {
+    ++rawrtc_shard_current()->usrsctp_batch_depth;
+}
+
+/*
+ * Stop gathering outgoing SCTP packets (re-entrant).
+ * Once the outermost batch has been left, the gathered packets of each
+ * transport will be flushed.
+ */
+void rawrtc_sctp_transport_packet_batch_leave(void) {
+    struct rawrtc_shard* const shard = rawrtc_shard_current();
+    struct le* le;
+
+    // Still within a batch?
+    --shard->usrsctp_batch_depth;
+    if (shard->usrsctp_batch_depth > 0) {
+        return;
+    }
+
+    // Flush gathered packets of each transport
+    while ((le = list_head(&shard->usrsctp_batch_transports))) {
+        struct rawrtc_sctp_transport* const transport = le->data;
+        list_unlink(le);
+        rawrtc_dtls_transport_batch_flush(transport->dtls_transport);
+    }
+}
+
+#ifdef RAWRTC_HAVE_USRSCTP_INIT_NOTHREADS
+/*
+ * (Re)start the shard's SCTP timer with a specific interval.
+ */
+static void timer_schedule(
+        struct rawrtc_shard* const shard, // not checked
+        uint32_t const interval
+) {
+    shard->usrsctp_tick_interval = interval;
+    tmr_start(&shard->usrsctp_tick_timer, interval, timer_handler, shard);
+}
+#endif
+
+#ifdef RAWRTC_HAVE_USRSCTP_GET_TIMEOUT
+/*
+ * Get the time until usrsctp's next timer expires (in milliseconds).
+ * The idle interval is returned in case no timer is pending, as SCTP
+ * activity re-arms the timer.
+ * Note: usrsctp's clock only advances when its timers are being
+ *       handled, so its timeout is relative to the last tick.
+ */
+static uint32_t timer_deadline(void) {
+    int const timeout = usrsctp_get_timeout();
+    uint64_t const tick_time = __atomic_load_n(
+            &rawrtc_global.usrsctp_tick_time, __ATOMIC_RELAXED);
+    uint64_t const now = tmr_jiffies();
+    uint64_t deadline;
+
+    // No timer pending?
+    if (timeout < 0) {
+        return rawrtc_default_config.sctp_timer_idle_interval;
+    }
+
+    // Calculate time until deadline
+    // Note: At least 1 ms, so a shard waiting for another shard that is driving the timers
+    //       right now does not spin.
+    deadline = tick_time + (uint64_t) timeout;
+    if (deadline <= now) {
+        return 1;
+    } else if (deadline - now > rawrtc_default_config.sctp_timer_idle_interval) {
+        return rawrtc_default_config.sctp_timer_idle_interval;
+    } else {
+        return (uint32_t) (deadline - now);
+    }
+}
+#endif
+
+/*
+ * Note SCTP activity on a shard. Arms the shard's SCTP timer for
+ * usrsctp's next timer deadline in case it is earlier. Without
+ * `usrsctp_get_timeout`, resets the timer to the regular interval in
+ * case it has been backed off instead.
+ */
+static void timer_activity(
+        struct rawrtc_shard* const shard // not checked
+) {
+    shard->usrsctp_activity_time = tmr_jiffies();
+#if defined(RAWRTC_HAVE_USRSCTP_GET_TIMEOUT)
+    // Note: Sending or receiving may have started a timer, e.g. for a retransmission.
+    if (shard->usrsctp_transports > 0) {
+        uint32_t const interval = timer_deadline();
+        if (interval < tmr_get_expire(&shard->usrsctp_tick_timer)) {
+            timer_schedule(shard, interval);
+        }
+    }
+#elif defined(RAWRTC_HAVE_USRSCTP_INIT_NOTHREADS)
+    if (shard->usrsctp_tick_interval > rawrtc_default_config.sctp_timer_interval) {
+        timer_schedule(shard, rawrtc_default_config.sctp_timer_interval);
+    }
+#endif
+}
+
+/*
+ * Mark the transport as busy (awaiting acknowledgements) or not.
+ * The shard's SCTP timer will not be backed off while any of its
+ * transports is busy.
+ */
+static void set_busy(
+        struct rawrtc_sctp_transport* const transport, // not checked
+        bool const busy
+) {
+    // Unchanged?
+    if (busy == !!(transport->flags & RAWRTC_SCTP_TRANSPORT_FLAGS_BUSY)) {
+        return;
+    }
+
+    // Update flag and counter
+    if (busy) {
+        transport->flags |= RAWRTC_SCTP_TRANSPORT_FLAGS_BUSY;
+        ++transport->shard->usrsctp_busy_transports;
+        timer_activity(transport->shard);
+    } else {
+        transport->flags &= ~RAWRTC_SCTP_TRANSPORT_FLAGS_BUSY;
+        --transport->shard->usrsctp_busy_transports;
+    }
+}
+
+/*
+ * Check if the SCTP send info marks the end of a record (message).
+ */
+static bool send_info_eor(
+        void* const info, // not checked
+        unsigned int const info_type
+) {
+    switch (info_type) {
+        case SCTP_SENDV_SNDINFO:
+            return ((struct sctp_sndinfo*) info)->snd_flags & SCTP_EOR ? true : false;
+        case SCTP_SENDV_SPA:
+            return ((struct sctp_sendv_spa*) info)->sendv_sndinfo.snd_flags & SCTP_EOR ?
+                   true : false;
+        default:
+            return true;
+    }
+}
+
 /*
  * Send a deferred SCTP message.
  */
@@ -356,36 +555,228 @@ out:
     return true;
 }
 
+/*
+ * Raise buffered amount low on a data channel.
+ */
+static void raise_buffered_amount_low_event(
+        struct rawrtc_data_channel* const channel // not checked
+) {
+    // Get context
+    struct rawrtc_sctp_data_channel_context* const context = channel->transport_arg;
+
+    // Mark as raised (until the next message is being sent)
+    context->flags |= RAWRTC_SCTP_DATA_CHANNEL_FLAGS_BUFFERED_AMOUNT_LOW;
+
+    // Check for event handler
+    if (channel->buffered_amount_low_handler) {
+        // Raise event
+        DEBUG_PRINTF("Raising buffered amount low event on channel with SID %"PRIu16"\n",
+                     context->sid);
+        channel->buffered_amount_low_handler(channel->arg);
+    }
+}
+
+/*
+ * Decrease the buffered amount of a data channel context.
+ * Raises the buffered amount low event in case the data channel's threshold has been crossed.
+ */
+static void decrease_buffered_amount(
+        struct rawrtc_sctp_transport* const transport, // not checked
+        struct rawrtc_sctp_data_channel_context* const context, // not checked
+        uint64_t const amount
+) {
+    struct rawrtc_data_channel* channel;
+    uint64_t const previous_amount = context->buffered_amount;
+
+    // Update buffered amount
+    context->buffered_amount = amount < previous_amount ? previous_amount - amount : 0;
+
+    // Get data channel (the default context has none)
+    channel = rawrtc_sid_map_get(transport->channels, context->sid);
+    if (!channel || channel->transport_arg != context) {
+        return;
+    }
+
+    // Raise event (if the threshold has been crossed)
+    if (previous_amount > channel->buffered_amount_low_threshold &&
+            context->buffered_amount <= channel->buffered_amount_low_threshold) {
+        raise_buffered_amount_low_event(channel);
+    }
+}
+
+/*
+ * Calculate the virtual finish time of the next buffered message of a data channel context.
+ * Note: The cost of a message is inversely proportional to the priority of the data channel,
+ *       so channels receive a share of the bandwidth that is proportional to their priority.
+ */
+static uint64_t scheduler_finish_time(
+        struct rawrtc_sctp_transport* const transport, // not checked
+        struct rawrtc_sctp_data_channel_context* const context // not checked
+) {
+    struct rawrtc_buffered_message* const message =
+            list_ledata(list_head(&context->buffered_messages_outgoing));
+    uint64_t const start_time = context->virtual_finish_time > transport->virtual_time ?
+                                context->virtual_finish_time : transport->virtual_time;
+    uint64_t const cost = (uint64_t) mbuf_get_left(message->buffer) *
+                          RAWRTC_DCEP_CHANNEL_PRIORITY_EXTRA_HIGH / context->priority;
+    return start_time + cost;
+}
+
+/*
+ * Select the data channel context whose next buffered message should be sent.
+ * Uses self-clocked fair queueing: The context with the smallest virtual finish time wins.
+ */
+static struct rawrtc_sctp_data_channel_context* scheduler_next_context(
+        uint64_t* const finish_timep, // de-referenced, not checked
+        struct rawrtc_sctp_transport* const transport // not checked
+) {
+    struct le* le;
+    struct rawrtc_sctp_data_channel_context* next = NULL;
+    uint64_t next_finish_time = UINT64_MAX;
+
+    // A partially sent message must be completed first (usrsctp locks the stream until EOR)
+    // Note: The next part of a streamed message may not have been produced, yet.
+    if (transport->context_sending) {
+        if (list_isempty(&transport->context_sending->buffered_messages_outgoing)) {
+            return NULL;
+        }
+        *finish_timep = transport->context_sending->virtual_finish_time;
+        return transport->context_sending;
+    }
+
+    // Find context with the smallest virtual finish time
+    for (le = list_head(&transport->contexts_outgoing); le != NULL; le = le->next) {
+        struct rawrtc_sctp_data_channel_context* const context = le->data;
+        uint64_t const finish_time = scheduler_finish_time(transport, context);
+        if (finish_time < next_finish_time) {
+            next = context;
+            next_finish_time = finish_time;
+        }
+    }
+
+    // Done
+    *finish_timep = next_finish_time;
+    return next;
+}
+
 /*
  * Send all deferred messages.
+ * Will return `RAWRTC_CODE_STOP_ITERATION` in case usrsctp's buffer is full.
  */
 static enum rawrtc_code sctp_send_deferred_messages(
         struct rawrtc_sctp_transport* const transport // not checked
 ) {
-    // Send buffered outgoing SCTP packets
-    return rawrtc_message_buffer_clear(
-            &transport->buffered_messages_outgoing, sctp_send_deferred_message, transport);
+    struct rawrtc_sctp_data_channel_context* context;
+    uint64_t finish_time;
+
+    // Send buffered outgoing SCTP messages in the order determined by the scheduler
+    while ((context = scheduler_next_context(&finish_time, transport))) {
+        struct le* const le = list_head(&context->buffered_messages_outgoing);
+        struct rawrtc_buffered_message* const message = le->data;
+        size_t const length = mbuf_get_left(message->buffer);
+        bool sent;
+
+        // Try sending
+        sent = sctp_send_deferred_message(message->buffer, message->context, transport);
+
+        // Advance virtual time (if the message has been started)
+        if (context != transport->context_sending && mbuf_get_left(message->buffer) < length) {
+            context->virtual_finish_time = finish_time;
+            transport->virtual_time = finish_time;
+        }
+
+        // Stop (if usrsctp's buffer is full)
+        if (!sent) {
+            size_t const left = mbuf_get_left(message->buffer);
+
+            // Lock the context (if the message has been sent partially)
+            if (left < length) {
+                transport->context_sending = context;
+            }
+
+            // Update buffered amount
+            decrease_buffered_amount(transport, context, length - left);
+            return RAWRTC_CODE_STOP_ITERATION;
+        }
+
+        // Keep the context locked until the end of the record has been sent
+        {
+            struct send_context* const send_context = message->context;
+            transport->context_sending =
+                    send_info_eor(&send_context->info, send_context->info_type) ? NULL : context;
+        }
+
+        // Remove message
+        // Note: The context is referenced until the end of this iteration as the buffered amount
+        //       low handler may close the data channel.
+        mem_ref(context);
+        list_unlink(le);
+        mem_deref(message);
+
+        // Remove context (if drained)
+        if (list_isempty(&context->buffered_messages_outgoing)) {
+            list_unlink(&context->le);
+            mem_deref(context);
+
+            // Reset pending outgoing stream
+            // Note: All messages of the data channel have been handed to usrsctp at this point.
+            if (context->flags & RAWRTC_SCTP_DATA_CHANNEL_FLAGS_PENDING_STREAM_RESET) {
+                struct rawrtc_data_channel* const channel = rawrtc_sid_map_get(
+                        transport->channels, context->sid);
+                context->flags &= ~RAWRTC_SCTP_DATA_CHANNEL_FLAGS_PENDING_STREAM_RESET;
+                if (channel && channel->transport_arg == context) {
+                    reset_outgoing_stream(transport, channel);
+                }
+            }
+        }
+
+        // Update buffered amount & continue producing a streamed message (if any)
+        decrease_buffered_amount(transport, context, length);
+        if (context->stream) {
+            stream_produce(transport, context);
+        }
+        mem_deref(context);
+    }
+
+    // Done
+    return RAWRTC_CODE_SUCCESS;
+}
+
+/*
+ * Discard all deferred messages.
+ */
+static void sctp_discard_deferred_messages(
+        struct rawrtc_sctp_transport* const transport // not checked
+) {
+    struct le* le;
+
+    // Flush each context's messages
+    for (le = list_head(&transport->contexts_outgoing); le != NULL; le = le->next) {
+        struct rawrtc_sctp_data_channel_context* const context = le->data;
+        list_flush(&context->buffered_messages_outgoing);
+        context->buffered_amount = 0;
+    }
+
+    // Remove contexts
+    list_flush(&transport->contexts_outgoing);
+    transport->context_sending = NULL;
 }
 
 /*
- * Send an SCTP message on the data channel.
- * TODO: Add EOR marking and some kind of an id (does ndata provide that?)
+ * Initialise the SCTP send info for a message on a data channel.
  */
-static enum rawrtc_code send_message(
-        struct rawrtc_sctp_transport* const transport, // not checked
+static enum rawrtc_code send_info_init(
+        struct sctp_sendv_spa* const spa, // not checked
         struct rawrtc_data_channel* const channel, // nullable (if DCEP message)
         struct rawrtc_sctp_data_channel_context* const context, // not checked
-        struct mbuf* const buffer, // not checked
         uint_fast32_t const ppid
 ) {
-    struct sctp_sendv_spa spa = {0};
-    enum rawrtc_code error;
-
     // Set stream identifier, protocol identifier and flags
-    spa.sendv_sndinfo.snd_sid = context->sid;
-    spa.sendv_sndinfo.snd_flags = SCTP_EOR; // TODO: Update signature
-    spa.sendv_sndinfo.snd_ppid = htonl((uint32_t) ppid);
-    spa.sendv_flags = SCTP_SEND_SNDINFO_VALID;
+    memset(spa, 0, sizeof(*spa));
+    spa->sendv_sndinfo.snd_sid = context->sid;
+    spa->sendv_sndinfo.snd_flags = SCTP_EOR; // TODO: Update signature
+    spa->sendv_sndinfo.snd_ppid = htonl((uint32_t) ppid);
+    spa->sendv_flags = SCTP_SEND_SNDINFO_VALID;
 
     // Set ordered/unordered and partial reliability policy
     if (ppid != RAWRTC_SCTP_TRANSPORT_PPID_DCEP) {
@@ -397,7 +788,7 @@ static enum rawrtc_code send_message(
         // Unordered?
         if (channel->parameters->channel_type & RAWRTC_DATA_CHANNEL_TYPE_IS_UNORDERED &&
                 context->flags & RAWRTC_SCTP_DATA_CHANNEL_FLAGS_CAN_SEND_UNORDERED) {
-            spa.sendv_sndinfo.snd_flags |= SCTP_UNORDERED;
+            spa->sendv_sndinfo.snd_flags |= SCTP_UNORDERED;
         }
 
         // Partial reliability policy
@@ -405,25 +796,56 @@ static enum rawrtc_code send_message(
             case RAWRTC_DATA_CHANNEL_TYPE_UNRELIABLE_ORDERED_RETRANSMIT:
             case RAWRTC_DATA_CHANNEL_TYPE_UNRELIABLE_UNORDERED_RETRANSMIT:
                 // Set amount of retransmissions
-                spa.sendv_prinfo.pr_policy = SCTP_PR_SCTP_RTX;
-                spa.sendv_prinfo.pr_value = channel->parameters->reliability_parameter;
-                spa.sendv_flags |= SCTP_SEND_PRINFO_VALID;
+                spa->sendv_prinfo.pr_policy = SCTP_PR_SCTP_RTX;
+                spa->sendv_prinfo.pr_value = channel->parameters->reliability_parameter;
+                spa->sendv_flags |= SCTP_SEND_PRINFO_VALID;
             case RAWRTC_DATA_CHANNEL_TYPE_UNRELIABLE_ORDERED_TIMED:
             case RAWRTC_DATA_CHANNEL_TYPE_UNRELIABLE_UNORDERED_TIMED:
                 // Set TTL
-                spa.sendv_prinfo.pr_policy = SCTP_PR_SCTP_TTL;
-                spa.sendv_prinfo.pr_value = channel->parameters->reliability_parameter;
-                spa.sendv_flags |= SCTP_SEND_PRINFO_VALID;
+                spa->sendv_prinfo.pr_policy = SCTP_PR_SCTP_TTL;
+                spa->sendv_prinfo.pr_value = channel->parameters->reliability_parameter;
+                spa->sendv_flags |= SCTP_SEND_PRINFO_VALID;
             default:
                 // Nothing to do
                 break;
         }
     }
 
-    // Send message
-    DEBUG_PRINTF("Sending message with SID %"PRIu16", PPID: %"PRIu32"\n", context->sid, ppid);
-    error = rawrtc_sctp_transport_send(
-            transport, buffer, &spa, sizeof(spa), SCTP_SENDV_SPA, 0);
+    // Done
+    return RAWRTC_CODE_SUCCESS;
+}
+
+/*
+ * Send SCTP messages with the same PPID on the data channel.
+ * `*n_sentp` will contain the amount of messages that have been sent or buffered.
+ * TODO: Add EOR marking and some kind of an id (does ndata provide that?)
+ */
+static enum rawrtc_code send_messages(
+        size_t* const n_sentp, // de-referenced, not checked
+        struct rawrtc_sctp_transport* const transport, // not checked
+        struct rawrtc_data_channel* const channel, // nullable (if DCEP message)
+        struct rawrtc_sctp_data_channel_context* const context, // not checked
+        struct mbuf* const * const buffers, // not checked
+        size_t const n_buffers,
+        uint_fast32_t const ppid
+) {
+    struct sctp_sendv_spa spa;
+    enum rawrtc_code error;
+
+    // Set amount of messages sent (in case of an early return)
+    *n_sentp = 0;
+
+    // Initialise send info
+    error = send_info_init(&spa, channel, context, ppid);
+    if (error) {
+        return error;
+    }
+
+    // Send messages
+    DEBUG_PRINTF("Sending %zu message(s) with SID %"PRIu16", PPID: %"PRIu32"\n",
+                 n_buffers, context->sid, ppid);
+    error = sctp_transport_send_or_buffer(
+            n_sentp, transport, context, buffers, n_buffers, &spa, sizeof(spa), SCTP_SENDV_SPA, 0);
     if (error) {
         DEBUG_WARNING("Unable to send message, reason: %s\n", rawrtc_code_to_str(error));
         return error;
@@ -434,68 +856,346 @@ static enum rawrtc_code send_message(
 }
 
 /*
- * Change the states of all data channels.
- * Caller MUST ensure that the same state is not set twice.
+ * Send an SCTP message on the data channel.
  */
-static void set_data_channel_states(
+static enum rawrtc_code send_message(
         struct rawrtc_sctp_transport* const transport, // not checked
-        enum rawrtc_data_channel_state const to_state,
-        enum rawrtc_data_channel_state const * const from_state // optional current state
+        struct rawrtc_data_channel* const channel, // nullable (if DCEP message)
+        struct rawrtc_sctp_data_channel_context* const context, // not checked
+        struct mbuf* const buffer, // not checked
+        uint_fast32_t const ppid
 ) {
-    uint_fast16_t i;
+    size_t n_sent;
+    return send_messages(&n_sent, transport, channel, context, &buffer, 1, ppid);
+}
 
-    // Set state on all data channels
-    for (i = 0; i < transport->n_channels; ++i) {
-        struct rawrtc_data_channel* const channel = transport->channels[i];
-        if (!channel) {
-            continue;
-        }
+/*
+ * Destructor for an existing message stream.
+ */
+static void message_stream_destroy(
+        void* arg
+) {
+    struct rawrtc_sctp_message_stream* const stream = arg;
 
-        // Update state
-        if (!from_state || channel->state == *from_state) {
-            rawrtc_data_channel_set_state(channel, to_state);
-        }
-    }
+    // Un-reference
+    mem_deref(stream->pending);
 }
 
 /*
- * Close all data channels.
- * Warning: This will not use the closing procedure, use `channel_close_handler` instead.
+ * Send (or buffer) the held back part of a streamed message.
  */
-static void close_data_channels(
-        struct rawrtc_sctp_transport* const transport // not checked
+static enum rawrtc_code stream_send_part(
+        struct rawrtc_sctp_transport* const transport, // not checked
+        struct rawrtc_sctp_data_channel_context* const context, // not checked
+        struct rawrtc_sctp_message_stream* const stream, // not checked
+        bool const last
 ) {
-    uint_fast16_t i;
-
-    // Set state on all data channels
-    for (i = 0; i < transport->n_channels; ++i) {
-        struct rawrtc_data_channel* const channel = transport->channels[i];
-        if (!channel) {
-            continue;
-        }
+    struct mbuf* const buffer = stream->pending;
+    size_t n_sent;
+    enum rawrtc_code error;
 
-        // Update state
-        DEBUG_PRINTF("Closing channel with SID %"PRIu16"\n", i);
-        rawrtc_data_channel_set_state(channel, RAWRTC_DATA_CHANNEL_STATE_CLOSED);
+    // Take the part
+    // Note: Sending may re-enter (e.g. by closing the data channel), so this MUST happen first.
+    stream->pending = NULL;
+    stream->started = true;
 
-        // Remove from transport
-        transport->channels[i] = mem_deref(channel);
+    // Mark the end of the record (if last part)
+    if (last) {
+        stream->spa.sendv_sndinfo.snd_flags |= SCTP_EOR;
+    } else {
+        stream->spa.sendv_sndinfo.snd_flags &= ~SCTP_EOR;
     }
+
+    // Send or buffer
+    DEBUG_PRINTF("Sending %zu bytes of streamed message on SID %"PRIu16" (last: %s)\n",
+                 mbuf_get_left(buffer), context->sid, last ? "yes" : "no");
+    error = sctp_transport_send_or_buffer(
+            &n_sent, transport, context, &buffer, 1,
+            &stream->spa, sizeof(stream->spa), SCTP_SENDV_SPA, 0);
+
+    // Un-reference
+    mem_deref(buffer);
+    return error;
 }
 
 /*
- * Change the state of the SCTP transport.
- * Will call the corresponding handler.
- * Caller MUST ensure that the same state is not set twice.
+ * Send an empty message in place of an empty streamed message.
  */
-static void set_state(
+static enum rawrtc_code stream_send_empty(
         struct rawrtc_sctp_transport* const transport, // not checked
-        enum rawrtc_sctp_transport_state const state
+        struct rawrtc_sctp_data_channel_context* const context, // not checked
+        struct rawrtc_sctp_message_stream* const stream // not checked
+) {
+    struct rawrtc_data_channel* const channel = rawrtc_sid_map_get(
+            transport->channels, context->sid);
+    uint_fast32_t const ppid = stream->is_binary ?
+            RAWRTC_SCTP_TRANSPORT_PPID_BINARY_EMPTY : RAWRTC_SCTP_TRANSPORT_PPID_UTF16_EMPTY;
+    struct mbuf* buffer;
+    enum rawrtc_code error;
+
+    // Create helper message as SCTP is unable to send messages of size 0
+    buffer = mbuf_alloc(RAWRTC_SCTP_TRANSPORT_EMPTY_MESSAGE_SIZE);
+    if (!buffer) {
+        return RAWRTC_CODE_NO_MEMORY;
+    }
+
+    // Note: The content is being ignored
+    error = rawrtc_error_to_code(mbuf_write_u8(buffer, 0));
+    if (error) {
+        goto out;
+    }
+    mbuf_set_pos(buffer, 0);
+
+    // Send
+    error = send_message(transport, channel, context, buffer, ppid);
+
+out:
+    // Un-reference
+    mem_deref(buffer);
+    return error;
+}
+
+/*
+ * Produce and send parts of a streamed message until the window is
+ * full or the last part has been sent.
+ * Note: A part is held back until the next part has been produced, so
+ *       the last part can be marked as the end of the record. The held
+ *       back part does not count against the window. Otherwise, a
+ *       window that is not larger than a part would be full before
+ *       anything has been sent and the stream would stall.
+ */
+static enum rawrtc_code stream_produce_parts(
+        struct rawrtc_sctp_transport* const transport, // not checked
+        struct rawrtc_sctp_data_channel_context* const context // not checked
+) {
+    struct rawrtc_sctp_message_stream* const stream = context->stream;
+    size_t const size = min(stream->window, (size_t) RAWRTC_SCTP_TRANSPORT_STREAM_PART_SIZE);
+    bool last = false;
+    enum rawrtc_code error = RAWRTC_CODE_SUCCESS;
+
+    // Already producing? (may be re-entered by handling usrsctp events while sending)
+    if (stream->producing) {
+        return RAWRTC_CODE_SUCCESS;
+    }
+    stream->producing = true;
+
+    // Note: The stream may be aborted while sending (e.g. by closing the data channel)
+    mem_ref(stream);
+
+    // Produce until the window is full
+    while (!last && context->stream == stream && context->buffered_amount < stream->window) {
+        size_t length;
+        struct mbuf* buffer = mbuf_alloc(size);
+        if (!buffer) {
+            error = RAWRTC_CODE_NO_MEMORY;
+            break;
+        }
+
+        // Produce part
+        error = stream->producer(buffer, &last, stream->arg);
+        if (error) {
+            mem_deref(buffer);
+            break;
+        }
+        mbuf_set_pos(buffer, 0);
+        length = mbuf_get_left(buffer);
+
+        // Check size
+        stream->length += length;
+        if (transport->remote_maximum_message_size != 0 &&
+                stream->length > transport->remote_maximum_message_size) {
+            mem_deref(buffer);
+            error = RAWRTC_CODE_MESSAGE_TOO_LONG;
+            break;
+        }
+
+        // Empty part?
+        if (length == 0) {
+            mem_deref(buffer);
+
+            // Only the last part may be empty
+            if (!last) {
+                error = RAWRTC_CODE_INVALID_STATE;
+                break;
+            }
+
+            // Send held back part as the last part (or an empty message)
+            if (stream->pending) {
+                error = stream_send_part(transport, context, stream, true);
+            } else {
+                error = stream_send_empty(transport, context, stream);
+            }
+            break;
+        }
+
+        // Send held back part
+        if (stream->pending) {
+            error = stream_send_part(transport, context, stream, false);
+            if (error) {
+                mem_deref(buffer);
+                break;
+            }
+        }
+
+        // Hold back part (or send it if it's the last one)
+        stream->pending = buffer;
+        if (last) {
+            error = stream_send_part(transport, context, stream, true);
+        }
+    }
+
+    // Remove stream (if complete)
+    stream->producing = false;
+    if (!error && last && context->stream == stream) {
+        DEBUG_PRINTF("Streamed message of %"PRIu64" bytes on SID %"PRIu16" complete\n",
+                     stream->length, context->sid);
+        context->stream = mem_deref(context->stream);
+    }
+
+    // Un-reference
+    mem_deref(stream);
+    return error;
+}
+
+/*
+ * Abort the streamed message of a data channel context.
+ * Return `true` in case parts of the message have been sent already. In
+ * that case, the message has been terminated early (if possible) and
+ * the data channel needs to be closed.
+ */
+static bool stream_abort(
+        struct rawrtc_sctp_transport* const transport, // not checked
+        struct rawrtc_sctp_data_channel_context* const context // not checked
+) {
+    struct rawrtc_sctp_message_stream* const stream = context->stream;
+    bool started;
+
+    // Remove stream
+    // Note: Our reference is being kept until the end of this function.
+    context->stream = NULL;
+    started = stream->started;
+
+    // Terminate message early (if started)
+    // Note: usrsctp locks the stream (and association) until the end of the record.
+    if (started && stream->pending) {
+        enum rawrtc_code const error = stream_send_part(transport, context, stream, true);
+        if (error) {
+            DEBUG_WARNING("Could not terminate streamed message, reason: %s\n",
+                          rawrtc_code_to_str(error));
+        }
+    }
+
+    // Un-reference
+    mem_deref(stream);
+    return started;
+}
+
+/*
+ * Handle an error while producing a streamed message: Abort the
+ * message and close the data channel (if parts have been sent).
+ */
+static void stream_fail(
+        struct rawrtc_sctp_transport* const transport, // not checked
+        struct rawrtc_sctp_data_channel_context* const context, // not checked
+        enum rawrtc_code const error
+) {
+    struct rawrtc_data_channel* const channel = rawrtc_sid_map_get(
+            transport->channels, context->sid);
+
+    // Abort
+    DEBUG_WARNING("Streamed message on SID %"PRIu16" failed, reason: %s\n",
+                  context->sid, rawrtc_code_to_str(error));
+    if (!context->stream || !stream_abort(transport, context)) {
+        return;
+    }
+
+    // Close data channel
+    if (channel && channel->transport_arg == context) {
+        rawrtc_data_channel_close(channel);
+    }
+}
+
+/*
+ * Continue producing a streamed message.
+ */
+static void stream_produce(
+        struct rawrtc_sctp_transport* const transport, // not checked
+        struct rawrtc_sctp_data_channel_context* const context // not checked
+) {
+    enum rawrtc_code const error = stream_produce_parts(transport, context);
+    if (error) {
+        stream_fail(transport, context, error);
+    }
+}
+
+/*
+ * Change the states of all data channels.
+ * Caller MUST ensure that the same state is not set twice.
+ */
+static void set_data_channel_states(
+        struct rawrtc_sctp_transport* const transport, // not checked
+        enum rawrtc_data_channel_state const to_state,
+        enum rawrtc_data_channel_state const * const from_state // optional current state
+) {
+    struct rawrtc_data_channel* channel;
+    uint16_t sid;
+
+    // Set state on all data channels
+    for (channel = rawrtc_sid_map_next(&sid, transport->channels, 0); channel != NULL;
+         channel = rawrtc_sid_map_next(&sid, transport->channels, sid + 1)) {
+        // Update state
+        if (!from_state || channel->state == *from_state) {
+            rawrtc_data_channel_set_state(channel, to_state);
+        }
+    }
+}
+
+/*
+ * Close all data channels.
+ * Warning: This will not use the closing procedure, use `channel_close_handler` instead.
+ */
+static void close_data_channels(
+        struct rawrtc_sctp_transport* const transport // not checked
+) {
+    struct rawrtc_data_channel* channel;
+    uint16_t sid;
+
+    // No channel map? (transport creation failed)
+    if (!transport->channels) {
+        return;
+    }
+
+    // Set state on all data channels
+    for (channel = rawrtc_sid_map_next(&sid, transport->channels, 0); channel != NULL;
+         channel = rawrtc_sid_map_next(&sid, transport->channels, sid + 1)) {
+        // Update state
+        DEBUG_PRINTF("Closing channel with SID %"PRIu16"\n", sid);
+        rawrtc_data_channel_set_state(channel, RAWRTC_DATA_CHANNEL_STATE_CLOSED);
+
+        // Remove from transport
+        rawrtc_sid_map_unset(transport->channels, sid);
+    }
+}
+
+/*
+ * Change the state of the SCTP transport.
+ * Will call the corresponding handler.
+ * Caller MUST ensure that the same state is not set twice.
+ */
+static void set_state(
+        struct rawrtc_sctp_transport* const transport, // not checked
+        enum rawrtc_sctp_transport_state const state
 ) {
     // Closed?
     if (state == RAWRTC_SCTP_TRANSPORT_STATE_CLOSED) {
         DEBUG_INFO("SCTP connection closed\n");
 
+        // Discard deferred messages
+        sctp_discard_deferred_messages(transport);
+
+        // Not awaiting acknowledgements any longer
+        set_busy(transport, false);
+
         // Close all data channels
         close_data_channels(transport);
 
@@ -506,7 +1206,7 @@ static void set_state(
         // Close socket and deregister transport
         if (transport->socket) {
             usrsctp_close(transport->socket);
-            usrsctp_deregister_address(transport);
+            usrsctp_deregister_address((void*) transport->address);
             transport->socket = NULL;
         }
 
@@ -530,6 +1230,10 @@ static void set_state(
                 RAWRTC_DATA_CHANNEL_STATE_CONNECTING;
         DEBUG_INFO("SCTP connection established\n");
 
+        // Handshake completed
+        // Note: Sending messages below will mark the transport as busy again.
+        set_busy(transport, false);
+
         // Send deferred messages
         error = sctp_send_deferred_messages(transport);
         if (error && error != RAWRTC_CODE_STOP_ITERATION) {
@@ -565,8 +1269,8 @@ static enum rawrtc_code reset_outgoing_stream(
     // Get context
     struct rawrtc_sctp_data_channel_context* const context = channel->transport_arg;
 
-    // Check if there are pending outgoing messages
-    if (!list_isempty(&transport->buffered_messages_outgoing)) {
+    // Check if there are pending outgoing messages on this channel
+    if (!list_isempty(&context->buffered_messages_outgoing)) {
         context->flags |= RAWRTC_SCTP_DATA_CHANNEL_FLAGS_PENDING_STREAM_RESET;
         return RAWRTC_CODE_SUCCESS;
     }
@@ -594,7 +1298,9 @@ static enum rawrtc_code reset_outgoing_stream(
     }
 
     // Done
+    // Note: The request may need to be retransmitted until the stream reset event arrives.
     DEBUG_PRINTF("Outgoing stream %"PRIu16" reset procedure started\n", context->sid);
+    set_busy(transport, true);
     error = RAWRTC_CODE_SUCCESS;
 
 out:
@@ -615,7 +1321,7 @@ out:
         }
 
         // Remove from transport
-        transport->channels[context->sid] = mem_deref(channel);
+        rawrtc_sid_map_unset(transport->channels, context->sid);
     }
     return error;
 }
@@ -839,22 +1545,23 @@ static void handle_partial_delivery_event(
     }
     sid = (uint16_t) event->pdapi_stream;
 
-    // Check if channel exists
+    // Get channel (if any)
     // TODO: Need to check if channel is open?
-    if (sid >= transport->n_channels || !transport->channels[sid]) {
+    channel = rawrtc_sid_map_get(transport->channels, sid);
+    if (!channel) {
         DEBUG_NOTICE("No channel registered for sid %"PRIu16"\n", sid);
         return;
     }
 
-    // Get channel and context
-    channel = transport->channels[sid];
+    // Get context
     context = channel->transport_arg;
 
     // Abort pending message
-    if (context->buffer_inbound) {
-        DEBUG_NOTICE("Abort partially delivered message of %zu bytes\n",
-                     mbuf_get_left(context->buffer_inbound));
+    if (context->buffer_inbound || !list_isempty(&context->chunks_inbound)) {
+        DEBUG_NOTICE("Abort partially delivered message of %"PRIu64" bytes\n",
+                     context->length_inbound);
         context->buffer_inbound = mem_deref(context->buffer_inbound);
+        list_flush(&context->chunks_inbound);
 
         // Sanity-check
         if (channel->options->deliver_partially) {
@@ -881,29 +1588,23 @@ static void handle_send_failed_event(
         struct rawrtc_sctp_transport* const transport,
         struct sctp_send_failed_event* const event
 ) {
+    struct rawrtc_data_channel* channel;
+
     // Print debug output for event
     DEBUG_PRINTF("Send failed event: %H", debug_send_failed_event, event);
-    (void) transport;
-    (void) event;
-}
 
-/*
- * Raise buffered amount low on a data channel.
- */
-static void raise_buffered_amount_low_event(
-        struct rawrtc_data_channel* const channel // not checked
-) {
-    // Check for event handler
-    if (channel->buffered_amount_low_handler) {
-        // Get context
-        struct rawrtc_sctp_data_channel_context* const context = channel->transport_arg;
-        (void) context;
-
-        // Raise event
-        DEBUG_PRINTF("Raising buffered amount low event on channel with SID %"PRIu16"\n",
-                     context->sid);
-        channel->buffered_amount_low_handler(channel->arg);
+    // Get data channel
+    channel = rawrtc_sid_map_get(transport->channels, event->ssfe_info.snd_sid);
+    if (!channel) {
+        return;
     }
+
+    // Allow the buffered amount low event to be raised again once the sender is dry
+    // Note: The message has been abandoned by usrsctp, so the data channel may want to resend.
+    DEBUG_NOTICE("Could not send message of size %"PRIu32" on channel with SID %"PRIu16"\n",
+                 (uint32_t) (event->ssfe_length - sizeof(*event)), event->ssfe_info.snd_sid);
+    ((struct rawrtc_sctp_data_channel_context*) channel->transport_arg)->flags &=
+            ~RAWRTC_SCTP_DATA_CHANNEL_FLAGS_BUFFERED_AMOUNT_LOW;
 }
 
 /*
@@ -913,60 +1614,88 @@ static void handle_sender_dry_event(
         struct rawrtc_sctp_transport* const transport,
         struct sctp_sender_dry_event* const event
 ) {
-    uint_fast16_t i;
-    uint_fast16_t stop;
+    struct rawrtc_data_channel* channel;
+    uint16_t sid;
+    uint_fast16_t start;
+    uint_fast32_t next;
+    bool wrapped = false;
     (void) event;
 
-    // If there are outstanding messages, don't raise an event
-    if (!list_isempty(&transport->buffered_messages_outgoing)) {
-        DEBUG_PRINTF("Pending messages, ignoring sender dry event\n");
-        return;
-    }
+    // Not awaiting acknowledgements any longer
+    set_busy(transport, false);
 
     // Set buffered amount low
     transport->flags |= RAWRTC_SCTP_TRANSPORT_FLAGS_BUFFERED_AMOUNT_LOW;
 
     // Reset counter if #channels has been reduced
     if (transport->current_channel_sid >= transport->n_channels) {
-        i = 0;
+        start = 0;
     } else {
-        i = transport->current_channel_sid;
+        start = transport->current_channel_sid;
     }
 
-    // Raise event on each data channel
-    stop = i;
-    do {
-        struct rawrtc_data_channel* const channel = transport->channels[i];
-        if (channel) {
-            struct rawrtc_sctp_data_channel_context* const context = channel->transport_arg;
+    // Raise event on each data channel (round-robin, starting with the current SID)
+    next = start;
+    while (true) {
+        // Get next channel (wraps around once)
+        channel = rawrtc_sid_map_next(&sid, transport->channels, next);
+        if (!channel && !wrapped) {
+            wrapped = true;
+            next = 0;
+            continue;
+        }
 
-            // Handle flags
-            if (context->flags & RAWRTC_SCTP_DATA_CHANNEL_FLAGS_PENDING_STREAM_RESET) {
-                // Reset pending outgoing stream
-                // TODO: This should probably be handled earlier but requires having separate
-                //       lists for each data channel to be sure that the stream is not reset before
-                //       all pending messages have been sent.
-                reset_outgoing_stream(transport, channel);
-                context->flags &= ~RAWRTC_SCTP_DATA_CHANNEL_FLAGS_PENDING_STREAM_RESET;
-            } else {
-                // Raise event
-                raise_buffered_amount_low_event(transport->channels[i]);
-            }
+        // Stop once all channels have been visited
+        if (!channel || (wrapped && sid >= start)) {
+            break;
+        }
+
+        // Raise event (if not already raised since the last message and below the threshold)
+        // Note: Data channels with a buffered amount above their threshold will raise the event
+        //       once enough of their messages have been handed over to usrsctp.
+        struct rawrtc_sctp_data_channel_context* const context = channel->transport_arg;
+        if (!(context->flags & RAWRTC_SCTP_DATA_CHANNEL_FLAGS_BUFFERED_AMOUNT_LOW) &&
+                context->buffered_amount <= channel->buffered_amount_low_threshold) {
+            raise_buffered_amount_low_event(channel);
         }
 
-        // Update/wrap
-        // Note: uint16 is sufficient here as the maximum number of channels is
-        //       65534, so 65535 will still fit
-        i = (i + 1) % transport->n_channels;
+        // Update current channel SID (wraps)
+        next = (uint_fast32_t) sid + 1;
+        transport->current_channel_sid = (uint_fast16_t) (next % transport->n_channels);
 
         // Stop if the flag has been cleared
         if (!(transport->flags & RAWRTC_SCTP_TRANSPORT_FLAGS_BUFFERED_AMOUNT_LOW)) {
             break;
         }
-    } while (i != stop);
+    }
+}
+
+/*
+ * Clear the busy flag of the transport in case no data is outstanding.
+ * Note: Needed where no sender dry event follows, e.g. a stream reset
+ *       on an association that has been dry already.
+ */
+static void update_busy(
+        struct rawrtc_sctp_transport* const transport // not checked
+) {
+    struct sctp_status status = {0};
+    socklen_t length = sizeof(status);
+
+    // Not busy?
+    if (!(transport->flags & RAWRTC_SCTP_TRANSPORT_FLAGS_BUSY)) {
+        return;
+    }
 
-    // Update current channel SID
-    transport->current_channel_sid = i;
+    // Get status
+    if (usrsctp_getsockopt(transport->socket, IPPROTO_SCTP, SCTP_STATUS, &status, &length)) {
+        DEBUG_WARNING("Could not retrieve association status, reason: %m\n", errno);
+        return;
+    }
+
+    // Not awaiting acknowledgements any longer?
+    if (status.sstat_unackdata == 0 && status.sstat_penddata == 0) {
+        set_busy(transport, false);
+    }
 }
 
 /*
@@ -985,6 +1714,9 @@ static void handle_stream_reset_event(
     // Print debug output for event
     DEBUG_PRINTF("Stream reset event: %H", debug_stream_reset_event, event, length);
 
+    // Stream reset complete (or denied/failed), no more retransmissions of the request
+    update_busy(transport);
+
     // Ignore denied/failed events
     if (event->strreset_flags & SCTP_STREAM_RESET_DENIED
         || event->strreset_flags & SCTP_STREAM_RESET_FAILED) {
@@ -997,14 +1729,14 @@ static void handle_stream_reset_event(
         struct rawrtc_data_channel* channel;
         struct rawrtc_sctp_data_channel_context* context;
 
-        // Check if channel exists
-        if (sid >= transport->n_channels || !transport->channels[sid]) {
+        // Get channel (if any)
+        channel = rawrtc_sid_map_get(transport->channels, (uint16_t) sid);
+        if (!channel) {
             DEBUG_NOTICE("No channel registered for sid %"PRIuFAST16"\n", sid);
             continue;
         }
 
-        // Get channel and context
-        channel = transport->channels[sid];
+        // Get context
         context = channel->transport_arg;
 
         // Incoming stream reset
@@ -1038,7 +1770,7 @@ static void handle_stream_reset_event(
             rawrtc_data_channel_set_state(channel, RAWRTC_DATA_CHANNEL_STATE_CLOSED);
 
             // Remove from transport
-            transport->channels[context->sid] = mem_deref(channel);
+            rawrtc_sid_map_unset(transport->channels, context->sid);
         }
     }
 }
@@ -1101,44 +1833,318 @@ static void handle_notification(
 }
 
 /*
- * Handle outgoing SCTP messages.
+ * Get the current (monotonic) time in microseconds.
  */
-static int sctp_packet_handler(
-        void* arg,
-        void* buffer,
-        size_t length,
-        uint8_t tos,
-        uint8_t set_df
+static uint64_t time_us(void) {
+    struct timespec now;
+    if (clock_gettime(CLOCK_MONOTONIC, &now)) {
+        return 0;
+    }
+    return (uint64_t) now.tv_sec * 1000000 + (uint64_t) now.tv_nsec / 1000;
+}
+
+/*
+ * usrsctp callback handed off to the shard owning the transport.
+ */
+struct routed_callback {
+    uintptr_t address; // usrsctp address of the transport
+    struct mbuf* buffer; // nullable (upcall if NULL)
+    uint64_t time; // in microseconds
+};
+
+/*
+ * Destructor for an existing routed callback.
+ */
+static void routed_callback_destroy(
+        void* arg
 ) {
-    struct rawrtc_sctp_transport* const transport = arg;
-    enum rawrtc_code error;
-    (void) tos; // TODO: Handle?
-    (void) set_df; // TODO: Handle?
+    struct routed_callback* const callback = arg;
 
-    // Lock event loop mutex
-    rawrtc_thread_enter();
+    // Un-reference
+    mem_deref(callback->buffer);
+}
 
-    // Closed?
-    if (transport->state == RAWRTC_SCTP_TRANSPORT_STATE_CLOSED) {
-        DEBUG_PRINTF("Ignoring SCTP packet ready event, transport is closed\n");
-        goto out;
-    }
+/*
+ * Find an SCTP transport of a shard by its usrsctp address.
+ * Note: A shard's table MUST only be accessed on the shard's thread
+ *       (or with the event loop locked in case of the main shard).
+ */
+static struct rawrtc_sctp_transport* shard_transport_find(
+        struct rawrtc_shard* const shard, // not checked
+        uintptr_t const address
+) {
+    struct le* le;
 
-    // Trace (if trace handle)
-    // Note: No need to check if NULL as the function does it for us
-    trace_packet(transport, buffer, length, SCTP_DUMP_OUTBOUND);
+    for (le = list_head(hash_list(shard->sctp_transports, (uint32_t) address));
+         le != NULL; le = le->next) {
+        struct rawrtc_sctp_transport* const transport = le->data;
+        if (transport->address == address) {
+            return transport;
+        }
+    }
 
-    // Note: We only need to copy the buffer if we add it to the outgoing queue
-    if (transport->dtls_transport->state == RAWRTC_DTLS_TRANSPORT_STATE_CONNECTED) {
-        struct mbuf mbuffer;
+    // Not found
+    return NULL;
+}
 
-        // Note: dtls_send does not reference the buffer, so we can safely fake an mbuf structure
-        // to avoid copying. This may change in the future, so be aware!
-        mbuffer.buf = buffer;
+/*
+ * Handle a usrsctp callback that has been handed off to this shard.
+ */
+static void routed_callback_handler(
+        void* const arg
+) {
+    struct routed_callback* const callback = arg;
+    struct rawrtc_sctp_transport* transport;
+
+    // Update statistics
+    __atomic_add_fetch(&rawrtc_global.usrsctp_callback_statistics.handoff_latency,
+                       time_us() - callback->time, __ATOMIC_RELAXED);
+
+    // Find transport
+    // Note: The transport may have been destroyed while the callback was queued. No reference
+    //       is being held while the callback crosses threads as libre's reference counting
+    //       is not thread-safe. Instead, the owning shard validates the address.
+    transport = shard_transport_find(rawrtc_shard_current(), callback->address);
+    if (!transport) {
+        DEBUG_PRINTF("Dropping routed callback, transport has been destroyed\n");
+        return;
+    }
+
+    // Reference the transport while handling the callback
+    // Note: A handler may drop the last reference to the transport.
+    mem_ref(transport);
+
+    // Handle outgoing packet or upcall
+    if (callback->buffer) {
+        packet_send(transport, mbuf_buf(callback->buffer), mbuf_get_left(callback->buffer));
+    } else if (transport->socket) {
+        upcall_handle(transport);
+    }
+
+    // Un-reference
+    mem_deref(transport);
+}
+
+/*
+ * Hand off a usrsctp callback to the shard owning the transport.
+ * This does not block, the callback will be handled on the shard's
+ * thread once it has been woken up.
+ */
+static void route_callback(
+        uintptr_t const address,
+        void* const buffer, // nullable
+        size_t const length
+) {
+    struct routed_callback* callback;
+    struct le* le;
+    enum rawrtc_code error = RAWRTC_CODE_SUCCESS;
+
+    // Allocate
+    callback = mem_zalloc(sizeof(*callback), routed_callback_destroy);
+    if (!callback) {
+        error = RAWRTC_CODE_NO_MEMORY;
+        goto out;
+    }
+
+    // Set fields
+    callback->address = address;
+    callback->time = time_us();
+
+    // Copy packet (if any)
+    if (buffer) {
+        callback->buffer = mbuf_alloc(length);
+        if (!callback->buffer) {
+            mem_deref(callback);
+            error = RAWRTC_CODE_NO_MEMORY;
+            goto out;
+        }
+        error = rawrtc_error_to_code(mbuf_write_mem(callback->buffer, buffer, length));
+        if (error) {
+            mem_deref(callback);
+            goto out;
+        }
+        mbuf_set_pos(callback->buffer, 0);
+    }
+
+    // Hand over to the owning shard
+    // Note: A transport is removed from the table (with the lock held) before it is being
+    //       destroyed and a shard outlives its transports. So, the shard is guaranteed to
+    //       exist while the lock is held. Whether the transport still exists once the call
+    //       is being handled will be checked by the owning shard.
+    pthread_mutex_lock(&rawrtc_global.sctp_transports_mutex);
+    for (le = list_head(hash_list(rawrtc_global.sctp_transports, (uint32_t) address));
+         le != NULL; le = le->next) {
+        struct rawrtc_sctp_transport* const transport = le->data;
+        if (transport->address == address) {
+            error = rawrtc_shard_call(transport->shard, routed_callback_handler, callback);
+            break;
+        }
+    }
+    pthread_mutex_unlock(&rawrtc_global.sctp_transports_mutex);
+    if (!le) {
+        DEBUG_PRINTF("Dropping callback, transport has been destroyed\n");
+        mem_deref(callback);
+        return;
+    }
+    if (error) {
+        goto out;
+    }
+
+    // Update statistics
+    __atomic_add_fetch(&rawrtc_global.usrsctp_callback_statistics.handed_off_callbacks,
+                       1, __ATOMIC_RELAXED);
+
+out:
+    if (error) {
+        DEBUG_WARNING("Could not route callback to shard, reason: %s\n",
+                      rawrtc_code_to_str(error));
+    }
+}
+
+#ifdef RAWRTC_HAVE_USRSCTP_INIT_NOTHREADS
+/*
+ * Check whether usrsctp callbacks of a transport are to be handed off
+ * to the shard owning the transport.
+ */
+static bool callback_handoff_enabled(
+        uintptr_t const address
+) {
+    struct le* le;
+    bool handoff = false;
+
+    // Find transport & get setting
+    pthread_mutex_lock(&rawrtc_global.sctp_transports_mutex);
+    for (le = list_head(hash_list(rawrtc_global.sctp_transports, (uint32_t) address));
+         le != NULL; le = le->next) {
+        struct rawrtc_sctp_transport* const transport = le->data;
+        if (transport->address == address) {
+            handoff = __atomic_load_n(&transport->callback_handoff, __ATOMIC_RELAXED);
+            break;
+        }
+    }
+    pthread_mutex_unlock(&rawrtc_global.sctp_transports_mutex);
+    return handoff;
+}
+#endif
+
+/*
+ * Prepare handling a usrsctp callback.
+ *
+ * Return the transport in case the callback can be handled on the
+ * calling thread (locking the event loop if required, see
+ * `callback_leave`). Otherwise, it needs to be handed off to the shard
+ * owning the transport (if the transport still exists).
+ * Note: The transport is only being looked up in the tables of the
+ *       calling thread's shard, so it will not be accessed by any other
+ *       thread than the owning one.
+ */
+static struct rawrtc_sctp_transport* callback_enter(
+        bool* const lockedp, // de-referenced
+        uintptr_t const address
+) {
+    struct rawrtc_sctp_callback_statistics* const statistics =
+            &rawrtc_global.usrsctp_callback_statistics;
+    struct rawrtc_shard* const self = rawrtc_shard_self();
+#ifdef RAWRTC_HAVE_USRSCTP_INIT_NOTHREADS
+    struct rawrtc_sctp_transport* transport;
+    uint64_t start;
+#endif
+
+    // Update statistics
+    __atomic_add_fetch(&statistics->callbacks, 1, __ATOMIC_RELAXED);
+    *lockedp = false;
+
+    // On a shard? Only the shard's own transports can be handled.
+    if (self) {
+        return shard_transport_find(self, address);
+    }
+
+#ifndef RAWRTC_HAVE_USRSCTP_INIT_NOTHREADS
+    // Hand off
+    // Note: This is a usrsctp thread which must not lock the event loop. usrsctp may hold
+    //       its locks while invoking the callback, so a shard calling into usrsctp with the
+    //       event loop locked would deadlock with it.
+    return NULL;
+#else
+    // Hand off (if enabled)
+    // Note: Only the main event loop can be locked and only from a thread that is not a shard.
+    if (callback_handoff_enabled(address)) {
+        return NULL;
+    }
+
+    // Lock event loop mutex & update statistics
+    start = time_us();
+    rawrtc_thread_enter();
+    __atomic_add_fetch(&statistics->lock_wait_time, time_us() - start, __ATOMIC_RELAXED);
+
+    // Transport of the main shard?
+    transport = shard_transport_find(rawrtc_global.main_shard, address);
+    if (!transport) {
+        rawrtc_thread_leave();
+        return NULL;
+    }
+
+    // Update statistics
+    __atomic_add_fetch(&statistics->locked_callbacks, 1, __ATOMIC_RELAXED);
+    *lockedp = true;
+    return transport;
+#endif
+}
+
+/*
+ * Finish handling a usrsctp callback on the calling thread.
+ */
+static void callback_leave(
+        bool const locked
+) {
+    // Unlock event loop mutex (if locked)
+    if (locked) {
+        rawrtc_thread_leave();
+    }
+}
+
+/*
+ * Send an outgoing SCTP packet.
+ */
+static void packet_send(
+        struct rawrtc_sctp_transport* const transport, // not checked
+        void* const buffer,
+        size_t const length
+) {
+    enum rawrtc_code error;
+
+    // Closed?
+    if (transport->state == RAWRTC_SCTP_TRANSPORT_STATE_CLOSED) {
+        DEBUG_PRINTF("Ignoring SCTP packet ready event, transport is closed\n");
+        return;
+    }
+
+    // Trace (if trace handle)
+    // Note: No need to check if NULL as the function does it for us
+    trace_packet(transport, buffer, length, SCTP_DUMP_OUTBOUND);
+
+    // Keep the timer running at the regular interval
+    timer_activity(transport->shard);
+
+    // Note: We only need to copy the buffer if we add it to the outgoing queue
+    if (transport->dtls_transport->state == RAWRTC_DTLS_TRANSPORT_STATE_CONNECTED) {
+        struct mbuf mbuffer;
+
+        // Note: dtls_send does not reference the buffer, so we can safely fake an mbuf structure
+        // to avoid copying. This may change in the future, so be aware!
+        mbuffer.buf = buffer;
         mbuffer.pos = 0;
         mbuffer.size = length;
         mbuffer.end = length;
 
+        // Start batching on the DTLS transport (if enabled and within a batch)
+        if (rawrtc_default_config.sctp_packet_batching
+                && transport->shard->usrsctp_batch_depth > 0 && !transport->batch_le.list) {
+            rawrtc_dtls_transport_batch_start(transport->dtls_transport);
+            list_append(&transport->shard->usrsctp_batch_transports, &transport->batch_le,
+                        transport);
+        }
+
         // Send
         error = rawrtc_dtls_transport_send(transport->dtls_transport, &mbuffer);
     } else {
@@ -1148,7 +2154,7 @@ static int sctp_packet_handler(
         struct mbuf* const mbuffer = mbuf_alloc(length);
         if (!mbuffer) {
             DEBUG_WARNING("Could not create buffer for outgoing packet, no memory\n");
-            goto out;
+            return;
         }
 
         // Copy and set position
@@ -1156,7 +2162,7 @@ static int sctp_packet_handler(
         if (err) {
             DEBUG_WARNING("Could not write to buffer, reason: %m\n", err);
             mem_deref(mbuffer);
-            goto out;
+            return;
         }
         mbuf_set_pos(mbuffer, 0);
 
@@ -1168,12 +2174,33 @@ static int sctp_packet_handler(
     // Handle error
     if (error) {
         DEBUG_WARNING("Could not send packet, reason: %s\n", rawrtc_code_to_str(error));
-        goto out;
     }
+}
 
-out:
-    // Unlock event loop mutex
-    rawrtc_thread_leave();
+/*
+ * Handle outgoing SCTP messages.
+ */
+static int sctp_packet_handler(
+        void* arg,
+        void* buffer,
+        size_t length,
+        uint8_t tos,
+        uint8_t set_df
+) {
+    uintptr_t const address = (uintptr_t) arg;
+    struct rawrtc_sctp_transport* transport;
+    bool locked;
+    (void) tos; // TODO: Handle?
+    (void) set_df; // TODO: Handle?
+
+    // Handle on this thread or hand off to the owning shard
+    transport = callback_enter(&locked, address);
+    if (transport) {
+        packet_send(transport, buffer, length);
+        callback_leave(locked);
+    } else {
+        route_callback(address, buffer, length);
+    }
 
     // TODO: What does the return code do?
     return 0;
@@ -1189,7 +2216,8 @@ static void handle_data_channel_ack_message(
     struct rawrtc_sctp_data_channel_context* context;
 
     // Get channel and context
-    struct rawrtc_data_channel* const channel = transport->channels[info->rcv_sid];
+    struct rawrtc_data_channel* const channel = rawrtc_sid_map_get(
+            transport->channels, info->rcv_sid);
     if (!channel) {
         DEBUG_WARNING("Received ack on an invalid channel with SID %"PRIu16"\n", info->rcv_sid);
         goto error;
@@ -1223,7 +2251,6 @@ static void handle_data_channel_open_message(
 ) {
     enum rawrtc_code error;
     struct rawrtc_data_channel_parameters* parameters;
-    uint_fast16_t priority;
     struct rawrtc_data_transport* data_transport = NULL;
     struct rawrtc_data_channel* channel = NULL;
     struct rawrtc_sctp_data_channel_context* context = NULL;
@@ -1254,13 +2281,13 @@ static void handle_data_channel_open_message(
     }
 
     // Check if slot is occupied
-    if (transport->channels[info->rcv_sid]) {
+    if (rawrtc_sid_map_get(transport->channels, info->rcv_sid)) {
         DEBUG_WARNING("Other peer chose already occupied SID %"PRIu16"\n", info->rcv_sid);
         return;
     }
 
     // Get parameters from data channel open message
-    error = data_channel_open_message_parse(&parameters, &priority, info->rcv_sid, buffer_in);
+    error = data_channel_open_message_parse(&parameters, info->rcv_sid, buffer_in);
     if (error) {
         DEBUG_WARNING("Unable to parse DCEP open message, reason: %s\n", rawrtc_code_to_str(error));
         return;
@@ -1284,17 +2311,13 @@ static void handle_data_channel_open_message(
     }
 
     // Allocate context to be used as an argument for the data channel handlers
-    error = channel_context_create(&context, info->rcv_sid, true);
+    error = channel_context_create(&context, info->rcv_sid, parameters->priority, true);
     if (error) {
         DEBUG_WARNING("Unable to create data channel context, reason: %s\n",
                       rawrtc_code_to_str(error));
         goto out;
     }
 
-    // TODO: Store priority for SCTP ndata,
-    //       see https://tools.ietf.org/html/draft-ietf-rtcweb-data-channel-13#section-6.4
-    (void) priority;
-
     // Create ack message
     buffer_out = NULL;
     error = data_channel_ack_message_create(&buffer_out);
@@ -1314,7 +2337,12 @@ static void handle_data_channel_open_message(
     }
 
     // Register data channel
-    channel_register(transport, channel, context, true);
+    error = channel_register(transport, channel, context, true);
+    if (error) {
+        DEBUG_WARNING("Unable to register data channel, reason: %s\n",
+                      rawrtc_code_to_str(error));
+        goto out;
+    }
 
     // TODO: Reset stream with SID on error
 
@@ -1400,6 +2428,170 @@ out:
     return error;
 }
 
+/*
+ * Reassemble incoming application message chunks.
+ *
+ * Chunks are referenced as they arrive. Once the message is complete,
+ * they are either left as is (to be handed out as a scatter-gather
+ * view) or merged with a single copy. In case the application announced
+ * the message's size, chunks are copied into a buffer pre-sized
+ * accordingly instead.
+ *
+ * Return `RAWRTC_CODE_SUCCESS` in case the message is complete and
+ * should be handled. Otherwise, return `RAWRTC_CODE_NO_VALUE`.
+ */
+static enum rawrtc_code reassemble_message_raise_complete(
+        struct rawrtc_sctp_data_channel_context* const context, // not checked
+        struct rawrtc_data_channel* const channel, // not checked
+        struct mbuf* const message_buffer, // not checked
+        struct sctp_rcvinfo* const info, // not checked
+        int const flags
+) {
+    bool const complete =
+            (flags & MSG_EOR) &&
+            info->rcv_ppid != RAWRTC_SCTP_TRANSPORT_PPID_UTF16_PARTIAL &&
+            info->rcv_ppid != RAWRTC_SCTP_TRANSPORT_PPID_BINARY_PARTIAL;
+    size_t const length = mbuf_get_left(message_buffer);
+    enum rawrtc_code error;
+    void* merge_context;
+
+    // Copy receive info (if first)
+    if (!context->buffer_inbound && list_isempty(&context->chunks_inbound)) {
+        memcpy(&context->info_inbound, info, sizeof(*info));
+        context->length_inbound = 0;
+
+        // Pre-size reassembly buffer (if the size has been announced)
+        // Note: The hint only applies to a single message.
+        if (!complete && channel->message_size_hint > 0 && !channel->message_view_handler) {
+            context->buffer_inbound = mbuf_alloc((size_t) channel->message_size_hint);
+            if (!context->buffer_inbound) {
+                error = RAWRTC_CODE_NO_MEMORY;
+                goto out;
+            }
+            DEBUG_PRINTF("Pre-sized reassembly buffer to %"PRIu64" bytes\n",
+                         channel->message_size_hint);
+        }
+        channel->message_size_hint = 0;
+
+        // Complete?
+        if (complete) {
+            DEBUG_PRINTF("Incoming message of size %zu is already complete\n", length);
+            context->buffer_inbound = mem_ref(message_buffer);
+            context->length_inbound = length;
+            error = RAWRTC_CODE_SUCCESS;
+            goto out;
+        }
+    }
+
+    // Copy into pre-sized buffer or reference chunk
+    if (context->buffer_inbound) {
+        error = rawrtc_error_to_code(mbuf_write_mem(
+                context->buffer_inbound, mbuf_buf(message_buffer), length));
+    } else {
+        error = rawrtc_message_buffer_append(&context->chunks_inbound, message_buffer, NULL);
+    }
+    if (error) {
+        goto out;
+    }
+    context->length_inbound += length;
+    DEBUG_PRINTF("Buffered incoming message chunk of size %zu\n", length);
+
+    // Stop (if not last chunk)
+    if (!complete) {
+        error = RAWRTC_CODE_NO_VALUE;
+        goto out;
+    }
+
+    // Pre-sized buffer: Set position & done
+    if (context->buffer_inbound) {
+        mbuf_set_pos(context->buffer_inbound, 0);
+        DEBUG_PRINTF("Reassembled incoming message of size %"PRIu64" in pre-sized buffer\n",
+                     context->length_inbound);
+        error = RAWRTC_CODE_SUCCESS;
+        goto out;
+    }
+
+    // Leave chunks as is (if they will be handed out as a view)
+    if (channel->message_view_handler) {
+        DEBUG_PRINTF("Reassembled incoming message of size %"PRIu64" from %u chunks\n",
+                     context->length_inbound, list_count(&context->chunks_inbound));
+        error = RAWRTC_CODE_SUCCESS;
+        goto out;
+    }
+
+    // Merge chunks into the first chunk's buffer (single resize)
+    error = rawrtc_message_buffer_merge(
+            &context->buffer_inbound, &merge_context, &context->chunks_inbound);
+    if (error) {
+        goto out;
+    }
+    DEBUG_PRINTF("Merged incoming message chunks to size %zu\n",
+                 mbuf_get_left(context->buffer_inbound));
+
+out:
+    if (error && error != RAWRTC_CODE_NO_VALUE) {
+        // Discard the message
+        context->buffer_inbound = mem_deref(context->buffer_inbound);
+        list_flush(&context->chunks_inbound);
+    }
+    return error;
+}
+
+/*
+ * Destructor for an existing message view.
+ */
+static void message_view_destroy(
+        void* arg
+) {
+    struct rawrtc_data_channel_message_view* const view = arg;
+    size_t i;
+
+    // Un-reference
+    for (i = 0; i < view->n_buffers; ++i) {
+        mem_deref(view->buffers[i]);
+    }
+    mem_deref(view->buffers);
+}
+
+/*
+ * Create a scatter-gather view of a reassembled message.
+ */
+static enum rawrtc_code message_view_create(
+        struct rawrtc_data_channel_message_view** const viewp, // de-referenced, not checked
+        struct rawrtc_sctp_data_channel_context* const context // not checked
+) {
+    size_t const n_buffers =
+            context->buffer_inbound ? 1 : list_count(&context->chunks_inbound);
+    struct rawrtc_data_channel_message_view* view;
+    struct le* le;
+
+    // Allocate
+    view = mem_zalloc(sizeof(*view), message_view_destroy);
+    if (!view) {
+        return RAWRTC_CODE_NO_MEMORY;
+    }
+    view->buffers = mem_zalloc(n_buffers * sizeof(*view->buffers), NULL);
+    if (!view->buffers) {
+        mem_deref(view);
+        return RAWRTC_CODE_NO_MEMORY;
+    }
+
+    // Reference buffers
+    if (context->buffer_inbound) {
+        view->buffers[view->n_buffers++] = mem_ref(context->buffer_inbound);
+    } else {
+        for (le = list_head(&context->chunks_inbound); le != NULL; le = le->next) {
+            struct rawrtc_buffered_message* const buffered_message = le->data;
+            view->buffers[view->n_buffers++] = mem_ref(buffered_message->buffer);
+        }
+    }
+    view->length = context->length_inbound;
+
+    // Set pointer & done
+    *viewp = view;
+    return RAWRTC_CODE_SUCCESS;
+}
+
 /*
  * Handle incoming application data messages.
  */
@@ -1411,10 +2603,12 @@ static void handle_application_message(
 ) {
     enum rawrtc_code error;
     struct rawrtc_sctp_data_channel_context* context = NULL;
+    struct rawrtc_data_channel_message_view* view = NULL;
     enum rawrtc_data_channel_message_flag message_flags = RAWRTC_DATA_CHANNEL_MESSAGE_FLAG_NONE;
 
     // Get channel and context
-    struct rawrtc_data_channel* const channel = transport->channels[info->rcv_sid];
+    struct rawrtc_data_channel* const channel = rawrtc_sid_map_get(
+            transport->channels, info->rcv_sid);
     if (!channel) {
         DEBUG_WARNING("Received application message on an invalid channel with SID %"PRIu16"\n",
                       info->rcv_sid);
@@ -1443,15 +2637,14 @@ static void handle_application_message(
 
         // Let the buffer appear to be empty
         mbuf_skip_to_end(context->buffer_inbound);
+        context->length_inbound = 0;
 
         // Empty message is complete
         message_flags |= RAWRTC_DATA_CHANNEL_MESSAGE_FLAG_IS_COMPLETE;
 
     } else if (!channel->options->deliver_partially) {
         // Buffer message (if needed) and get complete message (if any)
-        error = buffer_message_received_raise_complete(
-                &context->buffer_inbound, &context->info_inbound,
-                buffer, info, flags);
+        error = reassemble_message_raise_complete(context, channel, buffer, info, flags);
         switch (error) {
             case RAWRTC_CODE_SUCCESS:
                 break;
@@ -1499,8 +2692,19 @@ static void handle_application_message(
             break;
     }
 
-    // Pass message to handler
-    if (channel->message_handler) {
+    // Update statistics
+    if (message_flags & RAWRTC_DATA_CHANNEL_MESSAGE_FLAG_IS_COMPLETE) {
+        ++transport->statistics.messages_received;
+    }
+
+    // Pass message to handler (as a view, if requested)
+    if (channel->message_view_handler && !channel->options->deliver_partially) {
+        error = message_view_create(&view, context);
+        if (error) {
+            goto out;
+        }
+        channel->message_view_handler(view, message_flags, channel->arg);
+    } else if (channel->message_handler) {
         channel->message_handler(context->buffer_inbound, message_flags, channel->arg);
     } else {
         DEBUG_NOTICE("No message handler, message of %zu bytes has been discarded\n",
@@ -1519,8 +2723,10 @@ out:
     }
 
     // Un-reference
+    mem_deref(view);
     if (context) {
         context->buffer_inbound = mem_deref(context->buffer_inbound);
+        list_flush(&context->chunks_inbound);
     }
 }
 
@@ -1612,6 +2818,50 @@ static void data_receive_handler(
     }
 }
 
+/*
+ * Get a buffer to receive the next notification or data chunk into.
+ *
+ * In case recycling is enabled, the transport's receive buffer will be
+ * rewound and reused unless another party (e.g. a message that is
+ * being reassembled or the application) still holds a reference to
+ * it. In that case, the other party keeps the buffer and a new one
+ * will be allocated.
+ *
+ * Return a referenced buffer or `NULL` in case no memory is
+ * available.
+ */
+static struct mbuf* receive_buffer_get(
+        struct rawrtc_sctp_transport* const transport // not checked
+) {
+    struct mbuf* buffer = transport->buffer_receive;
+
+    // Reuse buffer (if not referenced elsewhere and has not been resized)
+    if (buffer) {
+        if (mem_nrefs(buffer) == 1 && buffer->size == rawrtc_global.usrsctp_chunk_size) {
+            mbuf_rewind(buffer);
+            return mem_ref(buffer);
+        }
+
+        // Leave the buffer to whoever is still referencing it
+        transport->buffer_receive = mem_deref(buffer);
+    }
+
+    // Allocate
+    buffer = mbuf_alloc(rawrtc_global.usrsctp_chunk_size);
+    if (!buffer) {
+        return NULL;
+    }
+    ++transport->statistics.receive_buffer_allocations;
+
+    // Keep for recycling (if enabled)
+    if (rawrtc_default_config.sctp_receive_buffer_recycle) {
+        transport->buffer_receive = mem_ref(buffer);
+    }
+
+    // Done
+    return buffer;
+}
+
 /*
  * Handle usrsctp read event.
  */
@@ -1635,8 +2885,8 @@ static int read_event_handler(
     // TODO: Get next message size
     // TODO: Can we get the COMPLETE message size or just the current message size?
 
-    // Create buffer
-    buffer = mbuf_alloc(rawrtc_global.usrsctp_chunk_size);
+    // Get (recycled) buffer
+    buffer = receive_buffer_get(transport);
     if (!buffer) {
         DEBUG_WARNING("Cannot allocate buffer, no memory");
         // TODO: This needs to be handled in a better way, otherwise it's probably going
@@ -1649,6 +2899,7 @@ static int read_event_handler(
     length = usrsctp_recvv(
             transport->socket, buffer->buf, buffer->size, NULL, NULL,
             &info, &info_length, &info_type, &flags);
+    ++transport->statistics.receive_calls;
     if (length < 0) {
         // Meh...
         if (errno == EAGAIN) {
@@ -1756,20 +3007,17 @@ static bool error_event_handler(
 }
 
 /*
- * usrsctp event handler helper.
+ * Handle pending usrsctp events of a transport.
  */
-static void upcall_handler_helper(
-        struct socket* socket,
-        void* arg,
-        int flags
+static void upcall_handle(
+        struct rawrtc_sctp_transport* const transport // not checked
 ) {
+    struct socket* const socket = transport->socket;
     int events = usrsctp_get_events(socket);
-    struct rawrtc_sctp_transport* const transport = arg;
     int ignore_events = RAWRTC_SCTP_EVENT_NONE;
-    (void) flags; // TODO: What does this indicate?
 
-    // Lock event loop mutex
-    rawrtc_thread_enter();
+    // Gather outgoing packets
+    rawrtc_sctp_transport_packet_batch_enter();
 
     // TODO: This loop may lead to long blocking and is unfair to normal fds.
     //       It's a compromise because scheduling repetitive timers in re's event loop seems to
@@ -1798,25 +3046,119 @@ static void upcall_handler_helper(
         events = usrsctp_get_events(socket) & ~ignore_events;
     }
 
-    // Unlock event loop mutex
-    rawrtc_thread_leave();
+    // Flush outgoing packets
+    rawrtc_sctp_transport_packet_batch_leave();
+}
+
+/*
+ * usrsctp event handler helper.
+ */
+static void upcall_handler_helper(
+        struct socket* socket,
+        void* arg,
+        int flags
+) {
+    uintptr_t const address = (uintptr_t) arg;
+    struct rawrtc_sctp_transport* transport;
+    bool locked;
+    (void) socket;
+    (void) flags; // TODO: What does this indicate?
+
+    // Handle on this thread or hand off to the owning shard
+    transport = callback_enter(&locked, address);
+    if (transport) {
+        // Note: A handler may drop the last reference to the transport.
+        mem_ref(transport);
+        upcall_handle(transport);
+        mem_deref(transport);
+        callback_leave(locked);
+    } else {
+        route_callback(address, NULL, 0);
+    }
 }
 
+#ifdef RAWRTC_HAVE_USRSCTP_INIT_NOTHREADS
 /*
- * Handle SCTP timer tick.
+ * Handle SCTP timer tick of a shard.
+ * With `usrsctp_get_timeout`, the timer is armed for usrsctp's next
+ * timer deadline, or for the idle interval if no timer is pending.
+ * Otherwise, the timer runs at the regular interval while any of the
+ * shard's transports is busy or SCTP packets have been exchanged
+ * recently, and the interval is doubled on each tick up to the idle
+ * interval.
+ * Note: usrsctp's timers are shared by all shards, so each shard
+ *       passes only the time that elapsed since the last tick of any
+ *       shard. usrsctp's timer wheel is not re-entrant, so only one
+ *       shard at a time drives it. Callbacks for transports of other
+ *       shards will be routed.
  */
 static void timer_handler(
         void* arg
 ) {
-    (void) arg;
+    struct rawrtc_shard* const shard = arg;
+    uint64_t const now = tmr_jiffies();
+    uint32_t elapsed = 0;
+#ifdef RAWRTC_HAVE_USRSCTP_GET_TIMEOUT
+    // Idle unless a timer is pending
+    bool const idle = usrsctp_get_timeout() < 0;
+#else
+    uint32_t interval = rawrtc_default_config.sctp_timer_interval;
+    bool const idle = shard->usrsctp_busy_transports == 0 &&
+            now - shard->usrsctp_activity_time >= RAWRTC_SCTP_TRANSPORT_TIMER_IDLE_DELAY;
+
+    // Back off (if idle)
+    if (idle) {
+        interval = shard->usrsctp_tick_interval * 2;
+        if (interval > rawrtc_default_config.sctp_timer_idle_interval) {
+            interval = rawrtc_default_config.sctp_timer_idle_interval;
+        }
+        if (interval < rawrtc_default_config.sctp_timer_interval) {
+            interval = rawrtc_default_config.sctp_timer_interval;
+        }
+    }
+#endif
+
+    // Update statistics
+    pthread_mutex_lock(&rawrtc_global.usrsctp_mutex);
+    ++rawrtc_global.usrsctp_timer_statistics.ticks;
+    if (idle) {
+        ++rawrtc_global.usrsctp_timer_statistics.idle_ticks;
+    }
+    pthread_mutex_unlock(&rawrtc_global.usrsctp_mutex);
 
+#ifndef RAWRTC_HAVE_USRSCTP_GET_TIMEOUT
     // Restart timer
-    tmr_start(&rawrtc_global.usrsctp_tick_timer, RAWRTC_SCTP_TRANSPORT_TIMER_TIMEOUT,
-              timer_handler, NULL);
+    timer_schedule(shard, interval);
+#endif
+
+    // Drive usrsctp's timers (unless another shard is driving them right now)
+    // Note: The elapsed time remains unclaimed in the latter case, so it will be passed on the
+    //       next tick (of any shard). Blocking would only delay this shard's event loop.
+    if (!pthread_mutex_trylock(&rawrtc_global.usrsctp_timer_mutex)) {
+        // Claim elapsed time
+        if (now > rawrtc_global.usrsctp_tick_time) {
+            elapsed = (uint32_t) (now - rawrtc_global.usrsctp_tick_time);
+            __atomic_store_n(&rawrtc_global.usrsctp_tick_time, now, __ATOMIC_RELAXED);
+        }
 
-    // Pass delta ms to usrsctp
-    usrsctp_handle_timers(RAWRTC_SCTP_TRANSPORT_TIMER_TIMEOUT);
+        // Pass elapsed ms to usrsctp (and flush outgoing packets afterwards)
+        // Note: The lock is being held for the whole call. Packets of other shards' transports
+        //       are routed to them, so this does not wait for other shards.
+        if (elapsed > 0) {
+            rawrtc_sctp_transport_packet_batch_enter();
+            usrsctp_handle_timers(elapsed);
+            rawrtc_sctp_transport_packet_batch_leave();
+        }
+        pthread_mutex_unlock(&rawrtc_global.usrsctp_timer_mutex);
+    }
+
+#ifdef RAWRTC_HAVE_USRSCTP_GET_TIMEOUT
+    // Arm timer for the next deadline
+    // Note: This includes timers that have been started by the expired ones.
+    timer_schedule(shard, timer_deadline());
+#endif
 }
+#endif
 
 /*
  * Handle incoming DTLS messages.
@@ -1838,72 +3180,43 @@ static void dtls_receive_handler(
     // Note: No need to check if NULL as the function does it for us
     trace_packet(transport, mbuf_buf(buffer), length, SCTP_DUMP_INBOUND);
 
+    // Keep the timer running at the regular interval (e.g. for delayed SACKs)
+    timer_activity(transport->shard);
+
     // Feed into SCTP socket
     // TODO: What about ECN bits?
+    // Note: Responses (e.g. SACKs) will be flushed after the packet has been handled.
     DEBUG_PRINTF("Feeding SCTP packet of %zu bytes\n", length);
-    usrsctp_conninput(transport, mbuf_buf(buffer), length, 0);
+    rawrtc_sctp_transport_packet_batch_enter();
+    usrsctp_conninput((void*) transport->address, mbuf_buf(buffer), length, 0);
+    rawrtc_sctp_transport_packet_batch_leave();
 }
 
 /*
- * Destructor for an existing SCTP data channel array.
+ * Handle path MTU changes of the DTLS transport.
+ * Path MTU discovery of usrsctp is disabled as the DTLS transport
+ * probes the path on our behalf.
  */
-static void data_channels_destroy(
-        void* arg
+static void dtls_path_mtu_handler(
+        size_t const path_mtu,
+        void* const arg
 ) {
     struct rawrtc_sctp_transport* const transport = arg;
-    uint_fast16_t i;
+    struct sctp_paddrparams peer_address_parameters = {0};
 
-    // Un-reference all members
-    for (i = 0; i < transport->n_channels; ++i) {
-        mem_deref(transport->channels[i]);
-    }
-}
-
-/*
- * Create SCTP data channel array.
- *
- * Warning: Will not pre-fill stream IDs of the members!
- */
-enum rawrtc_code data_channels_alloc(
-        struct rawrtc_data_channel*** channelsp, // de-referenced
-        uint_fast16_t const n_channels,
-        uint_fast16_t const n_channels_previously
-) {
-    size_t i;
-    struct rawrtc_data_channel** channels;
-
-    // Check arguments
-    if (!channelsp) {
-        return RAWRTC_CODE_INVALID_ARGUMENT;
-    }
-
-    // Allocated before and #channels is decreasing?
-    if (n_channels_previously > 0 && n_channels < n_channels_previously) {
-        // Ensure we're not removing active data channels
-        for (i = 0; i < n_channels_previously; ++i) {
-            if ((*channelsp)[i]) {
-                return RAWRTC_CODE_STILL_IN_USE;
-            }
-        }
-    }
-
-    // Allocate
-    channels = mem_reallocarray(*channelsp, n_channels, sizeof(*channels), data_channels_destroy);
-    if (!channels) {
-        return RAWRTC_CODE_NO_MEMORY;
+    // Closed?
+    if (!transport->socket) {
+        return;
     }
 
-    // Initialise
-    // Note: We can safely multiply 'n_channels' with size of the struct as 'mem_reallocarray'
-    //       ensures that it does not overflow (returns NULL).
-    if (n_channels > n_channels_previously) {
-        struct rawrtc_data_channel** channels_offset = channels + n_channels_previously;
-        memset(channels_offset, 0, (n_channels - n_channels_previously) * sizeof(*channels));
+    // Set path MTU for all peer addresses (or the defaults if not connected, yet)
+    DEBUG_PRINTF("Setting path MTU to %zu bytes\n", path_mtu);
+    peer_address_parameters.spp_flags = SPP_PMTUD_DISABLE;
+    peer_address_parameters.spp_pathmtu = (uint32_t) path_mtu;
+    if (usrsctp_setsockopt(transport->socket, IPPROTO_SCTP, SCTP_PEER_ADDR_PARAMS,
+                           &peer_address_parameters, sizeof(peer_address_parameters))) {
+        DEBUG_WARNING("Could not set path MTU, reason: %m\n", errno);
     }
-
-    // Set pointer & done
-    *channelsp = channels;
-    return RAWRTC_CODE_SUCCESS;
 }
 
 /*
@@ -1920,22 +3233,42 @@ static void rawrtc_sctp_transport_destroy(
 
     // Un-reference
     mem_deref(transport->channels);
+    mem_deref(transport->buffer_receive);
     mem_deref(transport->buffer_dcep_inbound);
-    list_flush(&transport->buffered_messages_outgoing);
+    sctp_discard_deferred_messages(transport);
+    mem_deref(transport->context_default);
+
+    // Not awaiting acknowledgements any longer
+    set_busy(transport, false);
+
+    // Flush gathered packets (if any)
+    if (transport->batch_le.list) {
+        list_unlink(&transport->batch_le);
+        rawrtc_dtls_transport_batch_flush(transport->dtls_transport);
+    }
     mem_deref(transport->dtls_transport);
 
+    // Remove from the shard's and the global table & stop the shard's timer (if needed)
+    // Note: Callbacks for this transport will be dropped from now on.
+    hash_unlink(&transport->shard_le);
+    pthread_mutex_lock(&rawrtc_global.sctp_transports_mutex);
+    hash_unlink(&transport->global_le);
+    pthread_mutex_unlock(&rawrtc_global.sctp_transports_mutex);
+    --transport->shard->usrsctp_transports;
+    if (transport->shard->usrsctp_transports == 0) {
+        tmr_cancel(&transport->shard->usrsctp_tick_timer);
+    }
+
     // Decrease in-use counter
+    pthread_mutex_lock(&rawrtc_global.usrsctp_mutex);
     --rawrtc_global.usrsctp_initialized;
 
     // Close usrsctp (if needed)
     if (rawrtc_global.usrsctp_initialized == 0) {
-        // Cancel timer
-        tmr_cancel(&rawrtc_global.usrsctp_tick_timer);
-
-        // Close
         usrsctp_finish();
         DEBUG_PRINTF("Closed usrsctp\n");
     }
+    pthread_mutex_unlock(&rawrtc_global.usrsctp_mutex);
 }
 
 /*
@@ -1959,6 +3292,8 @@ enum rawrtc_code rawrtc_sctp_transport_create(
     size_t i;
     int option_value;
     struct sockaddr_conn peer = {0};
+    struct rawrtc_shard* const shard = rawrtc_shard_current();
+    bool determine_chunk_size;
 
     // Check arguments
     if (!transportp || !dtls_transport) {
@@ -1990,9 +3325,20 @@ enum rawrtc_code rawrtc_sctp_transport_create(
     }
 
     // Initialise usrsctp (if needed)
+    // Note: The lock is being held until the in-use counter has been increased.
+    pthread_mutex_lock(&rawrtc_global.usrsctp_mutex);
     if (rawrtc_global.usrsctp_initialized == 0) {
         DEBUG_PRINTF("Initialising usrsctp\n");
+#ifdef RAWRTC_HAVE_USRSCTP_INIT_NOTHREADS
+        // Note: Timers are driven by the shards' timers, so usrsctp does not need its threads
+        usrsctp_init_nothreads(0, sctp_packet_handler, dbg_info);
+#else
+        // Note: The usrsctp fork pinned by make-dependencies.sh does not provide
+        //       `usrsctp_init_nothreads`. Its own timer thread drives its timers, so the shards
+        //       must not call `usrsctp_handle_timers` as well. Otherwise, timers would advance
+        //       twice as fast.
         usrsctp_init(0, sctp_packet_handler, dbg_info);
+#endif
 
         // TODO: Debugging depending on options
 #ifdef SCTP_DEBUG
@@ -2031,21 +3377,45 @@ enum rawrtc_code rawrtc_sctp_transport_create(
         // See: https://tools.ietf.org/html/rfc6458#section-8.1.20
         usrsctp_sysctl_set_sctp_default_frag_interleave(2);
 
-        // Start timers
-        tmr_init(&rawrtc_global.usrsctp_tick_timer);
-        tmr_start(&rawrtc_global.usrsctp_tick_timer, RAWRTC_SCTP_TRANSPORT_TIMER_TIMEOUT,
-                  timer_handler, NULL);
+        // Set time of the last tick
+        pthread_mutex_lock(&rawrtc_global.usrsctp_timer_mutex);
+        __atomic_store_n(&rawrtc_global.usrsctp_tick_time, tmr_jiffies(), __ATOMIC_RELAXED);
+        pthread_mutex_unlock(&rawrtc_global.usrsctp_timer_mutex);
     }
 
     // Allocate
     transport = mem_zalloc(sizeof(*transport), rawrtc_sctp_transport_destroy);
     if (!transport) {
+        pthread_mutex_unlock(&rawrtc_global.usrsctp_mutex);
         return RAWRTC_CODE_NO_MEMORY;
     }
 
     // Increase in-use counter
     // Note: This needs to be below allocation to ensure the counter is decreased properly on error
     ++rawrtc_global.usrsctp_initialized;
+    determine_chunk_size = rawrtc_global.usrsctp_initialized == 1;
+    pthread_mutex_unlock(&rawrtc_global.usrsctp_mutex);
+
+    // Assign a unique usrsctp address & add to the global table (for routing callbacks)
+    // Note: The address is being used instead of the transport's pointer, so usrsctp callbacks
+    //       never carry a pointer to a transport that may have been destroyed already.
+    pthread_mutex_lock(&rawrtc_global.sctp_transports_mutex);
+    transport->address = ++rawrtc_global.sctp_transport_address;
+    transport->shard = shard;
+    hash_append(rawrtc_global.sctp_transports, (uint32_t) transport->address,
+                &transport->global_le, transport);
+    pthread_mutex_unlock(&rawrtc_global.sctp_transports_mutex);
+
+    // Pin to the shard of the calling thread & start the shard's timer (if needed)
+    hash_append(shard->sctp_transports, (uint32_t) transport->address, &transport->shard_le,
+                transport);
+    ++shard->usrsctp_transports;
+    if (shard->usrsctp_transports == 1) {
+        shard->usrsctp_activity_time = tmr_jiffies();
+#ifdef RAWRTC_HAVE_USRSCTP_INIT_NOTHREADS
+        timer_schedule(shard, rawrtc_default_config.sctp_timer_interval);
+#endif
+    }
 
     // Set fields/reference
     transport->state = RAWRTC_SCTP_TRANSPORT_STATE_NEW; // TODO: Raise state (delayed)?
@@ -2054,10 +3424,21 @@ enum rawrtc_code rawrtc_sctp_transport_create(
     transport->data_channel_handler = data_channel_handler;
     transport->state_change_handler = state_change_handler;
     transport->arg = arg;
-    list_init(&transport->buffered_messages_outgoing);
+    list_init(&transport->contexts_outgoing);
+
+    // Busy until the handshake has been completed
+    set_busy(transport, true);
 
-    // Allocate channel array
-    error = data_channels_alloc(&transport->channels, n_channels, 0);
+    // Create default context (for messages sent without a data channel)
+    error = channel_context_create(
+            &transport->context_default, 0, RAWRTC_DCEP_CHANNEL_PRIORITY_NORMAL, false);
+    if (error) {
+        goto out;
+    }
+
+    // Create channel map
+    // Note: Pages are allocated on demand, so the number of streams does not matter here.
+    error = rawrtc_sid_map_create(&transport->channels);
     if (error) {
         goto out;
     }
@@ -2100,7 +3481,7 @@ enum rawrtc_code rawrtc_sctp_transport_create(
     }
 
     // Register instance
-    usrsctp_register_address(transport);
+    usrsctp_register_address((void*) transport->address);
 
     // Make socket non-blocking
     if (usrsctp_set_non_blocking(transport->socket, 1)) {
@@ -2110,14 +3491,15 @@ enum rawrtc_code rawrtc_sctp_transport_create(
     }
 
     // Set event callback
-    if (usrsctp_set_upcall(transport->socket, upcall_handler_helper, transport)) {
+    if (usrsctp_set_upcall(
+            transport->socket, upcall_handler_helper, (void*) transport->address)) {
         DEBUG_WARNING("Could not set event callback (upcall), reason: %m\n", errno);
         error = rawrtc_error_to_code(errno);
         goto out;
     }
 
     // Determine chunk size
-    if (rawrtc_global.usrsctp_initialized == 1) {
+    if (determine_chunk_size) {
         socklen_t option_size = sizeof(int); // PD point is int according to spec
         if (usrsctp_getsockopt(
                 transport->socket, IPPROTO_SCTP, SCTP_PARTIAL_DELIVERY_POINT,
@@ -2149,8 +3531,20 @@ enum rawrtc_code rawrtc_sctp_transport_create(
         goto out;
     }
 
-    // TODO: Set MTU (1200|1280 (IPv4|IPv6) - UDP - DTLS (cipher suite dependent) - SCTP (12)
-    // https://github.com/ortclib/ortclib-cpp/blob/master/ortc/cpp/ortc_SCTPTransport.cpp#L2143
+    // Use the fair bandwidth stream scheduler
+    // Note: Priorities are applied by the transport's scheduler which hands messages to usrsctp
+    //       in proportion to the data channels' priorities. usrsctp's priority scheduler would
+    //       be strict and let a high priority channel starve all others.
+    av.assoc_id = SCTP_ALL_ASSOC;
+    av.assoc_value = SCTP_SS_FAIR_BANDWITH;
+    if (usrsctp_setsockopt(transport->socket, IPPROTO_SCTP, SCTP_PLUGGABLE_SS,
+                           &av, sizeof(struct sctp_assoc_value))) {
+        DEBUG_WARNING("Could not set stream scheduler, reason: %m\n", errno);
+        error = rawrtc_error_to_code(errno);
+        goto out;
+    }
+
+    // Note: The path MTU will be set once attached to the DTLS transport
 
     // We want info
     option_value = 1;
@@ -2215,7 +3609,7 @@ enum rawrtc_code rawrtc_sctp_transport_create(
     // TODO: Check for existance of sconn_len
     //sconn.sconn_len = sizeof(peer);
     peer.sconn_port = htons(transport->port);
-    peer.sconn_addr = transport;
+    peer.sconn_addr = (void*) transport->address;
     if (usrsctp_bind(transport->socket, (struct sockaddr*) &peer, sizeof(peer))) {
         DEBUG_WARNING("Could not bind local address, reason: %m\n", errno);
         error = rawrtc_error_to_code(errno);
@@ -2225,7 +3619,7 @@ enum rawrtc_code rawrtc_sctp_transport_create(
     // Attach to ICE transport
     DEBUG_PRINTF("Attaching as data transport\n");
     error = rawrtc_dtls_transport_set_data_transport(
-            transport->dtls_transport, dtls_receive_handler, transport);
+            transport->dtls_transport, dtls_receive_handler, dtls_path_mtu_handler, transport);
     if (error) {
         goto out;
     }
@@ -2249,6 +3643,9 @@ static void channel_context_destroy(
     struct rawrtc_sctp_data_channel_context* const context = arg;
 
     // Un-reference
+    list_flush(&context->buffered_messages_outgoing);
+    mem_deref(context->stream);
+    list_flush(&context->chunks_inbound);
     mem_deref(context->buffer_inbound);
 }
 
@@ -2258,6 +3655,7 @@ static void channel_context_destroy(
 static enum rawrtc_code channel_context_create(
         struct rawrtc_sctp_data_channel_context** const contextp, // de-referenced, not checked
         uint16_t const sid,
+        uint_fast16_t const priority,
         bool const can_send_unordered
 ) {
     // Allocate context
@@ -2269,6 +3667,8 @@ static enum rawrtc_code channel_context_create(
 
     // Set fields
     context->sid = sid;
+    context->priority = priority > 0 ? priority : 1;
+    list_init(&context->buffered_messages_outgoing);
     if (can_send_unordered) {
         context->flags |= RAWRTC_SCTP_DATA_CHANNEL_FLAGS_CAN_SEND_UNORDERED;
     }
@@ -2289,7 +3689,7 @@ static bool channel_registered(
     struct rawrtc_sctp_data_channel_context* const context = channel->transport_arg;
 
     // Check status
-    if (transport->channels[context->sid] != channel) {
+    if (rawrtc_sid_map_get(transport->channels, context->sid) != channel) {
         DEBUG_WARNING("Invalid channel instance in slot. Please report this.\n");
         return false;
     } else {
@@ -2300,15 +3700,22 @@ static bool channel_registered(
 /*
  * Register data channel on transport.
  */
-static void channel_register(
+static enum rawrtc_code channel_register(
         struct rawrtc_sctp_transport* const transport, // not checked
         struct rawrtc_data_channel* const channel, // referenced, not checked
         struct rawrtc_sctp_data_channel_context* const context, // referenced, not checked
         bool const raise_event
 ) {
+    enum rawrtc_code error;
+
+    // Add to transport
+    error = rawrtc_sid_map_set(transport->channels, context->sid, channel);
+    if (error) {
+        return error;
+    }
+
     // Update channel with referenced context
     channel->transport_arg = mem_ref(context);
-    transport->channels[context->sid] = mem_ref(channel);
 
     // Raise data channel event?
     if (raise_event) {
@@ -2321,6 +3728,9 @@ static void channel_register(
     if (transport->state == RAWRTC_SCTP_TRANSPORT_STATE_CONNECTED) {
         rawrtc_data_channel_set_state(channel, RAWRTC_DATA_CHANNEL_STATE_OPEN);
     }
+
+    // Done
+    return RAWRTC_CODE_SUCCESS;
 }
 
 /*
@@ -2334,13 +3744,13 @@ static enum rawrtc_code channel_create_negotiated(
     // Check SID (> max, >= n_channels, or channel already occupied)
     if (parameters->id > RAWRTC_SCTP_TRANSPORT_SID_MAX ||
         parameters->id >= transport->n_channels ||
-        transport->channels[parameters->id]) {
+        rawrtc_sid_map_get(transport->channels, parameters->id)) {
         return RAWRTC_CODE_INVALID_ARGUMENT;
     }
 
     // Allocate context to be used as an argument for the data channel handlers
     // TODO: Is it okay to already allow sending unordered messages here? Assuming: Yes.
-    return channel_context_create(contextp, parameters->id, true);
+    return channel_context_create(contextp, parameters->id, parameters->priority, true);
 }
 
 /*
@@ -2379,9 +3789,10 @@ static enum rawrtc_code channel_create_inband(
     // Find free SID
     context = NULL;
     for (; i < transport->n_channels; i += 2) {
-        if (!transport->channels[i]) {
+        if (!rawrtc_sid_map_get(transport->channels, (uint16_t) i)) {
             // Allocate context to be used as an argument for the data channel handlers
-            error = channel_context_create(&context, (uint16_t) i, false);
+            error = channel_context_create(
+                    &context, (uint16_t) i, parameters->priority, false);
             if (error) {
                 return error;
             }
@@ -2453,11 +3864,11 @@ static enum rawrtc_code channel_create_handler(
     }
 
     // Register data channel
-    channel_register(sctp_transport, channel, context, false);
+    error = channel_register(sctp_transport, channel, context, false);
 
     // Un-reference & done
     mem_deref(context);
-    return RAWRTC_CODE_SUCCESS;
+    return error;
 }
 
 /*
@@ -2490,6 +3901,11 @@ static enum rawrtc_code channel_close_handler(
             return RAWRTC_CODE_UNKNOWN_ERROR;
         }
 
+        // Abort streamed message (if any)
+        if (context->stream) {
+            stream_abort(transport, context);
+        }
+
         // Reset outgoing streams
         // Important: This function will change the state of the channel to CLOSED
         //            and remove the channel from the transport on error.
@@ -2526,6 +3942,11 @@ static enum rawrtc_code channel_send_handler(
     // Get SCTP transport
     transport = channel->transport->transport;
 
+    // Check for a streamed message in progress
+    if (((struct rawrtc_sctp_data_channel_context*) channel->transport_arg)->stream) {
+        return RAWRTC_CODE_INVALID_STATE;
+    }
+
     // We accept both a NULL buffer and a buffer of length 0
     if (!buffer) {
         length = 0;
@@ -2587,6 +4008,189 @@ out:
     return error;
 }
 
+/*
+ * Send a batch of messages via the data channel (transport handler).
+ * Note: Consecutive non-empty messages are sent as a single batch sharing the same send info.
+ *       Empty messages need a different PPID and are sent individually.
+ */
+static enum rawrtc_code channel_send_batch_handler(
+        size_t* const n_sentp, // de-referenced
+        struct rawrtc_data_channel* const channel,
+        struct mbuf* const * const buffers, // entries nullable (if size 0), referenced
+        size_t const n_buffers,
+        bool const is_binary
+) {
+    struct rawrtc_sctp_transport* transport;
+    uint_fast32_t ppid;
+    size_t i;
+    size_t j;
+    size_t n_sent;
+    enum rawrtc_code error = RAWRTC_CODE_SUCCESS;
+
+    // Check arguments
+    if (!n_sentp || !channel || (!buffers && n_buffers > 0)) {
+        return RAWRTC_CODE_INVALID_ARGUMENT;
+    }
+
+    // Get SCTP transport
+    transport = channel->transport->transport;
+
+    // Check for a streamed message in progress
+    if (((struct rawrtc_sctp_data_channel_context*) channel->transport_arg)->stream) {
+        return RAWRTC_CODE_INVALID_STATE;
+    }
+
+    // Set PPID
+    // Note: We will not use the deprecated fragmentation & reassembly
+    if (is_binary) {
+        ppid = RAWRTC_SCTP_TRANSPORT_PPID_BINARY;
+    } else {
+        ppid = RAWRTC_SCTP_TRANSPORT_PPID_UTF16;
+    }
+
+    // Lock event loop mutex & gather outgoing packets
+    // Note: Locking only applies to threads without an event loop. On the event loop thread,
+    //       the gain is that the messages share one send info and their packets are flushed
+    //       together once the batch is complete (if packet batching is enabled).
+    rawrtc_thread_enter();
+    rawrtc_sctp_transport_packet_batch_enter();
+
+    // Send each run of non-empty messages
+    *n_sentp = 0;
+    for (i = 0; i < n_buffers; i = j) {
+        // Find end of run (and check size)
+        for (j = i; j < n_buffers && buffers[j] && mbuf_get_left(buffers[j]) > 0; ++j) {
+            if (transport->remote_maximum_message_size != 0 &&
+                mbuf_get_left(buffers[j]) > transport->remote_maximum_message_size) {
+                error = RAWRTC_CODE_MESSAGE_TOO_LONG;
+                break;
+            }
+        }
+
+        // Send run
+        if (j > i) {
+            enum rawrtc_code const run_error = send_messages(
+                    &n_sent, transport, channel, channel->transport_arg, &buffers[i], j - i, ppid);
+            *n_sentp += n_sent;
+            if (run_error) {
+                error = run_error;
+            }
+        }
+        if (error) {
+            break;
+        }
+
+        // Send empty message
+        if (j < n_buffers) {
+            error = channel_send_handler(channel, buffers[j], is_binary);
+            if (error) {
+                break;
+            }
+            ++*n_sentp;
+            ++j;
+        }
+    }
+
+    // Flush outgoing packets & unlock event loop mutex
+    rawrtc_sctp_transport_packet_batch_leave();
+    rawrtc_thread_leave();
+
+    // Done
+    return error;
+}
+
+/*
+ * Send a streamed message via the data channel (transport handler).
+ */
+static enum rawrtc_code channel_send_stream_handler(
+        struct rawrtc_data_channel* const channel,
+        rawrtc_data_channel_message_producer* const producer,
+        size_t const window,
+        bool const is_binary,
+        void* const arg // nullable
+) {
+    struct rawrtc_sctp_transport* transport;
+    struct rawrtc_sctp_data_channel_context* context;
+    struct rawrtc_sctp_message_stream* stream;
+    enum rawrtc_code error;
+
+    // Check arguments
+    if (!channel || !producer) {
+        return RAWRTC_CODE_INVALID_ARGUMENT;
+    }
+
+    // Get SCTP transport & context
+    transport = channel->transport->transport;
+    context = channel->transport_arg;
+
+    // Check for a streamed message in progress
+    if (context->stream) {
+        return RAWRTC_CODE_INVALID_STATE;
+    }
+
+    // Allocate
+    stream = mem_zalloc(sizeof(*stream), message_stream_destroy);
+    if (!stream) {
+        return RAWRTC_CODE_NO_MEMORY;
+    }
+
+    // Set fields
+    // Note: We will not use the deprecated fragmentation & reassembly
+    stream->producer = producer;
+    stream->arg = arg;
+    stream->window = window > 0 ? window : RAWRTC_SCTP_TRANSPORT_STREAM_WINDOW_DEFAULT;
+    stream->is_binary = is_binary;
+    error = send_info_init(&stream->spa, channel, context, is_binary ?
+            RAWRTC_SCTP_TRANSPORT_PPID_BINARY : RAWRTC_SCTP_TRANSPORT_PPID_UTF16);
+    if (error) {
+        mem_deref(stream);
+        return error;
+    }
+
+    // Attach to context
+    context->stream = stream;
+
+    // Lock event loop mutex
+    rawrtc_thread_enter();
+    rawrtc_sctp_transport_packet_batch_enter();
+
+    // Start producing
+    error = stream_produce_parts(transport, context);
+    if (error) {
+        stream_fail(transport, context, error);
+    }
+
+    // Flush outgoing packets & unlock event loop mutex
+    rawrtc_sctp_transport_packet_batch_leave();
+    rawrtc_thread_leave();
+
+    // Done
+    return error;
+}
+
+/*
+ * Get the amount of bytes buffered on the data channel (transport handler).
+ */
+static enum rawrtc_code channel_get_buffered_amount_handler(
+        uint64_t* const buffered_amountp, // de-referenced
+        struct rawrtc_data_channel* const channel
+) {
+    struct rawrtc_sctp_data_channel_context* context;
+
+    // Check arguments
+    if (!buffered_amountp || !channel) {
+        return RAWRTC_CODE_INVALID_ARGUMENT;
+    }
+
+    // Get context
+    // Note: The context will be NULL if the channel has not been registered yet
+    context = channel->transport_arg;
+
+    // Set buffered amount & done
+    *buffered_amountp = context ? context->buffered_amount : 0;
+    return RAWRTC_CODE_SUCCESS;
+}
+
 /*
  * Get the SCTP data transport instance.
  */
@@ -2610,7 +4214,9 @@ enum rawrtc_code rawrtc_sctp_transport_get_data_transport(
     // Create data transport
     error = rawrtc_data_transport_create(
             &transport, RAWRTC_DATA_TRANSPORT_TYPE_SCTP, sctp_transport,
-            channel_create_handler, channel_close_handler, channel_send_handler);
+            channel_create_handler, channel_close_handler, channel_send_handler,
+            channel_send_batch_handler, channel_send_stream_handler,
+            channel_get_buffered_amount_handler);
     if (error) {
         return error;
     }
@@ -2654,7 +4260,7 @@ enum rawrtc_code rawrtc_sctp_transport_start(
     // TODO: Check for existance of sconn_len
     //sconn.sconn_len = sizeof(peer);
     peer.sconn_port = htons(remote_port);
-    peer.sconn_addr = transport;
+    peer.sconn_addr = (void*) transport->address;
 
     // Connect
     DEBUG_PRINTF("Connecting to peer\n");
@@ -2665,10 +4271,6 @@ enum rawrtc_code rawrtc_sctp_transport_start(
         goto out;
     }
 
-    // TODO: Initiate Path MTU discovery (https://tools.ietf.org/html/rfc4821)
-    // by using probing messages (https://tools.ietf.org/html/rfc4820)
-    // see https://tools.ietf.org/html/draft-ietf-rtcweb-data-channel-13#section-5
-
     // Transition to connecting state
     set_state(transport, RAWRTC_SCTP_TRANSPORT_STATE_CONNECTING);
 
@@ -2846,8 +4448,9 @@ enum rawrtc_code sctp_transport_send(
 //            goto out;
         }
 
-        // Update buffer position
+        // Update buffer position & await acknowledgement
         mbuf_advance(buffer, written);
+        set_busy(transport, true);
     } while (mbuf_get_left(buffer) > 0);
 
     // Done
@@ -2863,69 +4466,196 @@ out:
 }
 
 /*
- * Send a message via the SCTP transport.
+ * Send messages via the SCTP transport or buffer them on the data channel context.
+ * `*n_sentp` will contain the amount of messages that have been sent or buffered.
+ * Note: All messages share the same info, so the info and the buffering context only need to be
+ *       created once per batch.
  */
-enum rawrtc_code rawrtc_sctp_transport_send(
-        struct rawrtc_sctp_transport* const transport,
-        struct mbuf* const buffer,
-        void* const info,
+static enum rawrtc_code sctp_transport_send_or_buffer(
+        size_t* const n_sentp, // de-referenced, not checked
+        struct rawrtc_sctp_transport* const transport, // not checked
+        struct rawrtc_sctp_data_channel_context* const context, // not checked
+        struct mbuf* const * const buffers, // not checked
+        size_t const n_buffers,
+        void* const info, // not checked
         socklen_t const info_size,
         unsigned int const info_type,
         int const flags
 ) {
-    struct send_context* context;
-    enum rawrtc_code error;
-
-    // Check arguments
-    if (!transport || !buffer) {
-        return RAWRTC_CODE_INVALID_ARGUMENT;
-    }
+    struct send_context* send_context = NULL;
+    bool sent_partially = false;
+    size_t i = 0;
+    enum rawrtc_code error = RAWRTC_CODE_SUCCESS;
 
-    // Clear buffered amount low flag
+    // Clear buffered amount low flags
     transport->flags &= ~RAWRTC_SCTP_TRANSPORT_FLAGS_BUFFERED_AMOUNT_LOW;
+    context->flags &= ~RAWRTC_SCTP_DATA_CHANNEL_FLAGS_BUFFERED_AMOUNT_LOW;
 
-    // Send directly (if connected and no outstanding messages)
+    // Send directly (if connected, no outstanding messages and no other message in progress)
     if (transport->state == RAWRTC_SCTP_TRANSPORT_STATE_CONNECTED &&
-            list_isempty(&transport->buffered_messages_outgoing)) {
-        // Try sending
-        DEBUG_PRINTF("Message queue is empty, sending directly\n");
-        error = sctp_transport_send(
-                transport, buffer, info, info_size, info_type, flags);
-        switch (error) {
-            case RAWRTC_CODE_SUCCESS:
-                // Done
-                return RAWRTC_CODE_SUCCESS;
-            case RAWRTC_CODE_TRY_AGAIN_LATER:
+            list_isempty(&transport->contexts_outgoing) &&
+            (!transport->context_sending || transport->context_sending == context)) {
+        DEBUG_PRINTF("Message queues are empty, sending directly\n");
+        for (; i < n_buffers; ++i) {
+            size_t const length = mbuf_get_left(buffers[i]);
+
+            // Try sending
+            error = sctp_transport_send(
+                    transport, buffers[i], info, info_size, info_type, flags);
+            if (error == RAWRTC_CODE_TRY_AGAIN_LATER) {
                 DEBUG_PRINTF("Need to buffer message and wait for a write request\n");
+                sent_partially = mbuf_get_left(buffers[i]) < length;
                 break;
-            case RAWRTC_CODE_MESSAGE_TOO_LONG:
-                DEBUG_WARNING("Incorrect message size guess, report this!\n");
-                return error;
-            default:
-                return error;
+            }
+            if (error) {
+                if (error == RAWRTC_CODE_MESSAGE_TOO_LONG) {
+                    DEBUG_WARNING("Incorrect message size guess, report this!\n");
+                }
+                goto out;
+            }
+
+            // Keep the context locked until the end of the record has been sent
+            transport->context_sending = send_info_eor(info, info_type) ? NULL : context;
+        }
+
+        // Done (if all messages have been sent)
+        if (i == n_buffers) {
+            error = RAWRTC_CODE_SUCCESS;
+            goto out;
         }
     }
 
     // Create message context (for buffering)
-    error = message_send_context_create(&context, info, info_type, flags);
+    // Note: The context is shared among all buffered messages of this batch.
+    error = message_send_context_create(&send_context, info, info_type, flags);
     if (error) {
         goto out;
     }
 
-    // Buffer message
-    error = rawrtc_message_buffer_append(&transport->buffered_messages_outgoing, buffer, context);
-    if (error) {
-        goto out;
+    // Buffer remaining messages
+    for (; i < n_buffers; ++i) {
+        error = rawrtc_message_buffer_append(
+                &context->buffered_messages_outgoing, buffers[i], send_context);
+        if (error) {
+            break;
+        }
+        context->buffered_amount += mbuf_get_left(buffers[i]);
+        DEBUG_PRINTF("Buffered outgoing message of size %zu on SID %"PRIu16"\n",
+                     mbuf_get_left(buffers[i]), context->sid);
+    }
+
+    // Add context to the scheduler (if not already added and any message has been buffered)
+    if (!context->le.list && !list_isempty(&context->buffered_messages_outgoing)) {
+        list_append(&transport->contexts_outgoing, &context->le, mem_ref(context));
+    }
+
+    // Lock the context (if the first buffered message has been sent partially)
+    if (sent_partially && context->le.list) {
+        transport->context_sending = context;
     }
-    DEBUG_PRINTF("Buffered outgoing message of size %zu\n", mbuf_get_left(buffer));
 
 out:
     // Un-reference
-    mem_deref(context);
+    mem_deref(send_context);
 
+    // Set amount of messages sent or buffered
+    *n_sentp = i;
     return error;
 }
 
+/*
+ * Send a message via the SCTP transport.
+ */
+enum rawrtc_code rawrtc_sctp_transport_send(
+        struct rawrtc_sctp_transport* const transport,
+        struct mbuf* const buffer,
+        void* const info,
+        socklen_t const info_size,
+        unsigned int const info_type,
+        int const flags
+) {
+    size_t n_sent;
+
+    // Check arguments
+    if (!transport || !buffer) {
+        return RAWRTC_CODE_INVALID_ARGUMENT;
+    }
+
+    // Send or buffer on the default context
+    return sctp_transport_send_or_buffer(
+            &n_sent, transport, transport->context_default, &buffer, 1,
+            info, info_size, info_type, flags);
+}
+
+/*
+ * Send a batch of messages via the SCTP transport.
+ * All messages will be sent using the same info.
+ * `*n_sentp` will contain the amount of messages that have been sent or
+ * buffered, even if an error is being returned.
+ */
+enum rawrtc_code rawrtc_sctp_transport_send_batch(
+        size_t* const n_sentp, // de-referenced, nullable
+        struct rawrtc_sctp_transport* const transport,
+        struct mbuf* const * const buffers, // referenced
+        size_t const n_buffers,
+        void* const info,
+        socklen_t const info_size,
+        unsigned int const info_type,
+        int const flags
+) {
+    size_t i;
+    size_t n_sent;
+    enum rawrtc_code error;
+
+    // Check arguments
+    if (!transport || (!buffers && n_buffers > 0)) {
+        return RAWRTC_CODE_INVALID_ARGUMENT;
+    }
+    for (i = 0; i < n_buffers; ++i) {
+        if (!buffers[i]) {
+            return RAWRTC_CODE_INVALID_ARGUMENT;
+        }
+    }
+
+    // Send or buffer on the default context
+    // Note: Holding the lock for the whole batch avoids re-locking for each outgoing packet.
+    rawrtc_thread_enter();
+    rawrtc_sctp_transport_packet_batch_enter();
+    error = sctp_transport_send_or_buffer(
+            &n_sent, transport, transport->context_default, buffers, n_buffers,
+            info, info_size, info_type, flags);
+    rawrtc_sctp_transport_packet_batch_leave();
+    rawrtc_thread_leave();
+
+    // Set amount of messages sent or buffered (if requested)
+    if (n_sentp) {
+        *n_sentp = n_sent;
+    }
+    return error;
+}
+
+/*
+ * Set whether usrsctp callbacks invoked on a thread other than the
+ * transport's shard are handed off to the shard (`true`) or lock the
+ * event loop (`false`, default).
+ * Note: In case usrsctp runs its own threads, callbacks invoked on
+ *       these threads are always handed off.
+ */
+enum rawrtc_code rawrtc_sctp_transport_set_callback_handoff(
+        struct rawrtc_sctp_transport* const transport,
+        bool const handoff
+) {
+    // Check arguments
+    if (!transport) {
+        return RAWRTC_CODE_INVALID_ARGUMENT;
+    }
+
+    // Set setting
+    // Note: Read by other threads (see `callback_handoff_enabled`).
+    __atomic_store_n(&transport->callback_handoff, handoff, __ATOMIC_RELAXED);
+    return RAWRTC_CODE_SUCCESS;
+}
+
 /*
  * Get the local port of the SCTP transport.
  */
@@ -2944,3 +4674,104 @@ enum rawrtc_code rawrtc_sctp_transport_get_port(
     // Done
     return RAWRTC_CODE_SUCCESS;
 }
+
+/*
+ * Get a snapshot of the SCTP transport's statistics.
+ */
+enum rawrtc_code rawrtc_sctp_transport_get_statistics(
+        struct rawrtc_sctp_transport_statistics* const statisticsp, // written into
+        struct rawrtc_sctp_transport* const transport
+) {
+    // Check arguments
+    if (!statisticsp || !transport) {
+        return RAWRTC_CODE_INVALID_ARGUMENT;
+    }
+
+    // Copy statistics
+    *statisticsp = transport->statistics;
+
+    // Done
+    return RAWRTC_CODE_SUCCESS;
+}
+
+/*
+ * Get the (approximate) amount of memory in bytes used by the SCTP
+ * transport and its data channels.
+ */
+enum rawrtc_code rawrtc_sctp_transport_get_memory_usage(
+        size_t* const sizep, // de-referenced
+        struct rawrtc_sctp_transport* const transport
+) {
+    size_t size;
+
+    // Check arguments
+    if (!sizep || !transport) {
+        return RAWRTC_CODE_INVALID_ARGUMENT;
+    }
+
+    // Transport, channel map & data channels
+    size = sizeof(*transport) + rawrtc_sid_map_size(transport->channels);
+    size += transport->channels->n_entries *
+            (sizeof(struct rawrtc_data_channel) + sizeof(struct rawrtc_sctp_data_channel_context));
+
+    // Buffers
+    if (transport->buffer_receive) {
+        size += transport->buffer_receive->size;
+    }
+    if (transport->buffer_dcep_inbound) {
+        size += transport->buffer_dcep_inbound->size;
+    }
+
+    // Set size & done
+    *sizep = size;
+    return RAWRTC_CODE_SUCCESS;
+}
+
+/*
+ * Get a snapshot of the (global) SCTP timer's statistics.
+ */
+enum rawrtc_code rawrtc_sctp_transport_get_timer_statistics(
+        struct rawrtc_sctp_timer_statistics* const statisticsp // written into
+) {
+    // Check arguments
+    if (!statisticsp) {
+        return RAWRTC_CODE_INVALID_ARGUMENT;
+    }
+
+    // Copy statistics
+    pthread_mutex_lock(&rawrtc_global.usrsctp_mutex);
+    *statisticsp = rawrtc_global.usrsctp_timer_statistics;
+    pthread_mutex_unlock(&rawrtc_global.usrsctp_mutex);
+
+    // Done
+    return RAWRTC_CODE_SUCCESS;
+}
+
+/*
+ * Get a snapshot of the (global) SCTP callback statistics.
+ */
+enum rawrtc_code rawrtc_sctp_transport_get_callback_statistics(
+        struct rawrtc_sctp_callback_statistics* const statisticsp // written into
+) {
+    struct rawrtc_sctp_callback_statistics* const statistics =
+            &rawrtc_global.usrsctp_callback_statistics;
+
+    // Check arguments
+    if (!statisticsp) {
+        return RAWRTC_CODE_INVALID_ARGUMENT;
+    }
+
+    // Copy statistics
+    // Note: Updated atomically from several threads, so we cannot simply copy the struct.
+    statisticsp->callbacks = __atomic_load_n(&statistics->callbacks, __ATOMIC_RELAXED);
+    statisticsp->locked_callbacks = __atomic_load_n(
+            &statistics->locked_callbacks, __ATOMIC_RELAXED);
+    statisticsp->lock_wait_time = __atomic_load_n(&statistics->lock_wait_time, __ATOMIC_RELAXED);
+    statisticsp->handed_off_callbacks = __atomic_load_n(
+            &statistics->handed_off_callbacks, __ATOMIC_RELAXED);
+    statisticsp->handoff_latency = __atomic_load_n(
+            &statistics->handoff_latency, __ATOMIC_RELAXED);
+
+    // Done
+    return RAWRTC_CODE_SUCCESS;
+}
@@ -7,11 +7,13 @@
 #define RAWRTC_SCTP_EVENT_ALL (SCTP_EVENT_READ | SCTP_EVENT_WRITE | SCTP_EVENT_ERROR)
 
 enum {
-    RAWRTC_SCTP_TRANSPORT_TIMER_TIMEOUT = 10,
+    RAWRTC_SCTP_TRANSPORT_TIMER_IDLE_DELAY = 250, // > usrsctp's delayed SACK timeout (200 ms)
     RAWRTC_SCTP_TRANSPORT_DEFAULT_PORT = 5000,
     RAWRTC_SCTP_TRANSPORT_DEFAULT_NUMBER_OF_STREAMS = 65535,
     RAWRTC_SCTP_TRANSPORT_SID_MAX = 65534,
-    RAWRTC_SCTP_TRANSPORT_EMPTY_MESSAGE_SIZE = 1
+    RAWRTC_SCTP_TRANSPORT_EMPTY_MESSAGE_SIZE = 1,
+    RAWRTC_SCTP_TRANSPORT_STREAM_WINDOW_DEFAULT = 1024 * 1024,
+    RAWRTC_SCTP_TRANSPORT_STREAM_PART_SIZE = 64 * 1024
 };
 
 /*
@@ -19,7 +21,8 @@ enum {
  */
 enum {
     RAWRTC_SCTP_TRANSPORT_FLAGS_SENDING_IN_PROGRESS = 1 << 0,
-    RAWRTC_SCTP_TRANSPORT_FLAGS_BUFFERED_AMOUNT_LOW = 1 << 1
+    RAWRTC_SCTP_TRANSPORT_FLAGS_BUFFERED_AMOUNT_LOW = 1 << 1,
+    RAWRTC_SCTP_TRANSPORT_FLAGS_BUSY = 1 << 2
 };
 
 /*
@@ -29,7 +32,8 @@ enum {
     RAWRTC_SCTP_DATA_CHANNEL_FLAGS_CAN_SEND_UNORDERED = 1 << 0,
     RAWRTC_SCTP_DATA_CHANNEL_FLAGS_PENDING_STREAM_RESET = 1 << 1,
     RAWRTC_SCTP_DATA_CHANNEL_FLAGS_INCOMING_STREAM_RESET = 1 << 2,
-    RAWRTC_SCTP_DATA_CHANNEL_FLAGS_OUTGOING_STREAM_RESET = 1 << 3
+    RAWRTC_SCTP_DATA_CHANNEL_FLAGS_OUTGOING_STREAM_RESET = 1 << 3,
+    RAWRTC_SCTP_DATA_CHANNEL_FLAGS_BUFFERED_AMOUNT_LOW = 1 << 4
 };
 
 /*
@@ -79,3 +83,18 @@ enum rawrtc_code rawrtc_sctp_transport_send(
     unsigned int const info_type,
     int const flags
 );
+
+enum rawrtc_code rawrtc_sctp_transport_send_batch(
+    size_t* const n_sentp, // de-referenced, nullable
+    struct rawrtc_sctp_transport* const transport,
+    struct mbuf* const * const buffers, // referenced
+    size_t const n_buffers,
+    void* const info,
+    socklen_t const info_size,
+    unsigned int const info_type,
+    int const flags
+);
+
+void rawrtc_sctp_transport_packet_batch_enter(void);
+
+void rawrtc_sctp_transport_packet_batch_leave(void);
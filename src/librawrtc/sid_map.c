@@ -0,0 +1,184 @@
+#include <rawrtc.h>
+#include "sid_map.h"
+
+#define DEBUG_MODULE "sid-map"
+//#define RAWRTC_DEBUG_MODULE_LEVEL 7 // Note: Uncomment this to debug this module only
+#include "debug.h"
+
+/*
+ * Destructor for an existing SID map page.
+ */
+static void sid_map_page_destroy(
+        void* arg
+) {
+    struct rawrtc_sid_map_page* const page = arg;
+    size_t i;
+
+    // Un-reference
+    for (i = 0; i < RAWRTC_SID_MAP_PAGE_SIZE; ++i) {
+        mem_deref(page->entries[i]);
+    }
+}
+
+/*
+ * Destructor for an existing SID map.
+ */
+static void sid_map_destroy(
+        void* arg
+) {
+    struct rawrtc_sid_map* const map = arg;
+    size_t i;
+
+    // Un-reference
+    for (i = 0; i < RAWRTC_SID_MAP_N_PAGES; ++i) {
+        mem_deref(map->pages[i]);
+    }
+}
+
+/*
+ * Create an empty SID map.
+ */
+enum rawrtc_code rawrtc_sid_map_create(
+        struct rawrtc_sid_map** const mapp // de-referenced
+) {
+    struct rawrtc_sid_map* map;
+
+    // Check arguments
+    if (!mapp) {
+        return RAWRTC_CODE_INVALID_ARGUMENT;
+    }
+
+    // Allocate
+    map = mem_zalloc(sizeof(*map), sid_map_destroy);
+    if (!map) {
+        return RAWRTC_CODE_NO_MEMORY;
+    }
+
+    // Set pointer & done
+    *mapp = map;
+    return RAWRTC_CODE_SUCCESS;
+}
+
+/*
+ * Get the item stored for a SID.
+ * Return the (not referenced) item or `NULL` in case the SID is not
+ * occupied.
+ */
+void* rawrtc_sid_map_get(
+        struct rawrtc_sid_map* const map, // not checked
+        uint16_t const sid
+) {
+    struct rawrtc_sid_map_page* const page = map->pages[sid >> RAWRTC_SID_MAP_PAGE_BITS];
+    return page ? page->entries[sid & (RAWRTC_SID_MAP_PAGE_SIZE - 1)] : NULL;
+}
+
+/*
+ * Store an item for a SID. Replaces (and un-references) the previous
+ * item (if any).
+ */
+enum rawrtc_code rawrtc_sid_map_set(
+        struct rawrtc_sid_map* const map, // not checked
+        uint16_t const sid,
+        void* const data // referenced
+) {
+    struct rawrtc_sid_map_page** const pagep = &map->pages[sid >> RAWRTC_SID_MAP_PAGE_BITS];
+    void** entryp;
+
+    // Check arguments
+    if (!data) {
+        return RAWRTC_CODE_INVALID_ARGUMENT;
+    }
+
+    // Allocate page (if needed)
+    if (!*pagep) {
+        *pagep = mem_zalloc(sizeof(**pagep), sid_map_page_destroy);
+        if (!*pagep) {
+            return RAWRTC_CODE_NO_MEMORY;
+        }
+        ++map->n_pages;
+    }
+
+    // Set entry
+    entryp = &(*pagep)->entries[sid & (RAWRTC_SID_MAP_PAGE_SIZE - 1)];
+    if (*entryp) {
+        mem_deref(*entryp);
+    } else {
+        ++(*pagep)->n_entries;
+        ++map->n_entries;
+    }
+    *entryp = mem_ref(data);
+
+    // Done
+    return RAWRTC_CODE_SUCCESS;
+}
+
+/*
+ * Remove (and un-reference) the item stored for a SID (if any). Frees
+ * the page once it is empty.
+ */
+void rawrtc_sid_map_unset(
+        struct rawrtc_sid_map* const map, // not checked
+        uint16_t const sid
+) {
+    struct rawrtc_sid_map_page** const pagep = &map->pages[sid >> RAWRTC_SID_MAP_PAGE_BITS];
+    struct rawrtc_sid_map_page* const page = *pagep;
+    void* data;
+
+    // Occupied?
+    if (!page || !page->entries[sid & (RAWRTC_SID_MAP_PAGE_SIZE - 1)]) {
+        return;
+    }
+
+    // Unset entry
+    // Note: The item is un-referenced last as its destructor may modify the map.
+    data = page->entries[sid & (RAWRTC_SID_MAP_PAGE_SIZE - 1)];
+    page->entries[sid & (RAWRTC_SID_MAP_PAGE_SIZE - 1)] = NULL;
+    --map->n_entries;
+
+    // Free page (if empty)
+    if (--page->n_entries == 0) {
+        *pagep = NULL;
+        --map->n_pages;
+        mem_deref(page);
+    }
+
+    // Un-reference
+    mem_deref(data);
+}
+
+/*
+ * Get the first occupied SID that is greater than or equal to `sid`.
+ * Return the (not referenced) item and set `*sidp` or return `NULL` in
+ * case there is no such SID.
+ */
+void* rawrtc_sid_map_next(
+        uint16_t* const sidp, // de-referenced
+        struct rawrtc_sid_map* const map, // not checked
+        uint_fast32_t sid
+) {
+    // Find next occupied entry (skipping empty pages)
+    while (sid <= UINT16_MAX) {
+        struct rawrtc_sid_map_page* const page = map->pages[sid >> RAWRTC_SID_MAP_PAGE_BITS];
+        if (!page) {
+            sid = (sid | (RAWRTC_SID_MAP_PAGE_SIZE - 1)) + 1;
+            continue;
+        }
+        if (page->entries[sid & (RAWRTC_SID_MAP_PAGE_SIZE - 1)]) {
+            *sidp = (uint16_t) sid;
+            return page->entries[sid & (RAWRTC_SID_MAP_PAGE_SIZE - 1)];
+        }
+        ++sid;
+    }
+
+    // None
+    return NULL;
+}
+
+/*
+ * Get the amount of memory used by the SID map in bytes.
+ */
+size_t rawrtc_sid_map_size(
+        struct rawrtc_sid_map* const map // not checked
+) {
+    return sizeof(*map) + map->n_pages * sizeof(struct rawrtc_sid_map_page);
+}
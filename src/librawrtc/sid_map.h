@@ -0,0 +1,57 @@
+#pragma once
+
+enum {
+    RAWRTC_SID_MAP_PAGE_BITS = 8,
+    RAWRTC_SID_MAP_PAGE_SIZE = 1 << RAWRTC_SID_MAP_PAGE_BITS,
+    RAWRTC_SID_MAP_N_PAGES = (UINT16_MAX + 1) >> RAWRTC_SID_MAP_PAGE_BITS,
+};
+
+/*
+ * Page of a SID map. Allocated once the first SID of its range has
+ * been occupied and freed once the last one has been released.
+ */
+struct rawrtc_sid_map_page {
+    uint_fast16_t n_entries;
+    void* entries[RAWRTC_SID_MAP_PAGE_SIZE]; // referenced
+};
+
+/*
+ * Sparse map from SCTP stream identifiers to referenced items.
+ * A two-level radix table: Lookups are O(1) and iteration in SID order
+ * skips unoccupied pages.
+ */
+struct rawrtc_sid_map {
+    size_t n_entries;
+    size_t n_pages;
+    struct rawrtc_sid_map_page* pages[RAWRTC_SID_MAP_N_PAGES]; // referenced
+};
+
+enum rawrtc_code rawrtc_sid_map_create(
+    struct rawrtc_sid_map** const mapp // de-referenced
+);
+
+void* rawrtc_sid_map_get(
+    struct rawrtc_sid_map* const map, // not checked
+    uint16_t const sid
+);
+
+enum rawrtc_code rawrtc_sid_map_set(
+    struct rawrtc_sid_map* const map, // not checked
+    uint16_t const sid,
+    void* const data // referenced
+);
+
+void rawrtc_sid_map_unset(
+    struct rawrtc_sid_map* const map, // not checked
+    uint16_t const sid
+);
+
+void* rawrtc_sid_map_next(
+    uint16_t* const sidp, // de-referenced
+    struct rawrtc_sid_map* const map, // not checked
+    uint_fast32_t sid
+);
+
+size_t rawrtc_sid_map_size(
+    struct rawrtc_sid_map* const map // not checked
+);
@@ -0,0 +1,342 @@
+#ifdef __linux__
+#ifndef _GNU_SOURCE
+#define _GNU_SOURCE // recvmmsg
+#endif
+#define RAWRTC_HAVE_MMSG
+#endif
+#include <string.h> // memset
+#include <sys/types.h>
+#include <sys/socket.h> // recvmsg, recvmmsg
+#include <errno.h>
+#include <rawrtc.h>
+#include "main.h"
+#include "sctp_transport.h"
+#include "udp_batch.h"
+
+#define DEBUG_MODULE "udp-batch"
+//#define RAWRTC_DEBUG_MODULE_LEVEL 7 // Note: Uncomment this to debug this module only
+#include "debug.h"
+
+/*
+ * Prepare the shard's receive buffers for another batch.
+ * Note: The buffers are shared by all batched sockets of the shard as
+ *       each batch is being dispatched before the next one is received.
+ */
+static enum rawrtc_code prepare_receive_buffers(
+        struct rawrtc_shard* const shard, // not checked
+        uint32_t const size,
+        size_t const buffer_size
+) {
+    uint32_t i;
+
+    for (i = 0; i < size; ++i) {
+        struct mbuf* const buffer = shard->udp_receive_buffers[i];
+
+        // Replace buffer if it is too small or still referenced elsewhere (or allocate it)
+        // Note: Handlers may buffer datagrams, e.g. until the DTLS transport has been started.
+        if (!buffer || buffer->size < buffer_size || mem_nrefs(buffer) > 1) {
+            mem_deref(buffer);
+            shard->udp_receive_buffers[i] = mbuf_alloc(buffer_size);
+            if (!shard->udp_receive_buffers[i]) {
+                return RAWRTC_CODE_NO_MEMORY;
+            }
+        }
+
+        // Rewind buffer
+        mbuf_rewind(shard->udp_receive_buffers[i]);
+    }
+
+    // Done
+    return RAWRTC_CODE_SUCCESS;
+}
+
+/*
+ * Count (and report) a datagram that has been truncated as it did not
+ * fit into the receive buffer.
+ */
+static void truncated(
+        struct rawrtc_shard* const shard, // not checked
+        struct rawrtc_udp_batch* const batch, // not checked
+        struct sa const* const source // not checked
+) {
+    struct rawrtc_udp_receive_statistics* const statistics = &shard->udp_receive_statistics;
+
+    // Report the first one (it's most likely a configuration issue)
+    if (statistics->datagrams_truncated == 0) {
+        DEBUG_NOTICE("Discarding datagram from %J larger than %zu bytes, consider raising the "
+                     "maximum path MTU\n", source, batch->buffer_size);
+    }
+    ++statistics->datagrams_truncated;
+}
+
+#ifdef RAWRTC_HAVE_MMSG
+/*
+ * Receive a batch of datagrams with a single `recvmmsg` call.
+ * Truncated datagrams are left empty.
+ * Return the amount of datagrams received or `-1` in case of an error.
+ */
+static int receive_batch(
+        struct rawrtc_shard* const shard, // not checked
+        struct rawrtc_udp_batch* const batch, // not checked
+        struct sa* const sources // not checked
+) {
+    uint32_t const size = batch->size;
+    struct mmsghdr messages[RAWRTC_UDP_BATCH_SIZE_MAX];
+    struct iovec vectors[RAWRTC_UDP_BATCH_SIZE_MAX];
+    int n_received;
+    int i;
+
+    // Prepare messages
+    memset(messages, 0, sizeof(messages[0]) * size);
+    for (i = 0; i < (int) size; ++i) {
+        vectors[i].iov_base = mbuf_buf(shard->udp_receive_buffers[i]);
+        vectors[i].iov_len = batch->buffer_size;
+        messages[i].msg_hdr.msg_name = &sources[i].u;
+        messages[i].msg_hdr.msg_namelen = sizeof(sources[i].u);
+        messages[i].msg_hdr.msg_iov = &vectors[i];
+        messages[i].msg_hdr.msg_iovlen = 1;
+    }
+
+    // Receive (whatever is pending)
+    n_received = recvmmsg(batch->fd, messages, size, MSG_DONTWAIT, NULL);
+    if (n_received < 0) {
+        return -1;
+    }
+
+    // Set lengths & source address lengths
+    for (i = 0; i < n_received; ++i) {
+        sources[i].len = messages[i].msg_hdr.msg_namelen;
+        if (messages[i].msg_hdr.msg_flags & MSG_TRUNC) {
+            truncated(shard, batch, &sources[i]);
+            continue;
+        }
+        mbuf_set_end(shard->udp_receive_buffers[i], messages[i].msg_len);
+    }
+    return n_received;
+}
+#else
+/*
+ * Receive a single datagram.
+ * A truncated datagram is left empty.
+ * Return the amount of datagrams received or `-1` in case of an error.
+ */
+static int receive_batch(
+        struct rawrtc_shard* const shard, // not checked
+        struct rawrtc_udp_batch* const batch, // not checked
+        struct sa* const sources // not checked
+) {
+    struct mbuf* const buffer = shard->udp_receive_buffers[0];
+    struct iovec vector;
+    struct msghdr message;
+    ssize_t length;
+
+    // Prepare message
+    memset(&message, 0, sizeof(message));
+    vector.iov_base = mbuf_buf(buffer);
+    vector.iov_len = batch->buffer_size;
+    message.msg_name = &sources[0].u;
+    message.msg_namelen = sizeof(sources[0].u);
+    message.msg_iov = &vector;
+    message.msg_iovlen = 1;
+
+    // Receive
+    length = recvmsg(batch->fd, &message, MSG_DONTWAIT);
+    if (length == -1) {
+        return -1;
+    }
+
+    // Set length & source address length
+    sources[0].len = message.msg_namelen;
+    if (message.msg_flags & MSG_TRUNC) {
+        truncated(shard, batch, &sources[0]);
+        return 1;
+    }
+    mbuf_set_end(buffer, (size_t) length);
+    return 1;
+}
+#endif
+
+/*
+ * Handle a readable socket: Receive a batch of datagrams and hand them
+ * to the socket's helpers and receive handler.
+ */
+static void read_handler(
+        int flags,
+        void* arg
+) {
+    struct rawrtc_udp_batch* const batch = arg;
+    struct rawrtc_shard* const shard = rawrtc_shard_current();
+    struct rawrtc_udp_receive_statistics* const statistics = &shard->udp_receive_statistics;
+    uint32_t const size = batch->size;
+    struct sa sources[RAWRTC_UDP_BATCH_SIZE_MAX];
+    enum rawrtc_code error;
+    int n_received;
+    int i;
+
+    if ((flags & FD_READ) != FD_READ) {
+        return;
+    }
+
+    // Prepare buffers
+    error = prepare_receive_buffers(shard, size, batch->buffer_size);
+    if (error) {
+        DEBUG_WARNING("Unable to prepare receive buffers: %s\n", rawrtc_code_to_str(error));
+        return;
+    }
+
+    // Receive
+    n_received = receive_batch(shard, batch, sources);
+    if (n_received == -1) {
+        if (errno != EAGAIN && errno != EWOULDBLOCK) {
+            DEBUG_WARNING("Unable to receive datagrams: %m\n", errno);
+        }
+        return;
+    }
+
+    // Update statistics
+    ++statistics->wakeups;
+    statistics->datagrams += (uint64_t) n_received;
+    if ((uint64_t) n_received > statistics->datagrams_max) {
+        statistics->datagrams_max = (uint64_t) n_received;
+    }
+    if ((uint32_t) n_received == size) {
+        ++statistics->full_batches;
+    }
+
+    // Hand datagrams to the layers above as a burst
+    // Note: Outgoing SCTP packets are gathered until the whole burst has been processed. The
+    //       handlers may release the last reference to the batch's owner.
+    mem_ref(batch);
+    rawrtc_sctp_transport_packet_batch_enter();
+    for (i = 0; i < n_received; ++i) {
+        struct mbuf* const buffer = shard->udp_receive_buffers[i];
+
+        // Skip truncated datagrams
+        if (mbuf_get_left(buffer) == 0) {
+            continue;
+        }
+
+        // Dispatch
+        udp_recv_helper(batch->socket, &sources[i], buffer, batch->helper);
+    }
+    rawrtc_sctp_transport_packet_batch_leave();
+    mem_deref(batch);
+}
+
+/*
+ * Pass through datagrams (that have not been received in a batch).
+ */
+static bool passthrough_handler(
+        struct sa* source,
+        struct mbuf* buffer,
+        void* arg
+) {
+    (void) source; (void) buffer; (void) arg;
+    return false; // Not handled
+}
+
+/*
+ * Destructor for an existing batched receiver.
+ */
+static void rawrtc_udp_batch_destroy(
+        void* arg
+) {
+    struct rawrtc_udp_batch* const batch = arg;
+
+    // Hand the socket back to re
+    if (batch->fd != -1) {
+        fd_close(batch->fd);
+        udp_thread_attach(batch->socket);
+    }
+
+    // Un-reference
+    mem_deref(batch->helper);
+    mem_deref(batch->socket);
+}
+
+/*
+ * Receive datagrams of a UDP socket in batches of up to `size`
+ * datagrams (if enabled). The receive buffers are sized to hold
+ * datagrams of the maximum path MTU (UDP payload size in bytes).
+ * Return `RAWRTC_CODE_NO_VALUE` in case batching is disabled.
+ */
+enum rawrtc_code rawrtc_udp_batch_attach(
+        struct rawrtc_udp_batch** const batchp, // de-referenced
+        struct udp_sock* const socket, // not checked, referenced
+        int const af,
+        uint32_t const size,
+        uint32_t const path_mtu_max
+) {
+    struct rawrtc_udp_batch* batch;
+    enum rawrtc_code error;
+
+    // Enabled?
+    // Note: A batch of one datagram would just replicate re's handler.
+    if (size <= 1) {
+        return RAWRTC_CODE_NO_VALUE;
+    }
+
+    // Allocate
+    batch = mem_zalloc(sizeof(*batch), rawrtc_udp_batch_destroy);
+    if (!batch) {
+        return RAWRTC_CODE_NO_MEMORY;
+    }
+
+    // Set fields/reference
+    // Note: The buffers are at least as large as re's, so batching never truncates datagrams
+    //       that would have been received without it.
+    batch->socket = mem_ref(socket);
+    batch->fd = -1;
+    batch->size = size > RAWRTC_UDP_BATCH_SIZE_MAX ? RAWRTC_UDP_BATCH_SIZE_MAX : size;
+    batch->buffer_size = path_mtu_max > RAWRTC_UDP_BATCH_BUFFER_SIZE_MIN
+            ? path_mtu_max : RAWRTC_UDP_BATCH_BUFFER_SIZE_MIN;
+
+    // Register helper on the lowest layer (dispatching starts above it)
+    error = rawrtc_error_to_code(udp_register_helper(
+            &batch->helper, socket, RAWRTC_LAYER_UDP_BATCH, NULL, passthrough_handler, batch));
+    if (error) {
+        goto out;
+    }
+
+    // Get file descriptor
+    batch->fd = udp_sock_fd(socket, af);
+    if (batch->fd == -1) {
+        error = RAWRTC_CODE_NO_SOCKET;
+        goto out;
+    }
+
+    // Replace re's file descriptor handler
+    udp_thread_detach(socket);
+    error = rawrtc_error_to_code(fd_listen(batch->fd, FD_READ, read_handler, batch));
+    if (error) {
+        udp_thread_attach(socket);
+        batch->fd = -1;
+        goto out;
+    }
+
+out:
+    if (error) {
+        mem_deref(batch);
+    } else {
+        // Set pointer
+        *batchp = batch;
+    }
+    return error;
+}
+
+/*
+ * Get a snapshot of the current shard's batched UDP receive
+ * statistics.
+ */
+enum rawrtc_code rawrtc_shard_get_receive_statistics(
+        struct rawrtc_udp_receive_statistics* const statisticsp // written into
+) {
+    // Check arguments
+    if (!statisticsp) {
+        return RAWRTC_CODE_INVALID_ARGUMENT;
+    }
+
+    // Copy statistics & done
+    *statisticsp = rawrtc_shard_current()->udp_receive_statistics;
+    return RAWRTC_CODE_SUCCESS;
+}
@@ -0,0 +1,29 @@
+#pragma once
+#include <rawrtc.h>
+
+enum {
+    RAWRTC_UDP_BATCH_SIZE_MAX = 64, // datagrams per wakeup
+    RAWRTC_UDP_BATCH_BUFFER_SIZE_MIN = 8192 // same as re's default receive buffer size
+};
+
+/*
+ * Batched receiver of a UDP socket: Replaces re's file descriptor
+ * handler and drains up to `size` datagrams per wakeup with a single
+ * system call. The datagrams are handed to the socket's helpers and
+ * receive handler as a burst.
+ */
+struct rawrtc_udp_batch {
+    struct udp_sock* socket; // referenced
+    struct udp_helper* helper; // entry point for dispatching
+    int fd;
+    uint32_t size;
+    size_t buffer_size; // per datagram, larger datagrams are truncated (and discarded)
+};
+
+enum rawrtc_code rawrtc_udp_batch_attach(
+    struct rawrtc_udp_batch** const batchp, // de-referenced
+    struct udp_sock* const socket, // not checked, referenced
+    int const af,
+    uint32_t const size,
+    uint32_t const path_mtu_max
+);
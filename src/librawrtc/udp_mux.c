@@ -0,0 +1,826 @@
+#include <string.h> // strlen
+#include <errno.h> // errno
+#include <pthread.h> // pthread_mutex_*
+#include <sys/socket.h> // bind, SOL_SOCKET, SO_REUSEPORT
+#include <rawrtc.h>
+#include "main.h"
+#include "candidate_helper.h"
+#include "packet_demux.h"
+#include "udp_batch.h"
+#include "udp_mux.h"
+#include "utils.h"
+
+#define DEBUG_MODULE "udp-mux"
+//#define RAWRTC_DEBUG_MODULE_LEVEL 7 // Note: Uncomment this to debug this module only
+#include "debug.h"
+
+/*
+ * Compare the local username fragment of an entry.
+ */
+static bool entry_username_fragment_equals(
+        struct le* le,
+        void* arg
+) {
+    struct rawrtc_udp_mux_entry* const entry = le->data;
+    struct pl const* const username_fragment = arg;
+    return pl_strcmp(
+            username_fragment, entry->candidate_helper->gatherer->ice_username_fragment) == 0;
+}
+
+/*
+ * Compare the remote address of a bound address.
+ */
+static bool address_equals(
+        struct le* le,
+        void* arg
+) {
+    struct rawrtc_udp_mux_address* const bound = le->data;
+    struct sa const* const address = arg;
+    return sa_cmp(&bound->address, address, SA_ALL);
+}
+
+/*
+ * Look up the entry of a local username fragment.
+ */
+static struct rawrtc_udp_mux_entry* lookup_entry(
+        struct rawrtc_udp_mux* const mux, // not checked
+        struct pl* const username_fragment // not checked
+) {
+    return list_ledata(hash_lookup(
+            mux->entries, hash_joaat((uint8_t const*) username_fragment->p, username_fragment->l),
+            entry_username_fragment_equals, username_fragment));
+}
+
+/*
+ * Look up the bound address of a remote address.
+ */
+static struct rawrtc_udp_mux_address* lookup_address(
+        struct rawrtc_udp_mux* const mux, // not checked
+        struct sa const* const address // not checked
+) {
+    return list_ledata(hash_lookup(
+            mux->addresses, sa_hash(address, SA_ALL), address_equals, (void*) address));
+}
+
+/*
+ * Key of a route lookup.
+ */
+struct route_key {
+    struct sa const* local_address;
+    struct pl const* username_fragment; // nullable
+    struct sa const* remote_address; // nullable
+};
+
+/*
+ * Calculate the hash of a route.
+ */
+static uint32_t route_hash(
+        struct sa const* const local_address, // not checked
+        struct pl const* const username_fragment, // nullable
+        struct sa const* const remote_address // nullable
+) {
+    uint32_t key = sa_hash(local_address, SA_ALL);
+    if (username_fragment) {
+        key ^= hash_joaat((uint8_t const*) username_fragment->p, username_fragment->l);
+    } else {
+        key ^= sa_hash(remote_address, SA_ALL);
+    }
+    return key;
+}
+
+/*
+ * Compare a route with a route key.
+ */
+static bool route_equals(
+        struct le* le,
+        void* arg
+) {
+    struct rawrtc_udp_mux_route* const route = le->data;
+    struct route_key const* const key = arg;
+
+    // Same local address?
+    if (!sa_cmp(&route->local_address, key->local_address, SA_ALL)) {
+        return false;
+    }
+
+    // Compare username fragment or remote address
+    if (key->username_fragment) {
+        return route->username_fragment
+                && pl_strcmp(key->username_fragment, route->username_fragment) == 0;
+    } else {
+        return !route->username_fragment
+                && sa_cmp(&route->remote_address, key->remote_address, SA_ALL);
+    }
+}
+
+/*
+ * Look up the shard a local username fragment or a remote address
+ * has been routed to.
+ * Return `NULL` in case there is no such route.
+ */
+static struct rawrtc_shard* lookup_route(
+        struct rawrtc_udp_mux* const mux, // not checked
+        struct pl const* const username_fragment, // nullable
+        struct sa const* const remote_address // nullable
+) {
+    struct route_key key = {
+        .local_address = &mux->local_address,
+        .username_fragment = username_fragment,
+        .remote_address = remote_address,
+    };
+    struct rawrtc_udp_mux_route* route;
+    struct rawrtc_shard* shard = NULL;
+
+    // Look up
+    pthread_mutex_lock(&rawrtc_global.udp_mux_routes_mutex);
+    route = list_ledata(hash_lookup(
+            rawrtc_global.udp_mux_routes,
+            route_hash(&mux->local_address, username_fragment, remote_address),
+            route_equals, &key));
+    if (route) {
+        shard = route->shard;
+    }
+    pthread_mutex_unlock(&rawrtc_global.udp_mux_routes_mutex);
+    return shard;
+}
+
+/*
+ * Destructor for an existing route.
+ */
+static void rawrtc_udp_mux_route_destroy(
+        void* arg
+) {
+    struct rawrtc_udp_mux_route* const route = arg;
+
+    // Remove from hash
+    pthread_mutex_lock(&rawrtc_global.udp_mux_routes_mutex);
+    hash_unlink(&route->le);
+    pthread_mutex_unlock(&rawrtc_global.udp_mux_routes_mutex);
+
+    // Un-reference
+    mem_deref(route->username_fragment);
+}
+
+/*
+ * Route a local username fragment or a remote address to the current
+ * shard. Does nothing in case the mux has been bound to an ephemeral
+ * port (it is not shared with other shards).
+ */
+static enum rawrtc_code route_create(
+        struct rawrtc_udp_mux_route** const routep, // de-referenced
+        struct rawrtc_udp_mux* const mux, // not checked
+        char* const username_fragment, // nullable, copied
+        struct sa const* const remote_address // nullable
+) {
+    struct rawrtc_udp_mux_route* route;
+    enum rawrtc_code error;
+    struct pl username_fragment_pl;
+
+    // Shared with other shards?
+    if (mux->port == 0) {
+        *routep = NULL;
+        return RAWRTC_CODE_SUCCESS;
+    }
+
+    // Allocate
+    route = mem_zalloc(sizeof(*route), rawrtc_udp_mux_route_destroy);
+    if (!route) {
+        return RAWRTC_CODE_NO_MEMORY;
+    }
+
+    // Set fields/copy
+    route->shard = rawrtc_shard_current();
+    route->local_address = mux->local_address;
+    if (username_fragment) {
+        error = rawrtc_strdup(&route->username_fragment, username_fragment);
+        if (error) {
+            mem_deref(route);
+            return error;
+        }
+        pl_set_str(&username_fragment_pl, username_fragment);
+    } else {
+        route->remote_address = *remote_address;
+    }
+
+    // Add to hash
+    pthread_mutex_lock(&rawrtc_global.udp_mux_routes_mutex);
+    hash_append(rawrtc_global.udp_mux_routes,
+                route_hash(&mux->local_address, username_fragment ? &username_fragment_pl : NULL,
+                           remote_address),
+                &route->le, route);
+    pthread_mutex_unlock(&rawrtc_global.udp_mux_routes_mutex);
+
+    // Set pointer & done
+    *routep = route;
+    return RAWRTC_CODE_SUCCESS;
+}
+
+/*
+ * Destructor for an existing bound address.
+ */
+static void rawrtc_udp_mux_address_destroy(
+        void* arg
+) {
+    struct rawrtc_udp_mux_address* const bound = arg;
+
+    // Remove from entry and hash
+    list_unlink(&bound->le);
+    hash_unlink(&bound->hash_le);
+
+    // Un-reference
+    mem_deref(bound->route);
+}
+
+/*
+ * Bind a remote address to an entry. Datagrams from this address will
+ * be handed to the entry's candidate from now on.
+ * A binding of the same address to another entry will only be moved
+ * if `rebind` is set. This MUST only be done for authenticated STUN
+ * binding requests, otherwise `RAWRTC_CODE_STILL_IN_USE` is returned.
+ */
+enum rawrtc_code rawrtc_udp_mux_entry_bind(
+        struct rawrtc_udp_mux_entry* const entry, // not checked
+        struct sa const* const address, // not checked
+        bool const rebind
+) {
+    struct rawrtc_udp_mux_address* bound;
+    enum rawrtc_code error;
+
+    // Already bound? Move to the front of the entry's list.
+    bound = lookup_address(entry->mux, address);
+    if (bound) {
+        if (bound->entry != entry) {
+            // Bound to another entry
+            // Note: Otherwise, anyone could take over another peer's traffic by signalling
+            //       its address.
+            if (!rebind) {
+                return RAWRTC_CODE_STILL_IN_USE;
+            }
+            DEBUG_PRINTF("Rebinding remote address %J\n", address);
+            list_unlink(&bound->le);
+            bound->entry = entry;
+        } else {
+            list_unlink(&bound->le);
+        }
+        list_prepend(&entry->addresses, &bound->le, bound);
+        return RAWRTC_CODE_SUCCESS;
+    }
+
+    // Limit reached? Replace the least recently bound address.
+    if (list_count(&entry->addresses) >= RAWRTC_UDP_MUX_ADDRESSES_MAX) {
+        mem_deref(list_ledata(list_tail(&entry->addresses)));
+    }
+
+    // Allocate
+    bound = mem_zalloc(sizeof(*bound), rawrtc_udp_mux_address_destroy);
+    if (!bound) {
+        return RAWRTC_CODE_NO_MEMORY;
+    }
+
+    // Set fields
+    bound->entry = entry;
+    bound->address = *address;
+
+    // Route to this shard
+    error = route_create(&bound->route, entry->mux, NULL, address);
+    if (error) {
+        mem_deref(bound);
+        return error;
+    }
+
+    // Add to entry and hash
+    list_prepend(&entry->addresses, &bound->le, bound);
+    hash_append(entry->mux->addresses, sa_hash(address, SA_ALL), &bound->hash_le, bound);
+    DEBUG_PRINTF("Bound remote address %J\n", address);
+    return RAWRTC_CODE_SUCCESS;
+}
+
+/*
+ * Hand a datagram to the candidate of an entry. The candidate helper's
+ * packet demultiplexer hands STUN messages to the ICE agent (or answers
+ * them directly in case of ICE lite) and everything else to the
+ * handler of its class (if any).
+ */
+static void dispatch(
+        struct rawrtc_udp_mux_entry* const entry, // not checked
+        struct sa* const source, // not checked
+        struct mbuf* const buffer // not checked
+) {
+    struct rawrtc_candidate_helper* const candidate_helper = entry->candidate_helper;
+
+    // ICE agent removed? (gatherer closed)
+    if (!candidate_helper->gatherer->ice) {
+        return;
+    }
+
+    // Hand to the packet demultiplexer
+    rawrtc_packet_demux_receive(candidate_helper->demux, source, buffer);
+}
+
+/*
+ * Find the entry of a STUN binding request by the local username
+ * fragment of its USERNAME attribute. The request's message integrity
+ * is verified with the entry's local password.
+ * Return `NULL` in case the message is not an authenticated binding
+ * request for one of the entries. If the username fragment belongs to
+ * an entry of another shard's mux, that shard will be set as owner.
+ * Note: `buffer` is left at its original position.
+ */
+static struct rawrtc_udp_mux_entry* find_request_entry(
+        struct rawrtc_udp_mux* const mux, // not checked
+        struct mbuf* const buffer, // not checked
+        bool* const is_requestp, // de-referenced
+        struct rawrtc_shard** const ownerp // de-referenced
+) {
+    size_t const position = buffer->pos;
+    struct stun_msg* message = NULL;
+    struct stun_attr* attribute;
+    struct pl username;
+    struct pl username_fragment;
+    char const* separator;
+    struct rawrtc_udp_mux_entry* entry = NULL;
+    char const* password;
+
+    // Decode
+    *is_requestp = false;
+    *ownerp = NULL;
+    if (stun_msg_decode(&message, buffer, NULL)) {
+        goto out;
+    }
+
+    // Binding request?
+    if (stun_msg_method(message) != STUN_METHOD_BINDING
+            || stun_msg_class(message) != STUN_CLASS_REQUEST) {
+        goto out;
+    }
+    *is_requestp = true;
+
+    // Get local username fragment (`<local>:<remote>`)
+    attribute = stun_msg_attr(message, STUN_ATTR_USERNAME);
+    if (!attribute) {
+        goto out;
+    }
+    pl_set_str(&username, attribute->v.username);
+    separator = pl_strchr(&username, ':');
+    if (!separator) {
+        goto out;
+    }
+    username_fragment.p = username.p;
+    username_fragment.l = (size_t) (separator - username.p);
+
+    // Look up entry (or the shard owning it)
+    entry = lookup_entry(mux, &username_fragment);
+    if (!entry) {
+        if (mux->port != 0) {
+            *ownerp = lookup_route(mux, &username_fragment, NULL);
+        }
+        goto out;
+    }
+
+    // Verify message integrity
+    password = entry->candidate_helper->gatherer->ice_password;
+    if (stun_msg_chk_mi(message, (uint8_t*) password, strlen(password))) {
+        ++mux->datagrams_unauthenticated;
+        entry = NULL;
+        goto out;
+    }
+
+out:
+    // Rewind
+    buffer->pos = position;
+
+    // Un-reference
+    mem_deref(message);
+    return entry;
+}
+
+/*
+ * Datagram handed to the shard of the mux it belongs to.
+ */
+struct handoff {
+    struct sa local_address;
+    struct sa source;
+    struct mbuf* buffer; // referenced
+};
+
+static void receive(
+    struct rawrtc_udp_mux* const mux, // not checked
+    struct sa* const source, // not checked
+    struct mbuf* const buffer, // not checked
+    bool const handed_off
+);
+
+/*
+ * Destructor for an existing handoff.
+ */
+static void handoff_destroy(
+        void* arg
+) {
+    struct handoff* const handoff = arg;
+
+    // Un-reference
+    mem_deref(handoff->buffer);
+}
+
+/*
+ * Handle a datagram handed off by another shard's mux (shard call).
+ */
+static void handoff_handler(
+        void* const arg
+) {
+    struct handoff* const handoff = arg;
+    struct le* le;
+
+    // Find the mux bound to the same local address
+    for (le = list_head(&rawrtc_shard_current()->udp_muxes); le != NULL; le = le->next) {
+        struct rawrtc_udp_mux* const mux = le->data;
+        if (mux->port != 0 && sa_cmp(&mux->local_address, &handoff->local_address, SA_ALL)) {
+            receive(mux, &handoff->source, handoff->buffer, true);
+            return;
+        }
+    }
+    DEBUG_PRINTF("Dropping handed off datagram, mux of %J is gone\n", &handoff->local_address);
+}
+
+/*
+ * Hand a datagram (copied) to the shard it has been routed to.
+ * Return `true` in case the datagram has been handed off.
+ */
+static bool hand_off(
+        struct rawrtc_udp_mux* const mux, // not checked
+        struct rawrtc_shard* const owner, // nullable
+        struct sa* const source, // not checked
+        struct mbuf* const buffer // not checked
+) {
+    struct handoff* handoff;
+    size_t const length = mbuf_get_left(buffer);
+
+    // Routed to another shard?
+    if (!owner || owner == rawrtc_shard_current()) {
+        return false;
+    }
+
+    // Allocate
+    handoff = mem_zalloc(sizeof(*handoff), handoff_destroy);
+    if (!handoff) {
+        return false;
+    }
+    handoff->buffer = mbuf_alloc(length);
+    if (!handoff->buffer) {
+        mem_deref(handoff);
+        return false;
+    }
+
+    // Set fields/copy
+    // Note: Buffers MUST NOT be shared between shards (reference counting is not thread-safe).
+    handoff->local_address = mux->local_address;
+    handoff->source = *source;
+    mbuf_write_mem(handoff->buffer, mbuf_buf(buffer), length);
+    handoff->buffer->pos = 0;
+
+    // Call the owning shard
+    if (rawrtc_shard_call(owner, handoff_handler, handoff)) {
+        return false;
+    }
+    ++mux->datagrams_handed_off;
+    return true;
+}
+
+/*
+ * Demultiplex a datagram received on the shared socket (or handed off
+ * by another shard's mux).
+ */
+static void receive(
+        struct rawrtc_udp_mux* const mux, // not checked
+        struct sa* const source, // not checked
+        struct mbuf* const buffer, // not checked
+        bool const handed_off
+) {
+    struct rawrtc_udp_mux_entry* entry = NULL;
+    struct rawrtc_udp_mux_address* bound;
+    struct rawrtc_shard* owner;
+    bool is_stun;
+    bool is_request = false;
+
+    // Empty?
+    if (mbuf_get_left(buffer) < 1) {
+        return;
+    }
+
+    // STUN binding requests are demultiplexed by the username fragment
+    // https://tools.ietf.org/html/rfc7983#section-7
+    is_stun = mbuf_buf(buffer)[0] < 4;
+    if (is_stun) {
+        entry = find_request_entry(mux, buffer, &is_request, &owner);
+        if (entry) {
+            // Bind source address (move binding if necessary)
+            // Note: An ICE agent only accepts datagrams from bound addresses, so this is
+            //       required for the peer-reflexive case. The request's message integrity
+            //       has been verified, so it may take over a binding of another entry.
+            rawrtc_udp_mux_entry_bind(entry, source, true);
+        } else if (is_request) {
+            // Owned by another shard? (message integrity is verified there)
+            if (!handed_off && hand_off(mux, owner, source, buffer)) {
+                return;
+            }
+
+            // Unknown username fragment or not authenticated
+            ++mux->datagrams_unclaimed;
+            return;
+        }
+    }
+
+    // Everything else is demultiplexed by the remote address
+    if (!entry) {
+        bound = lookup_address(mux, source);
+        if (!bound) {
+            // Bound by another shard?
+            if (!handed_off && mux->port != 0
+                    && hand_off(mux, lookup_route(mux, NULL, source), source, buffer)) {
+                return;
+            }
+            ++mux->datagrams_unclaimed;
+            return;
+        }
+        entry = bound->entry;
+    }
+
+    // Dispatch
+    // Note: The handler may release the last reference to the entry and the mux.
+    mem_ref(mux);
+    dispatch(entry, source, buffer);
+    mem_deref(mux);
+}
+
+/*
+ * Handle received UDP messages on the shared socket.
+ */
+static void receive_handler(
+        struct sa const* source_address,
+        struct mbuf* buffer,
+        void* arg
+) {
+    struct sa source = *source_address;
+    receive(arg, &source, buffer, false);
+}
+
+/*
+ * Handle received UDP messages on the shared socket before the UDP
+ * helpers of the ICE agents (UDP helper).
+ * Note: Each ICE agent registers a UDP helper on the shared socket
+ *       which would process (and reject) the STUN messages of all
+ *       other agents. So, all datagrams are consumed here and the mux
+ *       hands STUN messages to the right agent instead.
+ */
+static bool receive_helper(
+        struct sa* source,
+        struct mbuf* buffer,
+        void* arg
+) {
+    receive_handler(source, buffer, arg);
+    return true;
+}
+
+/*
+ * Destructor for an existing entry.
+ */
+static void rawrtc_udp_mux_entry_destroy(
+        void* arg
+) {
+    struct rawrtc_udp_mux_entry* const entry = arg;
+
+    // Unbind addresses & remove from hash
+    list_flush(&entry->addresses);
+    hash_unlink(&entry->le);
+
+    // Un-reference
+    mem_deref(entry->route);
+    mem_deref(entry->mux);
+}
+
+/*
+ * Register a host candidate with the mux. Datagrams will be handed to
+ * the candidate once the remote address has been bound (explicitly or
+ * by an authenticated STUN binding request).
+ */
+enum rawrtc_code rawrtc_udp_mux_register(
+        struct rawrtc_udp_mux_entry** const entryp, // de-referenced
+        struct rawrtc_udp_mux* const mux, // not checked
+        struct rawrtc_candidate_helper* const candidate_helper // not checked
+) {
+    struct rawrtc_udp_mux_entry* entry;
+    enum rawrtc_code error;
+
+    // Allocate
+    entry = mem_zalloc(sizeof(*entry), rawrtc_udp_mux_entry_destroy);
+    if (!entry) {
+        return RAWRTC_CODE_NO_MEMORY;
+    }
+
+    // Set fields/reference
+    entry->mux = mem_ref(mux);
+    entry->candidate_helper = candidate_helper;
+    list_init(&entry->addresses);
+
+    // Route to this shard
+    error = route_create(
+            &entry->route, mux, candidate_helper->gatherer->ice_username_fragment, NULL);
+    if (error) {
+        mem_deref(entry);
+        return error;
+    }
+
+    // Add to hash
+    hash_append(mux->entries, hash_joaat_str(candidate_helper->gatherer->ice_username_fragment),
+                &entry->le, entry);
+
+    // Set pointer & done
+    *entryp = entry;
+    return RAWRTC_CODE_SUCCESS;
+}
+
+/*
+ * Destructor for an existing mux.
+ */
+static void rawrtc_udp_mux_destroy(
+        void* arg
+) {
+    struct rawrtc_udp_mux* const mux = arg;
+
+    // Remove from shard
+    list_unlink(&mux->le);
+
+    // Un-reference
+    mem_deref(mux->batch);
+    mem_deref(mux->helper);
+    mem_deref(mux->socket);
+    mem_deref(mux->addresses);
+    mem_deref(mux->entries);
+}
+
+/*
+ * Bind a UDP socket to a fixed port that may be shared with the muxes
+ * of other shards.
+ */
+static int listen_reuse_port(
+        struct udp_sock** const socketp, // de-referenced
+        struct sa const* const address, // not checked
+        udp_recv_h* const receive_handler, // not checked
+        void* const arg
+) {
+#ifdef SO_REUSEPORT
+    struct udp_sock* udp_socket;
+    int const af = sa_af(address);
+    int const value = 1;
+    int err;
+
+    // Create unbound socket
+    err = udp_open(&udp_socket, af);
+    if (err) {
+        return err;
+    }
+
+    // Allow other shards to bind to the same port
+    err = udp_setsockopt(udp_socket, SOL_SOCKET, SO_REUSEPORT, &value, sizeof(value));
+    if (err) {
+        goto out;
+    }
+
+    // Bind
+    if (bind(udp_sock_fd(udp_socket, af), &address->u.sa, address->len) < 0) {
+        err = errno;
+        goto out;
+    }
+
+    // Start receiving
+    udp_rxsz_set(udp_socket, RAWRTC_UDP_MUX_RECEIVE_SIZE);
+    udp_handler_set(udp_socket, receive_handler, arg);
+    err = udp_thread_attach(udp_socket);
+
+out:
+    if (err) {
+        mem_deref(udp_socket);
+    } else {
+        // Set pointer
+        *socketp = udp_socket;
+    }
+    return err;
+#else
+    // Note: Only a single shard can bind to the port in this case.
+    return udp_listen(socketp, address, receive_handler, arg);
+#endif
+}
+
+/*
+ * Get the mux of an interface and the port of the gather options for
+ * the current shard. It will be created (and the socket will be bound)
+ * if it does not exist yet. Fixed ports are shared with the muxes of
+ * other shards.
+ * Note: The batch size and the maximum path MTU are only applied when
+ *       the mux is being created.
+ */
+enum rawrtc_code rawrtc_udp_mux_get(
+        struct rawrtc_udp_mux** const muxp, // de-referenced
+        struct sa const* const interface_address, // not checked
+        struct rawrtc_ice_gather_options* const options // not checked
+) {
+    uint16_t const port = options->udp_mux_port;
+    struct rawrtc_shard* const shard = rawrtc_shard_current();
+    struct le* le;
+    struct rawrtc_udp_mux* mux;
+    struct sa address;
+    int err;
+    enum rawrtc_code error;
+
+    // Already exists?
+    for (le = list_head(&shard->udp_muxes); le != NULL; le = le->next) {
+        mux = le->data;
+        if (mux->port == port && sa_cmp(&mux->interface_address, interface_address, SA_ADDR)) {
+            *muxp = mem_ref(mux);
+            return RAWRTC_CODE_SUCCESS;
+        }
+    }
+
+    // Allocate
+    mux = mem_zalloc(sizeof(*mux), rawrtc_udp_mux_destroy);
+    if (!mux) {
+        return RAWRTC_CODE_NO_MEMORY;
+    }
+
+    // Set fields
+    mux->interface_address = *interface_address;
+    mux->port = port;
+
+    // Create hashes
+    err = hash_alloc(&mux->entries, RAWRTC_UDP_MUX_HASH_SIZE);
+    if (err) {
+        goto out;
+    }
+    err = hash_alloc(&mux->addresses, RAWRTC_UDP_MUX_HASH_SIZE);
+    if (err) {
+        goto out;
+    }
+
+    // Bind socket
+    address = *interface_address;
+    sa_set_port(&address, port);
+    if (port == 0) {
+        err = udp_listen(&mux->socket, &address, receive_handler, mux);
+    } else {
+        err = listen_reuse_port(&mux->socket, &address, receive_handler, mux);
+    }
+    if (err) {
+        DEBUG_WARNING("Could not bind shared UDP socket to %J, reason: %m\n", &address, err);
+        goto out;
+    }
+    err = udp_local_get(mux->socket, &mux->local_address);
+    if (err) {
+        goto out;
+    }
+
+    // Consume datagrams before the ICE agents' UDP helpers
+    err = udp_register_helper(
+            &mux->helper, mux->socket, RAWRTC_LAYER_UDP_MUX, NULL, receive_helper, mux);
+    if (err) {
+        goto out;
+    }
+
+    // Receive in batches (if enabled)
+    error = rawrtc_udp_batch_attach(
+            &mux->batch, mux->socket, sa_af(&mux->local_address),
+            options->udp_receive_batch_size, options->path_mtu_max);
+    if (error && error != RAWRTC_CODE_NO_VALUE) {
+        DEBUG_WARNING("Could not receive in batches, reason: %s\n", rawrtc_code_to_str(error));
+        // Note: Considered non-critical, continuing
+    }
+
+    // Add to shard
+    list_append(&shard->udp_muxes, &mux->le, mux);
+    DEBUG_PRINTF("Created shared UDP socket on %J\n", &mux->local_address);
+
+out:
+    if (err) {
+        mem_deref(mux);
+    } else {
+        // Set pointer
+        *muxp = mux;
+    }
+    return rawrtc_error_to_code(err);
+}
+
+/*
+ * Check whether a UDP socket is the shared socket of one of the
+ * current shard's UDP muxes.
+ */
+bool rawrtc_udp_mux_is_shared_socket(
+        struct udp_sock const* const socket // not checked
+) {
+    struct le* le;
+    for (le = list_head(&rawrtc_shard_current()->udp_muxes); le != NULL; le = le->next) {
+        struct rawrtc_udp_mux* const mux = le->data;
+        if (mux->socket == socket) {
+            return true;
+        }
+    }
+    return false;
+}
@@ -0,0 +1,93 @@
+#pragma once
+#include <rawrtc.h>
+
+enum {
+    RAWRTC_UDP_MUX_HASH_SIZE = 256, // buckets, must be a power of two
+    RAWRTC_UDP_MUX_ADDRESSES_MAX = 16, // per entry, the oldest is replaced
+    RAWRTC_UDP_MUX_RECEIVE_SIZE = 8192 // bytes per datagram, as for `udp_listen`
+};
+
+/*
+ * UDP socket of an interface shared by the host candidates of all ICE
+ * gatherers of a shard. Incoming datagrams are demultiplexed to the
+ * ICE agent that knows the remote address and, for STUN binding
+ * requests from unknown addresses, by the local username fragment
+ * of the USERNAME attribute.
+ *
+ * Muxes of different shards bound to the same fixed port share it
+ * (SO_REUSEPORT). The kernel picks the receiving socket by the remote
+ * address, so datagrams that belong to another shard are handed to
+ * that shard (see `struct rawrtc_udp_mux_route`).
+ */
+struct rawrtc_udp_mux {
+    struct le le; // cached in the shard's list while in use
+    struct sa interface_address;
+    uint16_t port; // as requested, 0 for an ephemeral port
+    struct sa local_address; // as bound
+    struct udp_sock* socket;
+    struct udp_helper* helper; // consumes all datagrams
+    struct rawrtc_udp_batch* batch; // referenced, nullable
+    struct hash* entries; // not referenced, by local username fragment
+    struct hash* addresses; // not referenced, by remote address
+    uint64_t datagrams_unclaimed;
+    uint64_t datagrams_unauthenticated;
+    uint64_t datagrams_handed_off;
+};
+
+/*
+ * Route of a local username fragment or a bound remote address to the
+ * shard of the mux it has been registered with. Only maintained for
+ * muxes bound to a fixed port.
+ */
+struct rawrtc_udp_mux_route {
+    struct le le; // in the global hash of routes
+    struct rawrtc_shard* shard; // not referenced
+    struct sa local_address;
+    char* username_fragment; // copied, nullable
+    struct sa remote_address; // unset if the username fragment is set
+};
+
+/*
+ * Registration of a host candidate with a UDP mux. Owned by the
+ * candidate helper, so the mux does not keep the candidate alive.
+ */
+struct rawrtc_udp_mux_entry {
+    struct le le; // in the mux's hash of entries
+    struct rawrtc_udp_mux* mux; // referenced
+    struct rawrtc_candidate_helper* candidate_helper; // not referenced
+    struct list addresses; // referenced, most recently bound first
+    struct rawrtc_udp_mux_route* route; // referenced, nullable
+};
+
+/*
+ * Remote address bound to a UDP mux entry.
+ */
+struct rawrtc_udp_mux_address {
+    struct le le; // in the entry's list
+    struct le hash_le; // in the mux's hash of addresses
+    struct rawrtc_udp_mux_entry* entry; // not referenced
+    struct sa address;
+    struct rawrtc_udp_mux_route* route; // referenced, nullable
+};
+
+enum rawrtc_code rawrtc_udp_mux_get(
+    struct rawrtc_udp_mux** const muxp, // de-referenced
+    struct sa const* const interface_address, // not checked
+    struct rawrtc_ice_gather_options* const options // not checked
+);
+
+enum rawrtc_code rawrtc_udp_mux_register(
+    struct rawrtc_udp_mux_entry** const entryp, // de-referenced
+    struct rawrtc_udp_mux* const mux, // not checked
+    struct rawrtc_candidate_helper* const candidate_helper // not checked
+);
+
+enum rawrtc_code rawrtc_udp_mux_entry_bind(
+    struct rawrtc_udp_mux_entry* const entry, // not checked
+    struct sa const* const address, // not checked
+    bool const rebind
+);
+
+bool rawrtc_udp_mux_is_shared_socket(
+    struct udp_sock const* const socket // not checked
+);
@@ -30,7 +30,22 @@ struct rawrtc_config rawrtc_default_config = {
         STUN_DEFAULT_RM,
         STUN_DEFAULT_TI,
         0x00
-    }
+    },
+    .sctp_receive_buffer_recycle = true,
+    .sctp_packet_batching = true,
+    .sctp_timer_interval = 10,
+    .sctp_timer_idle_interval = 500,
+    .path_mtu_min = 1200,
+    .path_mtu_max = 1472, // Ethernet (IPv4)
+    .dtls_context_sharing = true,
+    .dtls_session_cache_size = 0,
+    .ice_udp_mux = false,
+    .ice_udp_mux_port = 0,
+    .ice_lite = false,
+    .udp_receive_batch_size = 0,
+    .ice_gatherer_buffer_slots = 16,
+    .ice_gatherer_buffer_slot_size = 2048,
+    .ice_gatherer_buffer_drop_policy = RAWRTC_ICE_GATHERER_BUFFER_DROP_NEWEST
 };
 
 /*
@@ -3,7 +3,12 @@
 
 #define RAWRTC_MODULUS_LENGTH_MIN 1024
 
+/*
+ * Default configuration.
+ * Note: Changes only apply to instances created afterwards.
+ */
 extern struct rawrtc_config rawrtc_default_config;
+
 extern struct rawrtc_certificate_options rawrtc_default_certificate_options;
 extern struct rawrtc_data_channel_options rawrtc_default_data_channel_options;
 
@@ -0,0 +1,176 @@
+#include <string.h> // memcpy, memset
+#include <time.h> // clock_gettime
+#include <rawrtc.h>
+#include "../librawrtc/crc32c.h" /* TODO: Replace with <rawrtc_internal/crc32c.h> */
+#include "helper/utils.h"
+
+#define DEBUG_MODULE "crc32c-bench-app"
+#define DEBUG_LEVEL 7
+#include <re_dbg.h>
+
+enum {
+    BENCH_BYTES_DEFAULT = 256, // in MiB (per kernel and size)
+    BENCH_BUFFER_OFFSET = 1 // misalign buffers like packets in the middle of a receive buffer
+};
+
+// Packet sizes
+static size_t const sizes[] = {64, 256, 1200, 4096, 16384, 65536, 1024 * 1024};
+
+/*
+ * Get the monotonic time in nanoseconds.
+ */
+static uint64_t time_ns(void) {
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return (uint64_t) now.tv_sec * 1000000000 + (uint64_t) now.tv_nsec;
+}
+
+/*
+ * Benchmark a kernel for a specific buffer size.
+ * Return the throughput in MB/s.
+ */
+static uint64_t bench_kernel(
+        crc32c_function* const kernel,
+        uint8_t const* const buffer,
+        size_t const size,
+        uint64_t const n_bytes
+) {
+    uint64_t const n_iterations = n_bytes / size > 0 ? n_bytes / size : 1;
+    uint64_t i;
+    uint64_t start;
+    uint64_t elapsed;
+    uint32_t crc = 0;
+
+    // Compute CRCs
+    // Note: Chaining the CRCs prevents the compiler from dropping any call.
+    start = time_ns();
+    for (i = 0; i < n_iterations; ++i) {
+        crc = kernel(crc, buffer, size);
+    }
+    elapsed = time_ns() - start;
+    if (crc == 0) {
+        DEBUG_PRINTF("Unlikely CRC of 0\n");
+    }
+
+    // Calculate throughput (bytes per nanosecond equals GB/s)
+    return n_iterations * size * 1000 / (elapsed > 0 ? elapsed : 1);
+}
+
+/*
+ * Verify and benchmark patching the ports of an SCTP common header
+ * against recomputing the checksum of the whole packet.
+ * Return the time per patch in nanoseconds or 0 on mismatch.
+ */
+static uint64_t bench_patch(
+        uint8_t* const buffer,
+        size_t const size,
+        uint64_t const n_bytes
+) {
+    uint64_t const n_iterations = n_bytes / size > 0 ? n_bytes / size : 1;
+    uint64_t i;
+    uint64_t start;
+    uint64_t elapsed;
+    uint8_t ports[4];
+    uint32_t crc;
+
+    // Clear checksum field & compute initial checksum
+    memset(buffer + 8, 0, 4);
+    crc = crc32c(0, buffer, size);
+
+    // Patch ports & checksum
+    start = time_ns();
+    for (i = 0; i < n_iterations; ++i) {
+        memcpy(ports, buffer, sizeof(ports));
+        buffer[(i & 3)] ^= (uint8_t) (i + 1);
+        crc = crc32c_patch(crc, size, 0, ports, buffer, sizeof(ports));
+    }
+    elapsed = time_ns() - start;
+
+    // Verify against a full recompute
+    if (crc != crc32c(0, buffer, size)) {
+        return 0;
+    }
+
+    // Calculate time per patch
+    return elapsed > n_iterations ? elapsed / n_iterations : 1;
+}
+
+int main(int argc, char* argv[argc + 1]) {
+    uint16_t size_mib = BENCH_BYTES_DEFAULT;
+    uint64_t n_bytes;
+    uint8_t* memory;
+    uint8_t* buffer;
+    size_t const max_size = sizes[ARRAY_SIZE(sizes) - 1];
+    size_t i;
+    int kernel;
+    crc32c_function* reference;
+
+    // Initialise
+    EOE(rawrtc_init());
+
+    // Debug
+    dbg_init(DBG_INFO, DBG_ALL);
+    DEBUG_PRINTF("Init\n");
+
+    // Get amount of bytes per measurement (optional)
+    if (argc > 1 && (!str_to_uint16(&size_mib, argv[1]) || size_mib == 0)) {
+        DEBUG_WARNING("Invalid amount of MiB: %s\n", argv[1]);
+        return 1;
+    }
+    n_bytes = (uint64_t) size_mib * 1024 * 1024;
+
+    // Allocate & fill buffer
+    memory = mem_alloc(max_size + BENCH_BUFFER_OFFSET, NULL);
+    if (!memory) {
+        DEBUG_WARNING("Could not allocate buffer\n");
+        return 1;
+    }
+    buffer = memory + BENCH_BUFFER_OFFSET;
+    for (i = 0; i < max_size; ++i) {
+        buffer[i] = (uint8_t) (i * 131 + 7);
+    }
+
+    // Benchmark each available kernel
+    reference = crc32c_get_kernel(CRC32C_KERNEL_SOFTWARE);
+    for (kernel = CRC32C_KERNEL_SOFTWARE; kernel < CRC32C_KERNEL_MAX; ++kernel) {
+        crc32c_function* const function = crc32c_get_kernel((enum crc32c_kernel) kernel);
+        char const* const name = crc32c_kernel_to_name((enum crc32c_kernel) kernel);
+
+        // Available?
+        if (!function) {
+            DEBUG_INFO("%s: not available\n", name);
+            continue;
+        }
+
+        // Verify against the software kernel
+        if (function(0, buffer, max_size) != reference(0, buffer, max_size)) {
+            DEBUG_WARNING("%s: CRC mismatch, skipping\n", name);
+            continue;
+        }
+
+        // Benchmark each packet size
+        for (i = 0; i < ARRAY_SIZE(sizes); ++i) {
+            uint64_t const rate = bench_kernel(function, buffer, sizes[i], n_bytes);
+            DEBUG_INFO("%s: %7zu bytes: %"PRIu64".%03"PRIu64" GB/s\n",
+                       name, sizes[i], rate / 1000, rate % 1000);
+        }
+    }
+
+    // Benchmark patching the ports of an SCTP packet
+    for (i = 0; i < ARRAY_SIZE(sizes); ++i) {
+        uint64_t const patch_ns = bench_patch(buffer, sizes[i], n_bytes);
+        if (patch_ns == 0) {
+            DEBUG_WARNING("patch: %7zu bytes: CRC mismatch\n", sizes[i]);
+            continue;
+        }
+        DEBUG_INFO("patch: %7zu bytes: %"PRIu64" ns per packet (verified)\n",
+                   sizes[i], patch_ns);
+    }
+
+    // Free
+    mem_deref(memory);
+
+    // Bye
+    before_exit();
+    return 0;
+}
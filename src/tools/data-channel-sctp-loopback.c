@@ -29,6 +29,11 @@ struct data_channel_sctp_client {
     struct data_channel_sctp_client* other_client;
 };
 
+enum {
+    BURST_N_MESSAGES = 1000,
+    BURST_MESSAGE_SIZE = 1 << 10
+};
+
 static struct tmr timer = {{0}};
 
 static void timer_handler(
@@ -72,6 +77,7 @@ static void data_channel_open_handler(
             (struct data_channel_sctp_client*) channel->client;
     struct mbuf* buffer;
     enum rawrtc_code error;
+    int i;
 
     // Print open event
     default_data_channel_open_handler(arg);
@@ -95,6 +101,125 @@ static void data_channel_open_handler(
         DEBUG_WARNING("Could not send, reason: %s\n", rawrtc_code_to_str(error));
     }
     mem_deref(buffer);
+
+    // Send a burst of small messages (to measure per-message receive overhead)
+    // Note: Each message needs its own buffer as it may be queued by the transport
+    DEBUG_PRINTF("(%s) Sending %d messages of %d bytes\n",
+                 client->name, BURST_N_MESSAGES, BURST_MESSAGE_SIZE);
+    for (i = 0; i < BURST_N_MESSAGES; ++i) {
+        // Compose message (1 KiB)
+        buffer = mbuf_alloc(BURST_MESSAGE_SIZE);
+        EOE(buffer ? RAWRTC_CODE_SUCCESS : RAWRTC_CODE_NO_MEMORY);
+        EOR(mbuf_fill(buffer, 'S', mbuf_get_space(buffer)));
+        mbuf_set_pos(buffer, 0);
+
+        // Send message
+        error = rawrtc_data_channel_send(channel->channel, buffer, true);
+        mem_deref(buffer);
+        if (error) {
+            DEBUG_WARNING("Could not send, reason: %s\n", rawrtc_code_to_str(error));
+            break;
+        }
+    }
+}
+
+static void print_sctp_transport_statistics(
+        struct data_channel_sctp_client* const client
+) {
+    struct rawrtc_sctp_transport_statistics statistics;
+    uint64_t messages;
+
+    // Get statistics
+    EOE(rawrtc_sctp_transport_get_statistics(&statistics, client->sctp_transport));
+    messages = statistics.messages_received > 0 ? statistics.messages_received : 1;
+
+    // Print allocations per message
+    // Note: Without recycling, one buffer is allocated per read
+    DEBUG_INFO("(%s) SCTP received %"PRIu64" messages in %"PRIu64" reads\n",
+               client->name, statistics.messages_received, statistics.receive_calls);
+    DEBUG_INFO("(%s) Receive buffer allocations per message: %"PRIu64".%03"PRIu64" "
+               "(without recycling: %"PRIu64".%03"PRIu64")\n", client->name,
+               statistics.receive_buffer_allocations / messages,
+               (statistics.receive_buffer_allocations * 1000 / messages) % 1000,
+               statistics.receive_calls / messages,
+               (statistics.receive_calls * 1000 / messages) % 1000);
+}
+
+static void print_sctp_transport_memory_usage(
+        struct data_channel_sctp_client* const client
+) {
+    size_t size;
+
+    // Get & print memory used per association
+    EOE(rawrtc_sctp_transport_get_memory_usage(&size, client->sctp_transport));
+    DEBUG_INFO("(%s) SCTP transport memory usage: %zu bytes\n", client->name, size);
+}
+
+static void print_dtls_transport_statistics(
+        struct data_channel_sctp_client* const client
+) {
+    struct rawrtc_dtls_transport_statistics statistics;
+    uint64_t send_calls;
+
+    // Get statistics
+    EOE(rawrtc_dtls_transport_get_statistics(&statistics, client->dtls_transport));
+    send_calls = statistics.send_calls > 0 ? statistics.send_calls : 1;
+
+    // Print packets per system call
+    // Note: Without batching, each datagram requires its own system call
+    DEBUG_INFO("(%s) DTLS sent %"PRIu64" datagrams in %"PRIu64" send calls "
+               "(%"PRIu64".%03"PRIu64" datagrams per call)\n", client->name,
+               statistics.datagrams_sent, statistics.send_calls,
+               statistics.datagrams_sent / send_calls,
+               (statistics.datagrams_sent * 1000 / send_calls) % 1000);
+
+    // Print path lookups
+    // Note: The selected candidate pair is only looked up after it may have changed
+    DEBUG_INFO("(%s) DTLS active path: %"PRIu64" cache hits, %"PRIu64" lookups\n",
+               client->name, statistics.path_cache_hits, statistics.path_updates);
+}
+
+static void print_ice_transport_demux_statistics(
+        struct data_channel_sctp_client* const client
+) {
+    struct rawrtc_ice_transport_demux_statistics statistics;
+
+    // Get & print packets per class
+    EOE(rawrtc_ice_transport_get_demux_statistics(&statistics, client->ice_transport));
+    DEBUG_INFO("(%s) ICE demux: %"PRIu64" STUN, %"PRIu64" DTLS, %"PRIu64" TURN channel, "
+               "%"PRIu64" RTP, %"PRIu64" other, %"PRIu64" dropped\n", client->name,
+               statistics.stun, statistics.dtls, statistics.turn_channel, statistics.rtp,
+               statistics.other, statistics.dropped);
+}
+
+static void print_ice_gatherer_buffer_statistics(
+        struct data_channel_sctp_client* const client
+) {
+    struct rawrtc_ice_gatherer_buffer_statistics statistics;
+
+    // Get & print early packets (received before the DTLS transport has been attached)
+    EOE(rawrtc_ice_gatherer_get_buffer_statistics(&statistics, client->gatherer));
+    DEBUG_INFO("(%s) ICE gatherer buffer: %"PRIu64" buffered, %"PRIu64" replayed, "
+               "%"PRIu64" dropped, %"PRIu64" oversized\n", client->name,
+               statistics.packets_buffered, statistics.packets_replayed,
+               statistics.packets_dropped, statistics.packets_oversized);
+}
+
+static void print_udp_receive_statistics(void) {
+    struct rawrtc_udp_receive_statistics statistics;
+    uint64_t wakeups;
+
+    // Get statistics (of both clients, they share the same thread)
+    EOE(rawrtc_shard_get_receive_statistics(&statistics));
+    wakeups = statistics.wakeups > 0 ? statistics.wakeups : 1;
+
+    // Print datagrams per wakeup
+    DEBUG_INFO("UDP received %"PRIu64" datagrams in %"PRIu64" wakeups "
+               "(%"PRIu64".%03"PRIu64" datagrams per wakeup, max %"PRIu64", "
+               "%"PRIu64" full batches, %"PRIu64" truncated)\n",
+               statistics.datagrams, statistics.wakeups, statistics.datagrams / wakeups,
+               (statistics.datagrams * 1000 / wakeups) % 1000, statistics.datagrams_max,
+               statistics.full_batches, statistics.datagrams_truncated);
 }
 
 static void ice_gatherer_local_candidate_handler(
@@ -254,6 +379,21 @@ static void client_start(
 static void client_stop(
         struct data_channel_sctp_client* const client
 ) {
+    // Print SCTP transport statistics
+    print_sctp_transport_statistics(client);
+
+    // Print SCTP transport memory usage
+    print_sctp_transport_memory_usage(client);
+
+    // Print DTLS transport statistics
+    print_dtls_transport_statistics(client);
+
+    // Print ICE transport demultiplexing statistics
+    print_ice_transport_demux_statistics(client);
+
+    // Print ICE gatherer early packet buffer statistics
+    print_ice_gatherer_buffer_statistics(client);
+
     // Stop transports & close gatherer
     if (client->data_channel) {
         EOE(rawrtc_data_channel_close(client->data_channel->channel));
@@ -311,6 +451,9 @@ int main(int argc, char* argv[argc + 1]) {
     // Create ICE gather options
     EOE(rawrtc_ice_gather_options_create(&gather_options, RAWRTC_ICE_GATHER_POLICY_ALL));
 
+    // Receive datagrams of host candidates in batches
+    EOE(rawrtc_ice_gather_options_set_udp_receive_batch_size(gather_options, 32));
+
     // Add ICE servers to ICE gather options
     EOE(rawrtc_ice_gather_options_add_server(
             gather_options, stun_google_com_urls, ARRAY_SIZE(stun_google_com_urls),
@@ -353,6 +496,9 @@ int main(int argc, char* argv[argc + 1]) {
     // TODO: Wrap re_main?
     EOR(re_main(default_signal_handler));
 
+    // Print batched UDP receive statistics
+    print_udp_receive_statistics();
+
     // Stop clients
     client_stop(&a);
     client_stop(&b);
@@ -0,0 +1,440 @@
+#include <unistd.h> // STDIN_FILENO
+#include <rawrtc.h>
+#include "helper/utils.h"
+#include "helper/handler.h"
+
+#define DEBUG_MODULE "data-channel-sctp-send-bench-app"
+#define DEBUG_LEVEL 7
+#include <re_dbg.h>
+
+// Note: Shadows struct client
+struct data_channel_sctp_client {
+    char* name;
+    char** ice_candidate_types;
+    size_t n_ice_candidate_types;
+    struct rawrtc_ice_gather_options* gather_options;
+    struct rawrtc_ice_parameters* ice_parameters;
+    struct rawrtc_dtls_parameters* dtls_parameters;
+    struct rawrtc_sctp_capabilities* sctp_capabilities;
+    enum rawrtc_ice_role role;
+    struct rawrtc_certificate* certificate;
+    uint16_t sctp_port;
+    struct rawrtc_ice_gatherer* gatherer;
+    struct rawrtc_ice_transport* ice_transport;
+    struct rawrtc_dtls_transport* dtls_transport;
+    struct rawrtc_sctp_transport* sctp_transport;
+    struct rawrtc_data_transport* data_transport;
+    struct data_channel_helper* data_channel;
+    struct data_channel_sctp_client* other_client;
+    uint64_t n_messages_received;
+};
+
+enum {
+    BENCH_N_MESSAGES = 100000,
+    BENCH_MESSAGE_SIZE = 64,
+    BENCH_BATCH_SIZE = 64
+};
+
+/*
+ * Benchmark phases. The next phase starts once the previous phase's
+ * messages have been delivered to the other peer.
+ */
+enum bench_phase {
+    BENCH_PHASE_SINGLE,
+    BENCH_PHASE_BATCH,
+    BENCH_PHASE_DONE
+};
+
+static enum bench_phase phase = BENCH_PHASE_SINGLE;
+static char const* phase_name = NULL;
+static uint64_t phase_start;
+static struct data_channel_helper* sender = NULL;
+static struct tmr phase_timer;
+
+/*
+ * Allocate benchmark messages.
+ * Note: Each message needs its own buffer as it may be queued by the transport.
+ */
+static struct mbuf** messages_alloc(void) {
+    struct mbuf** buffers;
+    size_t i;
+
+    // Allocate array
+    buffers = mem_zalloc(BENCH_N_MESSAGES * sizeof(*buffers), NULL);
+    EOE(buffers ? RAWRTC_CODE_SUCCESS : RAWRTC_CODE_NO_MEMORY);
+
+    // Compose messages
+    for (i = 0; i < BENCH_N_MESSAGES; ++i) {
+        buffers[i] = mbuf_alloc(BENCH_MESSAGE_SIZE);
+        EOE(buffers[i] ? RAWRTC_CODE_SUCCESS : RAWRTC_CODE_NO_MEMORY);
+        EOR(mbuf_fill(buffers[i], 'B', mbuf_get_space(buffers[i])));
+        mbuf_set_pos(buffers[i], 0);
+    }
+
+    // Done
+    return buffers;
+}
+
+/*
+ * Un-reference benchmark messages.
+ */
+static void messages_free(
+        struct mbuf** const buffers
+) {
+    size_t i;
+
+    // Un-reference each message
+    for (i = 0; i < BENCH_N_MESSAGES; ++i) {
+        mem_deref(buffers[i]);
+    }
+    mem_deref(buffers);
+}
+
+/*
+ * Print the time it took to queue the messages of a benchmark phase.
+ */
+static void print_queue_rate(
+        struct data_channel_sctp_client* const client,
+        uint64_t const elapsed // in milliseconds
+) {
+    uint64_t const rate = (uint64_t) BENCH_N_MESSAGES * 1000 / (elapsed > 0 ? elapsed : 1);
+    DEBUG_INFO("(%s) %s: %d messages of %d bytes queued in %"PRIu64" ms (%"PRIu64" msgs/s)\n",
+               client->name, phase_name, BENCH_N_MESSAGES, BENCH_MESSAGE_SIZE, elapsed, rate);
+}
+
+/*
+ * Print the rate at which the messages of a benchmark phase have been
+ * delivered (from the first message being sent until the last message
+ * has been received).
+ */
+static void print_delivery_rate(
+        struct data_channel_sctp_client* const client,
+        uint64_t const elapsed // in milliseconds
+) {
+    uint64_t const n_bytes = (uint64_t) BENCH_N_MESSAGES * BENCH_MESSAGE_SIZE;
+    uint64_t const divisor = elapsed > 0 ? elapsed : 1;
+    DEBUG_INFO("(%s) %s: %"PRIu64" bytes delivered in %"PRIu64" ms (%"PRIu64" msgs/s, "
+               "%"PRIu64" KiB/s)\n", client->name, phase_name, n_bytes, elapsed,
+               (uint64_t) BENCH_N_MESSAGES * 1000 / divisor, n_bytes * 1000 / 1024 / divisor);
+}
+
+/*
+ * Send all messages one by one.
+ */
+static void bench_send_single(
+        struct data_channel_helper* const channel
+) {
+    struct data_channel_sctp_client* const client =
+            (struct data_channel_sctp_client*) channel->client;
+    struct mbuf** const buffers = messages_alloc();
+    uint64_t start;
+    size_t i;
+
+    // Send
+    phase_name = "rawrtc_data_channel_send";
+    start = tmr_jiffies();
+    phase_start = start;
+    for (i = 0; i < BENCH_N_MESSAGES; ++i) {
+        EOE(rawrtc_data_channel_send(channel->channel, buffers[i], true));
+    }
+    print_queue_rate(client, tmr_jiffies() - start);
+
+    // Un-reference
+    messages_free(buffers);
+}
+
+/*
+ * Send all messages in batches.
+ */
+static void bench_send_batch(
+        struct data_channel_helper* const channel
+) {
+    struct data_channel_sctp_client* const client =
+            (struct data_channel_sctp_client*) channel->client;
+    struct mbuf** const buffers = messages_alloc();
+    uint64_t start;
+    size_t i;
+    size_t n_sent;
+
+    // Send
+    phase_name = "rawrtc_data_channel_send_batch";
+    start = tmr_jiffies();
+    phase_start = start;
+    for (i = 0; i < BENCH_N_MESSAGES; i += n_sent) {
+        size_t const n_buffers = min(BENCH_BATCH_SIZE, BENCH_N_MESSAGES - i);
+        EOE(rawrtc_data_channel_send_batch(
+                &n_sent, channel->channel, &buffers[i], n_buffers, true));
+    }
+    print_queue_rate(client, tmr_jiffies() - start);
+
+    // Un-reference
+    messages_free(buffers);
+}
+
+/*
+ * Run the next benchmark phase.
+ */
+static void bench_next_phase(
+        void* arg
+) {
+    struct data_channel_helper* const channel = arg;
+
+    switch (phase) {
+        case BENCH_PHASE_SINGLE:
+            phase = BENCH_PHASE_BATCH;
+            bench_send_single(channel);
+            break;
+        case BENCH_PHASE_BATCH:
+            phase = BENCH_PHASE_DONE;
+            bench_send_batch(channel);
+            break;
+        default:
+            break;
+    }
+}
+
+static void data_channel_open_handler(
+        void* const arg
+) {
+    struct data_channel_helper* const channel = arg;
+    struct data_channel_sctp_client* const client =
+            (struct data_channel_sctp_client*) channel->client;
+
+    // Print open event
+    default_data_channel_open_handler(arg);
+
+    // Only client A sends
+    if (client->role != RAWRTC_ICE_ROLE_CONTROLLING) {
+        return;
+    }
+
+    // Start benchmark
+    sender = channel;
+    bench_next_phase(channel);
+}
+
+static void data_channel_message_handler(
+        struct mbuf* const buffer,
+        enum rawrtc_data_channel_message_flag const flags,
+        void* const arg
+) {
+    struct data_channel_helper* const channel = arg;
+    struct data_channel_sctp_client* const client =
+            (struct data_channel_sctp_client*) channel->client;
+    (void) buffer; (void) flags;
+
+    // Count messages
+    ++client->n_messages_received;
+    if (client->n_messages_received % BENCH_N_MESSAGES != 0) {
+        return;
+    }
+
+    // All messages of the phase delivered
+    print_delivery_rate(client, tmr_jiffies() - phase_start);
+
+    // Start the next phase once this handler returned
+    if (sender) {
+        tmr_start(&phase_timer, 0, bench_next_phase, sender);
+    }
+}
+
+static void ice_gatherer_local_candidate_handler(
+        struct rawrtc_ice_candidate* const candidate,
+        char const * const url, // read-only
+        void* const arg
+) {
+    struct data_channel_sctp_client* const client = arg;
+
+    // Print local candidate
+    default_ice_gatherer_local_candidate_handler(candidate, url, arg);
+
+    // Add to other client as remote candidate (if type enabled)
+    add_to_other_if_ice_candidate_type_enabled(
+            arg, candidate, client->other_client->ice_transport);
+}
+
+static void client_init(
+        struct data_channel_sctp_client* const local
+) {
+    struct rawrtc_certificate* certificates[1];
+    struct rawrtc_data_channel_parameters* channel_parameters;
+
+    // Generate certificates
+    EOE(rawrtc_certificate_generate(&local->certificate, NULL));
+    certificates[0] = local->certificate;
+
+    // Create ICE gatherer
+    EOE(rawrtc_ice_gatherer_create(
+            &local->gatherer, local->gather_options,
+            default_ice_gatherer_state_change_handler, default_ice_gatherer_error_handler,
+            ice_gatherer_local_candidate_handler, local));
+
+    // Create ICE transport
+    EOE(rawrtc_ice_transport_create(
+            &local->ice_transport, local->gatherer,
+            default_ice_transport_state_change_handler,
+            default_ice_transport_candidate_pair_change_handler, local));
+
+    // Create DTLS transport
+    EOE(rawrtc_dtls_transport_create(
+            &local->dtls_transport, local->ice_transport, certificates, ARRAY_SIZE(certificates),
+            default_dtls_transport_state_change_handler, default_dtls_transport_error_handler,
+            local));
+
+    // Create SCTP transport
+    EOE(rawrtc_sctp_transport_create(
+            &local->sctp_transport, local->dtls_transport, local->sctp_port,
+            default_data_channel_handler, default_sctp_transport_state_change_handler, local));
+
+    // Get SCTP capabilities
+    EOE(rawrtc_sctp_transport_get_capabilities(&local->sctp_capabilities));
+
+    // Get data transport
+    EOE(rawrtc_sctp_transport_get_data_transport(
+            &local->data_transport, local->sctp_transport));
+
+    // Create data channel helper
+    data_channel_helper_create(
+            &local->data_channel, (struct client *) local, "bench");
+
+    // Create data channel parameters
+    EOE(rawrtc_data_channel_parameters_create(
+            &channel_parameters, local->data_channel->label,
+            RAWRTC_DATA_CHANNEL_TYPE_RELIABLE_ORDERED, 0, NULL, true, 0));
+
+    // Create pre-negotiated data channel
+    EOE(rawrtc_data_channel_create(
+            &local->data_channel->channel, local->data_transport,
+            channel_parameters, NULL,
+            data_channel_open_handler, default_data_channel_buffered_amount_low_handler,
+            default_data_channel_error_handler, default_data_channel_close_handler,
+            data_channel_message_handler, local->data_channel));
+
+    // Un-reference
+    mem_deref(channel_parameters);
+}
+
+static void client_start(
+        struct data_channel_sctp_client* const local,
+        struct data_channel_sctp_client* const remote
+) {
+    // Get & set ICE parameters
+    EOE(rawrtc_ice_gatherer_get_local_parameters(
+            &local->ice_parameters, remote->gatherer));
+
+    // Start gathering
+    EOE(rawrtc_ice_gatherer_gather(local->gatherer, NULL));
+
+    // Start ICE transport
+    EOE(rawrtc_ice_transport_start(
+            local->ice_transport, local->gatherer, local->ice_parameters, local->role));
+
+    // Get DTLS parameters
+    EOE(rawrtc_dtls_transport_get_local_parameters(
+            &remote->dtls_parameters, remote->dtls_transport));
+
+    // Start DTLS transport
+    EOE(rawrtc_dtls_transport_start(
+            local->dtls_transport, remote->dtls_parameters));
+
+    // Start SCTP transport
+    EOE(rawrtc_sctp_transport_start(
+            local->sctp_transport, remote->sctp_capabilities, remote->sctp_port));
+}
+
+static void client_stop(
+        struct data_channel_sctp_client* const client
+) {
+    // Stop transports & close gatherer
+    EOE(rawrtc_data_channel_close(client->data_channel->channel));
+    EOE(rawrtc_sctp_transport_stop(client->sctp_transport));
+    EOE(rawrtc_dtls_transport_stop(client->dtls_transport));
+    EOE(rawrtc_ice_transport_stop(client->ice_transport));
+    EOE(rawrtc_ice_gatherer_close(client->gatherer));
+
+    // Un-reference & close
+    client->data_channel = mem_deref(client->data_channel);
+    client->sctp_capabilities = mem_deref(client->sctp_capabilities);
+    client->dtls_parameters = mem_deref(client->dtls_parameters);
+    client->ice_parameters = mem_deref(client->ice_parameters);
+    client->data_transport = mem_deref(client->data_transport);
+    client->sctp_transport = mem_deref(client->sctp_transport);
+    client->dtls_transport = mem_deref(client->dtls_transport);
+    client->ice_transport = mem_deref(client->ice_transport);
+    client->gatherer = mem_deref(client->gatherer);
+    client->certificate = mem_deref(client->certificate);
+}
+
+int main(int argc, char* argv[argc + 1]) {
+    char** ice_candidate_types = NULL;
+    size_t n_ice_candidate_types = 0;
+    struct rawrtc_ice_gather_options* gather_options;
+    struct data_channel_sctp_client a = {0};
+    struct data_channel_sctp_client b = {0};
+
+    // Initialise
+    EOE(rawrtc_init());
+
+    // Debug
+    dbg_init(DBG_DEBUG, DBG_ALL);
+    DEBUG_PRINTF("Init\n");
+
+    // Get enabled ICE candidate types to be added (optional)
+    if (argc > 1) {
+        ice_candidate_types = &argv[1];
+        n_ice_candidate_types = (size_t) argc - 1;
+    }
+
+    // Create ICE gather options
+    EOE(rawrtc_ice_gather_options_create(&gather_options, RAWRTC_ICE_GATHER_POLICY_ALL));
+
+    // Setup client A
+    a.name = "A";
+    a.ice_candidate_types = ice_candidate_types;
+    a.n_ice_candidate_types = n_ice_candidate_types;
+    a.gather_options = gather_options;
+    a.role = RAWRTC_ICE_ROLE_CONTROLLING;
+    a.sctp_port = 6000;
+    a.other_client = &b;
+
+    // Setup client B
+    b.name = "B";
+    b.ice_candidate_types = ice_candidate_types;
+    b.n_ice_candidate_types = n_ice_candidate_types;
+    b.gather_options = gather_options;
+    b.role = RAWRTC_ICE_ROLE_CONTROLLED;
+    b.sctp_port = 5000;
+    b.other_client = &a;
+
+    // Initialise clients
+    client_init(&a);
+    client_init(&b);
+
+    // Start clients
+    client_start(&a, &b);
+    client_start(&b, &a);
+
+    // Initialise phase timer
+    tmr_init(&phase_timer);
+
+    // Listen on stdin
+    EOR(fd_listen(STDIN_FILENO, FD_READ, stop_on_return_handler, NULL));
+
+    // Start main loop
+    EOR(re_main(default_signal_handler));
+
+    // Stop benchmark & clients
+    tmr_cancel(&phase_timer);
+    client_stop(&a);
+    client_stop(&b);
+
+    // Stop listening on STDIN
+    fd_close(STDIN_FILENO);
+
+    // Free
+    mem_deref(gather_options);
+
+    // Bye
+    before_exit();
+    return 0;
+}
@@ -0,0 +1,414 @@
+#include <pthread.h> // pthread_*
+#include <rawrtc.h>
+#include "helper/utils.h"
+#include "helper/handler.h"
+
+#define DEBUG_MODULE "data-channel-sctp-shard-bench-app"
+#define DEBUG_LEVEL 7
+#include <re_dbg.h>
+
+enum {
+    BENCH_N_SHARDS_DEFAULT = 1,
+    BENCH_N_MESSAGES = 50000,
+    BENCH_MESSAGE_SIZE = 1024,
+    BENCH_BATCH_SIZE = 64,
+    BENCH_BUFFERED_AMOUNT_HIGH = 1024 * 1024,
+    BENCH_BUFFERED_AMOUNT_LOW = 256 * 1024
+};
+
+struct shard_bench;
+
+// Note: Shadows struct client
+struct data_channel_sctp_client {
+    char* name;
+    char** ice_candidate_types;
+    size_t n_ice_candidate_types;
+    struct rawrtc_ice_gather_options* gather_options;
+    struct rawrtc_ice_parameters* ice_parameters;
+    struct rawrtc_dtls_parameters* dtls_parameters;
+    struct rawrtc_sctp_capabilities* sctp_capabilities;
+    enum rawrtc_ice_role role;
+    struct rawrtc_certificate* certificate;
+    uint16_t sctp_port;
+    struct rawrtc_ice_gatherer* gatherer;
+    struct rawrtc_ice_transport* ice_transport;
+    struct rawrtc_dtls_transport* dtls_transport;
+    struct rawrtc_sctp_transport* sctp_transport;
+    struct rawrtc_data_transport* data_transport;
+    struct data_channel_helper* data_channel;
+    struct data_channel_sctp_client* other_client;
+    struct shard_bench* bench;
+};
+
+/*
+ * A pair of loopback peers running on its own shard (thread).
+ */
+struct shard_bench {
+    pthread_t thread;
+    struct data_channel_sctp_client a;
+    struct data_channel_sctp_client b;
+    size_t n_sent;
+    uint64_t n_received;
+    uint64_t start;
+    uint64_t elapsed; // in milliseconds
+    bool callback_handoff;
+};
+
+/*
+ * Send messages until the buffered amount is high or all messages
+ * have been sent.
+ */
+static void bench_send(
+        struct data_channel_helper* const channel
+) {
+    struct data_channel_sctp_client* const client =
+            (struct data_channel_sctp_client*) channel->client;
+    struct shard_bench* const bench = client->bench;
+    struct mbuf* buffers[BENCH_BATCH_SIZE];
+    uint64_t buffered_amount = 0;
+    size_t n_buffers;
+    size_t n_sent;
+    size_t i;
+
+    while (bench->n_sent < BENCH_N_MESSAGES && buffered_amount < BENCH_BUFFERED_AMOUNT_HIGH) {
+        // Compose messages
+        // Note: Each message needs its own buffer as it may be queued by the transport
+        n_buffers = min(BENCH_BATCH_SIZE, BENCH_N_MESSAGES - bench->n_sent);
+        for (i = 0; i < n_buffers; ++i) {
+            buffers[i] = mbuf_alloc(BENCH_MESSAGE_SIZE);
+            EOE(buffers[i] ? RAWRTC_CODE_SUCCESS : RAWRTC_CODE_NO_MEMORY);
+            EOR(mbuf_fill(buffers[i], 'S', mbuf_get_space(buffers[i])));
+            mbuf_set_pos(buffers[i], 0);
+        }
+
+        // Send messages
+        EOE(rawrtc_data_channel_send_batch(&n_sent, channel->channel, buffers, n_buffers, true));
+        bench->n_sent += n_sent;
+
+        // Un-reference
+        for (i = 0; i < n_buffers; ++i) {
+            mem_deref(buffers[i]);
+        }
+
+        // Get buffered amount
+        EOE(rawrtc_data_channel_get_buffered_amount(&buffered_amount, channel->channel));
+    }
+}
+
+static void data_channel_open_handler(
+        void* const arg
+) {
+    struct data_channel_helper* const channel = arg;
+    struct data_channel_sctp_client* const client =
+            (struct data_channel_sctp_client*) channel->client;
+
+    // Print open event
+    default_data_channel_open_handler(arg);
+
+    // Only client A sends
+    if (client->role != RAWRTC_ICE_ROLE_CONTROLLING) {
+        return;
+    }
+
+    // Start sending
+    EOE(rawrtc_data_channel_set_buffered_amount_low_threshold(
+            channel->channel, BENCH_BUFFERED_AMOUNT_LOW));
+    client->bench->start = tmr_jiffies();
+    bench_send(channel);
+}
+
+static void data_channel_buffered_amount_low_handler(
+        void* const arg
+) {
+    struct data_channel_helper* const channel = arg;
+    struct data_channel_sctp_client* const client =
+            (struct data_channel_sctp_client*) channel->client;
+
+    // Continue sending
+    if (client->role == RAWRTC_ICE_ROLE_CONTROLLING) {
+        bench_send(channel);
+    }
+}
+
+static void data_channel_message_handler(
+        struct mbuf* const buffer,
+        enum rawrtc_data_channel_message_flag const flags,
+        void* const arg
+) {
+    struct data_channel_helper* const channel = arg;
+    struct data_channel_sctp_client* const client =
+            (struct data_channel_sctp_client*) channel->client;
+    struct shard_bench* const bench = client->bench;
+    (void) buffer; (void) flags;
+
+    // Count messages & stop the shard's event loop once all messages have been received
+    ++bench->n_received;
+    if (bench->n_received == BENCH_N_MESSAGES) {
+        bench->elapsed = tmr_jiffies() - bench->start;
+        re_cancel();
+    }
+}
+
+static void ice_gatherer_local_candidate_handler(
+        struct rawrtc_ice_candidate* const candidate,
+        char const * const url, // read-only
+        void* const arg
+) {
+    struct data_channel_sctp_client* const client = arg;
+
+    // Print local candidate
+    default_ice_gatherer_local_candidate_handler(candidate, url, arg);
+
+    // Add to other client as remote candidate (if type enabled)
+    add_to_other_if_ice_candidate_type_enabled(
+            arg, candidate, client->other_client->ice_transport);
+}
+
+static void client_init(
+        struct data_channel_sctp_client* const local
+) {
+    struct rawrtc_certificate* certificates[1];
+    struct rawrtc_data_channel_parameters* channel_parameters;
+
+    // Generate certificates
+    EOE(rawrtc_certificate_generate(&local->certificate, NULL));
+    certificates[0] = local->certificate;
+
+    // Create ICE gatherer
+    EOE(rawrtc_ice_gatherer_create(
+            &local->gatherer, local->gather_options,
+            default_ice_gatherer_state_change_handler, default_ice_gatherer_error_handler,
+            ice_gatherer_local_candidate_handler, local));
+
+    // Create ICE transport
+    EOE(rawrtc_ice_transport_create(
+            &local->ice_transport, local->gatherer,
+            default_ice_transport_state_change_handler,
+            default_ice_transport_candidate_pair_change_handler, local));
+
+    // Create DTLS transport
+    EOE(rawrtc_dtls_transport_create(
+            &local->dtls_transport, local->ice_transport, certificates, ARRAY_SIZE(certificates),
+            default_dtls_transport_state_change_handler, default_dtls_transport_error_handler,
+            local));
+
+    // Create SCTP transport
+    EOE(rawrtc_sctp_transport_create(
+            &local->sctp_transport, local->dtls_transport, local->sctp_port,
+            default_data_channel_handler, default_sctp_transport_state_change_handler, local));
+
+    // Set callback mode
+    EOE(rawrtc_sctp_transport_set_callback_handoff(
+            local->sctp_transport, local->bench->callback_handoff));
+
+    // Get SCTP capabilities
+    EOE(rawrtc_sctp_transport_get_capabilities(&local->sctp_capabilities));
+
+    // Get data transport
+    EOE(rawrtc_sctp_transport_get_data_transport(
+            &local->data_transport, local->sctp_transport));
+
+    // Create data channel helper
+    data_channel_helper_create(
+            &local->data_channel, (struct client *) local, "bench");
+
+    // Create data channel parameters
+    EOE(rawrtc_data_channel_parameters_create(
+            &channel_parameters, local->data_channel->label,
+            RAWRTC_DATA_CHANNEL_TYPE_RELIABLE_ORDERED, 0, NULL, true, 0));
+
+    // Create pre-negotiated data channel
+    EOE(rawrtc_data_channel_create(
+            &local->data_channel->channel, local->data_transport,
+            channel_parameters, NULL,
+            data_channel_open_handler, data_channel_buffered_amount_low_handler,
+            default_data_channel_error_handler, default_data_channel_close_handler,
+            data_channel_message_handler, local->data_channel));
+
+    // Un-reference
+    mem_deref(channel_parameters);
+}
+
+static void client_start(
+        struct data_channel_sctp_client* const local,
+        struct data_channel_sctp_client* const remote
+) {
+    // Get & set ICE parameters
+    EOE(rawrtc_ice_gatherer_get_local_parameters(
+            &local->ice_parameters, remote->gatherer));
+
+    // Start gathering
+    EOE(rawrtc_ice_gatherer_gather(local->gatherer, NULL));
+
+    // Start ICE transport
+    EOE(rawrtc_ice_transport_start(
+            local->ice_transport, local->gatherer, local->ice_parameters, local->role));
+
+    // Get DTLS parameters
+    EOE(rawrtc_dtls_transport_get_local_parameters(
+            &remote->dtls_parameters, remote->dtls_transport));
+
+    // Start DTLS transport
+    EOE(rawrtc_dtls_transport_start(
+            local->dtls_transport, remote->dtls_parameters));
+
+    // Start SCTP transport
+    EOE(rawrtc_sctp_transport_start(
+            local->sctp_transport, remote->sctp_capabilities, remote->sctp_port));
+}
+
+static void client_stop(
+        struct data_channel_sctp_client* const client
+) {
+    // Stop transports & close gatherer
+    EOE(rawrtc_data_channel_close(client->data_channel->channel));
+    EOE(rawrtc_sctp_transport_stop(client->sctp_transport));
+    EOE(rawrtc_dtls_transport_stop(client->dtls_transport));
+    EOE(rawrtc_ice_transport_stop(client->ice_transport));
+    EOE(rawrtc_ice_gatherer_close(client->gatherer));
+
+    // Un-reference & close
+    client->data_channel = mem_deref(client->data_channel);
+    client->sctp_capabilities = mem_deref(client->sctp_capabilities);
+    client->dtls_parameters = mem_deref(client->dtls_parameters);
+    client->ice_parameters = mem_deref(client->ice_parameters);
+    client->data_transport = mem_deref(client->data_transport);
+    client->sctp_transport = mem_deref(client->sctp_transport);
+    client->dtls_transport = mem_deref(client->dtls_transport);
+    client->ice_transport = mem_deref(client->ice_transport);
+    client->gatherer = mem_deref(client->gatherer);
+    client->certificate = mem_deref(client->certificate);
+    client->gather_options = mem_deref(client->gather_options);
+}
+
+/*
+ * Run a pair of loopback peers on its own shard.
+ */
+static void* shard_thread(
+        void* arg
+) {
+    struct shard_bench* const bench = arg;
+    struct data_channel_sctp_client* const a = &bench->a;
+    struct data_channel_sctp_client* const b = &bench->b;
+
+    // Initialise shard
+    EOE(rawrtc_thread_init());
+
+    // Setup client A
+    a->name = "A";
+    a->role = RAWRTC_ICE_ROLE_CONTROLLING;
+    a->sctp_port = 6000;
+    a->other_client = b;
+    a->bench = bench;
+    EOE(rawrtc_ice_gather_options_create(&a->gather_options, RAWRTC_ICE_GATHER_POLICY_ALL));
+
+    // Setup client B
+    b->name = "B";
+    b->role = RAWRTC_ICE_ROLE_CONTROLLED;
+    b->sctp_port = 5000;
+    b->other_client = a;
+    b->bench = bench;
+    EOE(rawrtc_ice_gather_options_create(&b->gather_options, RAWRTC_ICE_GATHER_POLICY_ALL));
+
+    // Initialise & start clients
+    client_init(a);
+    client_init(b);
+    client_start(a, b);
+    client_start(b, a);
+
+    // Run the shard's event loop (until all messages have been received)
+    EOR(re_main(NULL));
+
+    // Stop clients
+    client_stop(a);
+    client_stop(b);
+
+    // Close shard
+    EOE(rawrtc_thread_close());
+    return NULL;
+}
+
+/*
+ * Print the SCTP callback statistics.
+ */
+static void print_sctp_callback_statistics(void) {
+    struct rawrtc_sctp_callback_statistics statistics;
+
+    // Get statistics
+    EOE(rawrtc_sctp_transport_get_callback_statistics(&statistics));
+
+    // Print
+    DEBUG_INFO("SCTP callbacks: %"PRIu64", locked: %"PRIu64" (%"PRIu64" us lock wait, "
+               "%"PRIu64" us per callback), handed off: %"PRIu64" (%"PRIu64" us latency, "
+               "%"PRIu64" us per callback)\n",
+               statistics.callbacks, statistics.locked_callbacks, statistics.lock_wait_time,
+               statistics.locked_callbacks > 0
+                    ? statistics.lock_wait_time / statistics.locked_callbacks : 0,
+               statistics.handed_off_callbacks, statistics.handoff_latency,
+               statistics.handed_off_callbacks > 0
+                    ? statistics.handoff_latency / statistics.handed_off_callbacks : 0);
+}
+
+int main(int argc, char* argv[argc + 1]) {
+    uint16_t n_shards = BENCH_N_SHARDS_DEFAULT;
+    bool callback_handoff = false;
+    struct shard_bench* benches;
+    uint64_t start;
+    uint64_t elapsed;
+    uint64_t elapsed_max = 0;
+    uint64_t n_bytes;
+    uint16_t i;
+
+    // Initialise
+    EOE(rawrtc_init());
+
+    // Debug
+    dbg_init(DBG_INFO, DBG_ALL);
+    DEBUG_PRINTF("Init\n");
+
+    // Get amount of shards (optional)
+    if (argc > 1 && (!str_to_uint16(&n_shards, argv[1]) || n_shards == 0)) {
+        DEBUG_WARNING("Invalid amount of shards: %s\n", argv[1]);
+        return 1;
+    }
+
+    // Get callback mode (optional)
+    if (argc > 2) {
+        if (str_casecmp(argv[2], "handoff") == 0) {
+            callback_handoff = true;
+        } else if (str_casecmp(argv[2], "lock") != 0) {
+            DEBUG_WARNING("Invalid callback mode: %s\n", argv[2]);
+            return 1;
+        }
+    }
+
+    // Allocate shards
+    benches = mem_zalloc(n_shards * sizeof(*benches), NULL);
+    EOE(benches ? RAWRTC_CODE_SUCCESS : RAWRTC_CODE_NO_MEMORY);
+
+    // Start a thread for each shard & wait until all of them are done
+    start = tmr_jiffies();
+    for (i = 0; i < n_shards; ++i) {
+        benches[i].callback_handoff = callback_handoff;
+        EOR(pthread_create(&benches[i].thread, NULL, shard_thread, &benches[i]));
+    }
+    for (i = 0; i < n_shards; ++i) {
+        EOR(pthread_join(benches[i].thread, NULL));
+        elapsed_max = max(elapsed_max, benches[i].elapsed);
+    }
+    elapsed = tmr_jiffies() - start;
+
+    // Print aggregate throughput (excluding connection establishment)
+    n_bytes = (uint64_t) n_shards * BENCH_N_MESSAGES * BENCH_MESSAGE_SIZE;
+    DEBUG_INFO("%"PRIu16" shards: %"PRIu64" bytes in %"PRIu64" ms (%"PRIu64" KiB/s), "
+               "%"PRIu64" ms total\n", n_shards, n_bytes, elapsed_max,
+               n_bytes * 1000 / 1024 / (elapsed_max > 0 ? elapsed_max : 1), elapsed);
+    print_sctp_callback_statistics();
+
+    // Free
+    mem_deref(benches);
+
+    // Bye
+    before_exit();
+    return 0;
+}
@@ -0,0 +1,399 @@
+#include <errno.h> // errno
+#include <unistd.h> // STDIN_FILENO
+#include <sys/resource.h> // getrusage
+#include <rawrtc.h>
+#include "helper/utils.h"
+#include "helper/handler.h"
+
+#define DEBUG_MODULE "data-channel-sctp-stream-bench-app"
+#define DEBUG_LEVEL 7
+#include <re_dbg.h>
+
+enum {
+    BENCH_MESSAGE_SIZE_DEFAULT = 100, // in MiB
+    BENCH_WINDOW_DEFAULT = 1024 // in KiB
+};
+
+enum receive_mode {
+    RECEIVE_MODE_PARTIAL,
+    RECEIVE_MODE_MERGE,
+    RECEIVE_MODE_HINT,
+    RECEIVE_MODE_VIEW,
+};
+
+// Note: Shadows struct client
+struct data_channel_sctp_client {
+    char* name;
+    char** ice_candidate_types;
+    size_t n_ice_candidate_types;
+    struct rawrtc_ice_gather_options* gather_options;
+    struct rawrtc_ice_parameters* ice_parameters;
+    struct rawrtc_dtls_parameters* dtls_parameters;
+    struct rawrtc_sctp_capabilities* sctp_capabilities;
+    enum rawrtc_ice_role role;
+    struct rawrtc_certificate* certificate;
+    uint16_t sctp_port;
+    struct rawrtc_ice_gatherer* gatherer;
+    struct rawrtc_ice_transport* ice_transport;
+    struct rawrtc_dtls_transport* dtls_transport;
+    struct rawrtc_sctp_transport* sctp_transport;
+    struct rawrtc_data_transport* data_transport;
+    struct data_channel_helper* data_channel;
+    struct data_channel_sctp_client* other_client;
+};
+
+static bool use_stream = true;
+static enum receive_mode receive_mode = RECEIVE_MODE_PARTIAL;
+static uint64_t message_size;
+static size_t window;
+static uint64_t n_produced = 0;
+static uint64_t n_received = 0;
+static uint64_t start;
+
+/*
+ * Get the peak resident set size of the process in KiB.
+ */
+static uint64_t max_rss_kib(void) {
+    struct rusage usage;
+    if (getrusage(RUSAGE_SELF, &usage)) {
+        EOR(errno);
+    }
+    return (uint64_t) usage.ru_maxrss;
+}
+
+/*
+ * Produce the next part of the streamed message.
+ */
+static enum rawrtc_code message_producer(
+        struct mbuf* const buffer,
+        bool* const lastp,
+        void* const arg
+) {
+    size_t const length = (size_t) min(mbuf_get_space(buffer), message_size - n_produced);
+    (void) arg;
+
+    // Write part
+    EOR(mbuf_fill(buffer, 'S', length));
+    n_produced += length;
+
+    // Last part?
+    *lastp = n_produced == message_size;
+    return RAWRTC_CODE_SUCCESS;
+}
+
+static void data_channel_open_handler(
+        void* const arg
+) {
+    struct data_channel_helper* const channel = arg;
+    struct data_channel_sctp_client* const client =
+            (struct data_channel_sctp_client*) channel->client;
+    struct mbuf* buffer;
+
+    // Print open event
+    default_data_channel_open_handler(arg);
+
+    // Only client A sends
+    if (client->role != RAWRTC_ICE_ROLE_CONTROLLING) {
+        return;
+    }
+
+    // Send the message
+    DEBUG_INFO("(%s) Sending message of %"PRIu64" bytes (%s, window: %zu bytes)\n",
+               client->name, message_size, use_stream ? "stream" : "buffer", window);
+    start = tmr_jiffies();
+    if (use_stream) {
+        EOE(rawrtc_data_channel_send_stream(
+                channel->channel, message_producer, window, true, NULL));
+    } else {
+        buffer = mbuf_alloc((size_t) message_size);
+        EOE(buffer ? RAWRTC_CODE_SUCCESS : RAWRTC_CODE_NO_MEMORY);
+        EOR(mbuf_fill(buffer, 'S', (size_t) message_size));
+        mbuf_set_pos(buffer, 0);
+        EOE(rawrtc_data_channel_send(channel->channel, buffer, true));
+        mem_deref(buffer);
+    }
+}
+
+/*
+ * Print results and stop.
+ */
+static void message_received(
+        size_t const n_buffers
+) {
+    uint64_t const elapsed = tmr_jiffies() - start;
+    DEBUG_INFO("Received %"PRIu64" bytes in %zu buffer(s) in %"PRIu64" ms (%"PRIu64" KiB/s), "
+               "peak RSS: %"PRIu64" KiB\n", n_received, n_buffers, elapsed,
+               n_received * 1000 / 1024 / (elapsed > 0 ? elapsed : 1), max_rss_kib());
+    re_cancel();
+}
+
+static void data_channel_message_handler(
+        struct mbuf* const buffer,
+        enum rawrtc_data_channel_message_flag const flags,
+        void* const arg
+) {
+    (void) arg;
+
+    // Count bytes
+    if (buffer) {
+        n_received += mbuf_get_left(buffer);
+    }
+
+    // Done?
+    if (flags & RAWRTC_DATA_CHANNEL_MESSAGE_FLAG_IS_COMPLETE) {
+        message_received(1);
+    }
+}
+
+static void data_channel_message_view_handler(
+        struct rawrtc_data_channel_message_view* const view,
+        enum rawrtc_data_channel_message_flag const flags,
+        void* const arg
+) {
+    (void) flags; (void) arg;
+
+    // Count bytes & done
+    n_received += view->length;
+    message_received(view->n_buffers);
+}
+
+static void ice_gatherer_local_candidate_handler(
+        struct rawrtc_ice_candidate* const candidate,
+        char const * const url, // read-only
+        void* const arg
+) {
+    struct data_channel_sctp_client* const client = arg;
+
+    // Print local candidate
+    default_ice_gatherer_local_candidate_handler(candidate, url, arg);
+
+    // Add to other client as remote candidate (if type enabled)
+    add_to_other_if_ice_candidate_type_enabled(
+            arg, candidate, client->other_client->ice_transport);
+}
+
+static void client_init(
+        struct data_channel_sctp_client* const local
+) {
+    struct rawrtc_certificate* certificates[1];
+    struct rawrtc_data_channel_parameters* channel_parameters;
+    struct rawrtc_data_channel_options* channel_options;
+
+    // Generate certificates
+    EOE(rawrtc_certificate_generate(&local->certificate, NULL));
+    certificates[0] = local->certificate;
+
+    // Create ICE gatherer
+    EOE(rawrtc_ice_gatherer_create(
+            &local->gatherer, local->gather_options,
+            default_ice_gatherer_state_change_handler, default_ice_gatherer_error_handler,
+            ice_gatherer_local_candidate_handler, local));
+
+    // Create ICE transport
+    EOE(rawrtc_ice_transport_create(
+            &local->ice_transport, local->gatherer,
+            default_ice_transport_state_change_handler,
+            default_ice_transport_candidate_pair_change_handler, local));
+
+    // Create DTLS transport
+    EOE(rawrtc_dtls_transport_create(
+            &local->dtls_transport, local->ice_transport, certificates, ARRAY_SIZE(certificates),
+            default_dtls_transport_state_change_handler, default_dtls_transport_error_handler,
+            local));
+
+    // Create SCTP transport
+    EOE(rawrtc_sctp_transport_create(
+            &local->sctp_transport, local->dtls_transport, local->sctp_port,
+            default_data_channel_handler, default_sctp_transport_state_change_handler, local));
+
+    // Get SCTP capabilities
+    EOE(rawrtc_sctp_transport_get_capabilities(&local->sctp_capabilities));
+
+    // Get data transport
+    EOE(rawrtc_sctp_transport_get_data_transport(
+            &local->data_transport, local->sctp_transport));
+
+    // Create data channel helper
+    data_channel_helper_create(
+            &local->data_channel, (struct client *) local, "bench");
+
+    // Create data channel parameters
+    EOE(rawrtc_data_channel_parameters_create(
+            &channel_parameters, local->data_channel->label,
+            RAWRTC_DATA_CHANNEL_TYPE_RELIABLE_ORDERED, 0, NULL, true, 0));
+
+    // Create data channel options
+    EOE(rawrtc_data_channel_options_create(
+            &channel_options, receive_mode == RECEIVE_MODE_PARTIAL));
+
+    // Create pre-negotiated data channel
+    EOE(rawrtc_data_channel_create(
+            &local->data_channel->channel, local->data_transport,
+            channel_parameters, channel_options,
+            data_channel_open_handler, default_data_channel_buffered_amount_low_handler,
+            default_data_channel_error_handler, default_data_channel_close_handler,
+            data_channel_message_handler, local->data_channel));
+
+    // Set message view handler or announce the message size (if requested)
+    if (receive_mode == RECEIVE_MODE_VIEW) {
+        EOE(rawrtc_data_channel_set_message_view_handler(
+                local->data_channel->channel, data_channel_message_view_handler));
+    } else if (receive_mode == RECEIVE_MODE_HINT) {
+        EOE(rawrtc_data_channel_set_message_size_hint(
+                local->data_channel->channel, message_size));
+    }
+
+    // Un-reference
+    mem_deref(channel_options);
+    mem_deref(channel_parameters);
+}
+
+static void client_start(
+        struct data_channel_sctp_client* const local,
+        struct data_channel_sctp_client* const remote
+) {
+    // Get & set ICE parameters
+    EOE(rawrtc_ice_gatherer_get_local_parameters(
+            &local->ice_parameters, remote->gatherer));
+
+    // Start gathering
+    EOE(rawrtc_ice_gatherer_gather(local->gatherer, NULL));
+
+    // Start ICE transport
+    EOE(rawrtc_ice_transport_start(
+            local->ice_transport, local->gatherer, local->ice_parameters, local->role));
+
+    // Get DTLS parameters
+    EOE(rawrtc_dtls_transport_get_local_parameters(
+            &remote->dtls_parameters, remote->dtls_transport));
+
+    // Start DTLS transport
+    EOE(rawrtc_dtls_transport_start(
+            local->dtls_transport, remote->dtls_parameters));
+
+    // Start SCTP transport
+    EOE(rawrtc_sctp_transport_start(
+            local->sctp_transport, remote->sctp_capabilities, remote->sctp_port));
+}
+
+static void client_stop(
+        struct data_channel_sctp_client* const client
+) {
+    // Stop transports & close gatherer
+    EOE(rawrtc_data_channel_close(client->data_channel->channel));
+    EOE(rawrtc_sctp_transport_stop(client->sctp_transport));
+    EOE(rawrtc_dtls_transport_stop(client->dtls_transport));
+    EOE(rawrtc_ice_transport_stop(client->ice_transport));
+    EOE(rawrtc_ice_gatherer_close(client->gatherer));
+
+    // Un-reference & close
+    client->data_channel = mem_deref(client->data_channel);
+    client->sctp_capabilities = mem_deref(client->sctp_capabilities);
+    client->dtls_parameters = mem_deref(client->dtls_parameters);
+    client->ice_parameters = mem_deref(client->ice_parameters);
+    client->data_transport = mem_deref(client->data_transport);
+    client->sctp_transport = mem_deref(client->sctp_transport);
+    client->dtls_transport = mem_deref(client->dtls_transport);
+    client->ice_transport = mem_deref(client->ice_transport);
+    client->gatherer = mem_deref(client->gatherer);
+    client->certificate = mem_deref(client->certificate);
+}
+
+int main(int argc, char* argv[argc + 1]) {
+    struct rawrtc_ice_gather_options* gather_options;
+    struct data_channel_sctp_client a = {0};
+    struct data_channel_sctp_client b = {0};
+    uint16_t size_mib = BENCH_MESSAGE_SIZE_DEFAULT;
+    uint16_t window_kib = BENCH_WINDOW_DEFAULT;
+
+    // Initialise
+    EOE(rawrtc_init());
+
+    // Debug
+    dbg_init(DBG_INFO, DBG_ALL);
+    DEBUG_PRINTF("Init\n");
+
+    // Get mode (optional)
+    if (argc > 1) {
+        if (str_casecmp(argv[1], "buffer") == 0) {
+            use_stream = false;
+        } else if (str_casecmp(argv[1], "stream") != 0) {
+            DEBUG_WARNING("Invalid mode: %s\n", argv[1]);
+            return 1;
+        }
+    }
+
+    // Get message size (optional)
+    if (argc > 2 && (!str_to_uint16(&size_mib, argv[2]) || size_mib == 0)) {
+        DEBUG_WARNING("Invalid message size: %s\n", argv[2]);
+        return 1;
+    }
+    message_size = (uint64_t) size_mib * 1024 * 1024;
+
+    // Get receive mode (optional)
+    if (argc > 3) {
+        if (str_casecmp(argv[3], "merge") == 0) {
+            receive_mode = RECEIVE_MODE_MERGE;
+        } else if (str_casecmp(argv[3], "hint") == 0) {
+            receive_mode = RECEIVE_MODE_HINT;
+        } else if (str_casecmp(argv[3], "view") == 0) {
+            receive_mode = RECEIVE_MODE_VIEW;
+        } else if (str_casecmp(argv[3], "partial") != 0) {
+            DEBUG_WARNING("Invalid receive mode: %s\n", argv[3]);
+            return 1;
+        }
+    }
+
+    // Get window size (optional)
+    // Note: A window that is not larger than a part (64 KiB) covers the small window case.
+    if (argc > 4 && (!str_to_uint16(&window_kib, argv[4]) || window_kib == 0)) {
+        DEBUG_WARNING("Invalid window size: %s\n", argv[4]);
+        return 1;
+    }
+    window = (size_t) window_kib * 1024;
+
+    // Create ICE gather options
+    EOE(rawrtc_ice_gather_options_create(&gather_options, RAWRTC_ICE_GATHER_POLICY_ALL));
+
+    // Setup client A
+    a.name = "A";
+    a.gather_options = gather_options;
+    a.role = RAWRTC_ICE_ROLE_CONTROLLING;
+    a.sctp_port = 6000;
+    a.other_client = &b;
+
+    // Setup client B
+    b.name = "B";
+    b.gather_options = gather_options;
+    b.role = RAWRTC_ICE_ROLE_CONTROLLED;
+    b.sctp_port = 5000;
+    b.other_client = &a;
+
+    // Initialise clients
+    client_init(&a);
+    client_init(&b);
+
+    // Start clients
+    client_start(&a, &b);
+    client_start(&b, &a);
+
+    // Listen on stdin
+    EOR(fd_listen(STDIN_FILENO, FD_READ, stop_on_return_handler, NULL));
+
+    // Start main loop (until the message has been received)
+    EOR(re_main(default_signal_handler));
+
+    // Stop clients
+    client_stop(&a);
+    client_stop(&b);
+
+    // Stop listening on STDIN
+    fd_close(STDIN_FILENO);
+
+    // Free
+    mem_deref(gather_options);
+
+    // Bye
+    before_exit();
+    return 0;
+}
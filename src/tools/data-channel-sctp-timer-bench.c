@@ -0,0 +1,405 @@
+#include <errno.h> // errno
+#include <stdlib.h> // qsort
+#include <time.h> // clock_gettime
+#include <unistd.h> // STDIN_FILENO
+#include <sys/resource.h> // getrusage
+#include <rawrtc.h>
+#include "helper/utils.h"
+#include "helper/handler.h"
+
+#define DEBUG_MODULE "data-channel-sctp-timer-bench-app"
+#define DEBUG_LEVEL 7
+#include <re_dbg.h>
+
+// Note: Shadows struct client
+struct data_channel_sctp_client {
+    char* name;
+    char** ice_candidate_types;
+    size_t n_ice_candidate_types;
+    struct rawrtc_ice_gather_options* gather_options;
+    struct rawrtc_ice_parameters* ice_parameters;
+    struct rawrtc_dtls_parameters* dtls_parameters;
+    struct rawrtc_sctp_capabilities* sctp_capabilities;
+    enum rawrtc_ice_role role;
+    struct rawrtc_certificate* certificate;
+    uint16_t sctp_port;
+    struct rawrtc_ice_gatherer* gatherer;
+    struct rawrtc_ice_transport* ice_transport;
+    struct rawrtc_dtls_transport* dtls_transport;
+    struct rawrtc_sctp_transport* sctp_transport;
+    struct rawrtc_data_transport* data_transport;
+    struct data_channel_helper* data_channel;
+    struct data_channel_sctp_client* other_client;
+};
+
+enum {
+    BENCH_IDLE_DURATION = 10000, // in milliseconds
+    BENCH_N_SAMPLES = 50,
+    BENCH_SAMPLE_GAP = 500 // in milliseconds
+};
+
+/*
+ * Benchmark phases.
+ */
+enum bench_phase {
+    BENCH_PHASE_IDLE,
+    BENCH_PHASE_ACK_LATENCY,
+    BENCH_PHASE_DONE
+};
+
+static enum bench_phase phase = BENCH_PHASE_IDLE;
+static struct tmr timer = {{0}};
+static uint64_t cpu_time_start;
+static struct rawrtc_sctp_timer_statistics timer_statistics_start;
+static uint64_t sample_start;
+static uint64_t samples[BENCH_N_SAMPLES];
+static size_t n_samples = 0;
+
+/*
+ * Get the monotonic time in microseconds.
+ */
+static uint64_t time_us(void) {
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return (uint64_t) now.tv_sec * 1000000 + (uint64_t) now.tv_nsec / 1000;
+}
+
+/*
+ * Get the CPU time (user and system) used by the process in microseconds.
+ */
+static uint64_t cpu_time_us(void) {
+    struct rusage usage;
+    if (getrusage(RUSAGE_SELF, &usage)) {
+        EOR(errno);
+    }
+    return (uint64_t) (usage.ru_utime.tv_sec + usage.ru_stime.tv_sec) * 1000000
+           + (uint64_t) (usage.ru_utime.tv_usec + usage.ru_stime.tv_usec);
+}
+
+static int sample_compare(
+        void const* a,
+        void const* b
+) {
+    uint64_t const x = *(uint64_t const*) a;
+    uint64_t const y = *(uint64_t const*) b;
+    return (x > y) - (x < y);
+}
+
+/*
+ * Print idle CPU usage and timer ticks.
+ */
+static void print_idle_results(void) {
+    struct rawrtc_sctp_timer_statistics statistics;
+    uint64_t const cpu_time = cpu_time_us() - cpu_time_start;
+    uint64_t ticks;
+
+    // Get timer statistics
+    EOE(rawrtc_sctp_transport_get_timer_statistics(&statistics));
+    ticks = statistics.ticks - timer_statistics_start.ticks;
+
+    // Print
+    DEBUG_INFO("Idle: %"PRIu64" us CPU time in %d ms (%"PRIu64".%03"PRIu64" %% CPU), "
+               "%"PRIu64" timer ticks (%"PRIu64" ticks/s, %"PRIu64" backed off)\n",
+               cpu_time, BENCH_IDLE_DURATION,
+               cpu_time / (BENCH_IDLE_DURATION * 10),
+               (cpu_time * 1000 / (BENCH_IDLE_DURATION * 10)) % 1000,
+               ticks, ticks * 1000 / BENCH_IDLE_DURATION,
+               statistics.idle_ticks - timer_statistics_start.idle_ticks);
+}
+
+/*
+ * Print acknowledgement latency percentiles.
+ */
+static void print_ack_latency_results(void) {
+    // Sort samples
+    qsort(samples, n_samples, sizeof(samples[0]), sample_compare);
+
+    // Print
+    DEBUG_INFO("Acknowledgement latency (%zu samples): p50 %"PRIu64" us, p99 %"PRIu64" us, "
+               "max %"PRIu64" us\n", n_samples, samples[n_samples / 2],
+               samples[(n_samples * 99) / 100], samples[n_samples - 1]);
+}
+
+/*
+ * Send a single message and wait for it to be acknowledged.
+ */
+static void sample_start_handler(
+        void* arg
+) {
+    struct data_channel_helper* const channel = arg;
+    struct mbuf* buffer;
+
+    // Compose message
+    buffer = mbuf_alloc(1);
+    EOE(buffer ? RAWRTC_CODE_SUCCESS : RAWRTC_CODE_NO_MEMORY);
+    EOR(mbuf_write_u8(buffer, 'T'));
+    mbuf_set_pos(buffer, 0);
+
+    // Send message
+    // Note: The buffered amount low event will be raised once the sender is dry, i.e. once
+    //       the message has been acknowledged.
+    sample_start = time_us();
+    EOE(rawrtc_data_channel_send(channel->channel, buffer, true));
+    mem_deref(buffer);
+}
+
+/*
+ * Idle phase done.
+ */
+static void idle_done_handler(
+        void* arg
+) {
+    // Print results
+    print_idle_results();
+
+    // Start acknowledgement latency phase
+    phase = BENCH_PHASE_ACK_LATENCY;
+    sample_start_handler(arg);
+}
+
+static void data_channel_open_handler(
+        void* const arg
+) {
+    struct data_channel_helper* const channel = arg;
+    struct data_channel_sctp_client* const client =
+            (struct data_channel_sctp_client*) channel->client;
+
+    // Print open event
+    default_data_channel_open_handler(arg);
+
+    // Only client A measures
+    if (client->role != RAWRTC_ICE_ROLE_CONTROLLING) {
+        return;
+    }
+
+    // Start idle phase
+    DEBUG_INFO("Idling for %d ms\n", BENCH_IDLE_DURATION);
+    EOE(rawrtc_sctp_transport_get_timer_statistics(&timer_statistics_start));
+    cpu_time_start = cpu_time_us();
+    tmr_start(&timer, BENCH_IDLE_DURATION, idle_done_handler, channel);
+}
+
+static void data_channel_buffered_amount_low_handler(
+        void* const arg
+) {
+    struct data_channel_helper* const channel = arg;
+    struct data_channel_sctp_client* const client =
+            (struct data_channel_sctp_client*) channel->client;
+
+    // Waiting for an acknowledgement?
+    if (client->role != RAWRTC_ICE_ROLE_CONTROLLING || phase != BENCH_PHASE_ACK_LATENCY
+            || tmr_isrunning(&timer)) {
+        return;
+    }
+
+    // Add sample
+    samples[n_samples++] = time_us() - sample_start;
+
+    // Done?
+    if (n_samples == BENCH_N_SAMPLES) {
+        phase = BENCH_PHASE_DONE;
+        print_ack_latency_results();
+        return;
+    }
+
+    // Send the next message once the timer has gone idle again
+    tmr_start(&timer, BENCH_SAMPLE_GAP, sample_start_handler, channel);
+}
+
+static void ice_gatherer_local_candidate_handler(
+        struct rawrtc_ice_candidate* const candidate,
+        char const * const url, // read-only
+        void* const arg
+) {
+    struct data_channel_sctp_client* const client = arg;
+
+    // Print local candidate
+    default_ice_gatherer_local_candidate_handler(candidate, url, arg);
+
+    // Add to other client as remote candidate (if type enabled)
+    add_to_other_if_ice_candidate_type_enabled(
+            arg, candidate, client->other_client->ice_transport);
+}
+
+static void client_init(
+        struct data_channel_sctp_client* const local
+) {
+    struct rawrtc_certificate* certificates[1];
+    struct rawrtc_data_channel_parameters* channel_parameters;
+
+    // Generate certificates
+    EOE(rawrtc_certificate_generate(&local->certificate, NULL));
+    certificates[0] = local->certificate;
+
+    // Create ICE gatherer
+    EOE(rawrtc_ice_gatherer_create(
+            &local->gatherer, local->gather_options,
+            default_ice_gatherer_state_change_handler, default_ice_gatherer_error_handler,
+            ice_gatherer_local_candidate_handler, local));
+
+    // Create ICE transport
+    EOE(rawrtc_ice_transport_create(
+            &local->ice_transport, local->gatherer,
+            default_ice_transport_state_change_handler,
+            default_ice_transport_candidate_pair_change_handler, local));
+
+    // Create DTLS transport
+    EOE(rawrtc_dtls_transport_create(
+            &local->dtls_transport, local->ice_transport, certificates, ARRAY_SIZE(certificates),
+            default_dtls_transport_state_change_handler, default_dtls_transport_error_handler,
+            local));
+
+    // Create SCTP transport
+    EOE(rawrtc_sctp_transport_create(
+            &local->sctp_transport, local->dtls_transport, local->sctp_port,
+            default_data_channel_handler, default_sctp_transport_state_change_handler, local));
+
+    // Get SCTP capabilities
+    EOE(rawrtc_sctp_transport_get_capabilities(&local->sctp_capabilities));
+
+    // Get data transport
+    EOE(rawrtc_sctp_transport_get_data_transport(
+            &local->data_transport, local->sctp_transport));
+
+    // Create data channel helper
+    data_channel_helper_create(
+            &local->data_channel, (struct client *) local, "bench");
+
+    // Create data channel parameters
+    EOE(rawrtc_data_channel_parameters_create(
+            &channel_parameters, local->data_channel->label,
+            RAWRTC_DATA_CHANNEL_TYPE_RELIABLE_ORDERED, 0, NULL, true, 0));
+
+    // Create pre-negotiated data channel
+    EOE(rawrtc_data_channel_create(
+            &local->data_channel->channel, local->data_transport,
+            channel_parameters, NULL,
+            data_channel_open_handler, data_channel_buffered_amount_low_handler,
+            default_data_channel_error_handler, default_data_channel_close_handler,
+            default_data_channel_message_handler, local->data_channel));
+
+    // Un-reference
+    mem_deref(channel_parameters);
+}
+
+static void client_start(
+        struct data_channel_sctp_client* const local,
+        struct data_channel_sctp_client* const remote
+) {
+    // Get & set ICE parameters
+    EOE(rawrtc_ice_gatherer_get_local_parameters(
+            &local->ice_parameters, remote->gatherer));
+
+    // Start gathering
+    EOE(rawrtc_ice_gatherer_gather(local->gatherer, NULL));
+
+    // Start ICE transport
+    EOE(rawrtc_ice_transport_start(
+            local->ice_transport, local->gatherer, local->ice_parameters, local->role));
+
+    // Get DTLS parameters
+    EOE(rawrtc_dtls_transport_get_local_parameters(
+            &remote->dtls_parameters, remote->dtls_transport));
+
+    // Start DTLS transport
+    EOE(rawrtc_dtls_transport_start(
+            local->dtls_transport, remote->dtls_parameters));
+
+    // Start SCTP transport
+    EOE(rawrtc_sctp_transport_start(
+            local->sctp_transport, remote->sctp_capabilities, remote->sctp_port));
+}
+
+static void client_stop(
+        struct data_channel_sctp_client* const client
+) {
+    // Stop transports & close gatherer
+    EOE(rawrtc_data_channel_close(client->data_channel->channel));
+    EOE(rawrtc_sctp_transport_stop(client->sctp_transport));
+    EOE(rawrtc_dtls_transport_stop(client->dtls_transport));
+    EOE(rawrtc_ice_transport_stop(client->ice_transport));
+    EOE(rawrtc_ice_gatherer_close(client->gatherer));
+
+    // Un-reference & close
+    client->data_channel = mem_deref(client->data_channel);
+    client->sctp_capabilities = mem_deref(client->sctp_capabilities);
+    client->dtls_parameters = mem_deref(client->dtls_parameters);
+    client->ice_parameters = mem_deref(client->ice_parameters);
+    client->data_transport = mem_deref(client->data_transport);
+    client->sctp_transport = mem_deref(client->sctp_transport);
+    client->dtls_transport = mem_deref(client->dtls_transport);
+    client->ice_transport = mem_deref(client->ice_transport);
+    client->gatherer = mem_deref(client->gatherer);
+    client->certificate = mem_deref(client->certificate);
+}
+
+int main(int argc, char* argv[argc + 1]) {
+    char** ice_candidate_types = NULL;
+    size_t n_ice_candidate_types = 0;
+    struct rawrtc_ice_gather_options* gather_options;
+    struct data_channel_sctp_client a = {0};
+    struct data_channel_sctp_client b = {0};
+
+    // Initialise
+    EOE(rawrtc_init());
+
+    // Debug
+    dbg_init(DBG_DEBUG, DBG_ALL);
+    DEBUG_PRINTF("Init\n");
+
+    // Get enabled ICE candidate types to be added (optional)
+    if (argc > 1) {
+        ice_candidate_types = &argv[1];
+        n_ice_candidate_types = (size_t) argc - 1;
+    }
+
+    // Create ICE gather options
+    EOE(rawrtc_ice_gather_options_create(&gather_options, RAWRTC_ICE_GATHER_POLICY_ALL));
+
+    // Setup client A
+    a.name = "A";
+    a.ice_candidate_types = ice_candidate_types;
+    a.n_ice_candidate_types = n_ice_candidate_types;
+    a.gather_options = gather_options;
+    a.role = RAWRTC_ICE_ROLE_CONTROLLING;
+    a.sctp_port = 6000;
+    a.other_client = &b;
+
+    // Setup client B
+    b.name = "B";
+    b.ice_candidate_types = ice_candidate_types;
+    b.n_ice_candidate_types = n_ice_candidate_types;
+    b.gather_options = gather_options;
+    b.role = RAWRTC_ICE_ROLE_CONTROLLED;
+    b.sctp_port = 5000;
+    b.other_client = &a;
+
+    // Initialise clients
+    client_init(&a);
+    client_init(&b);
+
+    // Start clients
+    client_start(&a, &b);
+    client_start(&b, &a);
+
+    // Listen on stdin
+    EOR(fd_listen(STDIN_FILENO, FD_READ, stop_on_return_handler, NULL));
+
+    // Start main loop
+    EOR(re_main(default_signal_handler));
+
+    // Stop clients
+    client_stop(&a);
+    client_stop(&b);
+
+    // Stop listening on STDIN & cancel timer
+    fd_close(STDIN_FILENO);
+    tmr_cancel(&timer);
+
+    // Free
+    mem_deref(gather_options);
+
+    // Bye
+    before_exit();
+    return 0;
+}
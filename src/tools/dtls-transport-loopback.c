@@ -21,8 +21,113 @@ struct dtls_transport_client {
     struct rawrtc_ice_transport* ice_transport;
     struct rawrtc_dtls_transport* dtls_transport;
     struct dtls_transport_client* other_client;
+    uint64_t ice_connected_time;
+    bool dtls_connected;
 };
 
+static struct tmr reconnect_timer = {{0}};
+static bool reconnect = false;
+static uint16_t n_reconnects = 0; // remaining
+static uint64_t n_full_handshakes = 0;
+static uint64_t full_handshake_time = 0; // in milliseconds
+static uint64_t n_resumed_handshakes = 0;
+static uint64_t resumed_handshake_time = 0; // in milliseconds
+
+static void client_init(
+    struct dtls_transport_client* const local
+);
+
+static void client_start(
+    struct dtls_transport_client* const local,
+    struct dtls_transport_client* const remote
+);
+
+static void client_stop(
+    struct dtls_transport_client* const client
+);
+
+/*
+ * Tear down both clients and connect them again.
+ */
+static void reconnect_handler(
+        void* arg
+) {
+    struct dtls_transport_client* const client = arg;
+    struct dtls_transport_client* const a =
+            client->role == RAWRTC_ICE_ROLE_CONTROLLING ? client : client->other_client;
+    struct dtls_transport_client* const b = a->other_client;
+
+    // Done?
+    if (n_reconnects == 0) {
+        re_cancel();
+        return;
+    }
+    --n_reconnects;
+
+    // Stop clients
+    DEBUG_INFO("Reconnecting (%"PRIu16" reconnects left)\n", n_reconnects);
+    client_stop(a);
+    client_stop(b);
+
+    // Initialise & start clients again (with the same certificates)
+    client_init(a);
+    client_init(b);
+    client_start(a, b);
+    client_start(b, a);
+}
+
+static void ice_transport_state_change_handler(
+        enum rawrtc_ice_transport_state const state,
+        void* const arg
+) {
+    struct dtls_transport_client* const client = arg;
+
+    // Print state
+    default_ice_transport_state_change_handler(state, arg);
+
+    // Remember when ICE is connected (the DTLS handshake starts at that point)
+    if (state == RAWRTC_ICE_TRANSPORT_STATE_CONNECTED && client->ice_connected_time == 0) {
+        client->ice_connected_time = tmr_jiffies();
+    }
+}
+
+/*
+ * Print the handshake duration and whether the session has been
+ * resumed. Reconnect once both clients are connected (if requested).
+ */
+static void handle_dtls_connected(
+        struct dtls_transport_client* const client
+) {
+    struct rawrtc_dtls_transport_statistics statistics;
+    uint64_t const elapsed = tmr_jiffies() - client->ice_connected_time;
+    bool resumed;
+
+    // Get statistics
+    EOE(rawrtc_dtls_transport_get_statistics(&statistics, client->dtls_transport));
+    resumed = statistics.sessions_resumed > 0;
+
+    // Print handshake duration
+    DEBUG_INFO("(%s) DTLS handshake: %"PRIu64" ms, session %s\n",
+               client->name, elapsed, resumed ? "resumed" : "not resumed");
+
+    // Count handshakes of client A
+    if (client->role == RAWRTC_ICE_ROLE_CONTROLLING) {
+        if (resumed) {
+            ++n_resumed_handshakes;
+            resumed_handshake_time += elapsed;
+        } else {
+            ++n_full_handshakes;
+            full_handshake_time += elapsed;
+        }
+    }
+
+    // Reconnect once both clients are connected
+    client->dtls_connected = true;
+    if (reconnect && client->other_client->dtls_connected) {
+        tmr_start(&reconnect_timer, 0, reconnect_handler, client);
+    }
+}
+
 static void ice_gatherer_local_candidate_handler(
         struct rawrtc_ice_candidate* const candidate,
         char const * const url, // read-only
@@ -47,6 +152,11 @@ static void dtls_transport_state_change_handler(
     // Print state
     default_dtls_transport_state_change_handler(state, arg);
 
+    // Connected?
+    if (state == RAWRTC_DTLS_TRANSPORT_STATE_CONNECTED) {
+        handle_dtls_connected(client);
+    }
+
     // Open? Send message (twice to test the buffering)
     if (state == RAWRTC_DTLS_TRANSPORT_STATE_CONNECTING ||
             state == RAWRTC_DTLS_TRANSPORT_STATE_CONNECTED) {
@@ -71,10 +181,16 @@ static void client_init(
 ) {
     struct rawrtc_certificate* certificates[1];
 
-    // Generate certificates
-    EOE(rawrtc_certificate_generate(&local->certificate, NULL));
+    // Generate certificates (unless reconnecting)
+    if (!local->certificate) {
+        EOE(rawrtc_certificate_generate(&local->certificate, NULL));
+    }
     certificates[0] = local->certificate;
 
+    // Reset connection state
+    local->ice_connected_time = 0;
+    local->dtls_connected = false;
+
     // Create ICE gatherer
     EOE(rawrtc_ice_gatherer_create(
             &local->gatherer, local->gather_options,
@@ -84,7 +200,7 @@ static void client_init(
     // Create ICE transport
     EOE(rawrtc_ice_transport_create(
             &local->ice_transport, local->gatherer,
-            default_ice_transport_state_change_handler,
+            ice_transport_state_change_handler,
             default_ice_transport_candidate_pair_change_handler, local));
 
     // Create DTLS transport
@@ -131,11 +247,11 @@ static void client_stop(
     client->dtls_transport = mem_deref(client->dtls_transport);
     client->ice_transport = mem_deref(client->ice_transport);
     client->gatherer = mem_deref(client->gatherer);
-    client->certificate = mem_deref(client->certificate);
 }
 
 static void exit_with_usage(char* program) {
-    DEBUG_WARNING("Usage: %s [<ice-candidate-type> ...]", program);
+    DEBUG_WARNING("Usage: %s [<n-reconnects> [<session-cache-size>]] [<ice-candidate-type> ...]",
+                  program);
     exit(1);
 }
 
@@ -148,6 +264,8 @@ int main(int argc, char* argv[argc + 1]) {
     char* const turn_threema_ch_urls[] = {"turn:turn.threema.ch:443"};
     struct dtls_transport_client a = {0};
     struct dtls_transport_client b = {0};
+    int arg_index = 1;
+    uint16_t session_cache_size = 64;
     (void) a.ice_candidate_types; (void) a.n_ice_candidate_types;
     (void) b.ice_candidate_types; (void) b.n_ice_candidate_types;
 
@@ -158,10 +276,23 @@ int main(int argc, char* argv[argc + 1]) {
     dbg_init(DBG_DEBUG, DBG_ALL);
     DEBUG_PRINTF("Init\n");
 
+    // Get amount of reconnects (optional)
+    // Note: Reconnecting enables DTLS session resumption unless the session cache size is 0.
+    if (argc > arg_index && str_to_uint16(&n_reconnects, argv[arg_index])) {
+        reconnect = true;
+        ++arg_index;
+
+        // Get session cache size (optional)
+        if (argc > arg_index && str_to_uint16(&session_cache_size, argv[arg_index])) {
+            ++arg_index;
+        }
+        EOE(rawrtc_shard_set_dtls_session_cache_size(session_cache_size));
+    }
+
     // Get enabled ICE candidate types to be added (optional)
-    if (argc > 1) {
-        ice_candidate_types = &argv[1];
-        n_ice_candidate_types = (size_t) argc - 1;
+    if (argc > arg_index) {
+        ice_candidate_types = &argv[arg_index];
+        n_ice_candidate_types = (size_t) (argc - arg_index);
     }
 
     // Create ICE gather options
@@ -208,7 +339,22 @@ int main(int argc, char* argv[argc + 1]) {
     client_stop(&a);
     client_stop(&b);
 
+    // Print handshake summary (client A)
+    if (reconnect) {
+        DEBUG_INFO("Full handshakes: %"PRIu64" (%"PRIu64" ms avg), "
+                   "resumed handshakes: %"PRIu64" (%"PRIu64" ms avg)\n",
+                   n_full_handshakes,
+                   n_full_handshakes > 0 ? full_handshake_time / n_full_handshakes : 0,
+                   n_resumed_handshakes,
+                   n_resumed_handshakes > 0 ? resumed_handshake_time / n_resumed_handshakes : 0);
+    }
+
+    // Stop reconnect timer
+    tmr_cancel(&reconnect_timer);
+
     // Free
+    mem_deref(b.certificate);
+    mem_deref(a.certificate);
     mem_deref(gather_options);
 
     // Bye
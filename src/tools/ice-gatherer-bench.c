@@ -0,0 +1,118 @@
+#include <dirent.h> // opendir, readdir, closedir
+#include <rawrtc.h>
+#include "helper/utils.h"
+#include "helper/handler.h"
+
+#define DEBUG_MODULE "ice-gatherer-bench-app"
+#define DEBUG_LEVEL 7
+#include <re_dbg.h>
+
+enum {
+    BENCH_N_GATHERERS_DEFAULT = 1000
+};
+
+/*
+ * Count the open file descriptors of this process.
+ * Return `-1` in case they cannot be counted.
+ */
+static int count_file_descriptors(void) {
+    DIR* directory;
+    struct dirent* entry;
+    int n = 0;
+
+    // Open directory
+    directory = opendir("/proc/self/fd");
+    if (!directory) {
+        return -1;
+    }
+
+    // Count entries (without '.', '..' and the directory itself)
+    while ((entry = readdir(directory)) != NULL) {
+        if (entry->d_name[0] != '.') {
+            ++n;
+        }
+    }
+    closedir(directory);
+    return n - 1;
+}
+
+int main(int argc, char* argv[argc + 1]) {
+    uint16_t n_gatherers = BENCH_N_GATHERERS_DEFAULT;
+    bool udp_mux = false;
+    uint16_t udp_mux_port = 0;
+    struct rawrtc_ice_gather_options* gather_options;
+    struct rawrtc_ice_gatherer** gatherers;
+    int n_file_descriptors_before;
+    int n_file_descriptors;
+    uint64_t start;
+    uint64_t elapsed;
+    uint16_t i;
+
+    // Initialise
+    EOE(rawrtc_init());
+
+    // Debug
+    dbg_init(DBG_INFO, DBG_ALL);
+    DEBUG_PRINTF("Init\n");
+
+    // Get amount of ICE gatherers (optional)
+    if (argc > 1 && (!str_to_uint16(&n_gatherers, argv[1]) || n_gatherers == 0)) {
+        DEBUG_WARNING("Invalid amount of ICE gatherers: %s\n", argv[1]);
+        return 1;
+    }
+
+    // Get UDP socket mode (optional)
+    if (argc > 2) {
+        if (str_casecmp(argv[2], "mux") == 0) {
+            udp_mux = true;
+        } else if (str_casecmp(argv[2], "sockets") != 0) {
+            DEBUG_WARNING("Invalid UDP socket mode: %s\n", argv[2]);
+            return 1;
+        }
+    }
+
+    // Get port of the shared UDP sockets (optional)
+    if (argc > 3 && !str_to_uint16(&udp_mux_port, argv[3])) {
+        DEBUG_WARNING("Invalid port: %s\n", argv[3]);
+        return 1;
+    }
+
+    // Create ICE gather options (host candidates only)
+    EOE(rawrtc_ice_gather_options_create(&gather_options, RAWRTC_ICE_GATHER_POLICY_ALL));
+    EOE(rawrtc_ice_gather_options_set_udp_mux(gather_options, udp_mux, udp_mux_port));
+
+    // Allocate ICE gatherers
+    gatherers = mem_zalloc(n_gatherers * sizeof(*gatherers), NULL);
+    EOE(gatherers ? RAWRTC_CODE_SUCCESS : RAWRTC_CODE_NO_MEMORY);
+
+    // Create ICE gatherers and gather
+    // Note: Host candidates are gathered synchronously.
+    n_file_descriptors_before = count_file_descriptors();
+    start = tmr_jiffies();
+    for (i = 0; i < n_gatherers; ++i) {
+        EOE(rawrtc_ice_gatherer_create(&gatherers[i], gather_options, NULL, NULL, NULL, NULL));
+        EOE(rawrtc_ice_gatherer_gather(gatherers[i], NULL));
+    }
+    elapsed = tmr_jiffies() - start;
+    n_file_descriptors = count_file_descriptors();
+
+    // Print result
+    DEBUG_INFO("%"PRIu16" ICE gatherers (UDP %s): gathered in %"PRIu64" ms "
+               "(%"PRIu64" us each), %d file descriptors opened\n",
+               n_gatherers, udp_mux ? "mux" : "sockets", elapsed,
+               elapsed * 1000 / n_gatherers, n_file_descriptors - n_file_descriptors_before);
+
+    // Close ICE gatherers
+    for (i = 0; i < n_gatherers; ++i) {
+        EOE(rawrtc_ice_gatherer_close(gatherers[i]));
+        mem_deref(gatherers[i]);
+    }
+
+    // Un-reference
+    mem_deref(gatherers);
+    mem_deref(gather_options);
+
+    // Bye
+    before_exit();
+    return 0;
+}
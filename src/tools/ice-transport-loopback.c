@@ -80,14 +80,17 @@ static void client_stop(
 }
 
 static void exit_with_usage(char* program) {
-    DEBUG_WARNING("Usage: %s [<ice-candidate-type> ...]", program);
+    DEBUG_WARNING("Usage: %s [lite] [<ice-candidate-type> ...]", program);
     exit(1);
 }
 
 int main(int argc, char* argv[argc + 1]) {
     char** ice_candidate_types = NULL;
     size_t n_ice_candidate_types = 0;
+    bool ice_lite_a = false;
+    bool ice_lite_b = false;
     struct rawrtc_ice_gather_options* gather_options;
+    struct rawrtc_ice_gather_options* lite_gather_options;
     char* const stun_google_com_urls[] = {"stun:stun.l.google.com:19302",
                                           "stun:stun1.l.google.com:19302"};
     char* const turn_threema_ch_urls[] = {"turn:turn.threema.ch:443"};
@@ -103,6 +106,18 @@ int main(int argc, char* argv[argc + 1]) {
     dbg_init(DBG_DEBUG, DBG_ALL);
     DEBUG_PRINTF("Init\n");
 
+    // Make client B (or both clients) an ICE lite agent (optional)
+    if (argc > 1 && str_casecmp(argv[1], "lite") == 0) {
+        ice_lite_b = true;
+        --argc;
+        ++argv;
+    } else if (argc > 1 && str_casecmp(argv[1], "both-lite") == 0) {
+        ice_lite_a = true;
+        ice_lite_b = true;
+        --argc;
+        ++argv;
+    }
+
     // Get enabled ICE candidate types to be added (optional)
     if (argc > 1) {
         ice_candidate_types = &argv[1];
@@ -121,19 +136,24 @@ int main(int argc, char* argv[argc + 1]) {
             "threema-angular", "Uv0LcCq3kyx6EiRwQW5jVigkhzbp70CjN2CJqzmRxG3UGIdJHSJV6tpo7Gj7YnGB",
             RAWRTC_ICE_CREDENTIAL_TYPE_PASSWORD));
 
+    // Create ICE gather options for ICE lite agents
+    // Note: ICE servers are ignored by ICE lite agents.
+    EOE(rawrtc_ice_gather_options_create(&lite_gather_options, RAWRTC_ICE_GATHER_POLICY_ALL));
+    EOE(rawrtc_ice_gather_options_set_ice_lite(lite_gather_options, true));
+
     // Setup client A
     a.name = "A";
     a.ice_candidate_types = ice_candidate_types;
     a.n_ice_candidate_types = n_ice_candidate_types;
-    a.gather_options = gather_options;
-    a.role = RAWRTC_ICE_ROLE_CONTROLLING;
+    a.gather_options = ice_lite_a ? lite_gather_options : gather_options;
+    a.role = RAWRTC_ICE_ROLE_CONTROLLING; // offerer (also if both are lite)
     a.other_client = &b;
 
     // Setup client B
     b.name = "B";
     b.ice_candidate_types = ice_candidate_types;
     b.n_ice_candidate_types = n_ice_candidate_types;
-    b.gather_options = gather_options;
+    b.gather_options = ice_lite_b ? lite_gather_options : gather_options;
     b.role = RAWRTC_ICE_ROLE_CONTROLLED;
     b.other_client = &a;
 
@@ -154,6 +174,7 @@ int main(int argc, char* argv[argc + 1]) {
     client_stop(&b);
 
     // Free
+    mem_deref(lite_gather_options);
     mem_deref(gather_options);
 
     // Bye
@@ -0,0 +1,381 @@
+#include <rawrtc.h>
+#include "../librawrtc/path_mtu.h" /* TODO: Replace with <rawrtc_internal/path_mtu.h> */
+#include "helper/utils.h"
+#include "helper/handler.h"
+
+#define DEBUG_MODULE "path-mtu-loopback-app"
+#define DEBUG_LEVEL 7
+#include <re_dbg.h>
+
+enum {
+    TEST_LIMIT_DEFAULT = 1300, // artificial path MTU limit
+    TEST_MAX_DEFAULT = 8972, // Ethernet jumbo frames (IPv4)
+    TEST_MESSAGE_SIZE = 64 * 1024,
+    TEST_POLL_INTERVAL = 250, // in milliseconds
+    TEST_TIMEOUT = 60 * 1000 // in milliseconds
+};
+
+struct path_mtu_test;
+
+// Note: Shadows struct client
+struct path_mtu_client {
+    char* name;
+    char** ice_candidate_types;
+    size_t n_ice_candidate_types;
+    struct rawrtc_ice_gather_options* gather_options;
+    struct rawrtc_ice_parameters* ice_parameters;
+    struct rawrtc_dtls_parameters* dtls_parameters;
+    struct rawrtc_sctp_capabilities* sctp_capabilities;
+    enum rawrtc_ice_role role;
+    struct rawrtc_certificate* certificate;
+    uint16_t sctp_port;
+    struct rawrtc_ice_gatherer* gatherer;
+    struct rawrtc_ice_transport* ice_transport;
+    struct rawrtc_dtls_transport* dtls_transport;
+    struct rawrtc_sctp_transport* sctp_transport;
+    struct rawrtc_data_transport* data_transport;
+    struct data_channel_helper* data_channel;
+    struct path_mtu_client* other_client;
+    struct path_mtu_test* test;
+};
+
+/*
+ * Both peers and the outcome of the test.
+ */
+struct path_mtu_test {
+    struct path_mtu_client a;
+    struct path_mtu_client b;
+    struct tmr poll_timer;
+    struct tmr timeout_timer;
+    bool open;
+    bool sent;
+    size_t n_received;
+};
+
+static void data_channel_open_handler(
+        void* const arg
+) {
+    struct data_channel_helper* const channel = arg;
+    struct path_mtu_client* const client = (struct path_mtu_client*) channel->client;
+
+    // Print open event
+    default_data_channel_open_handler(arg);
+
+    // Ready to send (once the search is complete)
+    client->test->open = true;
+}
+
+static void data_channel_message_handler(
+        struct mbuf* const buffer,
+        enum rawrtc_data_channel_message_flag const flags,
+        void* const arg
+) {
+    struct data_channel_helper* const channel = arg;
+    struct path_mtu_client* const client = (struct path_mtu_client*) channel->client;
+    (void) flags;
+
+    // Received the message? Done.
+    DEBUG_INFO("(%s) Received %zu bytes\n", client->name, mbuf_get_left(buffer));
+    client->test->n_received = mbuf_get_left(buffer);
+    re_cancel();
+}
+
+static void ice_gatherer_local_candidate_handler(
+        struct rawrtc_ice_candidate* const candidate,
+        char const * const url, // read-only
+        void* const arg
+) {
+    struct path_mtu_client* const client = arg;
+
+    // Print local candidate
+    default_ice_gatherer_local_candidate_handler(candidate, url, arg);
+
+    // Add to other client as remote candidate (if type enabled)
+    add_to_other_if_ice_candidate_type_enabled(
+            arg, candidate, client->other_client->ice_transport);
+}
+
+/*
+ * Send a message that is much larger than the path MTU once both
+ * peers have completed the search. It will only arrive if SCTP
+ * adheres to the discovered path MTU.
+ */
+static void poll_handler(
+        void* arg
+) {
+    struct path_mtu_test* const test = arg;
+    size_t path_mtu_a;
+    size_t path_mtu_b;
+    bool complete_a;
+    bool complete_b;
+    struct mbuf* buffer;
+
+    // Get path MTUs
+    EOE(rawrtc_dtls_transport_get_path_mtu(&path_mtu_a, &complete_a, test->a.dtls_transport));
+    EOE(rawrtc_dtls_transport_get_path_mtu(&path_mtu_b, &complete_b, test->b.dtls_transport));
+
+    // Wait until open and complete
+    if (!test->open || !complete_a || !complete_b) {
+        tmr_start(&test->poll_timer, TEST_POLL_INTERVAL, poll_handler, test);
+        return;
+    }
+    DEBUG_INFO("Search complete, path MTU: %zu (A), %zu (B)\n", path_mtu_a, path_mtu_b);
+
+    // Compose message
+    buffer = mbuf_alloc(TEST_MESSAGE_SIZE);
+    EOE(buffer ? RAWRTC_CODE_SUCCESS : RAWRTC_CODE_NO_MEMORY);
+    EOR(mbuf_fill(buffer, 'M', TEST_MESSAGE_SIZE));
+    mbuf_set_pos(buffer, 0);
+
+    // Send message
+    DEBUG_INFO("(A) Sending %zu bytes\n", mbuf_get_left(buffer));
+    EOE(rawrtc_data_channel_send(test->a.data_channel->channel, buffer, true));
+    test->sent = true;
+    mem_deref(buffer);
+}
+
+static void timeout_handler(
+        void* arg
+) {
+    (void) arg;
+    DEBUG_WARNING("Timeout\n");
+    re_cancel();
+}
+
+static void client_init(
+        struct path_mtu_client* const local
+) {
+    struct rawrtc_certificate* certificates[1];
+    struct rawrtc_data_channel_parameters* channel_parameters;
+
+    // Generate certificates
+    EOE(rawrtc_certificate_generate(&local->certificate, NULL));
+    certificates[0] = local->certificate;
+
+    // Create ICE gatherer
+    EOE(rawrtc_ice_gatherer_create(
+            &local->gatherer, local->gather_options,
+            default_ice_gatherer_state_change_handler, default_ice_gatherer_error_handler,
+            ice_gatherer_local_candidate_handler, local));
+
+    // Create ICE transport
+    EOE(rawrtc_ice_transport_create(
+            &local->ice_transport, local->gatherer,
+            default_ice_transport_state_change_handler,
+            default_ice_transport_candidate_pair_change_handler, local));
+
+    // Create DTLS transport
+    EOE(rawrtc_dtls_transport_create(
+            &local->dtls_transport, local->ice_transport, certificates, ARRAY_SIZE(certificates),
+            default_dtls_transport_state_change_handler, default_dtls_transport_error_handler,
+            local));
+
+    // Create SCTP transport
+    EOE(rawrtc_sctp_transport_create(
+            &local->sctp_transport, local->dtls_transport, local->sctp_port,
+            default_data_channel_handler, default_sctp_transport_state_change_handler, local));
+
+    // Get SCTP capabilities
+    EOE(rawrtc_sctp_transport_get_capabilities(&local->sctp_capabilities));
+
+    // Get data transport
+    EOE(rawrtc_sctp_transport_get_data_transport(
+            &local->data_transport, local->sctp_transport));
+
+    // Create data channel helper
+    data_channel_helper_create(
+            &local->data_channel, (struct client *) local, "path-mtu");
+
+    // Create data channel parameters
+    EOE(rawrtc_data_channel_parameters_create(
+            &channel_parameters, local->data_channel->label,
+            RAWRTC_DATA_CHANNEL_TYPE_RELIABLE_ORDERED, 0, NULL, true, 0));
+
+    // Create pre-negotiated data channel
+    EOE(rawrtc_data_channel_create(
+            &local->data_channel->channel, local->data_transport,
+            channel_parameters, NULL,
+            data_channel_open_handler, NULL,
+            default_data_channel_error_handler, default_data_channel_close_handler,
+            data_channel_message_handler, local->data_channel));
+
+    // Un-reference
+    mem_deref(channel_parameters);
+}
+
+static void client_start(
+        struct path_mtu_client* const local,
+        struct path_mtu_client* const remote
+) {
+    // Get & set ICE parameters
+    EOE(rawrtc_ice_gatherer_get_local_parameters(
+            &local->ice_parameters, remote->gatherer));
+
+    // Start gathering
+    EOE(rawrtc_ice_gatherer_gather(local->gatherer, NULL));
+
+    // Start ICE transport
+    EOE(rawrtc_ice_transport_start(
+            local->ice_transport, local->gatherer, local->ice_parameters, local->role));
+
+    // Get DTLS parameters
+    EOE(rawrtc_dtls_transport_get_local_parameters(
+            &remote->dtls_parameters, remote->dtls_transport));
+
+    // Start DTLS transport
+    EOE(rawrtc_dtls_transport_start(
+            local->dtls_transport, remote->dtls_parameters));
+
+    // Start SCTP transport
+    EOE(rawrtc_sctp_transport_start(
+            local->sctp_transport, remote->sctp_capabilities, remote->sctp_port));
+}
+
+/*
+ * Check and print the client's path MTU and DTLS statistics.
+ * Return whether the path MTU matches the expected value.
+ */
+static bool client_check(
+        struct path_mtu_client* const client,
+        size_t const expected_path_mtu
+) {
+    struct rawrtc_dtls_transport_statistics statistics;
+    size_t path_mtu;
+    bool complete;
+
+    // Get path MTU & statistics
+    EOE(rawrtc_dtls_transport_get_path_mtu(&path_mtu, &complete, client->dtls_transport));
+    EOE(rawrtc_dtls_transport_get_statistics(&statistics, client->dtls_transport));
+
+    // Print
+    DEBUG_INFO("(%s) Path MTU: %zu (expected: %zu, %s), %"PRIu64" datagrams sent, "
+               "%"PRIu64" discarded\n", client->name, path_mtu, expected_path_mtu,
+               complete ? "complete" : "incomplete", statistics.datagrams_sent,
+               statistics.datagrams_discarded);
+
+    // Check
+    return complete && path_mtu == expected_path_mtu && statistics.datagrams_discarded == 0;
+}
+
+static void client_stop(
+        struct path_mtu_client* const client
+) {
+    // Stop transports & close gatherer
+    EOE(rawrtc_data_channel_close(client->data_channel->channel));
+    EOE(rawrtc_sctp_transport_stop(client->sctp_transport));
+    EOE(rawrtc_dtls_transport_stop(client->dtls_transport));
+    EOE(rawrtc_ice_transport_stop(client->ice_transport));
+    EOE(rawrtc_ice_gatherer_close(client->gatherer));
+
+    // Un-reference & close
+    client->data_channel = mem_deref(client->data_channel);
+    client->sctp_capabilities = mem_deref(client->sctp_capabilities);
+    client->dtls_parameters = mem_deref(client->dtls_parameters);
+    client->ice_parameters = mem_deref(client->ice_parameters);
+    client->data_transport = mem_deref(client->data_transport);
+    client->sctp_transport = mem_deref(client->sctp_transport);
+    client->dtls_transport = mem_deref(client->dtls_transport);
+    client->ice_transport = mem_deref(client->ice_transport);
+    client->gatherer = mem_deref(client->gatherer);
+    client->certificate = mem_deref(client->certificate);
+}
+
+static void exit_with_usage(char* program) {
+    DEBUG_WARNING("Usage: %s [<mtu-limit> [<mtu-max>]]", program);
+    exit(1);
+}
+
+int main(int argc, char* argv[argc + 1]) {
+    uint16_t limit = TEST_LIMIT_DEFAULT;
+    uint16_t maximum = TEST_MAX_DEFAULT;
+    size_t expected_path_mtu;
+    struct rawrtc_ice_gather_options* gather_options;
+    struct path_mtu_test test = {0};
+    struct path_mtu_client* const a = &test.a;
+    struct path_mtu_client* const b = &test.b;
+    bool passed;
+
+    // Initialise
+    EOE(rawrtc_init());
+
+    // Debug
+    dbg_init(DBG_DEBUG, DBG_ALL);
+    DEBUG_PRINTF("Init\n");
+
+    // Get artificial limit and maximum (optional)
+    if (argc > 1 && !str_to_uint16(&limit, argv[1])) {
+        exit_with_usage(argv[0]);
+    }
+    if (argc > 2 && !str_to_uint16(&maximum, argv[2])) {
+        exit_with_usage(argv[0]);
+    }
+
+    // Create ICE gather options
+    // Note: Host candidates only, the loopback path is all we want to probe
+    EOE(rawrtc_ice_gather_options_create(&gather_options, RAWRTC_ICE_GATHER_POLICY_ALL));
+
+    // Set path MTU limits (keeping the default minimum)
+    // Note: The search converges to the largest multiple of the granularity within the limit.
+    if (limit < gather_options->path_mtu_min || maximum < gather_options->path_mtu_min) {
+        DEBUG_WARNING("Limit and maximum must not be below %"PRIu32"\n",
+                      gather_options->path_mtu_min);
+        exit_with_usage(argv[0]);
+    }
+    EOE(rawrtc_ice_gather_options_set_path_mtu(
+            gather_options, gather_options->path_mtu_min, maximum));
+    EOE(rawrtc_ice_gather_options_set_path_mtu_artificial_limit(gather_options, limit));
+    expected_path_mtu = limit < maximum ? limit - limit % RAWRTC_PATH_MTU_GRANULARITY : maximum;
+
+    // Setup client A
+    a->name = "A";
+    a->gather_options = gather_options;
+    a->role = RAWRTC_ICE_ROLE_CONTROLLING;
+    a->sctp_port = 6000;
+    a->other_client = b;
+    a->test = &test;
+
+    // Setup client B
+    b->name = "B";
+    b->gather_options = gather_options;
+    b->role = RAWRTC_ICE_ROLE_CONTROLLED;
+    b->sctp_port = 5000;
+    b->other_client = a;
+    b->test = &test;
+
+    // Initialise clients
+    client_init(a);
+    client_init(b);
+
+    // Start clients
+    client_start(a, b);
+    client_start(b, a);
+
+    // Start timers
+    tmr_init(&test.poll_timer);
+    tmr_init(&test.timeout_timer);
+    tmr_start(&test.poll_timer, TEST_POLL_INTERVAL, poll_handler, &test);
+    tmr_start(&test.timeout_timer, TEST_TIMEOUT, timeout_handler, NULL);
+
+    // Start main loop (until the message has been received or timeout)
+    EOR(re_main(default_signal_handler));
+    tmr_cancel(&test.poll_timer);
+    tmr_cancel(&test.timeout_timer);
+
+    // Check
+    passed = client_check(a, expected_path_mtu);
+    passed = client_check(b, expected_path_mtu) && passed;
+    passed = test.sent && test.n_received == TEST_MESSAGE_SIZE && passed;
+    DEBUG_INFO("Path MTU discovery with limit %"PRIu16" and maximum %"PRIu16": %s\n",
+               limit, maximum, passed ? "passed" : "FAILED");
+
+    // Stop clients
+    client_stop(a);
+    client_stop(b);
+
+    // Free
+    mem_deref(gather_options);
+
+    // Bye
+    before_exit();
+    return passed ? 0 : 1;
+}
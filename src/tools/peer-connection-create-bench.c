@@ -0,0 +1,239 @@
+#include <rawrtc.h>
+#include "helper/utils.h"
+#include "helper/handler.h"
+
+#define DEBUG_MODULE "peer-connection-create-bench-app"
+#define DEBUG_LEVEL 7
+#include <re_dbg.h>
+
+enum {
+    BENCH_N_CONNECTIONS_DEFAULT = 1000,
+    BENCH_POOL_SIZE = 64,
+    BENCH_POOL_WORKERS = 2
+};
+
+/*
+ * Where the certificates of the peer connections come from.
+ */
+enum bench_certificates {
+    BENCH_CERTIFICATES_PEM, // one certificate for all peer connections, loaded from PEM
+    BENCH_CERTIFICATES_GENERATE, // generated for each peer connection
+    BENCH_CERTIFICATES_POOL // taken from a certificate pool for each peer connection
+};
+
+static char const* const bench_certificates_names[] = {"pem", "generate", "pool"};
+
+/*
+ * A peer connection along with its pre-negotiated data channel and
+ * offer.
+ */
+struct bench_connection {
+    struct rawrtc_peer_connection* connection;
+    struct rawrtc_data_channel* channel;
+    struct rawrtc_peer_connection_description* offer;
+};
+
+static void negotiation_needed_handler(
+        void* const arg
+) {
+    (void) arg;
+    // Nothing to do, the offer is created right away
+}
+
+/*
+ * Create a peer connection, add a pre-negotiated data channel (which
+ * creates the ICE, DTLS and SCTP transports) and create an offer.
+ */
+static void bench_connection_create(
+        struct bench_connection* const bench,
+        struct rawrtc_peer_connection_configuration* const configuration,
+        struct rawrtc_data_channel_parameters* const channel_parameters
+) {
+    // Create peer connection
+    EOE(rawrtc_peer_connection_create(
+            &bench->connection, configuration, negotiation_needed_handler,
+            NULL, NULL, NULL, NULL, NULL, NULL, NULL, NULL));
+
+    // Create pre-negotiated data channel
+    EOE(rawrtc_peer_connection_create_data_channel(
+            &bench->channel, bench->connection, channel_parameters, NULL,
+            NULL, NULL, NULL, NULL, NULL, NULL));
+
+    // Create offer
+    EOE(rawrtc_peer_connection_create_offer(&bench->offer, bench->connection, false));
+}
+
+static void bench_connection_close(
+        struct bench_connection* const bench
+) {
+    // Close peer connection
+    EOE(rawrtc_peer_connection_close(bench->connection));
+
+    // Un-reference
+    mem_deref(bench->offer);
+    mem_deref(bench->channel);
+    mem_deref(bench->connection);
+}
+
+/*
+ * Generate a certificate and load it again from PEM, like a long-lived
+ * certificate would be loaded at startup.
+ */
+static void load_certificate(
+        struct rawrtc_certificate** const certificatep
+) {
+    struct rawrtc_certificate* generated;
+    char* pem;
+    size_t pem_length;
+
+    // Generate and encode
+    EOE(rawrtc_certificate_generate(&generated, NULL));
+    EOE(rawrtc_certificate_get_pem(&pem, &pem_length, generated, RAWRTC_CERTIFICATE_ENCODE_BOTH));
+
+    // Load
+    EOE(rawrtc_certificate_from_pem(certificatep, pem, pem_length));
+
+    // Un-reference
+    mem_deref(pem);
+    mem_deref(generated);
+}
+
+/*
+ * Wait until the certificate pool has been filled.
+ */
+static void wait_for_pool(
+        struct rawrtc_certificate_pool* const pool
+) {
+    struct rawrtc_certificate_pool_statistics statistics;
+
+    do {
+        sys_msleep(10);
+        EOE(rawrtc_certificate_pool_get_statistics(&statistics, pool));
+    } while (statistics.available < BENCH_POOL_SIZE);
+}
+
+int main(int argc, char* argv[argc + 1]) {
+    uint16_t n_connections = BENCH_N_CONNECTIONS_DEFAULT;
+    bool context_sharing = true;
+    enum bench_certificates certificates = BENCH_CERTIFICATES_PEM;
+    struct rawrtc_certificate* certificate = NULL;
+    struct rawrtc_certificate_pool* pool = NULL;
+    struct rawrtc_certificate_pool_statistics pool_statistics = {0};
+    struct rawrtc_peer_connection_configuration* configuration;
+    struct rawrtc_data_channel_parameters* channel_parameters;
+    struct bench_connection* connections;
+    uint64_t start;
+    uint64_t elapsed_create;
+    uint64_t elapsed_close;
+    uint16_t i;
+
+    // Initialise
+    EOE(rawrtc_init());
+
+    // Debug
+    dbg_init(DBG_INFO, DBG_ALL);
+    DEBUG_PRINTF("Init\n");
+
+    // Get amount of peer connections (optional)
+    if (argc > 1 && (!str_to_uint16(&n_connections, argv[1]) || n_connections == 0)) {
+        DEBUG_WARNING("Invalid amount of peer connections: %s\n", argv[1]);
+        return 1;
+    }
+
+    // Get DTLS context mode (optional)
+    if (argc > 2) {
+        if (str_casecmp(argv[2], "separate") == 0) {
+            context_sharing = false;
+        } else if (str_casecmp(argv[2], "shared") != 0) {
+            DEBUG_WARNING("Invalid DTLS context mode: %s\n", argv[2]);
+            return 1;
+        }
+    }
+
+    // Get certificate source (optional)
+    if (argc > 3) {
+        if (str_casecmp(argv[3], "generate") == 0) {
+            certificates = BENCH_CERTIFICATES_GENERATE;
+        } else if (str_casecmp(argv[3], "pool") == 0) {
+            certificates = BENCH_CERTIFICATES_POOL;
+        } else if (str_casecmp(argv[3], "pem") != 0) {
+            DEBUG_WARNING("Invalid certificate source: %s\n", argv[3]);
+            return 1;
+        }
+    }
+
+    // Create peer connection configuration (host candidates only)
+    EOE(rawrtc_peer_connection_configuration_create(
+            &configuration, RAWRTC_ICE_GATHER_POLICY_ALL));
+    EOE(rawrtc_peer_connection_configuration_set_dtls_context_sharing(
+            configuration, context_sharing));
+
+    // Set up certificates
+    switch (certificates) {
+        case BENCH_CERTIFICATES_PEM:
+            load_certificate(&certificate);
+            EOE(rawrtc_peer_connection_configuration_add_certificate(configuration, certificate));
+            break;
+        case BENCH_CERTIFICATES_POOL:
+            EOE(rawrtc_certificate_pool_create(
+                    &pool, NULL, BENCH_POOL_SIZE, BENCH_POOL_WORKERS));
+            EOE(rawrtc_peer_connection_configuration_set_certificate_pool(configuration, pool));
+            wait_for_pool(pool);
+            break;
+        default:
+            // Generated by the peer connection on demand
+            break;
+    }
+
+    // Create data channel parameters
+    EOE(rawrtc_data_channel_parameters_create(
+            &channel_parameters, "bench", RAWRTC_DATA_CHANNEL_TYPE_RELIABLE_ORDERED, 0, NULL,
+            true, 0));
+
+    // Allocate peer connections
+    connections = mem_zalloc(n_connections * sizeof(*connections), NULL);
+    EOE(connections ? RAWRTC_CODE_SUCCESS : RAWRTC_CODE_NO_MEMORY);
+
+    // Create peer connections
+    // Note: All peer connections are kept alive, like on a server with many peers.
+    start = tmr_jiffies();
+    for (i = 0; i < n_connections; ++i) {
+        bench_connection_create(&connections[i], configuration, channel_parameters);
+    }
+    elapsed_create = tmr_jiffies() - start;
+
+    // Get pool statistics
+    if (pool) {
+        EOE(rawrtc_certificate_pool_get_statistics(&pool_statistics, pool));
+    }
+
+    // Close peer connections
+    start = tmr_jiffies();
+    for (i = 0; i < n_connections; ++i) {
+        bench_connection_close(&connections[i]);
+    }
+    elapsed_close = tmr_jiffies() - start;
+
+    // Print creation rate
+    DEBUG_INFO("%"PRIu16" peer connections (DTLS contexts %s, certificates %s): created in "
+               "%"PRIu64" ms (%"PRIu64" per second, %"PRIu64" us each), closed in %"PRIu64" ms\n",
+               n_connections, context_sharing ? "shared" : "separate",
+               bench_certificates_names[certificates], elapsed_create,
+               (uint64_t) n_connections * 1000 / (elapsed_create > 0 ? elapsed_create : 1),
+               elapsed_create * 1000 / n_connections, elapsed_close);
+    if (pool) {
+        DEBUG_INFO("Certificate pool: %"PRIu64" taken, %"PRIu64" generated on demand\n",
+                   pool_statistics.taken, pool_statistics.generated_on_demand);
+    }
+
+    // Free
+    mem_deref(connections);
+    mem_deref(channel_parameters);
+    mem_deref(configuration);
+    mem_deref(pool);
+    mem_deref(certificate);
+
+    // Bye
+    before_exit();
+    return 0;
+}
@@ -9,6 +9,10 @@
 #define DEBUG_LEVEL 7
 #include <re_dbg.h>
 
+enum {
+    STATISTICS_INTERVAL = 1000 // in milliseconds
+};
+
 struct parameters {
     struct rawrtc_ice_parameters* ice_parameters;
     struct rawrtc_ice_candidates* ice_candidates;
@@ -32,6 +36,8 @@ struct sctp_redirect_transport_client {
     struct rawrtc_sctp_redirect_transport* sctp_redirect_transport;
     struct parameters local_parameters;
     struct parameters remote_parameters;
+    struct tmr statistics_timer;
+    struct rawrtc_sctp_redirect_transport_statistics statistics;
 };
 
 static void print_local_parameters(
@@ -54,6 +60,35 @@ static void ice_gatherer_local_candidate_handler(
     }
 }
 
+static void print_statistics(
+        void* arg
+) {
+    struct sctp_redirect_transport_client* const client = arg;
+    struct rawrtc_sctp_redirect_transport_statistics statistics;
+    struct rawrtc_sctp_redirect_transport_statistics* const previous = &client->statistics;
+
+    // Get statistics
+    EOE(rawrtc_sctp_redirect_transport_get_statistics(
+            &statistics, client->sctp_redirect_transport));
+
+    // Print packets per interval and per system call (if any)
+    if (statistics.packets_received != previous->packets_received
+            || statistics.packets_sent != previous->packets_sent) {
+        DEBUG_INFO("(%s) Redirected %"PRIu64" packets/s from RAW (%"PRIu64" receive calls), "
+                   "%"PRIu64" packets/s to RAW (%"PRIu64" send calls)\n", client->name,
+                   (statistics.packets_received - previous->packets_received)
+                   * 1000 / STATISTICS_INTERVAL,
+                   statistics.receive_calls - previous->receive_calls,
+                   (statistics.packets_sent - previous->packets_sent)
+                   * 1000 / STATISTICS_INTERVAL,
+                   statistics.send_calls - previous->send_calls);
+    }
+    *previous = statistics;
+
+    // Restart timer
+    tmr_start(&client->statistics_timer, STATISTICS_INTERVAL, print_statistics, client);
+}
+
 static void client_init(
         struct sctp_redirect_transport_client* const client
 ) {
@@ -123,6 +158,9 @@ static void client_start_transports(
     EOE(rawrtc_sctp_redirect_transport_start(
             client->sctp_redirect_transport, remote_parameters->sctp_parameters.capabilities,
             remote_parameters->sctp_parameters.port));
+
+    // Print statistics periodically
+    tmr_start(&client->statistics_timer, STATISTICS_INTERVAL, print_statistics, client);
 }
 
 static void parameters_destroy(
@@ -141,6 +179,7 @@ static void parameters_destroy(
 static void client_stop(
         struct sctp_redirect_transport_client* const client
 ) {
+    tmr_cancel(&client->statistics_timer);
     EOE(rawrtc_sctp_redirect_transport_stop(client->sctp_redirect_transport));
     EOE(rawrtc_dtls_transport_stop(client->dtls_transport));
     EOE(rawrtc_ice_transport_stop(client->ice_transport));
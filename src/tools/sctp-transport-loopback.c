@@ -146,6 +146,12 @@ static void client_start(
 static void client_stop(
         struct sctp_transport_client* const client
 ) {
+    size_t size;
+
+    // Print memory used per association
+    EOE(rawrtc_sctp_transport_get_memory_usage(&size, client->sctp_transport));
+    DEBUG_INFO("(%s) SCTP transport memory usage: %zu bytes\n", client->name, size);
+
     // Stop transports & close gatherer
     EOE(rawrtc_sctp_transport_stop(client->sctp_transport));
     EOE(rawrtc_dtls_transport_stop(client->dtls_transport));